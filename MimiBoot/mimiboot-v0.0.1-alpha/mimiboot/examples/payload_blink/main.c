@@ -146,6 +146,13 @@ void payload_main(mimi_handoff_t* handoff) {
         uart_puthex(handoff->image.entry);
         uart_puts("\n");
         
+        uart_puts("  Boot count: ");
+        uart_puthex(handoff->boot_count);
+        uart_puts("\n");
+        
+        /* Up and running: don't count this boot as a failed one */
+        MIMI_HANDOFF_CONFIRM(handoff);
+    
     } else {
         uart_puts("No handoff structure (booted directly?)\n");
     }
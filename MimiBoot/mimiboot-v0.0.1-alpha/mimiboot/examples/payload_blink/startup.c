@@ -35,7 +35,7 @@ void _entry(void) {
         "ldr r0, =__stack_top__     \n"
         "mov sp, r0                 \n"
         
-        /* Zero BSS */
+        /* Zero BSS (the loader skips it with zero_bss = 0) */
         "ldr r0, =__bss_start__     \n"
         "ldr r1, =__bss_end__       \n"
         "movs r2, #0                \n"
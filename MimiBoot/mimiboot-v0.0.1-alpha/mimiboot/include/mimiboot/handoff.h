@@ -76,6 +76,23 @@
 #define MIMI_SOURCE_USB         0x00000020  /* USB download */
 #define MIMI_SOURCE_INTERNAL    0x00000040  /* Internal flash (fallback) */
 
+/*============================================================================
+ * Boot Flags
+ *============================================================================*/
+
+#define MIMI_FLAG_PROFILE       0x00000001  /* profile_addr points to a boot profile */
+#define MIMI_FLAG_IMAGE_CRC     0x00000002  /* image.crc32 was computed during load */
+#define MIMI_FLAG_BSS_UNZEROED  0x00000004  /* Some BSS is listed as MIMI_REGION_UNZEROED */
+#define MIMI_FLAG_RESUMED       0x00000008  /* Image was already in RAM; storage not touched */
+#define MIMI_FLAG_CONFIRM       0x00000010  /* confirm_addr is counting boots; confirm when healthy */
+
+/**
+ * Value written to confirm_addr by MIMI_HANDOFF_CONFIRM. Until it is
+ * written, every reset that runs the image again counts as a failed
+ * boot, and after max_retries of them the loader boots the fallback.
+ */
+#define MIMI_BOOT_CONFIRMED     0x600DB007
+
 /*============================================================================
  * Memory Region Description
  *============================================================================*/
@@ -90,6 +107,11 @@
 #define MIMI_REGION_PAYLOAD     0x00000020  /* Payload loaded here */
 #define MIMI_REGION_HANDOFF     0x00000040  /* Handoff struct here */
 #define MIMI_REGION_RESERVED    0x00000080  /* Reserved, do not use */
+#define MIMI_REGION_UNZEROED    0x00000100  /* Payload BSS not cleared by the loader */
+#define MIMI_REGION_LOGBUF      0x00000200  /* Boot messages (mimi_logbuf_t) */
+#define MIMI_REGION_STRIPED     0x00000400  /* RAM interleaved across banks */
+#define MIMI_REGION_SCRATCH     0x00000800  /* RAM bank of its own (no contention) */
+#define MIMI_REGION_BLOB        0x00001000  /* File from a boot.cfg load line */
 
 /**
  * Memory region descriptor.
@@ -98,7 +120,7 @@ typedef struct {
     uint32_t    base;       /* Region base address */
     uint32_t    size;       /* Region size in bytes */
     uint32_t    flags;      /* Region flags (MIMI_REGION_*) */
-    uint32_t    reserved;   /* Reserved for alignment */
+    uint32_t    reserved;   /* MIMI_REGION_BLOB: load line index, else 0 */
 } mimi_region_t;
 
 /**
@@ -117,10 +139,142 @@ typedef struct {
     uint32_t    entry;          /* Entry point address */
     uint32_t    load_base;      /* Lowest load address */
     uint32_t    load_size;      /* Total size in memory */
-    uint32_t    crc32;          /* CRC32 of loaded data (0 if not computed) */
+    uint32_t    crc32;          /* CRC32 of loaded data (MIMI_FLAG_IMAGE_CRC) */
     char        name[32];       /* Image filename (null-terminated) */
 } mimi_image_info_t;
 
+/*============================================================================
+ * Boot Profile
+ *============================================================================*/
+
+/**
+ * Boot profile magic number: 'PROF' in little-endian
+ */
+#define MIMI_PROFILE_MAGIC      0x464F5250
+
+/**
+ * Boot profile version.
+ * New fields are only appended; check struct_size before reading them.
+ */
+#define MIMI_PROFILE_VERSION    1
+
+/**
+ * Boot phases, in the order they normally run.
+ */
+#define MIMI_PHASE_STORAGE_INIT 0   /* Storage subsystem (SPI, GPIO) */
+#define MIMI_PHASE_SD_INIT      1   /* Card identification and clock setup */
+#define MIMI_PHASE_MOUNT        2   /* FAT32 mount */
+#define MIMI_PHASE_CONFIG       3   /* boot.cfg load and parse */
+#define MIMI_PHASE_FILE_OPEN    4   /* Image lookup and open */
+#define MIMI_PHASE_PARSE        5   /* ELF header and program headers */
+#define MIMI_PHASE_COPY         6   /* Segment data copy (all segments) */
+#define MIMI_PHASE_BSS          7   /* BSS zeroing */
+#define MIMI_PHASE_VERIFY       8   /* Read-back verification */
+#define MIMI_PHASE_HANDOFF      9   /* Handoff construction */
+#define MIMI_PHASE_CORE1_WAIT   10  /* Waiting for core 1 to finish queued work */
+#define MIMI_PHASE_CRC          11  /* Image CRC32 */
+#define MIMI_PHASE_MANIFEST     12  /* Boot manifest check and update */
+#define MIMI_PHASE_RESUME       13  /* Resume check and writable data restore */
+#define MIMI_PHASE_COUNT        14
+#define MIMI_PHASE_MAX          16  /* Slots reserved in the profile */
+
+/**
+ * Per-segment copy times recorded.
+ */
+#define MIMI_PROFILE_SEGMENTS   8
+
+/**
+ * Timing of one boot phase.
+ * Phases that run several times accumulate into duration_us.
+ */
+typedef struct {
+    uint32_t    start_us;       /* Time of first entry (0 if never run) */
+    uint32_t    duration_us;    /* Total time spent in phase */
+} mimi_phase_time_t;
+
+/**
+ * Boot profile, pointed to by mimi_handoff_t.profile_addr when
+ * MIMI_FLAG_PROFILE is set in boot_flags. All times are from
+ * hal_get_time_us (microseconds since reset).
+ */
+typedef struct {
+    uint32_t            magic;          /* MIMI_PROFILE_MAGIC */
+    uint32_t            version;        /* MIMI_PROFILE_VERSION */
+    uint32_t            struct_size;    /* sizeof(mimi_boot_profile_t) */
+    uint32_t            phase_count;    /* Valid entries in phases[] */
+    
+    mimi_phase_time_t   phases[MIMI_PHASE_MAX];
+    
+    /* Per-segment copy time, in load order (first MIMI_PROFILE_SEGMENTS) */
+    uint32_t            segment_count;
+    uint32_t            segment_us[MIMI_PROFILE_SEGMENTS];
+    
+    /* Storage and filesystem counters */
+    uint32_t            storage_cmds;   /* Commands issued to the card */
+    uint32_t            sectors_read;   /* 512-byte sectors transferred */
+    uint32_t            fat_lookups;    /* FAT entry lookups */
+    uint32_t            fat_reads;      /* FAT sectors read (cache misses) */
+    
+    /* Loader counters */
+    uint32_t            bytes_copied;   /* Bytes copied from file */
+    uint32_t            bytes_zeroed;   /* Bytes zeroed (BSS) */
+    
+    /* Block cache counters */
+    uint32_t            block_hits;     /* Sector reads served from the block cache */
+    uint32_t            block_misses;   /* Sector reads that went to the card */
+    uint32_t            readahead_reads;/* Read-ahead transfers issued */
+
+} mimi_boot_profile_t;
+
+/*============================================================================
+ * Log Buffer
+ *============================================================================*/
+
+/**
+ * Log buffer magic number: 'LOGB' in little-endian
+ */
+#define MIMI_LOGBUF_MAGIC       0x42474F4C
+
+/**
+ * Log buffer version.
+ */
+#define MIMI_LOGBUF_VERSION     1
+
+/**
+ * Boot messages, in the RAM region flagged MIMI_REGION_LOGBUF. Every
+ * message is kept as an unformatted record, whether or not it went to
+ * the console; the oldest records are dropped when the ring is full.
+ * 
+ * Records start at data + head and take up used bytes, wrapping at
+ * size. A record never wraps: one with size 0 pads to the end of data,
+ * and the next record is at offset 0.
+ */
+typedef struct {
+    uint32_t    magic;          /* MIMI_LOGBUF_MAGIC */
+    uint32_t    version;        /* MIMI_LOGBUF_VERSION */
+    uint32_t    size;           /* Bytes of data[] */
+    uint32_t    head;           /* Offset of the oldest record */
+    uint32_t    used;           /* Bytes of records from head, padding included */
+    uint32_t    dropped;        /* Records lost to wrapping or too large to keep */
+    uint32_t    reserved[2];
+    uint8_t     data[];         /* Records */
+} mimi_logbuf_t;
+
+/**
+ * One boot message: render format with args as printf would, for the
+ * conversions %d %i %u %x %X %s %c with field widths (%08X). Each
+ * conversion but %% takes one argument; for %s it is the offset of a
+ * NUL-terminated copy of the string within the record. The format string stays in loader flash.
+ */
+typedef struct {
+    uint16_t    size;           /* Record bytes, a multiple of 4 (0: padding) */
+    uint8_t     arg_count;      /* Entries in args[] */
+    uint8_t     reserved;
+    uint32_t    format;         /* Format string address */
+    uint32_t    time_us;        /* Microseconds since reset */
+    uint32_t    args[];         /* Arguments, in order */
+} mimi_logbuf_entry_t;
+
 /*============================================================================
  * Main Handoff Structure
  *============================================================================*/
@@ -143,7 +297,7 @@ typedef struct {
     /*--- Boot Context (offset 0x10) ---*/
     uint32_t    boot_reason;        /* Reset cause (MIMI_BOOT_*) */
     uint32_t    boot_source;        /* Image source (MIMI_SOURCE_*) */
-    uint32_t    boot_count;         /* Boot attempt counter */
+    uint32_t    boot_count;         /* Unconfirmed boots of this image, this one included */
     uint32_t    boot_flags;         /* Additional flags */
     
     /*--- Timing (offset 0x20) ---*/
@@ -166,9 +320,10 @@ typedef struct {
     uint32_t    reserved_regions;   /* Reserved */
     mimi_region_t regions[MIMI_MAX_REGIONS];  /* Memory region descriptors */
     
-    /*--- Reserved for future use ---*/
-    uint32_t    reserved[8];
-    
+    /*--- Extensions (offset 0xF8) ---*/
+    uint32_t    profile_addr;       /* mimi_boot_profile_t address (MIMI_FLAG_PROFILE) */
+    uint32_t    confirm_addr;       /* Boot counter word (MIMI_FLAG_CONFIRM) */
+
 } mimi_handoff_t;
 
 /*============================================================================
@@ -194,6 +349,24 @@ _Static_assert(sizeof(mimi_handoff_t) == 256,
      (h)->magic == MIMI_HANDOFF_MAGIC && \
      (h)->version == MIMI_HANDOFF_VERSION)
 
+/**
+ * Get boot profile from handoff, or NULL if not provided.
+ */
+#define MIMI_HANDOFF_PROFILE(h) \
+    (((h)->boot_flags & MIMI_FLAG_PROFILE) ? \
+     (const mimi_boot_profile_t*)(uintptr_t)(h)->profile_addr : NULL)
+
+/**
+ * Confirm a good boot: the image is not counted as failing when it is
+ * next reset. Call once the payload is known to be healthy.
+ */
+#define MIMI_HANDOFF_CONFIRM(h) \
+    do { \
+        if ((h)->boot_flags & MIMI_FLAG_CONFIRM) { \
+            *(volatile uint32_t*)(uintptr_t)(h)->confirm_addr = MIMI_BOOT_CONFIRMED; \
+        } \
+    } while (0)
+
 /**
  * Get end of RAM from handoff.
  */
@@ -0,0 +1,625 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * boot_flow.c - Boot Policy
+ */
+
+#include "boot_flow.h"
+#include "mem.h"
+#include "crc32.h"
+#include "profile.h"
+#include "manifest.h"
+#include "resume.h"
+#include "probe.h"
+#include "delta.h"
+#include "bootstate.h"
+#include "../hal/hal.h"
+
+/*============================================================================
+ * Static State
+ *============================================================================*/
+
+static const mimi_flow_ops_t* s_ops;
+static fat32_fs_t*      s_fs;
+static mimi_config_t*   s_config;
+static mimi_flow_status_t s_status;
+
+static mimi_manifest_t  s_manifest;     /* Built during a cold boot */
+static mimi_bootstate_t s_bootstate;    /* Boot attempts as found at reset */
+static uint32_t         s_give_up;      /* Image given up on during this boot (0 if none) */
+
+/* Selected image (or delta), and the layout it is loaded from */
+static fat32_file_t     s_image;
+static const mimi_elf_layout_t* s_layout;
+
+/* boot.cfg text being parsed: too large for the boot stack */
+static char             s_config_text[CONFIG_MAX_FILE];
+
+#define LOG(fmt, ...) \
+    do { \
+        if (s_ops->log != NULL) { \
+            s_ops->log(false, fmt, ##__VA_ARGS__); \
+        } \
+    } while(0)
+
+#define LOG_VERBOSE(fmt, ...) \
+    do { \
+        if (s_ops->log != NULL) { \
+            s_ops->log(true, fmt, ##__VA_ARGS__); \
+        } \
+    } while(0)
+
+/*============================================================================
+ * Image I/O
+ *============================================================================*/
+
+static int32_t flow_io_read(mimi_file_t file, uint32_t offset, void* buffer, uint32_t size) {
+    fat32_file_t* f = (fat32_file_t*)file;
+    
+    if (fat32_seek(f, offset) != FAT32_OK) {
+        return -1;
+    }
+    return fat32_read(f, buffer, size);
+}
+
+static int32_t flow_io_size(mimi_file_t file) {
+    return fat32_size((fat32_file_t*)file);
+}
+
+const mimi_io_ops_t mimi_flow_io = {
+    .read = flow_io_read,
+    .size = flow_io_size,
+};
+
+/*============================================================================
+ * Boot Attempts
+ *============================================================================*/
+
+/**
+ * Read the retained attempt count and the log of images given up on.
+ */
+static void bootstate_read(void) {
+    uint32_t log_size;
+    const void* log = s_ops->nv_data(HAL_NV_LOG, &log_size);
+    uint32_t retained = 0;
+    
+    if (s_ops->retain_count() > MIMI_BOOTCOUNT_WORD) {
+        retained = s_ops->retain_get(MIMI_BOOTCOUNT_WORD);
+    }
+    mimi_bootstate_read(&s_bootstate, retained, log, log_size);
+}
+
+/**
+ * Check whether an image has used up its attempts. Without a fallback
+ * there is nothing else to boot, so the count never runs out.
+ */
+static bool bootstate_exhausted(const fat32_file_t* image, const mimi_config_t* config) {
+    uint32_t attempts = mimi_bootstate_attempts(&s_bootstate, mimi_bootstate_image_id(image));
+    return config->has_fallback && attempts >= config->max_retries;
+}
+
+/**
+ * Count this boot of the configured image. The payload clears the
+ * count by confirming; until then every reset back into it adds one.
+ */
+static void bootstate_count(const fat32_file_t* image) {
+    uint32_t id = mimi_bootstate_image_id(image);
+    
+    s_config->boot_count = mimi_bootstate_attempts(&s_bootstate, id);
+    mimi_config_boot_attempt(s_config);
+    
+    if (s_ops->retain_count() > MIMI_BOOTCOUNT_WORD) {
+        s_ops->retain_set(MIMI_BOOTCOUNT_WORD, mimi_bootstate_arm(id, s_config->boot_count));
+        s_status.confirm_addr = s_ops->retain_addr(MIMI_BOOTCOUNT_WORD);
+    }
+}
+
+/**
+ * Record the image given up on in flash, so it stays skipped after
+ * power-on clears the retained count.
+ */
+static bool bootstate_give_up(void) {
+    mimi_bootlog_record_t record;
+    uint32_t offset;
+    bool erase;
+    
+    if (s_give_up == 0 ||
+        !mimi_bootstate_give_up(&s_bootstate, s_give_up, &record, &offset, &erase)) {
+        return false;
+    }
+    
+    if (s_ops->nv_append(HAL_NV_LOG, offset, &record, sizeof(record), erase) != 0) {
+        return false;
+    }
+    LOG_VERBOSE("Boot log: image %06X given up\n", s_give_up);
+    return true;
+}
+
+/*============================================================================
+ * Fast Resume
+ *============================================================================*/
+
+/**
+ * Read the resume record from the retained words (zeros if the
+ * platform has too few).
+ */
+static void resume_read(mimi_resume_record_t* record) {
+    uint32_t* words = (uint32_t*)record;
+    bool present = s_ops->retain_count() >= MIMI_RESUME_WORDS;
+    
+    for (uint32_t i = 0; i < MIMI_RESUME_WORDS; i++) {
+        words[i] = present ? s_ops->retain_get(i) : 0;
+    }
+}
+
+/**
+ * Arm the record for the image just loaded, if it was loaded from the
+ * stored manifest's layout and can be rebuilt without storage.
+ */
+static bool resume_update(void) {
+    uint32_t nv_size;
+    const mimi_manifest_t* stored = (const mimi_manifest_t*)s_ops->nv_data(HAL_NV_MANIFEST, &nv_size);
+    
+    if (!s_config->resume || s_ops->retain_count() < MIMI_RESUME_WORDS ||
+        !mimi_manifest_valid(stored, nv_size) ||
+        mimi_memcmp(&stored->layout, s_layout, sizeof(*s_layout)) != 0 ||
+        !mimi_resume_supported(s_layout)) {
+        return false;
+    }
+    
+    mimi_resume_record_t record;
+    mimi_resume_arm(&record, stored);
+    
+    /* Magic (word 0) last, so a partial record never validates */
+    const uint32_t* words = (const uint32_t*)&record;
+    for (uint32_t i = MIMI_RESUME_WORDS; i-- > 0; ) {
+        s_ops->retain_set(i, words[i]);
+    }
+    LOG_VERBOSE("Resume armed\n");
+    return true;
+}
+
+/*============================================================================
+ * Image Selection
+ *============================================================================*/
+
+/* Candidate images for this boot */
+static mimi_probe_set_t s_probe;
+
+/**
+ * Probe the boot image, the fallback and the boot menu images together,
+ * then select the boot image if it is valid and has attempts left, else
+ * the fallback. The selected image's handle and layout go to s_image
+ * and s_manifest.
+ * 
+ * @param image_path    In: image to boot; out: image selected
+ * @param loader_config Loader configuration used for validation
+ * @return              MIMI_OK, or why the boot image cannot be loaded
+ */
+static mimi_err_t probe_select(const char** image_path, const mimi_loader_config_t* loader_config) {
+    const char* fallback_path = MIMI_CONFIG_STR(s_config, s_config->fallback_path);
+    
+    mimi_probe_init(&s_probe);
+    mimi_probe_add(&s_probe, *image_path);
+    if (s_config->has_fallback) {
+        mimi_probe_add(&s_probe, fallback_path);
+    }
+    for (uint32_t i = 0; i < s_config->image_count; i++) {
+        if (s_config->images[i].valid) {
+            mimi_probe_add(&s_probe, MIMI_CONFIG_STR(s_config, s_config->images[i].path));
+        }
+    }
+    
+    mimi_probe_run(&s_probe, s_fs, loader_config);
+    
+    const mimi_probe_t* probe = mimi_probe_find(&s_probe, *image_path);
+    bool exhausted = probe->status == MIMI_OK && bootstate_exhausted(&probe->file, s_config);
+    
+    if ((probe->status != MIMI_OK || exhausted) && s_config->has_fallback) {
+        const mimi_probe_t* fallback = mimi_probe_find(&s_probe, fallback_path);
+        
+        if (fallback != NULL && fallback->status == MIMI_OK) {
+            if (exhausted) {
+                LOG("Primary image: %u boots unconfirmed, using fallback\n",
+                    mimi_bootstate_attempts(&s_bootstate, mimi_bootstate_image_id(&probe->file)));
+                s_give_up = mimi_bootstate_image_id(&probe->file);
+            } else {
+                LOG("Primary image: %s, using fallback\n", mimi_strerror(probe->status));
+            }
+            probe = fallback;
+            *image_path = fallback_path;
+            s_status.fallback = true;
+        }
+    }
+    
+    if (probe->status == MIMI_OK) {
+        s_image = probe->file;
+        s_manifest.layout = probe->layout;
+    }
+    return probe->status;
+}
+
+/*============================================================================
+ * Delta Images
+ *============================================================================*/
+
+/* Configured delta, read in place of the boot image */
+static mimi_delta_t s_delta;
+
+/* Image cache header, built in RAM before it is written to flash */
+static mimi_delta_cache_t s_delta_cache;
+
+/**
+ * Build the boot image from the configured delta, if it applies to the
+ * image still in RAM or the one in the image cache. Its layout goes to
+ * s_manifest like a probed image's. On failure the full image is
+ * loaded instead, over whatever this left in RAM.
+ * 
+ * @param loader_config Loader configuration for the boot image
+ * @param result        Output: load result
+ * @return              true if the image was rebuilt and checked
+ */
+static bool delta_load(const mimi_loader_config_t* loader_config, mimi_load_result_t* result) {
+    const char* path = MIMI_CONFIG_STR(s_config, s_config->delta_path);
+    
+    if (fat32_open(s_fs, path, &s_image) != FAT32_OK) {
+        LOG_VERBOSE("Delta %s not found\n", path);
+        return false;
+    }
+    
+    /* Counted like an image: a rebuild that keeps failing is given up */
+    if (bootstate_exhausted(&s_image, s_config)) {
+        LOG("Delta: %u boots unconfirmed, loading full image\n",
+            mimi_bootstate_attempts(&s_bootstate, mimi_bootstate_image_id(&s_image)));
+        return false;
+    }
+    
+    /* The rebuilt image is read as if it were on the card */
+    mimi_loader_config_t config = *loader_config;
+    config.io = &mimi_delta_io;
+    config.compute_crc = true;
+    
+    uint32_t cache_size;
+    const void* cache = s_ops->cache_data(&cache_size);
+    
+    mimi_profile_begin(MIMI_PHASE_PARSE);
+    mimi_err_t err = mimi_delta_open(&s_delta, &mimi_flow_io, &s_image);
+    if (err == MIMI_OK) {
+        err = mimi_elf_parse(&config, &s_delta, &s_manifest.layout);
+    }
+    if (err == MIMI_OK) {
+        err = mimi_delta_bind(&s_delta, &s_manifest.layout, cache, cache_size);
+    }
+    mimi_profile_end(MIMI_PHASE_PARSE);
+    
+    if (err == MIMI_OK) {
+        LOG("Delta %s against the image in %s\n", path, s_delta.cache ? "flash" : "RAM");
+        err = mimi_elf_load_layout(&config, &s_delta, &s_manifest.layout, result);
+    }
+    
+    if (err != MIMI_OK) {
+        LOG("Delta %s: %s, loading full image\n", path, mimi_strerror(err));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * After a full load of the boot image, keep a copy in the image cache
+ * as the base for the next delta, unless it holds this image already.
+ */
+static bool delta_cache_update(const mimi_load_result_t* result) {
+    uint32_t cache_size;
+    const mimi_delta_cache_t* stored = (const mimi_delta_cache_t*)s_ops->cache_data(&cache_size);
+    
+    if (mimi_delta_cache_valid(stored, cache_size) && stored->image_crc == result->crc32) {
+        return false;
+    }
+    if (!mimi_delta_cache_build(&s_delta_cache, s_layout, result, cache_size)) {
+        LOG_VERBOSE("Image cache: image does not fit\n");
+        return false;
+    }
+    
+    LOG("Saving image to flash cache...\n");
+    
+    /* Header erased first and written last: a cut-off update leaves no cache */
+    int rc = s_ops->cache_write(0, NULL, 0);
+    for (uint32_t i = 0; i < s_delta_cache.segment_count && rc == 0; i++) {
+        const mimi_delta_cache_seg_t* seg = &s_delta_cache.segments[i];
+        rc = s_ops->cache_write(seg->offset, (const void*)(uintptr_t)seg->vaddr, seg->size);
+    }
+    if (rc == 0) {
+        rc = s_ops->cache_write(0, &s_delta_cache, sizeof(s_delta_cache));
+    }
+    
+    if (rc != 0) {
+        return false;
+    }
+    LOG_VERBOSE("Image cache saved\n");
+    return true;
+}
+
+/*============================================================================
+ * Extra Load Items
+ *============================================================================*/
+
+/* boot.cfg load items, in card order once planned */
+static fat32_file_t s_blob_files[CONFIG_MAX_LOADS];
+static mimi_blob_t s_blobs[CONFIG_MAX_LOADS];
+static uint32_t s_blob_count;
+
+/*============================================================================
+ * Boot Manifest
+ *============================================================================*/
+
+/**
+ * After a cold boot, save what it resolved so the next boot can go
+ * straight to the segment reads, or erase a manifest that no longer
+ * applies. Flash is only written when the contents change.
+ */
+static bool manifest_update(const char* image_path) {
+    uint32_t nv_size;
+    const void* stored = s_ops->nv_data(HAL_NV_MANIFEST, &nv_size);
+    
+    /* A fallback boot must not become the cached one, nor a delta's rebuild */
+    bool wanted = s_config->manifest && s_config->config_loaded && !s_config->has_delta &&
+                  s_config->load_count == 0 &&
+                  image_path == MIMI_CONFIG_STR(s_config, s_config->image_path);
+    
+    if (!wanted || nv_size < sizeof(s_manifest)) {
+        if (mimi_manifest_valid(stored, nv_size)) {
+            s_ops->nv_write(HAL_NV_MANIFEST, NULL, 0);
+            LOG_VERBOSE("Boot manifest erased\n");
+        }
+        return false;
+    }
+    
+    fat32_get_volume(s_fs, &s_manifest.volume);
+    s_manifest.image = s_image;
+    mimi_manifest_seal(&s_manifest);
+    
+    if (mimi_memcmp(stored, &s_manifest, sizeof(s_manifest)) == 0) {
+        return false;
+    }
+    
+    if (s_ops->nv_write(HAL_NV_MANIFEST, &s_manifest, sizeof(s_manifest)) != 0) {
+        return false;
+    }
+    LOG_VERBOSE("Boot manifest saved\n");
+    return true;
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void mimi_flow_init(const mimi_flow_ops_t* ops, fat32_fs_t* fs, mimi_config_t* config) {
+    s_ops = ops;
+    s_fs = fs;
+    s_config = config;
+    mimi_memset(&s_status, 0, sizeof(s_status));
+    s_give_up = 0;
+    s_blob_count = 0;
+    s_layout = &s_manifest.layout;
+    
+    bootstate_read();
+}
+
+const mimi_flow_status_t* mimi_flow_status(void) {
+    return &s_status;
+}
+
+bool mimi_flow_resume(mimi_load_result_t* result) {
+    mimi_resume_record_t record;
+    resume_read(&record);
+    if (record.magic != MIMI_RESUME_MAGIC) {
+        return false;
+    }
+    
+    uint32_t nv_size;
+    const mimi_manifest_t* stored = (const mimi_manifest_t*)s_ops->nv_data(HAL_NV_MANIFEST, &nv_size);
+    if (!mimi_manifest_valid(stored, nv_size) || !stored->config.resume) {
+        return false;
+    }
+    
+    /* An image that keeps resetting is reloaded, and replaced, from the card */
+    if (bootstate_exhausted(&stored->image, &stored->config)) {
+        return false;
+    }
+    
+    mimi_profile_begin(MIMI_PHASE_RESUME);
+    mimi_err_t err = mimi_resume(&record, stored, result);
+    mimi_profile_end(MIMI_PHASE_RESUME);
+    
+    if (err != MIMI_OK) {
+        LOG_VERBOSE("Resume: %s\n", mimi_strerror(err));
+        return false;
+    }
+    
+    *s_config = stored->config;
+    bootstate_count(&stored->image);
+    return true;
+}
+
+void mimi_flow_resume_disarm(void) {
+    if (s_ops->retain_count() >= MIMI_RESUME_WORDS) {
+        s_ops->retain_set(0, 0);
+    }
+}
+
+bool mimi_flow_warm(int (*read_sector)(uint32_t, uint8_t*),
+                    int (*read_sectors)(uint32_t, uint8_t*, uint32_t)) {
+    uint32_t nv_size;
+    const mimi_manifest_t* cached = (const mimi_manifest_t*)s_ops->nv_data(HAL_NV_MANIFEST, &nv_size);
+    
+    /* An image out of attempts goes cold, where the fallback is chosen */
+    if (!mimi_manifest_valid(cached, nv_size) ||
+        bootstate_exhausted(&cached->image, &cached->config)) {
+        return false;
+    }
+    
+    mimi_profile_begin(MIMI_PHASE_MANIFEST);
+    mimi_err_t err = mimi_manifest_open(cached, s_fs, read_sector, &s_image);
+    mimi_profile_end(MIMI_PHASE_MANIFEST);
+    
+    if (err != MIMI_OK) {
+        LOG_VERBOSE("Boot manifest: %s\n", mimi_strerror(err));
+        return false;
+    }
+    
+    fat32_set_multi_read(s_fs, read_sectors);
+    *s_config = cached->config;
+    s_layout = &cached->layout;
+    s_status.warm = true;
+    LOG("Boot manifest matches card, skipping lookup\n");
+    return true;
+}
+
+/* Compiled boot.cfg, built in RAM before it is written to flash */
+static mimi_config_cache_t s_config_cache;
+
+/**
+ * Read boot.cfg into the configuration (see mimi_flow_config_load).
+ */
+static int config_read(const char* path) {
+    fat32_file_t file;
+    
+    if (fat32_open(s_fs, path, &file) != FAT32_OK) {
+        return -1;
+    }
+    
+    /* Any change to boot.cfg invalidates the boot manifest and the compiled copy */
+    s_manifest.config_stamp = file.stamp;
+    uint32_t source = mimi_crc32_update(0, &file.stamp, sizeof(file.stamp));
+    
+    uint32_t nv_size;
+    const void* stored = s_ops->nv_data(HAL_NV_CONFIG, &nv_size);
+    if (mimi_config_cache_load(s_config, stored, nv_size, source)) {
+        return 1;
+    }
+    
+    uint32_t size = fat32_size(&file);
+    if (size > sizeof(s_config_text) - 1) {
+        size = sizeof(s_config_text) - 1;
+    }
+    
+    int32_t read = fat32_read(&file, s_config_text, size);
+    if (read < 0) {
+        return read;
+    }
+    s_config_text[read] = '\0';
+    mimi_config_parse(s_config, s_config_text);
+    
+    if (nv_size >= sizeof(s_config_cache)) {
+        mimi_config_cache_seal(&s_config_cache, s_config, source);
+        s_ops->nv_write(HAL_NV_CONFIG, &s_config_cache, sizeof(s_config_cache));
+    }
+    return 0;
+}
+
+int mimi_flow_config_load(const char* path) {
+    int rc = config_read(path);
+    
+    /* As parsed, before this boot's attempt is counted */
+    s_manifest.config = *s_config;
+    return rc;
+}
+
+mimi_err_t mimi_flow_load(
+    const char**                image_path,
+    const mimi_loader_config_t* loader_config,
+    bool                        one_off,
+    mimi_load_result_t*         result
+) {
+    /* The manifest only knows its own image */
+    if (one_off) {
+        s_status.warm = false;
+        s_layout = &s_manifest.layout;
+    }
+    
+    /* A delta stands in for the boot image while its base is at hand */
+    if (!s_status.warm && !one_off && s_config->has_delta &&
+        delta_load(loader_config, result)) {
+        s_status.delta = true;
+        s_status.delta_cached = s_delta.cache != NULL;
+        return MIMI_OK;
+    }
+    
+    /* Open and validate every candidate, then pick one */
+    if (!s_status.warm) {
+        mimi_err_t err = probe_select(image_path, loader_config);
+        if (err != MIMI_OK) {
+            return err;
+        }
+    }
+    
+    LOG_VERBOSE("File size: %u bytes\n", fat32_size(&s_image));
+    return mimi_elf_load_layout(loader_config, &s_image, s_layout, result);
+}
+
+mimi_err_t mimi_flow_blobs_load(const char* image_path, const mimi_loader_config_t* loader_config) {
+    /* Extra files ride along with the configured image only */
+    if (s_config->load_count == 0 ||
+        image_path != MIMI_CONFIG_STR(s_config, s_config->image_path)) {
+        return MIMI_OK;
+    }
+    
+    /* Lookups back to back, through the directory cache */
+    for (uint32_t i = 0; i < s_config->load_count; i++) {
+        const char* path = MIMI_CONFIG_STR(s_config, s_config->loads[i].path);
+        
+        if (fat32_open(s_fs, path, &s_blob_files[i]) != FAT32_OK) {
+            LOG("[ERROR] Load item not found: %s\n", path);
+            return MIMI_ERR_NOT_FOUND;
+        }
+        s_blobs[i] = (mimi_blob_t){
+            .file = &s_blob_files[i],
+            .addr = s_config->loads[i].addr,
+            .size = fat32_size(&s_blob_files[i]),
+            .position = s_blob_files[i].start_cluster,
+            .index = i,
+        };
+    }
+    
+    mimi_err_t err = mimi_blob_plan(loader_config, s_layout, s_blobs, s_config->load_count);
+    if (err == MIMI_OK) {
+        err = mimi_blob_load(loader_config, s_blobs, s_config->load_count, &s_blob_count);
+    }
+    
+    for (uint32_t i = 0; i < s_blob_count; i++) {
+        LOG_VERBOSE("  Load item:   %s, %u bytes at 0x%08X\n",
+            MIMI_CONFIG_STR(s_config, s_config->loads[s_blobs[i].index].path),
+            s_blobs[i].size, s_blobs[i].addr);
+    }
+    return err;
+}
+
+const mimi_blob_t* mimi_flow_blobs(uint32_t* count) {
+    *count = s_blob_count;
+    return s_blobs;
+}
+
+void mimi_flow_finish(const char* image_path, const mimi_load_result_t* result, bool one_off) {
+    bool boot_image = image_path == MIMI_CONFIG_STR(s_config, s_config->image_path);
+    
+    /* Cache this cold boot's lookups for the next one (a one-off is not) */
+    if (!s_status.warm && !one_off) {
+        mimi_profile_begin(MIMI_PHASE_MANIFEST);
+        s_status.manifest_saved = manifest_update(image_path);
+        mimi_profile_end(MIMI_PHASE_MANIFEST);
+    }
+    
+    /* The boot image, loaded in full, is the base for the next delta */
+    if (s_config->has_delta && !s_status.delta && !one_off && boot_image) {
+        s_status.cache_saved = delta_cache_update(result);
+    }
+    
+    /* Count a boot of the configured image, or give it up for the fallback */
+    if (boot_image) {
+        bootstate_count(&s_image);
+    } else {
+        s_status.given_up = bootstate_give_up();
+    }
+    
+    s_status.resume_armed = resume_update();
+}
@@ -0,0 +1,186 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * boot_flow.h - Boot Policy
+ * 
+ * The decisions main.c takes between reset and the jump: restarting an
+ * image still in RAM, trusting the boot manifest, reading boot.cfg or
+ * its compiled copy, rebuilding the image from a delta, choosing between
+ * the boot image and its fallback, loading the extra files, and what is
+ * saved for the next boot (manifest, image cache, attempt count, resume
+ * record).
+ * 
+ * Flash and the retained words are reached through callbacks, so the
+ * host simulator runs exactly this code against its simulated card and
+ * flash. main.c keeps the hardware sequence, messages about it and the
+ * handoff.
+ */
+
+#ifndef MIMIBOOT_BOOT_FLOW_H
+#define MIMIBOOT_BOOT_FLOW_H
+
+#include "loader.h"
+#include "config.h"
+#include "../fs/fat32.h"
+
+/*============================================================================
+ * Platform Services
+ *============================================================================*/
+
+/**
+ * Services the boot flow needs, with the meaning of the hal_nv_*,
+ * hal_cache_* and hal_retain_* functions of the same names (hal/hal.h).
+ * Blocks are HAL_NV_* numbers.
+ */
+typedef struct {
+    /* Non-volatile blocks */
+    const void* (*nv_data)(uint32_t block, uint32_t* size);
+    int         (*nv_write)(uint32_t block, const void* data, uint32_t size);
+    int         (*nv_append)(uint32_t block, uint32_t offset, const void* data,
+                             uint32_t size, bool erase);
+    
+    /* Image cache */
+    const void* (*cache_data)(uint32_t* size);
+    int         (*cache_write)(uint32_t offset, const void* data, uint32_t size);
+    
+    /* Retained words */
+    uint32_t    (*retain_count)(void);
+    uint32_t    (*retain_get)(uint32_t index);
+    void        (*retain_set)(uint32_t index, uint32_t value);
+    uint32_t    (*retain_addr)(uint32_t index);
+    
+    /* Boot message; verbose ones are for verbose = 1 only (NULL: no messages) */
+    void        (*log)(bool verbose, const char* fmt, ...);
+} mimi_flow_ops_t;
+
+/**
+ * What the boot flow did so far.
+ */
+typedef struct {
+    bool        warm;           /* Image opened through the boot manifest */
+    bool        delta;          /* Image rebuilt from the configured delta */
+    bool        delta_cached;   /* ...against the image cache, not RAM */
+    bool        fallback;       /* Fallback selected over the boot image */
+    bool        manifest_saved; /* Manifest (re)written for the next boot */
+    bool        cache_saved;    /* Image cache (re)written for the next delta */
+    bool        given_up;       /* Boot image recorded in the boot log as failing */
+    bool        resume_armed;   /* Resume record set for the next reset */
+    uint32_t    confirm_addr;   /* Word the payload confirms its boot through (0 if none) */
+} mimi_flow_status_t;
+
+/**
+ * I/O operations for the loader reading the selected image (the file
+ * handle is a fat32_file_t).
+ */
+extern const mimi_io_ops_t mimi_flow_io;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Start a boot: remember the services and state to work on, and read
+ * the attempt count and boot log before anything overwrites them.
+ * 
+ * @param ops       Platform services, must stay valid
+ * @param fs        Filesystem, mounted by the caller (or by mimi_flow_warm)
+ * @param config    Configuration, initialized by the caller
+ */
+void mimi_flow_init(const mimi_flow_ops_t* ops, fat32_fs_t* fs, mimi_config_t* config);
+
+/**
+ * Get what the boot flow did so far.
+ */
+const mimi_flow_status_t* mimi_flow_status(void);
+
+/**
+ * After a warm or watchdog reset, restart the previous image if it is
+ * intact in RAM and has attempts left. The configuration becomes the
+ * one saved with it, and the attempt is counted.
+ * 
+ * @param result    Output: load result of the resumed image
+ * @return          true if the image can be restarted
+ */
+bool mimi_flow_resume(mimi_load_result_t* result);
+
+/**
+ * Disarm the resume record, so an image being replaced is never resumed.
+ */
+void mimi_flow_resume_disarm(void);
+
+/**
+ * Open the card through the boot manifest, if there is one and its
+ * image has attempts left. The configuration becomes the manifest's.
+ * 
+ * @param read_sector   Sector read for the filesystem
+ * @param read_sectors  Multi-sector read for the filesystem
+ * @return              true if the image was reattached (a warm boot)
+ */
+bool mimi_flow_warm(int (*read_sector)(uint32_t, uint8_t*),
+                    int (*read_sectors)(uint32_t, uint8_t*, uint32_t));
+
+/**
+ * Load boot.cfg: the compiled copy in flash while the file's directory
+ * entry is unchanged, else the text, which is then compiled for the
+ * next boot. Core 1 must be stopped.
+ * 
+ * @param path  boot.cfg path
+ * @return      1 if the compiled copy was used, 0 if the text was
+ *              parsed, negative if there is no boot.cfg
+ */
+int mimi_flow_config_load(const char* path);
+
+/**
+ * Load the boot image. A warm boot loads the manifest's image. A cold
+ * one first tries the configured delta, then probes the boot image,
+ * the fallback and the boot menu images together and loads the boot
+ * image if it is valid and has attempts left, else the fallback.
+ * 
+ * A one-off image (boot menu, host command line) is never rebuilt from
+ * the delta and always probed, so a warm boot must be mounted first.
+ * 
+ * @param image_path    In: image to boot; out: image loaded
+ * @param loader_config Loader configuration, io mimi_flow_io
+ * @param one_off       Image chosen for this boot only
+ * @param result        Output: load result
+ * @return              MIMI_OK, or why the image could not be loaded
+ */
+mimi_err_t mimi_flow_load(
+    const char**                image_path,
+    const mimi_loader_config_t* loader_config,
+    bool                        one_off,
+    mimi_load_result_t*         result
+);
+
+/**
+ * Load the extra files configured for the boot image: open them all,
+ * check them against the image and each other, then read them in card
+ * order. Nothing is loaded with any other image.
+ * 
+ * @param image_path    Image loaded (from mimi_flow_load)
+ * @param loader_config Loader configuration for the boot image
+ * @return              MIMI_OK, or why an item could not be loaded
+ */
+mimi_err_t mimi_flow_blobs_load(const char* image_path, const mimi_loader_config_t* loader_config);
+
+/**
+ * Get the extra files loaded.
+ * 
+ * @param count     Output: number of items
+ * @return          Items, in card order
+ */
+const mimi_blob_t* mimi_flow_blobs(uint32_t* count);
+
+/**
+ * Save what this boot leaves for the next one: the boot manifest and
+ * image cache after a cold boot of the boot image, its attempt count
+ * (or the fallback's give-up record) and the resume record. Flash is
+ * only written when the contents change. Core 1 must be stopped.
+ * 
+ * @param image_path    Image loaded (from mimi_flow_load)
+ * @param result        Its load result
+ * @param one_off       Image chosen for this boot only
+ */
+void mimi_flow_finish(const char* image_path, const mimi_load_result_t* result, bool one_off);
+
+#endif /* MIMIBOOT_BOOT_FLOW_H */
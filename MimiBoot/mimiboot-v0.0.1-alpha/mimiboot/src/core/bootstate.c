@@ -0,0 +1,115 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * bootstate.c - Boot Attempt Counting (A/B image selection across resets)
+ */
+
+#include "bootstate.h"
+#include "crc32.h"
+#include "../../include/mimiboot/handoff.h"
+
+/*============================================================================
+ * Helper Functions
+ *============================================================================*/
+
+static uint32_t record_crc(const mimi_bootlog_record_t* record) {
+    return mimi_crc32_update(0, record, sizeof(*record) - sizeof(record->crc32));
+}
+
+static bool record_erased(const mimi_bootlog_record_t* record) {
+    return record->magic == 0xFFFFFFFF && record->sequence == 0xFFFFFFFF &&
+           record->bad_image == 0xFFFFFFFF && record->crc32 == 0xFFFFFFFF;
+}
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+uint32_t mimi_bootstate_image_id(const fat32_file_t* file) {
+    uint32_t id = mimi_crc32_update(0, &file->stamp, sizeof(file->stamp)) & MIMI_BOOTCOUNT_ID_MASK;
+    return (id != 0) ? id : 1;
+}
+
+void mimi_bootstate_read(
+    mimi_bootstate_t*   state,
+    uint32_t            retained,
+    const void*         log,
+    uint32_t            log_size
+) {
+    state->image_id = 0;
+    state->attempts = 0;
+    state->confirmed = (retained == MIMI_BOOT_CONFIRMED);
+    state->bad_image = 0;
+    state->sequence = 0;
+    state->log_size = (log != NULL) ? log_size : 0;
+    
+    /* Anything else (power-on zero, a confirmation) starts the count over */
+    if ((retained & MIMI_BOOTCOUNT_TAG_MASK) == MIMI_BOOTCOUNT_TAG) {
+        state->image_id = retained & MIMI_BOOTCOUNT_ID_MASK;
+        state->attempts = (retained >> MIMI_BOOTCOUNT_SHIFT) & MIMI_BOOTCOUNT_MAX;
+    }
+    
+    /* Records are appended in order; the first erased one ends the log */
+    const mimi_bootlog_record_t* records = (const mimi_bootlog_record_t*)log;
+    uint32_t count = MIMI_BOOTLOG_RECORDS(state->log_size);
+    
+    state->log_next = count * sizeof(mimi_bootlog_record_t);
+    for (uint32_t i = 0; i < count; i++) {
+        const mimi_bootlog_record_t* r = &records[i];
+        
+        if (record_erased(r)) {
+            state->log_next = i * sizeof(mimi_bootlog_record_t);
+            break;
+        }
+        
+        /* Torn writes fail the CRC and are stepped over */
+        if (r->magic == MIMI_BOOTLOG_MAGIC && r->crc32 == record_crc(r) &&
+            r->sequence > state->sequence) {
+            state->sequence = r->sequence;
+            state->bad_image = r->bad_image;
+        }
+    }
+}
+
+uint32_t mimi_bootstate_attempts(const mimi_bootstate_t* state, uint32_t image_id) {
+    if (image_id == state->bad_image) {
+        return MIMI_BOOTCOUNT_MAX;
+    }
+    return (image_id == state->image_id) ? state->attempts : 0;
+}
+
+uint32_t mimi_bootstate_arm(uint32_t image_id, uint32_t attempts) {
+    if (attempts > MIMI_BOOTCOUNT_MAX) {
+        attempts = MIMI_BOOTCOUNT_MAX;
+    }
+    return MIMI_BOOTCOUNT_TAG | (attempts << MIMI_BOOTCOUNT_SHIFT) |
+           (image_id & MIMI_BOOTCOUNT_ID_MASK);
+}
+
+bool mimi_bootstate_give_up(
+    mimi_bootstate_t*       state,
+    uint32_t                image_id,
+    mimi_bootlog_record_t*  record,
+    uint32_t*               offset,
+    bool*                   erase
+) {
+    if (image_id == state->bad_image || state->log_size < sizeof(*record)) {
+        return false;
+    }
+    
+    *erase = state->log_next + sizeof(*record) > state->log_size;
+    if (*erase) {
+        state->log_next = 0;
+    }
+    *offset = state->log_next;
+    
+    record->magic = MIMI_BOOTLOG_MAGIC;
+    record->sequence = state->sequence + 1;
+    record->bad_image = image_id;
+    record->crc32 = record_crc(record);
+    
+    state->sequence = record->sequence;
+    state->bad_image = image_id;
+    state->log_next += sizeof(*record);
+    return true;
+}
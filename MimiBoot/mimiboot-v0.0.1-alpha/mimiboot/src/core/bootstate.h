@@ -0,0 +1,150 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * bootstate.h - Boot Attempt Counting (A/B image selection across resets)
+ * 
+ * The configured image is slot A, the fallback slot B. Every boot of an
+ * image counts as an attempt until the payload confirms it through the
+ * handoff (MIMI_HANDOFF_CONFIRM). An image with max_retries unconfirmed
+ * boots behind it is not started again: the loader boots the fallback,
+ * and skips the fast resume and boot manifest that would only restart
+ * the failing image.
+ * 
+ * Nothing is written to the card. The state lives in two places:
+ * 
+ *   Retained word  Attempt count and the image it belongs to. Rewritten
+ *                  on every boot; survives watchdog and soft resets and
+ *                  reads 0 after power-on, which starts the count over.
+ *   Flash log      One record per image given up on, so a bad image
+ *                  stays skipped across power cycles. Records are
+ *                  appended into erased flash; the sector is erased once
+ *                  every MIMI_BOOTLOG_RECORDS images given up on.
+ * 
+ * Images are identified by their directory entry: copying a new image
+ * to the card gives it a fresh set of attempts.
+ */
+
+#ifndef MIMIBOOT_BOOTSTATE_H
+#define MIMIBOOT_BOOTSTATE_H
+
+#include "loader.h"
+#include "../fs/fat32.h"
+
+/*============================================================================
+ * Retained Word
+ *============================================================================*/
+
+/* Retained word index, after the resume record (words 0-2) */
+#define MIMI_BOOTCOUNT_WORD     3
+
+/*
+ * Layout: tag (31:28), attempts (27:24), image id (23:0). The payload
+ * overwrites the whole word with MIMI_BOOT_CONFIRMED to confirm.
+ */
+#define MIMI_BOOTCOUNT_TAG      0xB0000000
+#define MIMI_BOOTCOUNT_TAG_MASK 0xF0000000
+#define MIMI_BOOTCOUNT_SHIFT    24
+#define MIMI_BOOTCOUNT_MAX      15          /* Attempts saturate here */
+#define MIMI_BOOTCOUNT_ID_MASK  0x00FFFFFF
+
+/*============================================================================
+ * Flash Log
+ *============================================================================*/
+
+#define MIMI_BOOTLOG_MAGIC      0x474F4C42  /* "BLOG" */
+
+/**
+ * Log record: an image that used up its attempts. The newest valid
+ * record (highest sequence) is the one in effect.
+ */
+typedef struct {
+    uint32_t    magic;          /* MIMI_BOOTLOG_MAGIC */
+    uint32_t    sequence;       /* One more than the previous record's */
+    uint32_t    bad_image;      /* Image id given up on */
+    uint32_t    crc32;          /* crc32 of the fields above */
+} mimi_bootlog_record_t;
+
+#define MIMI_BOOTLOG_RECORDS(log_size)  ((log_size) / sizeof(mimi_bootlog_record_t))
+
+/*============================================================================
+ * State
+ *============================================================================*/
+
+/**
+ * Boot state as found at reset.
+ */
+typedef struct {
+    uint32_t    image_id;       /* Image the retained count belongs to, 0 if none */
+    uint32_t    attempts;       /* Its unconfirmed boots */
+    bool        confirmed;      /* The previous boot was confirmed */
+    uint32_t    bad_image;      /* Image given up on (flash log), 0 if none */
+    uint32_t    sequence;       /* Sequence of that log record */
+    uint32_t    log_next;       /* Offset of the first free record, log size if full */
+    uint32_t    log_size;
+} mimi_bootstate_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Identify an image by the directory entry it was opened from.
+ * 
+ * @param file      Open image
+ * @return          Image id, never 0
+ */
+uint32_t mimi_bootstate_image_id(const fat32_file_t* file);
+
+/**
+ * Decode the retained word and find the newest record in the log.
+ * 
+ * @param state     Output: boot state
+ * @param retained  Retained word MIMI_BOOTCOUNT_WORD (0 if unavailable)
+ * @param log       Flash log contents, memory-mapped (NULL if none)
+ * @param log_size  Log size in bytes
+ */
+void mimi_bootstate_read(
+    mimi_bootstate_t*   state,
+    uint32_t            retained,
+    const void*         log,
+    uint32_t            log_size
+);
+
+/**
+ * Get the unconfirmed boots already made of an image.
+ * 
+ * @param state     Boot state
+ * @param image_id  Image id
+ * @return          Attempts so far, MIMI_BOOTCOUNT_MAX if the log
+ *                  records the image as given up on
+ */
+uint32_t mimi_bootstate_attempts(const mimi_bootstate_t* state, uint32_t image_id);
+
+/**
+ * Build the retained word for a boot about to start.
+ * 
+ * @param image_id  Image being booted
+ * @param attempts  Attempts including this one
+ * @return          Value for retained word MIMI_BOOTCOUNT_WORD
+ */
+uint32_t mimi_bootstate_arm(uint32_t image_id, uint32_t attempts);
+
+/**
+ * Prepare the log record that gives up on an image.
+ * 
+ * @param state     Boot state (updated to include the record)
+ * @param image_id  Image that used up its attempts
+ * @param record    Output: record to program
+ * @param offset    Output: log offset to program it at
+ * @param erase     Output: log must be erased first (full)
+ * @return          true if a record is needed, false if already logged
+ */
+bool mimi_bootstate_give_up(
+    mimi_bootstate_t*       state,
+    uint32_t                image_id,
+    mimi_bootlog_record_t*  record,
+    uint32_t*               offset,
+    bool*                   erase
+);
+
+#endif /* MIMIBOOT_BOOTSTATE_H */
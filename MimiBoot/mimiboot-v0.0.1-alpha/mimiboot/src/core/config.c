@@ -5,69 +5,210 @@
  */
 
 #include "config.h"
+#include "crc32.h"
+#include "mem.h"
 #include <stddef.h>
 
 /*============================================================================
- * String Helpers (no libc)
+ * Character Classes
  *============================================================================*/
 
-static int str_len(const char* s) {
-    int len = 0;
-    while (*s++) len++;
-    return len;
-}
+#define CC_OTHER    0
+#define CC_SPACE    1       /* Blank inside a line */
+#define CC_EOL      2       /* Newline or end of text */
+#define CC_HASH     3       /* Comment start */
+#define CC_EQ       4       /* Key/value separator */
+#define CC_KEY      5       /* May appear in a key */
 
-static void str_copy(char* dst, const char* src, int max) {
-    int i = 0;
-    while (i < max - 1 && src[i]) {
-        dst[i] = src[i];
-        i++;
-    }
-    dst[i] = '\0';
-}
+static const uint8_t s_class[128] = {
+    2, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 1, 0, 0,   /* NUL .. SI */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /* DLE .. US */
+    1, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   /*  !"#$%&'()*+,-./ */
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 0, 0, 0, 4, 0, 0,   /* 0123456789:;<=>? */
+    0, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,   /* @ABCDEFGHIJKLMNO */
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 0, 0, 0, 0, 5,   /* PQRSTUVWXYZ[\]^_ */
+    0, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,   /* `abcdefghijklmno */
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 0, 0, 0, 0, 0,   /* pqrstuvwxyz{|}~ */
+};
+
+#define CHAR_CLASS(c) \
+    (((uint8_t)(c) < 128) ? s_class[(uint8_t)(c)] : CC_OTHER)
+
+/*============================================================================
+ * Key Table (perfect hash)
+ *============================================================================*/
+
+/*
+ * Keys hash as h = h * 31 + c over their characters and sit in slot
+ * (h >> 10) & 63, which is different for every key below. A new key
+ * must land in a free slot; if none of its aliases do, pick another
+ * shift or multiplier that keeps all keys apart.
+ */
+#define CFG_HASH_STEP(h, c)     ((h) * 31 + (uint8_t)(c))
+#define CFG_SLOTS               64
+#define CFG_SLOT(h)             (((h) >> 10) & (CFG_SLOTS - 1))
+
+/* Value types */
+#define CFG_PATH    1       /* mimi_config_str_t */
+#define CFG_UINT    2       /* uint32_t, decimal or 0x hex */
+#define CFG_BOOL    3       /* bool: 1, true, yes, on */
+#define CFG_IMAGE   4       /* Next images[] entry: path, then display name */
+#define CFG_LOAD    5       /* Next loads[] entry: path, then address */
+
+#define CFG_NONE    0       /* No flag set alongside */
+
+typedef struct {
+    const char* name;
+    uint8_t     len;
+    uint8_t     type;       /* CFG_* */
+    uint16_t    offset;     /* Field in mimi_config_t */
+    uint16_t    given;      /* bool set to true with it, or CFG_NONE */
+} cfg_key_t;
+
+#define CFG_KEY(key, type, field, given) \
+    { key, sizeof(key) - 1, type, offsetof(mimi_config_t, field), given }
 
-static bool str_equal(const char* a, const char* b) {
-    while (*a && *b) {
-        if (*a++ != *b++) return false;
+#define CFG_GIVEN(field)        offsetof(mimi_config_t, field)
+
+static const cfg_key_t s_keys[CFG_SLOTS] = {
+    [42] = CFG_KEY("image",         CFG_PATH, image_path,    CFG_NONE),
+    [41] = CFG_KEY("fallback",      CFG_PATH, fallback_path, CFG_GIVEN(has_fallback)),
+    [8]  = CFG_KEY("patch",         CFG_PATH, delta_path,    CFG_GIVEN(has_delta)),
+    [19] = CFG_KEY("timeout",       CFG_UINT, timeout_ms,    CFG_NONE),
+    [46] = CFG_KEY("delay",         CFG_UINT, boot_delay_ms, CFG_NONE),
+    [7]  = CFG_KEY("baudrate",      CFG_UINT, console_baud,  CFG_NONE),
+    [1]  = CFG_KEY("baud",          CFG_UINT, console_baud,  CFG_NONE),
+    [30] = CFG_KEY("verbose",       CFG_BOOL, verbose,       CFG_NONE),
+    [9]  = CFG_KEY("quiet",         CFG_BOOL, quiet,         CFG_NONE),
+    [57] = CFG_KEY("logbuf",        CFG_BOOL, logbuf,        CFG_NONE),
+    [34] = CFG_KEY("verify",        CFG_BOOL, verify,        CFG_NONE),
+    [51] = CFG_KEY("xip",           CFG_BOOL, xip,           CFG_NONE),
+    [16] = CFG_KEY("multicore",     CFG_BOOL, multicore,     CFG_NONE),
+    [6]  = CFG_KEY("zero_bss",      CFG_BOOL, zero_bss,      CFG_NONE),
+    [32] = CFG_KEY("crc",           CFG_BOOL, crc,           CFG_NONE),
+    [13] = CFG_KEY("image_crc",     CFG_UINT, image_crc,     CFG_GIVEN(has_image_crc)),
+    [11] = CFG_KEY("manifest",      CFG_BOOL, manifest,      CFG_NONE),
+    [50] = CFG_KEY("resume",        CFG_BOOL, resume,        CFG_NONE),
+    [22] = CFG_KEY("reset_on_fail", CFG_BOOL, reset_on_fail, CFG_NONE),
+    [36] = CFG_KEY("max_retries",   CFG_UINT, max_retries,   CFG_NONE),
+    [58] = CFG_KEY("retries",       CFG_UINT, max_retries,   CFG_NONE),
+    [5]  = CFG_KEY("menu",          CFG_IMAGE, images,       CFG_NONE),
+    [53] = CFG_KEY("default",       CFG_UINT, default_index, CFG_NONE),
+    [49] = CFG_KEY("load",          CFG_LOAD, loads,         CFG_NONE),
+};
+
+/*============================================================================
+ * Value Helpers (no libc, values are not NUL-terminated)
+ *============================================================================*/
+
+static bool span_equal(const char* s, uint32_t len, const char* word) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (s[i] != word[i]) return false;
     }
-    return *a == *b;
+    return word[len] == '\0';
 }
 
-static bool str_start(const char* s, const char* prefix) {
-    while (*prefix) {
-        if (*s++ != *prefix++) return false;
-    }
-    return true;
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
 }
 
-static bool is_space(char c) {
-    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+/* Decimal, or hex with a 0x prefix; stops at the first other character */
+static uint32_t parse_uint(const char* s, uint32_t len) {
+    uint32_t val = 0;
+    uint32_t i = 0;
+    
+    if (len > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        int d;
+        for (i = 2; i < len && (d = hex_digit(s[i])) >= 0; i++) {
+            val = (val << 4) | (uint32_t)d;
+        }
+        return val;
+    }
+    
+    for (; i < len && s[i] >= '0' && s[i] <= '9'; i++) {
+        val = val * 10 + (uint32_t)(s[i] - '0');
+    }
+    return val;
 }
 
-static bool is_digit(char c) {
-    return c >= '0' && c <= '9';
+static bool parse_bool(const char* s, uint32_t len) {
+    return span_equal(s, len, "1") || span_equal(s, len, "true") ||
+           span_equal(s, len, "yes") || span_equal(s, len, "on");
 }
 
-static const char* skip_space(const char* s) {
-    while (*s && is_space(*s)) s++;
-    return s;
+/**
+ * Append a string to the pool.
+ * 
+ * @return  true with *str set, false if the pool is full
+ */
+static bool pool_add(mimi_config_t* config, const char* s, uint32_t len, mimi_config_str_t* str) {
+    if (len == 0) {
+        *str = 0;
+        return true;
+    }
+    if (len > CONFIG_MAX_PATH - 1) {
+        len = CONFIG_MAX_PATH - 1;
+    }
+    if (config->strings_used + len + 1 > CONFIG_STRINGS_SIZE) {
+        return false;
+    }
+    
+    *str = (mimi_config_str_t)config->strings_used;
+    mimi_memcpy(&config->strings[config->strings_used], s, len);
+    config->strings[config->strings_used + len] = '\0';
+    config->strings_used += len + 1;
+    return true;
 }
 
-static uint32_t parse_uint(const char* s) {
-    uint32_t val = 0;
-    while (is_digit(*s)) {
-        val = val * 10 + (*s - '0');
-        s++;
+/**
+ * Add a boot menu entry from "path name...". The name is optional and
+ * may contain blanks; without one the menu shows the path.
+ */
+static void image_add(mimi_config_t* config, const char* s, uint32_t len) {
+    if (config->image_count >= CONFIG_MAX_IMAGES) {
+        return;
     }
-    return val;
+    
+    uint32_t path_len = 0;
+    while (path_len < len && CHAR_CLASS(s[path_len]) != CC_SPACE) path_len++;
+    uint32_t name = path_len;
+    while (name < len && CHAR_CLASS(s[name]) == CC_SPACE) name++;
+    
+    mimi_image_entry_t* entry = &config->images[config->image_count];
+    if (path_len == 0 ||
+        !pool_add(config, s, path_len, &entry->path) ||
+        !pool_add(config, s + name, len - name, &entry->name)) {
+        return;
+    }
+    
+    entry->valid = true;
+    config->image_count++;
 }
 
-static bool parse_bool(const char* s) {
-    if (str_equal(s, "1") || str_equal(s, "true") || 
-        str_equal(s, "yes") || str_equal(s, "on")) {
-        return true;
+/**
+ * Add an extra load item from "path address". Lines without an
+ * address are ignored.
+ */
+static void load_add(mimi_config_t* config, const char* s, uint32_t len) {
+    if (config->load_count >= CONFIG_MAX_LOADS) {
+        return;
+    }
+    
+    uint32_t path_len = 0;
+    while (path_len < len && CHAR_CLASS(s[path_len]) != CC_SPACE) path_len++;
+    uint32_t addr = path_len;
+    while (addr < len && CHAR_CLASS(s[addr]) == CC_SPACE) addr++;
+    
+    mimi_load_entry_t* entry = &config->loads[config->load_count];
+    if (path_len == 0 || addr == len || !pool_add(config, s, path_len, &entry->path)) {
+        return;
     }
-    return false;
+    
+    entry->addr = parse_uint(s + addr, len - addr);
+    config->load_count++;
 }
 
 /*============================================================================
@@ -75,15 +216,15 @@ static bool parse_bool(const char* s) {
  *============================================================================*/
 
 void mimi_config_init(mimi_config_t* config) {
-    /* Zero everything */
-    uint8_t* p = (uint8_t*)config;
-    for (uint32_t i = 0; i < sizeof(mimi_config_t); i++) {
-        p[i] = 0;
-    }
+    /* Zero everything (the pool too: saved configs compare byte for byte) */
+    mimi_memset(config, 0, sizeof(mimi_config_t));
+    
+    /* Offset 0 is the empty string */
+    config->strings_used = 1;
     
     /* Set defaults */
-    str_copy(config->image_path, MIMI_DEFAULT_IMAGE, CONFIG_MAX_PATH);
-    str_copy(config->fallback_path, MIMI_DEFAULT_FALLBACK, CONFIG_MAX_PATH);
+    pool_add(config, MIMI_DEFAULT_IMAGE, sizeof(MIMI_DEFAULT_IMAGE) - 1, &config->image_path);
+    pool_add(config, MIMI_DEFAULT_FALLBACK, sizeof(MIMI_DEFAULT_FALLBACK) - 1, &config->fallback_path);
     config->has_fallback = true;
     
     config->timeout_ms = MIMI_DEFAULT_TIMEOUT;
@@ -92,8 +233,15 @@ void mimi_config_init(mimi_config_t* config) {
     config->console_baud = MIMI_DEFAULT_BAUD;
     config->verbose = MIMI_DEFAULT_VERBOSE;
     config->quiet = false;
+    config->logbuf = true;
     
     config->verify = false;
+    config->multicore = true;
+    config->zero_bss = true;
+    config->crc = true;
+    config->has_image_crc = false;
+    config->manifest = false;
+    config->resume = false;
     config->reset_on_fail = true;
     config->max_retries = 3;
     
@@ -106,120 +254,90 @@ void mimi_config_init(mimi_config_t* config) {
  *============================================================================*/
 
 /**
- * Parse a single configuration line.
+ * Store one key's value. Unknown keys are ignored.
  */
-static void parse_line(mimi_config_t* config, const char* line) {
-    /* Skip leading whitespace */
-    line = skip_space(line);
-    
-    /* Skip empty lines and comments */
-    if (*line == '\0' || *line == '#') {
+static void apply_key(
+    mimi_config_t*  config,
+    const char*     key,
+    uint32_t        key_len,
+    uint32_t        hash,
+    const char*     value,
+    uint32_t        value_len
+) {
+    const cfg_key_t* k = &s_keys[CFG_SLOT(hash)];
+    if (k->name == NULL || k->len != key_len || !span_equal(key, key_len, k->name)) {
         return;
     }
     
-    /* Find '=' separator */
-    const char* eq = line;
-    while (*eq && *eq != '=') eq++;
-    
-    if (*eq != '=') {
-        return;  /* No '=' found, skip line */
-    }
-    
-    /* Extract key (trim trailing whitespace) */
-    char key[64];
-    int key_len = 0;
-    const char* k = line;
-    while (k < eq && key_len < 63) {
-        if (!is_space(*k)) {
-            key[key_len++] = *k;
-        } else if (key_len > 0) {
-            /* Stop at first space after key starts */
+    uint8_t* field = (uint8_t*)config + k->offset;
+    switch (k->type) {
+        case CFG_PATH:
+            if (!pool_add(config, value, value_len, (mimi_config_str_t*)field)) {
+                return;
+            }
+            break;
+        case CFG_UINT:
+            *(uint32_t*)field = parse_uint(value, value_len);
+            break;
+        case CFG_BOOL:
+            *(bool*)field = parse_bool(value, value_len);
+            break;
+        case CFG_IMAGE:
+            image_add(config, value, value_len);
+            break;
+        case CFG_LOAD:
+            load_add(config, value, value_len);
             break;
-        }
-        k++;
-    }
-    key[key_len] = '\0';
-    
-    /* Extract value (skip leading whitespace, trim trailing) */
-    const char* val_start = skip_space(eq + 1);
-    char value[CONFIG_MAX_PATH];
-    int val_len = 0;
-    
-    while (*val_start && *val_start != '\n' && *val_start != '\r' && 
-           *val_start != '#' && val_len < CONFIG_MAX_PATH - 1) {
-        value[val_len++] = *val_start++;
-    }
-    
-    /* Trim trailing whitespace from value */
-    while (val_len > 0 && is_space(value[val_len - 1])) {
-        val_len--;
     }
-    value[val_len] = '\0';
     
-    /* Match known keys */
-    if (str_equal(key, "image")) {
-        str_copy(config->image_path, value, CONFIG_MAX_PATH);
-    }
-    else if (str_equal(key, "fallback")) {
-        str_copy(config->fallback_path, value, CONFIG_MAX_PATH);
-        config->has_fallback = true;
-    }
-    else if (str_equal(key, "timeout")) {
-        config->timeout_ms = parse_uint(value);
-    }
-    else if (str_equal(key, "delay")) {
-        config->boot_delay_ms = parse_uint(value);
-    }
-    else if (str_equal(key, "baudrate") || str_equal(key, "baud")) {
-        config->console_baud = parse_uint(value);
-    }
-    else if (str_equal(key, "verbose")) {
-        config->verbose = parse_bool(value);
+    if (k->given != CFG_NONE) {
+        *(bool*)((uint8_t*)config + k->given) = true;
     }
-    else if (str_equal(key, "quiet")) {
-        config->quiet = parse_bool(value);
-        if (config->quiet) config->verbose = false;
-    }
-    else if (str_equal(key, "verify")) {
-        config->verify = parse_bool(value);
-    }
-    else if (str_equal(key, "reset_on_fail")) {
-        config->reset_on_fail = parse_bool(value);
-    }
-    else if (str_equal(key, "max_retries") || str_equal(key, "retries")) {
-        config->max_retries = parse_uint(value);
-    }
-    /* Ignore unknown keys */
 }
 
 int mimi_config_parse(mimi_config_t* config, const char* buffer) {
-    const char* line_start = buffer;
+    const char* p = buffer;
     
-    while (*line_start) {
-        /* Find end of line */
-        const char* line_end = line_start;
-        while (*line_end && *line_end != '\n') {
-            line_end++;
-        }
+    /* One pass: every character is classified once, nothing is copied but paths */
+    while (*p) {
+        while (CHAR_CLASS(*p) == CC_SPACE) p++;
         
-        /* Copy line to temporary buffer */
-        char line[CONFIG_MAX_LINE];
-        int line_len = line_end - line_start;
-        if (line_len >= CONFIG_MAX_LINE) {
-            line_len = CONFIG_MAX_LINE - 1;
+        /* Key, hashed as it is scanned */
+        const char* key = p;
+        uint32_t hash = 0;
+        while (CHAR_CLASS(*p) == CC_KEY) {
+            hash = CFG_HASH_STEP(hash, *p);
+            p++;
         }
+        uint32_t key_len = (uint32_t)(p - key);
         
-        for (int i = 0; i < line_len; i++) {
-            line[i] = line_start[i];
-        }
-        line[line_len] = '\0';
+        while (CHAR_CLASS(*p) == CC_SPACE) p++;
         
-        /* Parse line */
-        parse_line(config, line);
+        if (key_len > 0 && CHAR_CLASS(*p) == CC_EQ) {
+            p++;
+            while (CHAR_CLASS(*p) == CC_SPACE) p++;
+            
+            /* Value runs to the end of the line or a comment, trailing blanks trimmed */
+            const char* value = p;
+            const char* end = p;
+            uint8_t cc;
+            while ((cc = CHAR_CLASS(*p)) != CC_EOL && cc != CC_HASH) {
+                if (cc != CC_SPACE) {
+                    end = p + 1;
+                }
+                p++;
+            }
+            
+            apply_key(config, key, key_len, hash, value, (uint32_t)(end - value));
+        }
         
-        /* Move to next line */
-        line_start = line_end;
-        if (*line_start == '\n') line_start++;
+        /* Comments, blank lines and lines without a key end here */
+        while (CHAR_CLASS(*p) != CC_EOL) p++;
+        if (*p == '\n') p++;
+    }
+    
+    if (config->quiet) {
+        config->verbose = false;
     }
     
     config->config_loaded = true;
@@ -231,7 +349,7 @@ int mimi_config_load(
     int (*read_file)(const char* path, char* buffer, uint32_t max_size),
     const char* path
 ) {
-    char buffer[2048];  /* Max config file size */
+    char buffer[CONFIG_MAX_FILE];
     
     int result = read_file(path, buffer, sizeof(buffer) - 1);
     if (result < 0) {
@@ -242,6 +360,52 @@ int mimi_config_load(
     return mimi_config_parse(config, buffer);
 }
 
+/*============================================================================
+ * Compiled Configuration
+ *============================================================================*/
+
+/* Bytes covered by the CRC */
+#define CACHE_BODY_OFFSET       offsetof(mimi_config_cache_t, source)
+#define CACHE_BODY_SIZE         (sizeof(mimi_config_cache_t) - CACHE_BODY_OFFSET)
+
+static uint32_t cache_crc(const mimi_config_cache_t* cache) {
+    return mimi_crc32_update(0, (const uint8_t*)cache + CACHE_BODY_OFFSET, CACHE_BODY_SIZE);
+}
+
+void mimi_config_cache_seal(
+    mimi_config_cache_t*    cache,
+    const mimi_config_t*    config,
+    uint32_t                source
+) {
+    cache->magic = MIMI_CONFIG_CACHE_MAGIC;
+    cache->version = MIMI_CONFIG_CACHE_VERSION;
+    cache->size = sizeof(mimi_config_cache_t);
+    cache->source = source;
+    mimi_memcpy(&cache->config, config, sizeof(mimi_config_t));
+    cache->crc32 = cache_crc(cache);
+}
+
+bool mimi_config_cache_load(
+    mimi_config_t*  config,
+    const void*     data,
+    uint32_t        size,
+    uint32_t        source
+) {
+    const mimi_config_cache_t* cache = (const mimi_config_cache_t*)data;
+    
+    if (data == NULL || size < sizeof(mimi_config_cache_t) ||
+        cache->magic != MIMI_CONFIG_CACHE_MAGIC ||
+        cache->version != MIMI_CONFIG_CACHE_VERSION ||
+        cache->size != sizeof(mimi_config_cache_t) ||
+        cache->source != source ||
+        cache->crc32 != cache_crc(cache)) {
+        return false;
+    }
+    
+    mimi_memcpy(config, &cache->config, sizeof(mimi_config_t));
+    return true;
+}
+
 /*============================================================================
  * Boot Image Selection
  *============================================================================*/
@@ -249,14 +413,14 @@ int mimi_config_load(
 const char* mimi_config_get_image(mimi_config_t* config) {
     /* If too many retries, try fallback */
     if (config->boot_count >= config->max_retries) {
-        if (config->has_fallback && config->fallback_path[0] != '\0') {
-            return config->fallback_path;
+        if (config->has_fallback && config->strings[config->fallback_path] != '\0') {
+            return MIMI_CONFIG_STR(config, config->fallback_path);
         }
     }
     
     /* Return primary image */
-    if (config->image_path[0] != '\0') {
-        return config->image_path;
+    if (config->strings[config->image_path] != '\0') {
+        return MIMI_CONFIG_STR(config, config->image_path);
     }
     
     return NULL;
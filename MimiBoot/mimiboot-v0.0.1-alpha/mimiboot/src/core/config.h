@@ -10,13 +10,30 @@
  * 
  *     # MimiBoot Configuration
  *     image = /boot/kernel.elf
- *     timeout = 3
+ *     timeout = 3000
  *     fallback = /boot/recovery.elf
+ *     patch = /boot/kernel.mdl
+ *     menu = /boot/test.elf Test build
+ *     load = /boot/core1.bin 0x20030000
+ *     default = 0
  *     console = uart0
  *     baudrate = 115200
  *     verbose = 1
+ *     logbuf = 1
+ *     xip = 1
+ *     multicore = 1
+ *     zero_bss = 1
+ *     crc = 1
+ *     image_crc = 0x1C291CA3
+ *     manifest = 1
+ *     resume = 1
  * 
  * Simple key=value format, # for comments, whitespace ignored.
+ * 
+ * The text is tokenized in a single pass, straight into the config,
+ * and known keys are dispatched through a perfect hash. The parsed
+ * config can be saved in binary form (mimi_config_cache_t) so later
+ * boots skip the text entirely while boot.cfg is unchanged.
  */
 
 #ifndef MIMIBOOT_CONFIG_H
@@ -29,21 +46,37 @@
  * Constants
  *============================================================================*/
 
-#define CONFIG_MAX_PATH         128
-#define CONFIG_MAX_LINE         256
+#define CONFIG_MAX_PATH         128     /* Longest path kept, NUL included */
 #define CONFIG_MAX_IMAGES       8
+#define CONFIG_MAX_LOADS        4       /* Extra files loaded with the boot image */
+#define CONFIG_MAX_FILE         2048    /* Longest boot.cfg read */
+#define CONFIG_STRINGS_SIZE     512     /* String pool: every path and name */
+
+/**
+ * String in the config's pool: an offset into mimi_config_t.strings,
+ * resolved with MIMI_CONFIG_STR. Offset 0 is the empty string.
+ */
+typedef uint16_t mimi_config_str_t;
 
 /*============================================================================
  * Boot Image Entry
  *============================================================================*/
 
 typedef struct {
-    char        path[CONFIG_MAX_PATH];  /* Path to ELF file */
-    char        name[32];               /* Display name */
-    uint32_t    flags;                  /* Image flags */
-    bool        valid;                  /* Entry is valid */
+    mimi_config_str_t   path;           /* Path to ELF file */
+    mimi_config_str_t   name;           /* Display name */
+    uint16_t            flags;          /* Image flags */
+    bool                valid;          /* Entry is valid */
 } mimi_image_entry_t;
 
+/**
+ * Extra file loaded with the boot image ("load = path address").
+ */
+typedef struct {
+    mimi_config_str_t   path;           /* Raw file, loaded whole */
+    uint32_t            addr;           /* Load address */
+} mimi_load_entry_t;
+
 /* Image flags */
 #define IMAGE_FLAG_DEFAULT      0x0001  /* Default boot image */
 #define IMAGE_FLAG_FALLBACK     0x0002  /* Fallback/recovery image */
@@ -55,37 +88,88 @@ typedef struct {
 
 typedef struct {
     /* Primary image */
-    char        image_path[CONFIG_MAX_PATH];
+    mimi_config_str_t   image_path;
     
     /* Fallback image */
-    char        fallback_path[CONFIG_MAX_PATH];
-    bool        has_fallback;
+    mimi_config_str_t   fallback_path;
+    bool                has_fallback;
+    
+    /* Delta of the boot image against the previous one (core/delta.h) */
+    mimi_config_str_t   delta_path;
+    bool                has_delta;
     
-    /* Boot menu (optional) */
+    /* Files loaded along with the boot image (core 1 firmware, data) */
+    mimi_load_entry_t   loads[CONFIG_MAX_LOADS];
+    uint32_t            load_count;
+    
+    /* Boot menu (optional): entry 0 is the boot image, then images[] */
     mimi_image_entry_t  images[CONFIG_MAX_IMAGES];
     uint32_t            image_count;
-    uint32_t            default_index;
+    uint32_t            default_index;  /* Entry booted when the menu times out */
     
     /* Timing */
-    uint32_t    timeout_ms;         /* Menu timeout (0 = no menu) */
+    uint32_t    timeout_ms;         /* Menu countdown (0 = no menu unless a number or Enter is waiting) */
     uint32_t    boot_delay_ms;      /* Delay before boot */
     
     /* Console */
     uint32_t    console_baud;       /* UART baud rate */
     bool        verbose;            /* Verbose boot messages */
     bool        quiet;              /* Suppress all output */
+    bool        logbuf;             /* Hand the log buffer to the payload */
     
     /* Options */
     bool        verify;             /* Verify loaded image */
+    bool        xip;                /* Run flash-linked segments in place */
+    bool        multicore;          /* Offload decode/BSS/verify to core 1 */
+    bool        zero_bss;           /* Clear BSS (else the payload's crt0 does) */
+    bool        crc;                /* Compute image CRC32 for the handoff */
+    bool        has_image_crc;      /* image_crc was given */
+    uint32_t    image_crc;          /* Expected image CRC32 */
+    bool        manifest;           /* Keep a boot manifest for warm boots */
+    bool        resume;             /* Rerun the image in RAM after a soft reset */
     bool        reset_on_fail;      /* Reset on boot failure */
     uint32_t    max_retries;        /* Max boot attempts */
     
     /* State */
-    uint32_t    boot_count;         /* Current boot attempt */
+    uint32_t    boot_count;         /* Unconfirmed boots of image_path (core/bootstate.h) */
     bool        config_loaded;      /* Config file was found */
     
+    /* Paths and names, NUL-terminated and packed */
+    uint32_t    strings_used;       /* Bytes of strings[] in use */
+    char        strings[CONFIG_STRINGS_SIZE];
+
 } mimi_config_t;
 
+/**
+ * Resolve a pool string. The pointer stays valid, and compares equal
+ * for the same string, while the config is not copied.
+ */
+#define MIMI_CONFIG_STR(config, str) \
+    ((const char*)&(config)->strings[(str)])
+
+/*============================================================================
+ * Compiled Configuration
+ *============================================================================*/
+
+#define MIMI_CONFIG_CACHE_MAGIC     0x47464343  /* "CCFG" */
+#define MIMI_CONFIG_CACHE_VERSION   5
+
+/**
+ * Parsed configuration as saved to flash. Only meaningful to the
+ * loader build that wrote it (the size check rejects other layouts),
+ * and only for the boot.cfg it was parsed from: source identifies that
+ * file, so an edited or replaced boot.cfg is parsed again.
+ */
+typedef struct {
+    uint32_t        magic;          /* MIMI_CONFIG_CACHE_MAGIC */
+    uint32_t        version;        /* MIMI_CONFIG_CACHE_VERSION */
+    uint32_t        size;           /* sizeof(mimi_config_cache_t) */
+    uint32_t        crc32;          /* CRC-32 of everything after this field */
+    
+    uint32_t        source;         /* Identifies the boot.cfg parsed */
+    mimi_config_t   config;         /* As parsed */
+} mimi_config_cache_t;
+
 /*============================================================================
  * Default Configuration
  *============================================================================*/
@@ -125,12 +209,45 @@ int mimi_config_load(
 /**
  * Parse configuration from buffer.
  * 
+ * Paths that do not fit the string pool are ignored, leaving the
+ * previous value (the default) in place.
+ * 
  * @param config    Configuration structure to populate
  * @param buffer    Null-terminated configuration text
  * @return          0 on success, negative on error
  */
 int mimi_config_parse(mimi_config_t* config, const char* buffer);
 
+/**
+ * Save a parsed configuration in binary form.
+ * 
+ * @param cache     Output: record to store
+ * @param config    Parsed configuration
+ * @param source    Identifies the boot.cfg it was parsed from (e.g. a
+ *                  CRC of its directory entry)
+ */
+void mimi_config_cache_seal(
+    mimi_config_cache_t*    cache,
+    const mimi_config_t*    config,
+    uint32_t                source
+);
+
+/**
+ * Load a configuration saved by mimi_config_cache_seal.
+ * 
+ * @param config    Output: configuration (untouched on failure)
+ * @param data      Stored bytes (may be erased flash)
+ * @param size      Bytes available at data
+ * @param source    Identifies the boot.cfg about to be parsed
+ * @return          true if data holds a sealed record for source
+ */
+bool mimi_config_cache_load(
+    mimi_config_t*  config,
+    const void*     data,
+    uint32_t        size,
+    uint32_t        source
+);
+
 /**
  * Get path to boot image.
  * 
@@ -138,7 +255,7 @@ int mimi_config_parse(mimi_config_t* config, const char* buffer);
  * and retries exceeded.
  * 
  * @param config    Configuration
- * @return          Path to image, or NULL if none available
+ * @return          Path to image (in the string pool), or NULL if none
  */
 const char* mimi_config_get_image(mimi_config_t* config);
 
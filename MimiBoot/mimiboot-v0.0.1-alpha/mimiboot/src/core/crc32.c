@@ -0,0 +1,69 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * crc32.c - CRC-32 (IEEE 802.3)
+ * 
+ * The software path handles a nibble per table lookup: two lookups per
+ * byte instead of eight shift/xor steps, for a 64-byte table (a full
+ * 256-entry table would cost 1KB more of loader flash). With unaligned
+ * loads (the RP2350's M33) it takes a word at a time: XORing a little-
+ * endian word into the CRC and running eight nibble steps equals four
+ * bytes of two steps each, with a quarter of the loads. The M33's DSP
+ * extension has no carry-less multiply or bit-serial step to offer
+ * here: its SIMD and multiply-accumulate work on integer lanes.
+ */
+
+#include "crc32.h"
+#include "mem.h"
+#include <stddef.h>
+
+/*============================================================================
+ * Platform Acceleration
+ *============================================================================*/
+
+static mimi_crc32_fn s_accel = NULL;
+
+void mimi_crc32_init(mimi_crc32_fn accel) {
+    s_accel = accel;
+}
+
+/*============================================================================
+ * Software CRC
+ *============================================================================*/
+
+/* CRC of each 4-bit value (reflected polynomial 0xEDB88320) */
+static const uint32_t s_crc_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+MIMI_RAMFUNC
+uint32_t mimi_crc32_update(uint32_t crc, const void* data, uint32_t size) {
+    if (s_accel != NULL && size >= MIMI_CRC32_ACCEL_MIN) {
+        return s_accel(crc, data, size);
+    }
+    
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+
+#if defined(MIMI_UNALIGNED_LOADS)
+    while (size >= 4) {
+        crc ^= mimi_load32(p);
+        for (uint32_t i = 0; i < 8; i++) {
+            crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0F];
+        }
+        p += 4;
+        size -= 4;
+    }
+#endif
+    
+    while (size--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0F];
+    }
+    
+    return ~crc;
+}
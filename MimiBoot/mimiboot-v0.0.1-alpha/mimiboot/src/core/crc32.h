@@ -0,0 +1,42 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * crc32.h - CRC-32 (IEEE 802.3)
+ * 
+ * The common reflected CRC-32 (polynomial 0xEDB88320, as used by zlib,
+ * Ethernet and `crc32` on the host). Values chain: the CRC of a + b is
+ * mimi_crc32_update(mimi_crc32_update(0, a), b).
+ * 
+ * Large blocks can be handed to a platform engine (e.g. the RP2040 DMA
+ * sniffer) registered at startup; otherwise a 16-entry table is used.
+ */
+
+#ifndef MIMIBOOT_CRC32_H
+#define MIMIBOOT_CRC32_H
+
+#include <stdint.h>
+
+/**
+ * CRC-32 of size bytes at data, continuing from crc (0 to start).
+ */
+typedef uint32_t (*mimi_crc32_fn)(uint32_t crc, const void* data, uint32_t size);
+
+/* Blocks smaller than this stay in software */
+#define MIMI_CRC32_ACCEL_MIN    64
+
+/**
+ * Register a platform CRC routine, or NULL for software only.
+ */
+void mimi_crc32_init(mimi_crc32_fn accel);
+
+/**
+ * Extend a CRC-32 over a block of memory.
+ * 
+ * @param crc       CRC of the preceding data, 0 for none
+ * @param data      Data
+ * @param size      Bytes of data
+ * @return          CRC of the preceding data followed by this block
+ */
+uint32_t mimi_crc32_update(uint32_t crc, const void* data, uint32_t size);
+
+#endif /* MIMIBOOT_CRC32_H */
@@ -0,0 +1,344 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * delta.c - Delta Images and the Image Cache
+ */
+
+#include "delta.h"
+#include "crc32.h"
+#include "mem.h"
+#include <stddef.h>
+
+/*============================================================================
+ * Image Cache
+ *============================================================================*/
+
+/**
+ * CRC-32 of a cache header with its header_crc field taken as zero.
+ */
+static uint32_t delta_cache_crc(const mimi_delta_cache_t* cache) {
+    static const uint32_t zero = 0;
+    
+    uint32_t crc = mimi_crc32_update(0, cache, offsetof(mimi_delta_cache_t, header_crc));
+    crc = mimi_crc32_update(crc, &zero, sizeof(zero));
+    return mimi_crc32_update(crc, cache->segments, sizeof(cache->segments));
+}
+
+bool mimi_delta_cache_valid(const void* data, uint32_t size) {
+    const mimi_delta_cache_t* cache = (const mimi_delta_cache_t*)data;
+    
+    if (data == NULL || size < sizeof(mimi_delta_cache_t)) {
+        return false;
+    }
+    
+    if (cache->magic != MIMI_DELTA_CACHE_MAGIC ||
+        cache->version != MIMI_DELTA_CACHE_VERSION ||
+        cache->segment_count > MIMI_MAX_SEGMENTS ||
+        cache->header_crc != delta_cache_crc(cache)) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < cache->segment_count; i++) {
+        const mimi_delta_cache_seg_t* seg = &cache->segments[i];
+        
+        if (seg->offset % MIMI_DELTA_CACHE_ALIGN != 0 || seg->offset < MIMI_DELTA_CACHE_ALIGN ||
+            seg->offset > size || seg->size > size - seg->offset) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool mimi_delta_cache_build(
+    mimi_delta_cache_t*         cache,
+    const mimi_elf_layout_t*    layout,
+    const mimi_load_result_t*   result,
+    uint32_t                    size
+) {
+    mimi_memset(cache, 0, sizeof(*cache));
+    
+    if (!result->has_crc) {
+        return false;
+    }
+    
+    uint32_t offset = MIMI_DELTA_CACHE_ALIGN;
+    
+    for (uint32_t i = 0; i < layout->segment_count; i++) {
+        const mimi_seg_desc_t* seg = &layout->segments[i];
+        uint32_t init_size = result->segments[i].init_size;
+        
+        /* Flash-resident segments are already non-volatile */
+        if (seg->source == MIMI_SEG_IN_PLACE || init_size == 0) {
+            continue;
+        }
+        if (offset > size || init_size > size - offset) {
+            return false;
+        }
+        
+        mimi_delta_cache_seg_t* entry = &cache->segments[cache->segment_count++];
+        entry->vaddr = seg->vaddr;
+        entry->size = init_size;
+        entry->offset = offset;
+        
+        offset += (init_size + MIMI_DELTA_CACHE_ALIGN - 1) & ~(uint32_t)(MIMI_DELTA_CACHE_ALIGN - 1);
+    }
+    
+    cache->magic = MIMI_DELTA_CACHE_MAGIC;
+    cache->version = MIMI_DELTA_CACHE_VERSION;
+    cache->image_crc = result->crc32;
+    cache->header_crc = delta_cache_crc(cache);
+    return cache->segment_count > 0;
+}
+
+/*============================================================================
+ * Base Image
+ *============================================================================*/
+
+/**
+ * Locate size bytes of the base image loaded at addr: in RAM at that
+ * address, or in the image cache.
+ * 
+ * @return  Base bytes, or NULL if the cache does not hold them
+ */
+MIMI_RAMFUNC
+static const uint8_t* delta_base(const mimi_delta_t* delta, uint32_t addr, uint32_t size) {
+    const mimi_delta_cache_t* cache = delta->cache;
+    
+    if (cache == NULL) {
+        return (const uint8_t*)(uintptr_t)addr;
+    }
+    
+    for (uint32_t i = 0; i < cache->segment_count; i++) {
+        const mimi_delta_cache_seg_t* seg = &cache->segments[i];
+        
+        if (addr >= seg->vaddr && addr - seg->vaddr <= seg->size &&
+            size <= seg->size - (addr - seg->vaddr)) {
+            return (const uint8_t*)cache + seg->offset + (addr - seg->vaddr);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Check that every base run is still in RAM where it will be loaded:
+ * inside the plain (uncompressed, from file) data of a segment, at
+ * that segment's address for its offset.
+ */
+static bool delta_in_place(const mimi_delta_t* delta, const mimi_elf_layout_t* layout) {
+    for (uint32_t r = 0; r < delta->header.run_count; r++) {
+        const mimi_delta_run_t* run = &delta->runs[r];
+        if (!(run->flags & MIMI_DELTA_RUN_BASE)) {
+            continue;
+        }
+        
+        bool found = false;
+        for (uint32_t i = 0; i < layout->segment_count && !found; i++) {
+            const mimi_seg_desc_t* seg = &layout->segments[i];
+            
+            found = seg->source == MIMI_SEG_FROM_FILE && !(seg->flags & PF_MIMI_LZ4) &&
+                    run->offset >= seg->offset &&
+                    run->offset - seg->offset <= seg->filesz &&
+                    run->size <= seg->filesz - (run->offset - seg->offset) &&
+                    run->source == seg->vaddr + (run->offset - seg->offset);
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * CRC-32 of the base bytes the delta uses, in run order.
+ * 
+ * @return  true if the base holds them all and they match ref_crc
+ */
+static bool delta_refs_match(const mimi_delta_t* delta) {
+    uint32_t crc = 0;
+    
+    for (uint32_t r = 0; r < delta->header.run_count; r++) {
+        const mimi_delta_run_t* run = &delta->runs[r];
+        if (!(run->flags & MIMI_DELTA_RUN_BASE)) {
+            continue;
+        }
+        
+        const uint8_t* base = delta_base(delta, run->source, run->size);
+        if (base == NULL) {
+            return false;
+        }
+        crc = mimi_crc32_update(crc, base, run->size);
+    }
+    return crc == delta->header.ref_crc;
+}
+
+/*============================================================================
+ * Delta Reader
+ *============================================================================*/
+
+/**
+ * Find the run holding a target offset (offset below image_size).
+ */
+MIMI_RAMFUNC
+static const mimi_delta_run_t* delta_find(const mimi_delta_t* delta, uint32_t offset) {
+    uint32_t lo = 0;
+    uint32_t hi = delta->header.run_count;
+    
+    /* Last run starting at or before offset (run 0 starts at 0) */
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        if (delta->runs[mid].offset <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return &delta->runs[lo];
+}
+
+MIMI_RAMFUNC
+static int32_t delta_read(mimi_file_t file, uint32_t offset, void* buffer, uint32_t size) {
+    const mimi_delta_t* delta = (const mimi_delta_t*)file;
+    uint32_t image_size = delta->header.image_size;
+    
+    /* Short read at the end, as from a file */
+    if (offset > image_size) {
+        return -1;
+    }
+    if (size > image_size - offset) {
+        size = image_size - offset;
+    }
+    if (size == 0) {
+        return 0;
+    }
+    
+    uint8_t* dest = (uint8_t*)buffer;
+    const mimi_delta_run_t* run = delta_find(delta, offset);
+    uint32_t done = 0;
+    
+    while (done < size) {
+        uint32_t skip = offset + done - run->offset;
+        uint32_t chunk = run->size - skip;
+        if (chunk > size - done) {
+            chunk = size - done;
+        }
+        
+        if (run->flags & MIMI_DELTA_RUN_BASE) {
+            /* Bytes already at their load address are left where they are */
+            const uint8_t* base = delta->bound ? delta_base(delta, run->source + skip, chunk) : NULL;
+            if (base == NULL) {
+                return -1;
+            }
+            if (base != dest + done) {
+                mimi_memcpy(dest + done, base, chunk);
+            }
+        } else {
+            int32_t read = delta->io->read(delta->file, run->source + skip, dest + done, chunk);
+            if (read < 0 || (uint32_t)read != chunk) {
+                return -1;
+            }
+        }
+        
+        done += chunk;
+        run++;
+    }
+    
+    return (int32_t)size;
+}
+
+static int32_t delta_size(mimi_file_t file) {
+    return (int32_t)((const mimi_delta_t*)file)->header.image_size;
+}
+
+const mimi_io_ops_t mimi_delta_io = {
+    .read = delta_read,
+    .size = delta_size,
+};
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+mimi_err_t mimi_delta_open(mimi_delta_t* delta, const mimi_io_ops_t* io, mimi_file_t file) {
+    mimi_delta_header_t* hdr = &delta->header;
+    
+    mimi_memset(delta, 0, sizeof(*delta));
+    delta->io = io;
+    delta->file = file;
+    
+    int32_t file_size = io->size(file);
+    int32_t read = io->read(file, 0, hdr, sizeof(*hdr));
+    if (file_size < 0 || read < 0 || (uint32_t)read != sizeof(*hdr)) {
+        return MIMI_ERR_READ;
+    }
+    
+    if (hdr->magic != MIMI_DELTA_MAGIC || hdr->version != MIMI_DELTA_VERSION ||
+        hdr->run_count == 0 || hdr->run_count > MIMI_DELTA_MAX_RUNS) {
+        return MIMI_ERR_BAD_HEADER;
+    }
+    
+    uint32_t table_len = hdr->run_count * sizeof(mimi_delta_run_t);
+    read = io->read(file, sizeof(*hdr), delta->runs, table_len);
+    if (read < 0 || (uint32_t)read != table_len) {
+        return MIMI_ERR_READ;
+    }
+    
+    /* Header CRC is taken with its own field zeroed */
+    uint32_t header_crc = hdr->header_crc;
+    hdr->header_crc = 0;
+    uint32_t crc = mimi_crc32_update(0, hdr, sizeof(*hdr));
+    hdr->header_crc = header_crc;
+    if (mimi_crc32_update(crc, delta->runs, table_len) != header_crc) {
+        return MIMI_ERR_BAD_HEADER;
+    }
+    
+    /* Back to back over the whole target, literal bytes inside the file */
+    uint32_t end = 0;
+    for (uint32_t r = 0; r < hdr->run_count; r++) {
+        const mimi_delta_run_t* run = &delta->runs[r];
+        
+        if (run->offset != end || run->size == 0 || run->offset + run->size < run->offset ||
+            run->source + run->size < run->source) {
+            return MIMI_ERR_BAD_HEADER;
+        }
+        if (!(run->flags & MIMI_DELTA_RUN_BASE) &&
+            run->source + run->size > (uint32_t)file_size) {
+            return MIMI_ERR_BAD_HEADER;
+        }
+        end = run->offset + run->size;
+    }
+    if (end != hdr->image_size) {
+        return MIMI_ERR_BAD_HEADER;
+    }
+    
+    return MIMI_OK;
+}
+
+mimi_err_t mimi_delta_bind(
+    mimi_delta_t*               delta,
+    const mimi_elf_layout_t*    layout,
+    const void*                 cache,
+    uint32_t                    size
+) {
+    delta->bound = false;
+    delta->cache = NULL;
+    
+    /* The image in RAM costs nothing to use */
+    if ((delta->header.flags & MIMI_DELTA_IN_PLACE) && delta_in_place(delta, layout) &&
+        delta_refs_match(delta)) {
+        delta->bound = true;
+        return MIMI_OK;
+    }
+    
+    const mimi_delta_cache_t* stored = (const mimi_delta_cache_t*)cache;
+    if (mimi_delta_cache_valid(cache, size) && stored->image_crc == delta->header.base_crc) {
+        delta->cache = stored;
+        if (delta_refs_match(delta)) {
+            delta->bound = true;
+            return MIMI_OK;
+        }
+    }
+    
+    delta->cache = NULL;
+    return MIMI_ERR_STALE;
+}
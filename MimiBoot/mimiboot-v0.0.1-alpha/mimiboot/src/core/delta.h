@@ -0,0 +1,199 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * delta.h - Delta Images and the Image Cache
+ * 
+ * A delta rebuilds a native image (mimg.h) from a base image the
+ * device already holds plus the blocks that changed, so an
+ * incremental build costs only its changed sectors from the card.
+ * It is produced on the host by mimiboot_delta:
+ * 
+ *     Sector 0..  mimi_delta_header_t, then run_count mimi_delta_run_t
+ *     Then        Literal data, one piece per literal run
+ * 
+ * The runs cover the target image back to back. A literal run's bytes
+ * are stored in the delta, at a file offset with the same sector
+ * alignment as the run itself; a base run's bytes are taken from the
+ * base image at a load address. The base is either:
+ * 
+ * - The image still in RAM after a reset. Only usable when every base
+ *   run takes bytes from the address they are loaded to (the packer
+ *   sets MIMI_DELTA_IN_PLACE), so they are never moved at all.
+ * - The image cache: a flash copy of the last image loaded in full,
+ *   kept as the base for the next delta (mimi_delta_cache_t).
+ * 
+ * Before anything is loaded, the bytes a delta takes from its base
+ * must match ref_crc. The rebuilt image is checked against the image
+ * CRC in the target's header, as for any native image.
+ * 
+ * An opened and bound delta is read through mimi_delta_io as if it
+ * were the target image itself: the usual parse and load path rebuild
+ * the segments in place, with fat32 reading literal runs straight to
+ * their load address.
+ */
+
+#ifndef MIMIBOOT_DELTA_H
+#define MIMIBOOT_DELTA_H
+
+#include "loader.h"
+
+/*============================================================================
+ * Format
+ *============================================================================*/
+
+#define MIMI_DELTA_MAGIC        0x544C444D  /* "MDLT" */
+#define MIMI_DELTA_VERSION      1
+
+/* Runs per delta (the whole table is kept in RAM) */
+#define MIMI_DELTA_MAX_RUNS     64
+
+/* Header flags */
+#define MIMI_DELTA_IN_PLACE     0x0001  /* Every base run is at its load address */
+
+/* Run flags */
+#define MIMI_DELTA_RUN_BASE     0x0001  /* Bytes come from the base image */
+
+/**
+ * Delta header, at file offset 0.
+ */
+typedef struct {
+    uint32_t    magic;          /* MIMI_DELTA_MAGIC */
+    uint16_t    version;        /* MIMI_DELTA_VERSION */
+    uint16_t    run_count;      /* Entries in the run table */
+    uint32_t    flags;          /* MIMI_DELTA_* */
+    uint32_t    image_size;     /* Size of the target image */
+    uint32_t    base_crc;       /* Image CRC of the base */
+    uint32_t    ref_crc;        /* crc32 of the base bytes used, in run order */
+    uint32_t    reserved;
+    uint32_t    header_crc;     /* crc32 of header and table, this field zero */
+} mimi_delta_header_t;
+
+/**
+ * Run table entry, following the header. Runs are in target order.
+ */
+typedef struct {
+    uint32_t    offset;         /* Offset in the target image */
+    uint32_t    size;           /* Bytes */
+    uint32_t    source;         /* Literal: offset in the delta; base: load address */
+    uint32_t    flags;          /* MIMI_DELTA_RUN_* */
+} mimi_delta_run_t;
+
+_Static_assert(sizeof(mimi_delta_header_t) == 32, "mimi_delta_header_t size mismatch");
+_Static_assert(sizeof(mimi_delta_run_t) == 16, "mimi_delta_run_t size mismatch");
+
+/*============================================================================
+ * Image Cache
+ *============================================================================*/
+
+#define MIMI_DELTA_CACHE_MAGIC      0x434D494D  /* "MIMC" */
+#define MIMI_DELTA_CACHE_VERSION    1
+
+/* Alignment of cached segments (one flash sector) */
+#define MIMI_DELTA_CACHE_ALIGN      4096
+
+/**
+ * Cached segment: size bytes of the image loaded at vaddr.
+ */
+typedef struct {
+    uint32_t    vaddr;          /* Load address */
+    uint32_t    size;           /* Initialized bytes */
+    uint32_t    offset;         /* Offset in the cache, multiple of MIMI_DELTA_CACHE_ALIGN */
+} mimi_delta_cache_seg_t;
+
+/**
+ * Cache header, in the first sector of the cache. Written after the
+ * segments, so an interrupted update leaves no valid cache.
+ */
+typedef struct {
+    uint32_t                magic;          /* MIMI_DELTA_CACHE_MAGIC */
+    uint16_t                version;        /* MIMI_DELTA_CACHE_VERSION */
+    uint16_t                segment_count;
+    uint32_t                image_crc;      /* Image CRC of the cached image */
+    uint32_t                header_crc;     /* crc32 of this header, this field zero */
+    mimi_delta_cache_seg_t  segments[MIMI_MAX_SEGMENTS];
+} mimi_delta_cache_t;
+
+/*============================================================================
+ * Delta Reader
+ *============================================================================*/
+
+/**
+ * Open delta image.
+ */
+typedef struct {
+    const mimi_io_ops_t*        io;         /* Delta file access */
+    mimi_file_t                 file;
+    mimi_delta_header_t         header;
+    const mimi_delta_cache_t*   cache;      /* Base in the image cache, or NULL for RAM */
+    bool                        bound;      /* Base runs can be read */
+    mimi_delta_run_t            runs[MIMI_DELTA_MAX_RUNS];
+} mimi_delta_t;
+
+/**
+ * I/O operations reading the target image out of a mimi_delta_t
+ * (the file handle). Base runs read as an error until it is bound.
+ */
+extern const mimi_io_ops_t mimi_delta_io;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Open a delta: read and check its header and run table.
+ * 
+ * @param delta     Output: delta reader
+ * @param io        I/O operations for the delta file
+ * @param file      Delta file handle
+ * @return          MIMI_OK, MIMI_ERR_BAD_HEADER or a read error
+ */
+mimi_err_t mimi_delta_open(mimi_delta_t* delta, const mimi_io_ops_t* io, mimi_file_t file);
+
+/**
+ * Bind a delta to its base once the target is parsed (through
+ * mimi_delta_io), before anything is loaded: the image in RAM if the
+ * delta allows it and the bytes it uses still match, else the image
+ * cache if it holds the delta's base.
+ * 
+ * @param delta     Open delta
+ * @param layout    Target layout from mimi_elf_parse
+ * @param cache     Image cache contents (may be erased flash, or NULL)
+ * @param size      Bytes available at cache
+ * @return          MIMI_OK, or MIMI_ERR_STALE if neither base matches
+ */
+mimi_err_t mimi_delta_bind(
+    mimi_delta_t*               delta,
+    const mimi_elf_layout_t*    layout,
+    const void*                 cache,
+    uint32_t                    size
+);
+
+/**
+ * Check the image cache holds a complete image written by this build.
+ * 
+ * @param data      Cache contents (may be erased flash)
+ * @param size      Bytes available at data
+ * @return          true if data starts with a sealed cache header
+ */
+bool mimi_delta_cache_valid(const void* data, uint32_t size);
+
+/**
+ * Describe a loaded image for the image cache: every segment with
+ * initialized bytes in RAM, each on a sector of its own after the
+ * header. The caller then stores each segment at its offset and the
+ * header last.
+ * 
+ * @param cache     Output: cache header, sealed
+ * @param layout    Layout the image was loaded from
+ * @param result    Load result, with its image CRC
+ * @param size      Cache size
+ * @return          true if the image fits
+ */
+bool mimi_delta_cache_build(
+    mimi_delta_cache_t*         cache,
+    const mimi_elf_layout_t*    layout,
+    const mimi_load_result_t*   result,
+    uint32_t                    size
+);
+
+#endif /* MIMIBOOT_DELTA_H */
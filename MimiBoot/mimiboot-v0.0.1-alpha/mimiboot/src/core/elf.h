@@ -92,6 +92,10 @@
 #define PF_X            0x1     /* Execute permission */
 #define PF_W            0x2     /* Write permission */
 #define PF_R            0x4     /* Read permission */
+#define PF_MASKOS       0x0FF00000  /* OS-specific flags */
+
+/* MimiBoot: file data is LZ4-compressed (see lz4.h) */
+#define PF_MIMI_LZ4     0x00100000
 
 /*============================================================================
  * Section Header Constants (for reference, not used in loading)
@@ -8,6 +8,8 @@
  */
 
 #include "handoff.h"
+#include "mem.h"
+#include "crc32.h"
 #include "../core/loader.h"
 #include "../hal/hal.h"
 #include "../../include/mimiboot/handoff.h"
@@ -29,24 +31,6 @@ static void mimi_strncpy(char* dst, const char* src, uint32_t max) {
     dst[i] = '\0';
 }
 
-/**
- * Simple CRC32 (IEEE polynomial).
- * Used for optional integrity checks.
- */
-static uint32_t mimi_crc32(const void* data, uint32_t len) {
-    const uint8_t* p = (const uint8_t*)data;
-    uint32_t crc = 0xFFFFFFFF;
-    
-    while (len--) {
-        crc ^= *p++;
-        for (int i = 0; i < 8; i++) {
-            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
-        }
-    }
-    
-    return ~crc;
-}
-
 /*============================================================================
  * Handoff Construction
  *============================================================================*/
@@ -61,10 +45,7 @@ void mimi_handoff_build(
     const char*                 image_name
 ) {
     /* Clear structure */
-    uint8_t* p = (uint8_t*)handoff;
-    for (uint32_t i = 0; i < sizeof(mimi_handoff_t); i++) {
-        p[i] = 0;
-    }
+    mimi_memset(handoff, 0, sizeof(mimi_handoff_t));
     
     /* Identification */
     handoff->magic = MIMI_HANDOFF_MAGIC;
@@ -74,13 +55,13 @@ void mimi_handoff_build(
     /* Boot context - from platform */
     handoff->boot_reason = platform->reset_reason;
     handoff->boot_source = platform->boot_source;
-    handoff->boot_count = 0;  /* TODO: persistent counter */
+    handoff->boot_count = 0;  /* Filled in by mimi_handoff_attach_confirm */
     handoff->boot_flags = 0;
     
     /* Timing */
     handoff->sys_clock_hz = platform->sys_clock_hz;
     handoff->boot_time_us = hal_get_time_us();
-    handoff->loader_time_us = handoff->boot_time_us;  /* Same for now */
+    handoff->loader_time_us = 0;  /* Measured and filled in by the caller */
     
     /* Memory layout */
     handoff->ram_base = platform->ram_base;
@@ -92,7 +73,10 @@ void mimi_handoff_build(
     handoff->image.entry = load_result->entry;
     handoff->image.load_base = load_result->load_base;
     handoff->image.load_size = load_result->total_size;
-    handoff->image.crc32 = 0;  /* TODO: compute if requested */
+    if (load_result->has_crc) {
+        handoff->image.crc32 = load_result->crc32;
+        handoff->boot_flags |= MIMI_FLAG_IMAGE_CRC;
+    }
     
     if (image_name != NULL) {
         mimi_strncpy(handoff->image.name, image_name, sizeof(handoff->image.name));
@@ -101,8 +85,28 @@ void mimi_handoff_build(
     /* Memory regions */
     handoff->region_count = 0;
     
-    /* Add RAM region */
-    if (handoff->region_count < MIMI_MAX_REGIONS) {
+    /* Add RAM, by kind of bank: the loader's share is the payload's now */
+    for (uint32_t i = 0; i < platform->ram_region_count; i++) {
+        const mimi_mem_region_t* bank = &platform->ram_regions[i];
+        uint32_t flags = MIMI_REGION_RAM | MIMI_REGION_PAYLOAD |
+            ((bank->flags & MIMI_MEM_STRIPED) ? MIMI_REGION_STRIPED : 0) |
+            ((bank->flags & MIMI_MEM_SCRATCH) ? MIMI_REGION_SCRATCH : 0);
+        
+        mimi_region_t* last = (handoff->region_count > 0) ?
+            &handoff->regions[handoff->region_count - 1] : NULL;
+        if (last != NULL && last->flags == flags && last->base + last->size == bank->base) {
+            last->size += bank->size;
+        } else if (handoff->region_count < MIMI_MAX_REGIONS) {
+            mimi_region_t* r = &handoff->regions[handoff->region_count++];
+            r->base = bank->base;
+            r->size = bank->size;
+            r->flags = flags;
+            r->reserved = 0;
+        }
+    }
+    
+    /* Platforms without a bank map: all of RAM */
+    if (handoff->region_count == 0) {
         mimi_region_t* r = &handoff->regions[handoff->region_count++];
         r->base = platform->ram_base;
         r->size = platform->ram_size;
@@ -110,6 +114,15 @@ void mimi_handoff_build(
         r->reserved = 0;
     }
     
+    /* Add payload XIP flash region */
+    if (load_result->bytes_in_place > 0 && handoff->region_count < MIMI_MAX_REGIONS) {
+        mimi_region_t* r = &handoff->regions[handoff->region_count++];
+        r->base = load_result->xip_base;
+        r->size = load_result->xip_end - load_result->xip_base;
+        r->flags = MIMI_REGION_FLASH | MIMI_REGION_PAYLOAD;
+        r->reserved = 0;
+    }
+    
     /* Add loader flash region */
     if (handoff->region_count < MIMI_MAX_REGIONS) {
         mimi_region_t* r = &handoff->regions[handoff->region_count++];
@@ -119,15 +132,124 @@ void mimi_handoff_build(
         r->reserved = 0;
     }
     
+    /* Add non-volatile flash blocks (rewritten by the loader) */
+    if (platform->nv_size > 0 && handoff->region_count < MIMI_MAX_REGIONS) {
+        mimi_region_t* r = &handoff->regions[handoff->region_count++];
+        r->base = platform->nv_base;
+        r->size = platform->nv_size;
+        r->flags = MIMI_REGION_FLASH | MIMI_REGION_RESERVED;
+        r->reserved = 0;
+    }
+    
+    /* BSS the loader skipped: listed for the payload, or cleared here if no slot */
+    for (uint32_t i = 0; load_result->bytes_unzeroed > 0 && i < load_result->segment_count; i++) {
+        const mimi_segment_info_t* seg = &load_result->segments[i];
+        if (seg->size <= seg->init_size) {
+            continue;
+        }
+        
+        uint32_t base = seg->vaddr + seg->init_size;
+        uint32_t size = seg->size - seg->init_size;
+        
+        if (handoff->region_count < MIMI_MAX_REGIONS) {
+            mimi_region_t* r = &handoff->regions[handoff->region_count++];
+            r->base = base;
+            r->size = size;
+            r->flags = MIMI_REGION_RAM | MIMI_REGION_PAYLOAD | MIMI_REGION_UNZEROED;
+            r->reserved = 0;
+            handoff->boot_flags |= MIMI_FLAG_BSS_UNZEROED;
+        } else {
+            mimi_memset((void*)(uintptr_t)base, 0, size);
+        }
+    }
+    
     /* Header CRC (covers first 16 bytes) */
     handoff->header_crc = 0;  /* Clear before computing */
-    handoff->header_crc = mimi_crc32(handoff, 16);
+    handoff->header_crc = mimi_crc32_update(0, handoff, 16);
+}
+
+/**
+ * Attach boot profile to handoff structure.
+ */
+void mimi_handoff_attach_profile(
+    mimi_handoff_t*             handoff,
+    const mimi_boot_profile_t*  profile
+) {
+    handoff->profile_addr = (uint32_t)(uintptr_t)profile;
+    handoff->boot_flags |= MIMI_FLAG_PROFILE;
+}
+
+/**
+ * Attach the boot attempt counter to handoff structure.
+ */
+void mimi_handoff_attach_confirm(
+    mimi_handoff_t*             handoff,
+    uint32_t                    boot_count,
+    uint32_t                    confirm_addr
+) {
+    handoff->boot_count = boot_count;
+    if (confirm_addr != 0) {
+        handoff->confirm_addr = confirm_addr;
+        handoff->boot_flags |= MIMI_FLAG_CONFIRM;
+    }
+}
+
+/**
+ * List an extra load item for the payload.
+ */
+bool mimi_handoff_attach_blob(
+    mimi_handoff_t*             handoff,
+    uint32_t                    base,
+    uint32_t                    size,
+    uint32_t                    index
+) {
+    if (handoff->region_count >= MIMI_MAX_REGIONS) {
+        return false;
+    }
+    
+    mimi_region_t* r = &handoff->regions[handoff->region_count++];
+    r->base = base;
+    r->size = size;
+    r->flags = MIMI_REGION_RAM | MIMI_REGION_PAYLOAD | MIMI_REGION_BLOB;
+    r->reserved = index;
+    return true;
+}
+
+/**
+ * Publish the log buffer to the payload.
+ */
+void mimi_handoff_attach_logbuf(
+    mimi_handoff_t*             handoff,
+    const mimi_logbuf_t*       log,
+    uint32_t                    size
+) {
+    if (log == NULL || handoff->region_count >= MIMI_MAX_REGIONS) {
+        return;
+    }
+    
+    mimi_region_t* r = &handoff->regions[handoff->region_count++];
+    r->base = (uint32_t)(uintptr_t)log;
+    r->size = size;
+    r->flags = MIMI_REGION_RAM | MIMI_REGION_LOGBUF;
+    r->reserved = 0;
 }
 
 /*============================================================================
  * Execution Transfer
  *============================================================================*/
 
+/*
+ * ARMv8-M (the RP2350's M33) has a main stack limit register. A limit
+ * left by the loader's runtime would fault the payload's first push
+ * to a stack below it, so it is cleared before the jump.
+ */
+#if defined(__ARM_ARCH_8M_MAIN__)
+#define HANDOFF_CLEAR_MSPLIM    "movs r3, #0                \n" \
+                                "msr msplim, r3             \n"
+#else
+#define HANDOFF_CLEAR_MSPLIM
+#endif
+
 /**
  * Jump to payload entry point.
  * 
@@ -159,6 +281,9 @@ void mimi_handoff_jump(mimi_handoff_t* handoff, uint32_t entry) {
         /* Disable interrupts */
         "cpsid i                    \n"
         
+        /* No stack limit for the payload */
+        HANDOFF_CLEAR_MSPLIM
+        
         /* Data synchronization barrier */
         "dsb                        \n"
         
@@ -198,7 +323,8 @@ void mimi_handoff_jump_with_sp(mimi_handoff_t* handoff, uint32_t entry, uint32_t
         /* Disable interrupts */
         "cpsid i                    \n"
         
-        /* Set stack pointer from r2 */
+        /* No stack limit, then stack pointer from r2 */
+        HANDOFF_CLEAR_MSPLIM
         "msr msp, r2                \n"
         
         /* Data synchronization barrier */
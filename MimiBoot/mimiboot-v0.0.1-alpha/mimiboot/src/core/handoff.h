@@ -26,6 +26,72 @@ void mimi_handoff_build(
     const char*                 image_name
 );
 
+/**
+ * Attach boot profile to handoff structure.
+ * 
+ * Sets profile_addr and MIMI_FLAG_PROFILE. The profile must stay
+ * in memory the payload does not overwrite.
+ * 
+ * @param handoff       Handoff structure
+ * @param profile       Filled boot profile
+ */
+void mimi_handoff_attach_profile(
+    mimi_handoff_t*             handoff,
+    const mimi_boot_profile_t*  profile
+);
+
+/**
+ * Attach the boot attempt counter to handoff structure.
+ * 
+ * Sets boot_count, and confirm_addr with MIMI_FLAG_CONFIRM when the
+ * attempts are being counted (confirm_addr not 0).
+ * 
+ * @param handoff       Handoff structure
+ * @param boot_count    Unconfirmed boots of the image, this one included
+ * @param confirm_addr  Word the payload writes MIMI_BOOT_CONFIRMED to, or 0
+ */
+void mimi_handoff_attach_confirm(
+    mimi_handoff_t*             handoff,
+    uint32_t                    boot_count,
+    uint32_t                    confirm_addr
+);
+
+/**
+ * List an extra load item for the payload.
+ * 
+ * Adds a MIMI_REGION_BLOB region with the item's boot.cfg entry number
+ * in its reserved word, if a region slot is left.
+ * 
+ * @param handoff       Handoff structure
+ * @param base          Load address
+ * @param size          Bytes loaded
+ * @param index         Entry among the boot.cfg load lines
+ * @return              true if listed
+ */
+bool mimi_handoff_attach_blob(
+    mimi_handoff_t*             handoff,
+    uint32_t                    base,
+    uint32_t                    size,
+    uint32_t                    index
+);
+
+/**
+ * Publish the log buffer to the payload.
+ * 
+ * Adds a MIMI_REGION_LOGBUF region covering the log, if a region slot
+ * is left. Attach it last, with nothing more to log: the payload reads
+ * the log as it is at this call.
+ * 
+ * @param handoff       Handoff structure
+ * @param log           Active log buffer
+ * @param size          Bytes at log, header included
+ */
+void mimi_handoff_attach_logbuf(
+    mimi_handoff_t*             handoff,
+    const mimi_logbuf_t*       log,
+    uint32_t                    size
+);
+
 /**
  * Jump to payload entry point.
  * 
@@ -7,90 +7,78 @@
  * No external dependencies beyond standard integer types.
  * 
  * Loading Process:
- * 1. Read and validate ELF header
- * 2. Read program headers
- * 3. Validate all PT_LOAD segments fit in memory
- * 4. Copy segment data to target addresses
- * 5. Zero BSS regions (p_memsz > p_filesz)
- * 6. Return entry point and load information
+ * 1. Read ELF header and program headers (or a native image's header
+ *    and segment table) in one I/O
+ * 2. Validate all PT_LOAD segments fit in memory
+ * 3. Sort segments by file offset
+ * 4. Copy (or decompress) segment data to target addresses in one
+ *    forward pass
+ * 5. Zero BSS regions (p_memsz > initialized size)
+ * 6. CRC the loaded image (optional) and check it against boot.cfg
+ * 7. Return entry point and load information
  */
 
 #include "loader.h"
+#include "crc32.h"
 #include "elf.h"
+#include "lz4.h"
+#include "mem.h"
+#include "mimg.h"
+#include "pipeline.h"
+#include "profile.h"
 #include <stddef.h>
 
 /*============================================================================
  * Internal Constants
  *============================================================================*/
 
-/* Read buffer size for loading - trade-off between RAM usage and speed */
+/* Read-back buffer size for verification - trade-off between RAM usage and speed */
 #define LOAD_BUFFER_SIZE    512
 
-/*============================================================================
- * Internal Helpers - Memory Operations (no libc dependency)
- *============================================================================*/
+/* Bytes at the start of each segment in flash (XIP or .data LMA) compared against the file */
+#define XIP_CHECK_SIZE      LOAD_BUFFER_SIZE
 
-/**
- * Set memory region to value (like memset but no libc).
+/*
+ * Initial read: one sector, the ELF header plus a typical program header
+ * table (14 entries; longer tables are fetched in further batches), or a
+ * native image's header and whole segment table
  */
-static void mimi_memset(void* dst, uint8_t val, uint32_t size) {
-    uint8_t* d = (uint8_t*)dst;
-    while (size--) {
-        *d++ = val;
-    }
-}
+#define ELF_HEAD_SIZE       512
 
-/**
- * Copy memory (like memcpy but no libc).
- */
-static void mimi_memcpy(void* dst, const void* src, uint32_t size) {
-    uint8_t* d = (uint8_t*)dst;
-    const uint8_t* s = (const uint8_t*)src;
-    while (size--) {
-        *d++ = *s++;
-    }
-}
-
-/**
- * Compare memory (like memcmp but no libc).
- */
-static int mimi_memcmp(const void* a, const void* b, uint32_t size) {
-    const uint8_t* pa = (const uint8_t*)a;
-    const uint8_t* pb = (const uint8_t*)b;
-    while (size--) {
-        if (*pa != *pb) {
-            return (*pa < *pb) ? -1 : 1;
-        }
-        pa++;
-        pb++;
-    }
-    return 0;
-}
+_Static_assert(ELF_HEAD_SIZE >= MIMG_ALIGN, "initial read must cover a native image header");
 
 /*============================================================================
  * Internal Helpers - Validation
  *============================================================================*/
 
 /**
- * Check if address range is within a memory region.
+ * Find the region holding addr with the required flags. Regions the
+ * loader itself is using never qualify.
  */
-static bool mimi_addr_in_region(
+static const mimi_mem_region_t* mimi_region_at(
     uint32_t addr,
-    uint32_t size,
-    const mimi_mem_region_t* region
+    uint32_t required_flags,
+    const mimi_loader_config_t* config
 ) {
-    /* Check for overflow */
-    if (addr + size < addr) {
-        return false;
+    for (uint32_t i = 0; i < config->region_count; i++) {
+        const mimi_mem_region_t* region = &config->regions[i];
+        
+        /* Check region has required flags */
+        if ((region->flags & required_flags) != required_flags ||
+            (region->flags & MIMI_MEM_LOADER)) {
+            continue;
+        }
+        
+        if (addr >= region->base && addr - region->base < region->size) {
+            return region;
+        }
     }
-    
-    uint32_t region_end = region->base + region->size;
-    
-    return (addr >= region->base) && ((addr + size) <= region_end);
+    return NULL;
 }
 
 /**
- * Check if address range is within any valid memory region.
+ * Check if address range is covered by valid memory regions: one, or
+ * several back to back (per-bank maps).
  */
 static bool mimi_addr_valid(
     uint32_t addr,
@@ -98,19 +86,26 @@ static bool mimi_addr_valid(
     uint32_t required_flags,
     const mimi_loader_config_t* config
 ) {
-    for (uint32_t i = 0; i < config->region_count; i++) {
-        const mimi_mem_region_t* region = &config->regions[i];
-        
-        /* Check region has required flags */
-        if ((region->flags & required_flags) != required_flags) {
-            continue;
+    /* Check for overflow */
+    if (addr + size < addr) {
+        return false;
+    }
+    
+    do {
+        const mimi_mem_region_t* region = mimi_region_at(addr, required_flags, config);
+        if (region == NULL) {
+            return false;
         }
         
-        if (mimi_addr_in_region(addr, size, region)) {
+        uint32_t room = region->size - (addr - region->base);
+        if (size <= room) {
             return true;
         }
-    }
-    return false;
+        addr += room;
+        size -= room;
+    } while (size > 0);
+    
+    return true;
 }
 
 /**
@@ -185,6 +180,11 @@ mimi_err_t mimi_elf_validate_header(const Elf32_Ehdr* ehdr) {
         return MIMI_ERR_TOO_MANY_PHDRS;
     }
     
+    /* Table must end within a 32-bit file offset */
+    if (ehdr->e_phoff > 0xFFFFFFFFu - (uint32_t)(ehdr->e_phnum * sizeof(Elf32_Phdr))) {
+        return MIMI_ERR_NO_PHDRS;
+    }
+    
     return MIMI_OK;
 }
 
@@ -209,12 +209,17 @@ const char* mimi_strerror(mimi_err_t err) {
         case MIMI_ERR_NO_PHDRS:         return "No program headers";
         case MIMI_ERR_BAD_PHDR_SIZE:    return "Invalid program header size";
         case MIMI_ERR_TOO_MANY_PHDRS:   return "Too many program headers";
+        case MIMI_ERR_BAD_HEADER:       return "Corrupt image header";
         case MIMI_ERR_NO_LOADABLE:      return "No loadable segments";
         case MIMI_ERR_ADDR_INVALID:     return "Segment address outside RAM";
         case MIMI_ERR_ADDR_OVERLAP:     return "Segments overlap";
         case MIMI_ERR_TOO_LARGE:        return "Image too large";
         case MIMI_ERR_LOAD_FAILED:      return "Load failed";
         case MIMI_ERR_ALIGNMENT:        return "Bad segment alignment";
+        case MIMI_ERR_XIP_MISMATCH:     return "Flash contents differ from image";
+        case MIMI_ERR_BAD_COMPRESSED:   return "Corrupt compressed segment";
+        case MIMI_ERR_CRC_MISMATCH:     return "Image CRC mismatch";
+        case MIMI_ERR_STALE:            return "Saved state out of date";
         case MIMI_ERR_NO_MEMORY:        return "Out of memory";
         case MIMI_ERR_BAD_REGION:       return "Invalid memory region";
         default:                        return "Unknown error";
@@ -222,254 +227,726 @@ const char* mimi_strerror(mimi_err_t err) {
 }
 
 /*============================================================================
- * Segment Loading
+ * Layout Parsing
  *============================================================================*/
 
 /**
- * Load a single PT_LOAD segment into memory.
+ * Decide where a segment's bytes come from and check its addresses.
  */
-static mimi_err_t mimi_load_segment(
+static mimi_err_t mimi_seg_source(
     const mimi_loader_config_t* config,
-    mimi_file_t                 file,
     const Elf32_Phdr*           phdr,
-    mimi_segment_info_t*        info,
-    uint32_t*                   bytes_copied,
-    uint32_t*                   bytes_zeroed
+    uint32_t*                   source
 ) {
-    uint8_t buffer[LOAD_BUFFER_SIZE];
+    /* Compressed data may be larger than the segment if it didn't pack well */
+    bool compressed = (phdr->p_flags & PF_MIMI_LZ4) != 0;
+    if (!compressed && phdr->p_filesz > phdr->p_memsz) {
+        return MIMI_ERR_BAD_PHDR_SIZE;
+    }
     
-    /* Record segment info */
-    info->vaddr = phdr->p_vaddr;
-    info->size = phdr->p_memsz;
-    info->flags = phdr->p_flags;
-    info->loaded = false;
+    *source = MIMI_SEG_FROM_FILE;
     
-    /* Skip zero-size segments */
+    if (config->allow_xip &&
+        mimi_addr_valid(phdr->p_vaddr, phdr->p_memsz, MIMI_MEM_READ | MIMI_MEM_FLASH, config)) {
+        /* Linked for the XIP window - nothing to zero or decompress in flash */
+        if (compressed || phdr->p_memsz != phdr->p_filesz) {
+            return MIMI_ERR_ADDR_INVALID;
+        }
+        *source = MIMI_SEG_IN_PLACE;
+    } else {
+        /* Validate address range */
+        if (config->validate_addresses) {
+            if (!mimi_addr_valid(phdr->p_vaddr, phdr->p_memsz,
+                                MIMI_MEM_WRITE | MIMI_MEM_RAM, config)) {
+                return MIMI_ERR_ADDR_INVALID;
+            }
+        }
+        
+        /* .data with its initial image in flash */
+        if (config->allow_xip && !compressed && phdr->p_filesz > 0 &&
+            phdr->p_paddr != phdr->p_vaddr &&
+            mimi_addr_valid(phdr->p_paddr, phdr->p_filesz, MIMI_MEM_READ | MIMI_MEM_FLASH, config)) {
+            *source = MIMI_SEG_FROM_FLASH;
+        }
+    }
+    
+    return MIMI_OK;
+}
+
+/**
+ * Add a PT_LOAD program header to the layout.
+ * Keeps segments sorted by file offset (insertion sort - counts are tiny).
+ */
+static mimi_err_t mimi_layout_add(
+    const mimi_loader_config_t* config,
+    const Elf32_Phdr*           phdr,
+    mimi_elf_layout_t*          layout
+) {
+    /* Skip empty segments */
     if (phdr->p_memsz == 0) {
-        info->loaded = true;
         return MIMI_OK;
     }
     
-    /* Validate address is writable RAM */
-    if (config->validate_addresses) {
-        if (!mimi_addr_valid(phdr->p_vaddr, phdr->p_memsz, 
-                            MIMI_MEM_WRITE | MIMI_MEM_RAM, config)) {
-            return MIMI_ERR_ADDR_INVALID;
+    if (layout->segment_count >= MIMI_MAX_SEGMENTS) {
+        return MIMI_ERR_TOO_MANY_PHDRS;
+    }
+    
+    uint32_t source;
+    mimi_err_t err = mimi_seg_source(config, phdr, &source);
+    if (err != MIMI_OK) {
+        return err;
+    }
+    
+    /* Check for overlaps with previously seen segments */
+    for (uint32_t j = 0; j < layout->segment_count; j++) {
+        if (mimi_ranges_overlap(phdr->p_vaddr, phdr->p_memsz,
+                               layout->segments[j].vaddr, layout->segments[j].memsz)) {
+            return MIMI_ERR_ADDR_OVERLAP;
         }
     }
     
-    /*
-     * Load segment data from file.
-     * p_filesz bytes come from the file, remaining (p_memsz - p_filesz)
-     * bytes are zeroed (this is typically .bss).
-     */
+    /* Insert in file offset order */
+    uint32_t pos = layout->segment_count;
+    while (pos > 0 && layout->segments[pos - 1].offset > phdr->p_offset) {
+        layout->segments[pos] = layout->segments[pos - 1];
+        pos--;
+    }
     
-    uint32_t file_offset = phdr->p_offset;
-    uint32_t dest_addr = phdr->p_vaddr;
-    uint32_t remaining = phdr->p_filesz;
+    mimi_seg_desc_t* seg = &layout->segments[pos];
+    seg->offset = phdr->p_offset;
+    seg->vaddr = phdr->p_vaddr;
+    seg->paddr = phdr->p_paddr;
+    seg->filesz = phdr->p_filesz;
+    seg->memsz = phdr->p_memsz;
+    seg->flags = phdr->p_flags;
+    seg->source = source;
+    seg->read_size = phdr->p_filesz;
+    layout->segment_count++;
+    
+    /* Track memory bounds */
+    if (phdr->p_vaddr < layout->load_base) {
+        layout->load_base = phdr->p_vaddr;
+    }
+    if (phdr->p_vaddr + phdr->p_memsz > layout->load_end) {
+        layout->load_end = phdr->p_vaddr + phdr->p_memsz;
+    }
+    layout->total_size += phdr->p_memsz;
     
-    while (remaining > 0) {
-        uint32_t chunk = (remaining > LOAD_BUFFER_SIZE) ? LOAD_BUFFER_SIZE : remaining;
-        
-        /* Read from file */
-        int32_t read_result = config->io->read(file, file_offset, buffer, chunk);
-        if (read_result < 0 || (uint32_t)read_result != chunk) {
-            return MIMI_ERR_READ;
-        }
-        
-        /* Copy to target address */
-        mimi_memcpy((void*)dest_addr, buffer, chunk);
-        
-        file_offset += chunk;
-        dest_addr += chunk;
-        remaining -= chunk;
-        *bytes_copied += chunk;
+    return MIMI_OK;
+}
+
+/**
+ * Parse a native image from its first sector.
+ * 
+ * The packer sorted the segments by address and file offset, so they
+ * are taken in table order and checked against their predecessor only.
+ */
+static mimi_err_t mimi_mimg_parse(
+    const mimi_loader_config_t* config,
+    const uint8_t*              head,
+    uint32_t                    head_len,
+    mimi_elf_layout_t*          layout
+) {
+    mimg_header_t hdr;
+    
+    if (head_len < sizeof(hdr)) {
+        return MIMI_ERR_READ;
+    }
+    mimi_memcpy(&hdr, head, sizeof(hdr));
+    
+    uint32_t table_len = hdr.segment_count * sizeof(mimg_segment_t);
+    if (hdr.version != MIMG_VERSION || hdr.segment_count > MIMI_MAX_SEGMENTS ||
+        sizeof(hdr) + table_len > head_len) {
+        return MIMI_ERR_BAD_HEADER;
     }
     
-    /* Zero BSS portion (p_memsz > p_filesz) */
-    if (config->zero_bss && phdr->p_memsz > phdr->p_filesz) {
-        uint32_t bss_size = phdr->p_memsz - phdr->p_filesz;
-        mimi_memset((void*)dest_addr, 0, bss_size);
-        *bytes_zeroed += bss_size;
+    /* Header CRC is taken with its own field zeroed */
+    uint32_t header_crc = hdr.header_crc;
+    hdr.header_crc = 0;
+    uint32_t crc = mimi_crc32_update(0, &hdr, sizeof(hdr));
+    if (mimi_crc32_update(crc, head + sizeof(hdr), table_len) != header_crc) {
+        return MIMI_ERR_BAD_HEADER;
     }
     
-    /* Optional verification */
-    if (config->verify_after_load && phdr->p_filesz > 0) {
-        file_offset = phdr->p_offset;
-        dest_addr = phdr->p_vaddr;
-        remaining = phdr->p_filesz;
+    if (hdr.entry == 0) {
+        return MIMI_ERR_NO_ENTRY;
+    }
+    
+    layout->entry = hdr.entry;
+    layout->load_base = hdr.load_base;
+    layout->load_end = hdr.load_end;
+    layout->total_size = hdr.total_size;
+    layout->has_crc = true;
+    layout->crc32 = hdr.image_crc;
+    
+    uint32_t data_end = MIMG_ALIGN;
+    uint32_t addr_end = 0;
+    
+    for (uint32_t i = 0; i < hdr.segment_count; i++) {
+        mimg_segment_t entry;
+        mimi_memcpy(&entry, head + sizeof(hdr) + i * sizeof(entry), sizeof(entry));
         
-        while (remaining > 0) {
-            uint32_t chunk = (remaining > LOAD_BUFFER_SIZE) ? LOAD_BUFFER_SIZE : remaining;
-            
-            int32_t read_result = config->io->read(file, file_offset, buffer, chunk);
-            if (read_result < 0 || (uint32_t)read_result != chunk) {
-                return MIMI_ERR_READ;
-            }
-            
-            if (mimi_memcmp((void*)dest_addr, buffer, chunk) != 0) {
-                return MIMI_ERR_LOAD_FAILED;
-            }
-            
-            file_offset += chunk;
-            dest_addr += chunk;
-            remaining -= chunk;
+        /* In order, sector aligned, no overlap with the previous segment */
+        if (entry.memsz == 0 || entry.offset % MIMG_ALIGN != 0 ||
+            entry.offset < data_end || entry.offset + entry.filesz < entry.offset) {
+            return MIMI_ERR_ALIGNMENT;
+        }
+        if (entry.vaddr < addr_end || entry.vaddr + entry.memsz < entry.vaddr) {
+            return MIMI_ERR_ADDR_OVERLAP;
         }
+        data_end = entry.offset + entry.filesz;
+        addr_end = entry.vaddr + entry.memsz;
+        
+        Elf32_Phdr phdr = {
+            .p_type = PT_LOAD,
+            .p_offset = entry.offset,
+            .p_vaddr = entry.vaddr,
+            .p_paddr = entry.paddr,
+            .p_filesz = entry.filesz,
+            .p_memsz = entry.memsz,
+            .p_flags = entry.flags,
+        };
+        
+        mimi_seg_desc_t* seg = &layout->segments[i];
+        mimi_err_t err = mimi_seg_source(config, &phdr, &seg->source);
+        if (err != MIMI_OK) {
+            return err;
+        }
+        
+        seg->offset = entry.offset;
+        seg->vaddr = entry.vaddr;
+        seg->paddr = entry.paddr;
+        seg->filesz = entry.filesz;
+        seg->memsz = entry.memsz;
+        seg->flags = entry.flags;
+        seg->read_size = entry.filesz;
+        
+        /*
+         * The zeroed padding up to the next sector is read along with
+         * the data when BSS will overwrite it, so the whole segment
+         * goes straight into place without a bounced tail sector.
+         */
+        uint32_t padded = (entry.filesz + MIMG_ALIGN - 1) & ~(uint32_t)(MIMG_ALIGN - 1);
+        if (seg->source == MIMI_SEG_FROM_FILE && !(entry.flags & PF_MIMI_LZ4) &&
+            padded <= entry.memsz) {
+            seg->read_size = padded;
+        }
+    }
+    layout->segment_count = hdr.segment_count;
+    
+    if (layout->segment_count == 0) {
+        return MIMI_ERR_NO_LOADABLE;
     }
     
-    info->loaded = true;
     return MIMI_OK;
 }
 
-/*============================================================================
- * Main Load Function
- *============================================================================*/
-
-mimi_err_t mimi_elf_load(
+mimi_err_t mimi_elf_parse(
     const mimi_loader_config_t* config,
     mimi_file_t                 file,
-    mimi_load_result_t*         result
+    mimi_elf_layout_t*          layout
 ) {
-    Elf32_Ehdr ehdr;
+    /* Word-aligned so the header can be read in place */
+    union {
+        Elf32_Ehdr  ehdr;
+        uint8_t     bytes[ELF_HEAD_SIZE];
+    } head;
     Elf32_Phdr phdr;
     mimi_err_t err;
     
-    /* Initialize result */
-    mimi_memset(result, 0, sizeof(*result));
-    result->load_base = 0xFFFFFFFF;
-    result->load_end = 0;
+    mimi_memset(layout, 0, sizeof(*layout));
+    layout->load_base = 0xFFFFFFFF;
     
     /*------------------------------------------------------------------------
-     * Phase 1: Read and validate ELF header
+     * Read ELF header and, usually, the whole phdr table in one I/O
      *------------------------------------------------------------------------*/
     
-    int32_t read_result = config->io->read(file, 0, &ehdr, sizeof(ehdr));
-    if (read_result < 0 || (uint32_t)read_result != sizeof(ehdr)) {
-        result->status = MIMI_ERR_READ;
-        return result->status;
+    int32_t head_len = config->io->read(file, 0, head.bytes, sizeof(head.bytes));
+    if (head_len < 0 || (uint32_t)head_len < sizeof(Elf32_Ehdr)) {
+        return MIMI_ERR_READ;
+    }
+    
+    uint32_t magic;
+    mimi_memcpy(&magic, head.bytes, sizeof(magic));
+    if (magic == MIMG_MAGIC) {
+        return mimi_mimg_parse(config, head.bytes, (uint32_t)head_len, layout);
     }
     
-    err = mimi_elf_validate_header(&ehdr);
+    err = mimi_elf_validate_header(&head.ehdr);
     if (err != MIMI_OK) {
-        result->status = err;
-        return result->status;
+        return err;
     }
     
-    result->entry = ehdr.e_entry;
+    layout->entry = head.ehdr.e_entry;
+    
+    uint32_t phoff = head.ehdr.e_phoff;
+    uint32_t phnum = head.ehdr.e_phnum;
     
     /*------------------------------------------------------------------------
-     * Phase 2: First pass - validate all segments
+     * Collect PT_LOAD segments
      *------------------------------------------------------------------------*/
     
-    uint32_t loadable_count = 0;
-    uint32_t total_memsz = 0;
+    uint32_t i = 0;
+    while (i < phnum) {
+        const uint8_t* table;
+        uint32_t first = i;
+        uint32_t batch;
+        
+        if (phoff <= (uint32_t)head_len &&
+            phnum * sizeof(Elf32_Phdr) <= (uint32_t)head_len - phoff) {
+            /* Table already in the head buffer (checked in parts, so it cannot wrap) */
+            table = head.bytes + phoff;
+            batch = phnum;
+        } else {
+            /* Fetch the next run of headers in one read */
+            batch = phnum - i;
+            if (batch > MIMI_MAX_PHDRS) {
+                batch = MIMI_MAX_PHDRS;
+            }
+            
+            uint32_t len = batch * sizeof(Elf32_Phdr);
+            int32_t read_result = config->io->read(file,
+                                                   phoff + (i * sizeof(Elf32_Phdr)),
+                                                   head.bytes, len);
+            if (read_result < 0 || (uint32_t)read_result != len) {
+                return MIMI_ERR_READ;
+            }
+            
+            table = head.bytes;
+            batch += i;
+        }
+        
+        for (; i < batch; i++) {
+            /* phoff need not be word aligned */
+            mimi_memcpy(&phdr, table + ((i - first) * sizeof(Elf32_Phdr)), sizeof(phdr));
+            
+            if (phdr.p_type != PT_LOAD) {
+                continue;
+            }
+            
+            err = mimi_layout_add(config, &phdr, layout);
+            if (err != MIMI_OK) {
+                return err;
+            }
+        }
+    }
     
-    /* Temporary storage for segment info during validation */
-    struct {
-        uint32_t vaddr;
-        uint32_t memsz;
-    } seg_info[MIMI_MAX_SEGMENTS];
+    if (layout->segment_count == 0) {
+        return MIMI_ERR_NO_LOADABLE;
+    }
     
-    for (uint32_t i = 0; i < ehdr.e_phnum && i < MIMI_MAX_SEGMENTS; i++) {
-        uint32_t phdr_offset = ehdr.e_phoff + (i * sizeof(Elf32_Phdr));
+    return MIMI_OK;
+}
+
+/*============================================================================
+ * Segment Loading
+ *============================================================================*/
+
+/**
+ * Read a segment back from the file and compare it with the bytes at
+ * addr, its load address or the flash it is copied from
+ * (at most limit bytes from the start).
+ */
+MIMI_RAMFUNC
+static mimi_err_t mimi_verify_segment(
+    const mimi_loader_config_t* config,
+    mimi_file_t                 file,
+    const mimi_seg_desc_t*      seg,
+    uint32_t                    addr,
+    uint32_t                    limit
+) {
+    uint8_t buffer[LOAD_BUFFER_SIZE];
+    
+    if (seg->flags & PF_MIMI_LZ4) {
+        /* Re-run the decoder in compare mode */
+        uint32_t raw_size;
+        return mimi_lz4_decode(config->io, file, seg->offset, seg->filesz,
+                               (uint8_t*)(uintptr_t)addr, seg->memsz,
+                               true, &raw_size);
+    }
+    
+    uint32_t file_offset = seg->offset;
+    uint32_t dest_addr = addr;
+    uint32_t remaining = (seg->filesz < limit) ? seg->filesz : limit;
+    
+    while (remaining > 0) {
+        uint32_t chunk = (remaining > LOAD_BUFFER_SIZE) ? LOAD_BUFFER_SIZE : remaining;
         
-        read_result = config->io->read(file, phdr_offset, &phdr, sizeof(phdr));
-        if (read_result < 0 || (uint32_t)read_result != sizeof(phdr)) {
-            result->status = MIMI_ERR_READ;
-            return result->status;
+        int32_t read_result = config->io->read(file, file_offset, buffer, chunk);
+        if (read_result < 0 || (uint32_t)read_result != chunk) {
+            return MIMI_ERR_READ;
         }
         
-        /* Only process PT_LOAD segments */
-        if (phdr.p_type != PT_LOAD) {
-            continue;
+        if (mimi_memcmp((void*)(uintptr_t)dest_addr, buffer, chunk) != 0) {
+            return MIMI_ERR_LOAD_FAILED;
         }
         
-        /* Skip empty segments */
-        if (phdr.p_memsz == 0) {
-            continue;
+        file_offset += chunk;
+        dest_addr += chunk;
+        remaining -= chunk;
+    }
+    
+    return MIMI_OK;
+}
+
+/**
+ * Load a single PT_LOAD segment into memory.
+ */
+MIMI_RAMFUNC
+static mimi_err_t mimi_load_segment(
+    const mimi_loader_config_t* config,
+    mimi_file_t                 file,
+    const mimi_seg_desc_t*      seg,
+    uint32_t                    index,
+    mimi_load_result_t*         result
+) {
+    uint32_t* bytes_copied = &result->bytes_copied;
+    uint32_t* bytes_zeroed = &result->bytes_zeroed;
+    
+    if (seg->source == MIMI_SEG_IN_PLACE) {
+        /* Spot-check that flash holds this image, not a stale one */
+        if (mimi_verify_segment(config, file, seg, seg->vaddr, XIP_CHECK_SIZE) != MIMI_OK) {
+            return MIMI_ERR_XIP_MISMATCH;
         }
         
-        /* Validate address range */
-        if (config->validate_addresses) {
-            if (!mimi_addr_valid(phdr.p_vaddr, phdr.p_memsz,
-                                MIMI_MEM_WRITE | MIMI_MEM_RAM, config)) {
-                result->status = MIMI_ERR_ADDR_INVALID;
-                return result->status;
-            }
+        if (result->xip_base == 0 || seg->vaddr < result->xip_base) {
+            result->xip_base = seg->vaddr;
+        }
+        if (seg->vaddr + seg->memsz > result->xip_end) {
+            result->xip_end = seg->vaddr + seg->memsz;
         }
+        result->bytes_in_place += seg->filesz;
+        result->segments[index].init_size = seg->filesz;
+        return MIMI_OK;
+    }
+    
+    /*
+     * Load segment data from file.
+     * filesz bytes come from the file, remaining (memsz - filesz)
+     * bytes are zeroed (this is typically .bss).
+     * 
+     * The destination address is handed straight to the I/O layer so
+     * sector-aligned data lands in its final location without passing
+     * through an intermediate buffer. Only the unaligned head and tail
+     * of the segment are bounced by the filesystem/storage layers.
+     * 
+     * Compressed segments are decoded into the same place as they are
+     * read; their initialized size comes from the LZ4 header.
+     * 
+     * With the pipeline running, decoding, flash copies and BSS zeroing
+     * are queued to core 1 and this returns as soon as core 0 has
+     * finished reading; mimi_load_drain() collects the outcome. Plain
+     * file data is still read straight into place by core 0, which is
+     * cheaper than staging it through the slot ring.
+     */
+    
+    uint32_t dest_addr = seg->vaddr;
+    uint32_t init_size = seg->filesz;
+    
+    if (seg->filesz > 0) {
+        uint32_t start_us = mimi_profile_now();
+        mimi_profile_begin(MIMI_PHASE_COPY);
         
-        /* Check for overlaps with previously seen segments */
-        for (uint32_t j = 0; j < loadable_count; j++) {
-            if (mimi_ranges_overlap(phdr.p_vaddr, phdr.p_memsz,
-                                   seg_info[j].vaddr, seg_info[j].memsz)) {
-                result->status = MIMI_ERR_ADDR_OVERLAP;
-                return result->status;
+        int32_t read_result;
+        if (seg->flags & PF_MIMI_LZ4) {
+            uint8_t* dest = (uint8_t*)(uintptr_t)dest_addr;
+            mimi_err_t err;
+            
+            if (mimi_pipe_active()) {
+                err = mimi_pipe_stream(config->io, file, seg->offset, seg->filesz,
+                                       dest, seg->memsz, MIMI_PIPE_LZ4, index, &init_size);
+            } else {
+                err = mimi_lz4_decode(config->io, file, seg->offset, seg->filesz,
+                                      dest, seg->memsz, false, &init_size);
+            }
+            if (err != MIMI_OK) {
+                mimi_profile_end(MIMI_PHASE_COPY);
+                return err;
+            }
+            read_result = (int32_t)seg->filesz;
+            result->bytes_compressed += seg->filesz;
+        } else if (seg->source == MIMI_SEG_FROM_FLASH) {
+            /* Same spot check as in-place segments before trusting flash */
+            if (mimi_verify_segment(config, file, seg, seg->paddr, XIP_CHECK_SIZE) != MIMI_OK) {
+                mimi_profile_end(MIMI_PHASE_COPY);
+                return MIMI_ERR_XIP_MISMATCH;
+            }
+            mimi_pipe_copy((void*)(uintptr_t)dest_addr,
+                           (const void*)(uintptr_t)seg->paddr, seg->filesz, index);
+            read_result = (int32_t)seg->filesz;
+        } else {
+            /* A native image's padding lands in BSS, zeroed below */
+            read_result = config->io->read(file, seg->offset,
+                                           (void*)(uintptr_t)dest_addr, seg->read_size);
+            if (read_result == (int32_t)seg->read_size) {
+                read_result = (int32_t)seg->filesz;
             }
         }
         
-        /* Record segment for overlap checking */
-        seg_info[loadable_count].vaddr = phdr.p_vaddr;
-        seg_info[loadable_count].memsz = phdr.p_memsz;
+        mimi_profile_end(MIMI_PHASE_COPY);
+        mimi_profile_segment(index, mimi_profile_now() - start_us);
         
-        /* Track memory bounds */
-        if (phdr.p_vaddr < result->load_base) {
-            result->load_base = phdr.p_vaddr;
-        }
-        if (phdr.p_vaddr + phdr.p_memsz > result->load_end) {
-            result->load_end = phdr.p_vaddr + phdr.p_memsz;
+        if (read_result < 0 || (uint32_t)read_result != seg->filesz) {
+            return MIMI_ERR_READ;
         }
         
-        total_memsz += phdr.p_memsz;
-        loadable_count++;
+        dest_addr += init_size;
+        *bytes_copied += init_size;
     }
+    result->segments[index].init_size = init_size;
     
-    if (loadable_count == 0) {
-        result->status = MIMI_ERR_NO_LOADABLE;
-        return result->status;
+    /* Zero BSS portion (memsz > initialized size) */
+    if (seg->memsz > init_size) {
+        uint32_t bss_size = seg->memsz - init_size;
+        
+        if (config->zero_bss) {
+            mimi_profile_begin(MIMI_PHASE_BSS);
+            mimi_pipe_zero((void*)(uintptr_t)dest_addr, bss_size, index);
+            mimi_profile_end(MIMI_PHASE_BSS);
+            
+            *bytes_zeroed += bss_size;
+        } else {
+            /* Left to the payload's startup code (see mimi_handoff_build) */
+            result->bytes_unzeroed += bss_size;
+        }
     }
     
-    /*------------------------------------------------------------------------
-     * Phase 3: Second pass - actually load segments
-     *------------------------------------------------------------------------*/
+    return MIMI_OK;
+}
+
+/**
+ * Wait for work queued to core 1. A failure marks the segment that
+ * queued it as not loaded.
+ */
+MIMI_RAMFUNC
+static mimi_err_t mimi_load_drain(mimi_load_result_t* result) {
+    if (!mimi_pipe_active()) {
+        return MIMI_OK;
+    }
     
-    uint32_t seg_index = 0;
+    uint32_t tag;
     
-    for (uint32_t i = 0; i < ehdr.e_phnum; i++) {
-        uint32_t phdr_offset = ehdr.e_phoff + (i * sizeof(Elf32_Phdr));
+    mimi_profile_begin(MIMI_PHASE_CORE1_WAIT);
+    mimi_err_t err = mimi_pipe_wait(&tag);
+    mimi_profile_end(MIMI_PHASE_CORE1_WAIT);
+    
+    if (err != MIMI_OK && tag < MIMI_MAX_SEGMENTS) {
+        result->segments[tag].loaded = false;
+    }
+    return err;
+}
+
+/**
+ * Check whether a segment's data is written by core 1.
+ */
+static bool mimi_load_queued(const mimi_seg_desc_t* seg) {
+    return mimi_pipe_active() && seg->filesz > 0 &&
+           ((seg->flags & PF_MIMI_LZ4) || seg->source == MIMI_SEG_FROM_FLASH);
+}
+
+/**
+ * Extend the image CRC over segments [*next, end).
+ */
+static void mimi_load_crc(mimi_load_result_t* result, uint32_t end, uint32_t* next) {
+    mimi_profile_begin(MIMI_PHASE_CRC);
+    for (; *next < end; (*next)++) {
+        const mimi_segment_info_t* info = &result->segments[*next];
+        result->crc32 = mimi_crc32_update(result->crc32,
+                                          (const void*)(uintptr_t)info->vaddr,
+                                          info->init_size);
+    }
+    mimi_profile_end(MIMI_PHASE_CRC);
+}
+
+mimi_err_t mimi_elf_load_layout(
+    const mimi_loader_config_t* config,
+    mimi_file_t                 file,
+    const mimi_elf_layout_t*    layout,
+    mimi_load_result_t*         result
+) {
+    mimi_err_t err;
+    uint32_t crc_next = 0;
+    
+    /* Initialize result */
+    mimi_memset(result, 0, sizeof(*result));
+    result->entry = layout->entry;
+    result->load_base = layout->load_base;
+    result->load_end = layout->load_end;
+    result->total_size = layout->total_size;
+    
+    /* Segments are in file order: every read moves forward */
+    for (uint32_t i = 0; i < layout->segment_count; i++) {
+        const mimi_seg_desc_t* seg = &layout->segments[i];
+        mimi_segment_info_t* info = &result->segments[i];
         
-        read_result = config->io->read(file, phdr_offset, &phdr, sizeof(phdr));
-        if (read_result < 0 || (uint32_t)read_result != sizeof(phdr)) {
-            result->status = MIMI_ERR_READ;
+        info->vaddr = seg->vaddr;
+        info->size = seg->memsz;
+        info->flags = seg->flags;
+        
+        err = mimi_load_segment(config, file, seg, i, result);
+        if (err != MIMI_OK) {
+            /* Core 1 must be idle before the caller reuses memory */
+            mimi_load_drain(result);
+            result->status = err;
             return result->status;
         }
         
-        if (phdr.p_type != PT_LOAD) {
-            continue;
-        }
+        info->loaded = true;
+        result->segment_count = i + 1;
         
-        if (seg_index >= MIMI_MAX_SEGMENTS) {
-            break;
+        /*
+         * Checksum data that is already in place. Segments queued to
+         * core 1 (and all after them, to keep file order) are covered
+         * once the pipeline has drained.
+         */
+        if (config->compute_crc && crc_next == i && !mimi_load_queued(seg)) {
+            mimi_load_crc(result, i + 1, &crc_next);
         }
+    }
+    
+    err = mimi_load_drain(result);
+    if (err != MIMI_OK) {
+        result->status = err;
+        return result->status;
+    }
+    
+    if (config->compute_crc) {
+        mimi_load_crc(result, layout->segment_count, &crc_next);
+        result->has_crc = true;
         
-        err = mimi_load_segment(
-            config, file, &phdr,
-            &result->segments[seg_index],
-            &result->bytes_copied,
-            &result->bytes_zeroed
-        );
+        /* An explicit CRC wins over the one the packer recorded */
+        bool check = config->check_crc || layout->has_crc;
+        uint32_t expected = config->check_crc ? config->expected_crc : layout->crc32;
+        if (check && result->crc32 != expected) {
+            result->status = MIMI_ERR_CRC_MISMATCH;
+            return result->status;
+        }
+    }
+    
+    /* Optional verification - a second forward pass */
+    if (config->verify_after_load) {
+        for (uint32_t i = 0; i < layout->segment_count; i++) {
+            const mimi_seg_desc_t* seg = &layout->segments[i];
+            
+            mimi_profile_begin(MIMI_PHASE_VERIFY);
+            if (mimi_pipe_active() && seg->filesz > 0) {
+                /* Core 1 compares while core 0 reads the next chunk */
+                uint32_t kind = (seg->flags & PF_MIMI_LZ4) ? MIMI_PIPE_LZ4_VERIFY
+                                                           : MIMI_PIPE_COMPARE;
+                uint32_t size;
+                err = mimi_pipe_stream(config->io, file, seg->offset, seg->filesz,
+                                       (uint8_t*)(uintptr_t)seg->vaddr, seg->memsz,
+                                       kind, i, &size);
+            } else {
+                err = mimi_verify_segment(config, file, seg, seg->vaddr, 0xFFFFFFFF);
+            }
+            mimi_profile_end(MIMI_PHASE_VERIFY);
+            
+            if (err != MIMI_OK) {
+                mimi_load_drain(result);
+                result->segments[i].loaded = false;
+                result->status = err;
+                return result->status;
+            }
+        }
         
+        err = mimi_load_drain(result);
         if (err != MIMI_OK) {
             result->status = err;
             return result->status;
         }
-        
-        seg_index++;
     }
     
-    result->segment_count = seg_index;
-    result->total_size = total_memsz;
     result->status = MIMI_OK;
+    return MIMI_OK;
+}
+
+/*============================================================================
+ * Main Load Function
+ *============================================================================*/
+
+mimi_err_t mimi_elf_load(
+    const mimi_loader_config_t* config,
+    mimi_file_t                 file,
+    mimi_load_result_t*         result
+) {
+    mimi_elf_layout_t layout;
+    
+    mimi_profile_begin(MIMI_PHASE_PARSE);
+    mimi_err_t err = mimi_elf_parse(config, file, &layout);
+    mimi_profile_end(MIMI_PHASE_PARSE);
     
+    if (err != MIMI_OK) {
+        mimi_memset(result, 0, sizeof(*result));
+        result->status = err;
+        return err;
+    }
+    
+    return mimi_elf_load_layout(config, file, &layout, result);
+}
+
+/*============================================================================
+ * Extra Load Items
+ *============================================================================*/
+
+mimi_err_t mimi_blob_plan(
+    const mimi_loader_config_t* config,
+    const mimi_elf_layout_t*    layout,
+    mimi_blob_t*                blobs,
+    uint32_t                    count
+) {
+    for (uint32_t i = 0; i < count; i++) {
+        const mimi_blob_t* blob = &blobs[i];
+        
+        if (blob->size == 0 || blob->addr + blob->size < blob->addr) {
+            return MIMI_ERR_ADDR_INVALID;
+        }
+        if (config->validate_addresses &&
+            !mimi_addr_valid(blob->addr, blob->size, MIMI_MEM_WRITE | MIMI_MEM_RAM, config)) {
+            return MIMI_ERR_ADDR_INVALID;
+        }
+        
+        for (uint32_t j = 0; j < layout->segment_count; j++) {
+            if (mimi_ranges_overlap(blob->addr, blob->size,
+                                   layout->segments[j].vaddr, layout->segments[j].memsz)) {
+                return MIMI_ERR_ADDR_OVERLAP;
+            }
+        }
+        for (uint32_t j = 0; j < i; j++) {
+            if (mimi_ranges_overlap(blob->addr, blob->size, blobs[j].addr, blobs[j].size)) {
+                return MIMI_ERR_ADDR_OVERLAP;
+            }
+        }
+    }
+    
+    /* Storage order (insertion sort - counts are tiny) */
+    for (uint32_t i = 1; i < count; i++) {
+        mimi_blob_t blob = blobs[i];
+        uint32_t pos = i;
+        while (pos > 0 && blobs[pos - 1].position > blob.position) {
+            blobs[pos] = blobs[pos - 1];
+            pos--;
+        }
+        blobs[pos] = blob;
+    }
+    
+    return MIMI_OK;
+}
+
+mimi_err_t mimi_blob_load(
+    const mimi_loader_config_t* config,
+    const mimi_blob_t*          blobs,
+    uint32_t                    count,
+    uint32_t*                   loaded
+) {
+    for (*loaded = 0; *loaded < count; (*loaded)++) {
+        const mimi_blob_t* blob = &blobs[*loaded];
+        
+        int32_t read = config->io->read(blob->file, 0, (void*)(uintptr_t)blob->addr, blob->size);
+        if (read < 0 || (uint32_t)read != blob->size) {
+            return MIMI_ERR_READ;
+        }
+    }
     return MIMI_OK;
 }
 
@@ -4,7 +4,8 @@
  * loader.h - ELF Loader Interface
  * 
  * Pure C, no external dependencies. Defines the loader interface
- * and all associated types.
+ * and all associated types. Images are ELF executables or MimiBoot
+ * native images (see mimg.h); both parse into the same load layout.
  */
 
 #ifndef MIMIBOOT_LOADER_H
@@ -39,19 +40,24 @@ typedef enum {
     MIMI_ERR_NO_PHDRS           = -17,  /* No program headers */
     MIMI_ERR_BAD_PHDR_SIZE      = -18,  /* Invalid program header size */
     MIMI_ERR_TOO_MANY_PHDRS     = -19,  /* Too many program headers */
+    MIMI_ERR_BAD_HEADER         = -20,  /* Corrupt native image header */
     
     /* Loading errors */
     MIMI_ERR_NO_LOADABLE        = -30,  /* No PT_LOAD segments */
     MIMI_ERR_ADDR_INVALID       = -31,  /* Segment address outside RAM */
-    MIMI_ERR_ADDR_OVERLAP       = -32,  /* Segments overlap */
+    MIMI_ERR_ADDR_OVERLAP       = -32,  /* Segments or load items overlap */
     MIMI_ERR_TOO_LARGE          = -33,  /* Image too large for RAM */
     MIMI_ERR_LOAD_FAILED        = -34,  /* Failed to load segment */
     MIMI_ERR_ALIGNMENT          = -35,  /* Bad segment alignment */
+    MIMI_ERR_XIP_MISMATCH       = -36,  /* Flash contents differ from image */
+    MIMI_ERR_BAD_COMPRESSED     = -37,  /* Corrupt compressed segment */
+    MIMI_ERR_CRC_MISMATCH       = -38,  /* Image CRC differs from expected */
+    MIMI_ERR_STALE              = -39,  /* Manifest, resume record or delta base out of date */
     
     /* Memory errors */
     MIMI_ERR_NO_MEMORY          = -40,  /* Out of memory */
     MIMI_ERR_BAD_REGION         = -41,  /* Invalid memory region */
-    
+
 } mimi_err_t;
 
 /*============================================================================
@@ -61,6 +67,8 @@ typedef enum {
 /**
  * Describes a memory region available for loading.
  * The loader validates that all segments fit within defined regions.
+ * Regions may be given per RAM bank: a segment can run on from one
+ * region into the next one that starts where it ends.
  */
 typedef struct {
     uint32_t    base;       /* Region base address */
@@ -74,6 +82,9 @@ typedef struct {
 #define MIMI_MEM_EXEC       0x0004  /* Executable */
 #define MIMI_MEM_RAM        0x0010  /* RAM (volatile) */
 #define MIMI_MEM_FLASH      0x0020  /* Flash (non-volatile) */
+#define MIMI_MEM_STRIPED    0x0040  /* Banks interleaved by word (bulk bandwidth) */
+#define MIMI_MEM_SCRATCH    0x0080  /* Bank of its own (no contention with the rest) */
+#define MIMI_MEM_LOADER     0x0100  /* Used by the loader until handoff: never loaded */
 
 /*============================================================================
  * I/O Abstraction
@@ -92,6 +103,12 @@ typedef struct {
     /**
      * Read bytes from file at specified offset.
      * 
+     * The loader passes the segment's final load address as the
+     * destination, so implementations should read directly into
+     * buffer wherever possible rather than staging through a
+     * temporary copy. The buffer has no alignment guarantee and
+     * size may span many sectors.
+     * 
      * @param file      File handle
      * @param offset    Byte offset from start of file
      * @param buffer    Destination buffer
@@ -107,7 +124,7 @@ typedef struct {
      * @return          File size in bytes, or negative error
      */
     int32_t (*size)(mimi_file_t file);
-    
+
 } mimi_io_ops_t;
 
 /*============================================================================
@@ -121,6 +138,7 @@ typedef struct {
 typedef struct {
     uint32_t    vaddr;      /* Virtual (load) address */
     uint32_t    size;       /* Size in memory */
+    uint32_t    init_size;  /* Initialized bytes (decoded size for LZ4) */
     uint32_t    flags;      /* Segment flags (PF_*) */
     bool        loaded;     /* Successfully loaded */
 } mimi_segment_info_t;
@@ -128,6 +146,51 @@ typedef struct {
 /* Maximum segments we track */
 #define MIMI_MAX_SEGMENTS   16
 
+/* Program headers fetched per table read */
+#define MIMI_MAX_PHDRS      16
+
+/*============================================================================
+ * Parsed Image Layout
+ *============================================================================*/
+
+/**
+ * Where a segment's initialized bytes come from.
+ */
+#define MIMI_SEG_FROM_FILE      0   /* Copied from the image file */
+#define MIMI_SEG_IN_PLACE       1   /* Already resident in XIP flash, not copied */
+#define MIMI_SEG_FROM_FLASH     2   /* Copied from its load address (LMA) in flash */
+
+/**
+ * PT_LOAD segment as described by the program header table.
+ */
+typedef struct {
+    uint32_t    offset;     /* Offset of segment data in file */
+    uint32_t    vaddr;      /* Load address */
+    uint32_t    paddr;      /* Physical (LMA) address */
+    uint32_t    filesz;     /* Bytes stored in file */
+    uint32_t    memsz;      /* Bytes occupied in memory */
+    uint32_t    flags;      /* Segment flags (PF_*) */
+    uint32_t    source;     /* MIMI_SEG_* */
+    uint32_t    read_size;  /* Bytes read into place: filesz, or on to the sector
+                               end of a native image when BSS covers the padding */
+} mimi_seg_desc_t;
+
+/**
+ * Load layout of an ELF image.
+ * Segments are sorted by file offset so they can be loaded in a
+ * single forward pass over the file.
+ */
+typedef struct {
+    uint32_t            entry;          /* Entry point address */
+    uint32_t            load_base;      /* Lowest load address */
+    uint32_t            load_end;       /* Highest load address + 1 */
+    uint32_t            total_size;     /* Sum of segment memsz */
+    bool                has_crc;        /* crc32 precomputed (native image) */
+    uint32_t            crc32;          /* Image CRC recorded by the packer */
+    uint32_t            segment_count;  /* Number of non-empty PT_LOAD segments */
+    mimi_seg_desc_t     segments[MIMI_MAX_SEGMENTS];
+} mimi_elf_layout_t;
+
 /*============================================================================
  * Load Result
  *============================================================================*/
@@ -152,12 +215,39 @@ typedef struct {
     uint32_t            segment_count;  /* Number of PT_LOAD segments */
     mimi_segment_info_t segments[MIMI_MAX_SEGMENTS];
     
+    /* Execute-in-place segments */
+    uint32_t            xip_base;       /* Lowest in-place address (0 if none) */
+    uint32_t            xip_end;        /* Highest in-place address + 1 */
+    
     /* Statistics */
-    uint32_t            bytes_copied;   /* Bytes copied from file */
+    uint32_t            bytes_copied;   /* Bytes copied/decoded from file or flash */
     uint32_t            bytes_zeroed;   /* Bytes zeroed (BSS) */
+    uint32_t            bytes_unzeroed; /* BSS left uncleared (zero_bss off) */
+    uint32_t            bytes_in_place; /* Bytes left in XIP flash */
+    uint32_t            bytes_compressed; /* LZ4 input read from file */
     
+    /* Integrity */
+    bool                has_crc;        /* crc32 was computed */
+    uint32_t            crc32;          /* Image CRC (see compute_crc) */
+
 } mimi_load_result_t;
 
+/*============================================================================
+ * Extra Load Items
+ *============================================================================*/
+
+/**
+ * Raw file loaded at a fixed address alongside the image: core 1
+ * firmware, tables, assets. Loaded whole, as it is stored.
+ */
+typedef struct {
+    mimi_file_t         file;           /* File handle (passed to io ops) */
+    uint32_t            addr;           /* Load address */
+    uint32_t            size;           /* Bytes (the whole file) */
+    uint32_t            position;       /* Where the file starts on storage, for ordering */
+    uint32_t            index;          /* Caller's tag (boot.cfg entry) */
+} mimi_blob_t;
+
 /*============================================================================
  * Loader Configuration
  *============================================================================*/
@@ -176,9 +266,29 @@ typedef struct {
     
     /* Options */
     bool    validate_addresses;     /* Validate segment addresses */
-    bool    zero_bss;               /* Zero BSS sections */
+    bool    zero_bss;               /* Zero BSS (else left to the payload) */
     bool    verify_after_load;      /* Read back and verify (slow) */
     
+    /*
+     * Execute in place: segments linked into a MIMI_MEM_FLASH region
+     * are expected to be programmed there already and are not copied
+     * (only spot-checked against the file). RAM segments whose LMA is
+     * in flash (.data) are copied from flash instead of the file.
+     */
+    bool    allow_xip;
+    
+    /*
+     * Image CRC-32 over the initialized bytes of every segment (decoded
+     * data for LZ4 segments, in-place data for XIP ones) as they sit in
+     * memory, in file order. BSS is not covered. Computed while loading,
+     * so checking it costs no extra I/O, unlike verify_after_load.
+     * Without check_crc, a native image is checked against the CRC
+     * recorded in its header.
+     */
+    bool        compute_crc;
+    bool        check_crc;          /* Fail the load unless crc == expected_crc */
+    uint32_t    expected_crc;
+
 } mimi_loader_config_t;
 
 /*============================================================================
@@ -204,11 +314,55 @@ mimi_err_t mimi_elf_validate_header(const Elf32_Ehdr* ehdr);
  */
 const char* mimi_strerror(mimi_err_t err);
 
+/**
+ * Parse ELF file into a load layout.
+ * 
+ * Reads the ELF header and program header table (a single I/O for
+ * typical images), validates every PT_LOAD segment against the
+ * configured memory regions and checks for overlaps. Nothing is
+ * written to the load addresses.
+ * 
+ * A MimiBoot native image (MIMG_MAGIC) is recognized from the same
+ * read: its header and segment table fill the first sector, and the
+ * packer has already sorted and laid out the segments.
+ * 
+ * @param config    Loader configuration
+ * @param file      File handle (passed to io ops)
+ * @param layout    Output: parsed layout, segments sorted by file offset
+ * @return          MIMI_OK if successful, error code otherwise
+ */
+mimi_err_t mimi_elf_parse(
+    const mimi_loader_config_t* config,
+    mimi_file_t                 file,
+    mimi_elf_layout_t*          layout
+);
+
+/**
+ * Load a parsed layout into memory.
+ * 
+ * Copies segment data in ascending file-offset order, so the file is
+ * consumed in one forward sequential pass, then zeroes BSS. With
+ * verify_after_load the image is read back in a second forward pass.
+ * 
+ * @param config    Loader configuration
+ * @param file      File handle (passed to io ops)
+ * @param layout    Layout from mimi_elf_parse
+ * @param result    Output: load result and segment information
+ * @return          MIMI_OK if successful, error code otherwise
+ */
+mimi_err_t mimi_elf_load_layout(
+    const mimi_loader_config_t* config,
+    mimi_file_t                 file,
+    const mimi_elf_layout_t*    layout,
+    mimi_load_result_t*         result
+);
+
 /**
  * Load ELF file into memory.
  * 
  * Parses the ELF file, validates it, and loads all PT_LOAD segments
  * into their specified virtual addresses. BSS sections are zeroed.
+ * Equivalent to mimi_elf_parse followed by mimi_elf_load_layout.
  * 
  * @param config    Loader configuration
  * @param file      File handle (passed to io ops)
@@ -221,6 +375,44 @@ mimi_err_t mimi_elf_load(
     mimi_load_result_t*         result
 );
 
+/**
+ * Plan the extra load items of an image.
+ * 
+ * Checks every item against the configured memory regions, then for
+ * overlaps with the image's segments and every other item, as segments
+ * are checked against each other. The items are then sorted by storage position,
+ * so the batch is read in one forward sweep over the device.
+ * 
+ * @param config    Loader configuration
+ * @param layout    Layout of the image loaded with them
+ * @param blobs     Items, sorted in place
+ * @param count     Number of items
+ * @return          MIMI_OK, MIMI_ERR_ADDR_INVALID or MIMI_ERR_ADDR_OVERLAP
+ */
+mimi_err_t mimi_blob_plan(
+    const mimi_loader_config_t* config,
+    const mimi_elf_layout_t*    layout,
+    mimi_blob_t*                blobs,
+    uint32_t                    count
+);
+
+/**
+ * Load planned items, in order, each in a single read straight to its
+ * address.
+ * 
+ * @param config    Loader configuration
+ * @param blobs     Items from mimi_blob_plan
+ * @param count     Number of items
+ * @param loaded    Output: items loaded before any error
+ * @return          MIMI_OK, or MIMI_ERR_READ
+ */
+mimi_err_t mimi_blob_load(
+    const mimi_loader_config_t* config,
+    const mimi_blob_t*          blobs,
+    uint32_t                    count,
+    uint32_t*                   loaded
+);
+
 /**
  * Validate loaded image.
  * 
@@ -0,0 +1,212 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * logbuf.c - Deferred Boot Messages
+ */
+
+#include "logbuf.h"
+#include "mem.h"
+#include "profile.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*============================================================================
+ * Static State
+ *============================================================================*/
+
+static mimi_logbuf_t* s_log = NULL;
+static uint32_t s_log_size;
+
+/* Record bytes before args[] */
+#define RECORD_HEADER   offsetof(mimi_logbuf_entry_t, args)
+
+/*============================================================================
+ * Ring
+ *============================================================================*/
+
+/**
+ * Drop the oldest record, or the padding in front of the wrap.
+ */
+static void drop_oldest(mimi_logbuf_t* log) {
+    uint32_t size = *(const uint16_t*)&log->data[log->head];
+    
+    if (size == 0) {
+        size = log->size - log->head;
+    } else {
+        log->dropped++;
+    }
+    
+    log->used -= size;
+    log->head += size;
+    if (log->head == log->size) {
+        log->head = 0;
+    }
+}
+
+/**
+ * Append a record of size bytes (a multiple of 4), making room first.
+ */
+static void append(mimi_logbuf_t* log, const void* record, uint32_t size) {
+    if (size > log->size) {
+        log->dropped++;
+        return;
+    }
+    
+    uint32_t tail;
+    uint32_t pad;
+    
+    for (;;) {
+        tail = log->head + log->used;
+        if (tail >= log->size) {
+            tail -= log->size;
+        }
+        
+        /* Records never wrap: pad to the end of the ring first */
+        pad = (tail + size > log->size) ? log->size - tail : 0;
+        if (log->size - log->used >= pad + size) {
+            break;
+        }
+        
+        if (log->used == 0) {
+            log->head = 0;
+        } else {
+            drop_oldest(log);
+        }
+    }
+    
+    if (pad > 0) {
+        *(uint16_t*)&log->data[tail] = 0;
+        log->used += pad;
+        tail = 0;
+    }
+    
+    mimi_memcpy(&log->data[tail], record, size);
+    log->used += size;
+}
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void mimi_logbuf_start(mimi_logbuf_t* buffer, uint32_t size) {
+    mimi_memset(buffer, 0, sizeof(*buffer));
+    buffer->magic = MIMI_LOGBUF_MAGIC;
+    buffer->version = MIMI_LOGBUF_VERSION;
+    buffer->size = (size - sizeof(mimi_logbuf_t)) & ~3u;
+    
+    s_log = buffer;
+    s_log_size = size;
+}
+
+/* Skip a field width (%08X): it only matters when the record is rendered */
+static const char* skip_width(const char* p) {
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    return p;
+}
+
+/* Conversions of hal_console_printf that take an argument */
+static bool takes_arg(char c) {
+    return c == 'd' || c == 'i' || c == 'u' || c == 'x' || c == 'X' ||
+           c == 's' || c == 'c';
+}
+
+void mimi_logbuf_vadd(const char* fmt, va_list args) {
+    if (s_log == NULL) {
+        return;
+    }
+    
+    uint32_t words[MIMI_LOGBUF_MAX_RECORD / 4];
+    mimi_logbuf_entry_t* rec = (mimi_logbuf_entry_t*)words;
+    char* bytes = (char*)words;
+    
+    /* Count first: copied strings go after the arguments */
+    uint32_t count = 0;
+    for (const char* p = fmt; *p != '\0'; p++) {
+        if (*p == '%' && p[1] != '\0') {
+            p = skip_width(p + 1);
+            if (*p == '\0') {
+                break;
+            }
+            count += takes_arg(*p);
+        }
+    }
+    if (count > MIMI_LOGBUF_MAX_ARGS) {
+        count = MIMI_LOGBUF_MAX_ARGS;
+    }
+    
+    uint32_t end = RECORD_HEADER + count * sizeof(uint32_t);
+    uint32_t n = 0;
+    
+    for (const char* p = fmt; *p != '\0' && n < count; p++) {
+        if (*p != '%' || p[1] == '\0') {
+            continue;
+        }
+        p = skip_width(p + 1);
+        if (*p == '\0') {
+            break;
+        }
+        
+        switch (*p) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+                rec->args[n++] = va_arg(args, uint32_t);
+                break;
+            case 'c':
+                rec->args[n++] = (uint32_t)va_arg(args, int);
+                break;
+            case 's': {
+                const char* str = va_arg(args, const char*);
+                
+                /* Record full: share the previous string's terminator */
+                if (end >= MIMI_LOGBUF_MAX_RECORD) {
+                    rec->args[n++] = MIMI_LOGBUF_MAX_RECORD - 1;
+                    break;
+                }
+                
+                uint32_t room = MIMI_LOGBUF_MAX_RECORD - 1 - end;
+                uint32_t len = 0;
+                while (str != NULL && str[len] != '\0' && len < room) {
+                    bytes[end + len] = str[len];
+                    len++;
+                }
+                bytes[end + len] = '\0';
+                
+                rec->args[n++] = end;
+                end += len + 1;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    
+    /* Whole words, padding cleared */
+    while (end & 3) {
+        bytes[end++] = '\0';
+    }
+    
+    rec->size = (uint16_t)end;
+    rec->arg_count = (uint8_t)count;
+    rec->reserved = 0;
+    rec->format = (uint32_t)(uintptr_t)fmt;
+    rec->time_us = mimi_profile_now();
+    
+    append(s_log, rec, end);
+}
+
+void mimi_logbuf_add(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    mimi_logbuf_vadd(fmt, args);
+    va_end(args);
+}
+
+const mimi_logbuf_t* mimi_logbuf_get(uint32_t* size) {
+    *size = s_log_size;
+    return s_log;
+}
@@ -0,0 +1,54 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * logbuf.h - Deferred Boot Messages
+ * 
+ * Keeps boot messages in a RAM ring as format string, arguments and
+ * timestamp (mimi_logbuf_t), without formatting them. The payload
+ * finds the ring in the handoff regions and renders it if it wants
+ * to. As with the profile, one log is active at a time and all calls
+ * are no-ops until mimi_logbuf_start.
+ */
+
+#ifndef MIMIBOOT_LOGBUF_H
+#define MIMIBOOT_LOGBUF_H
+
+#include <stdint.h>
+#include <stdarg.h>
+#include "../../include/mimiboot/handoff.h"
+
+/* Arguments kept per record; later ones are dropped */
+#define MIMI_LOGBUF_MAX_ARGS    8
+
+/* Largest record, %s copies included */
+#define MIMI_LOGBUF_MAX_RECORD  256
+
+/**
+ * Start logging into buffer.
+ * 
+ * @param buffer    Log (header and ring), word aligned
+ * @param size      Bytes at buffer
+ */
+void mimi_logbuf_start(mimi_logbuf_t* buffer, uint32_t size);
+
+/**
+ * Record one message. Takes the conversions of hal_console_printf.
+ * 
+ * @param fmt   Format string; must stay in place (flash) for the payload
+ * @param args  Arguments
+ */
+void mimi_logbuf_vadd(const char* fmt, va_list args);
+
+/**
+ * Record one message (see mimi_logbuf_vadd).
+ */
+void mimi_logbuf_add(const char* fmt, ...);
+
+/**
+ * Get the active log (NULL if inactive).
+ * 
+ * @param size  Output: bytes at the log, header included
+ */
+const mimi_logbuf_t* mimi_logbuf_get(uint32_t* size);
+
+#endif /* MIMIBOOT_LOGBUF_H */
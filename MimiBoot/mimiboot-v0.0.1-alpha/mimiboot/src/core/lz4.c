@@ -0,0 +1,295 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * lz4.c - Streaming LZ4 Segment Decoder
+ * 
+ * LZ4 block format: a sequence of
+ * 
+ *     token       literal length (high nibble), match length - 4 (low)
+ *     [len...]    extra literal length bytes while nibble/byte == 15/255
+ *     literals
+ *     offset      16-bit little-endian match distance (1..65535)
+ *     [len...]    extra match length bytes
+ * 
+ * The last sequence stops after its literals. Input is pulled through
+ * a stream of chunks (a sector-aligned file buffer, or the pipeline's
+ * slot ring); output goes directly to the load address.
+ */
+
+#include "lz4.h"
+#include "mem.h"
+#include <stddef.h>
+
+/*============================================================================
+ * Stream Helpers
+ *============================================================================*/
+
+MIMI_RAMFUNC
+static bool lz4_at_end(const mimi_lz4_stream_t* in) {
+    return in->last && in->pos == in->len;
+}
+
+/**
+ * Make sure at least one byte is available.
+ */
+MIMI_RAMFUNC
+static mimi_err_t lz4_fill(mimi_lz4_stream_t* in) {
+    while (in->pos == in->len) {
+        if (in->last) {
+            return MIMI_ERR_BAD_COMPRESSED;
+        }
+        
+        mimi_err_t err = in->refill(in);
+        if (err != MIMI_OK) {
+            return err;
+        }
+    }
+    return MIMI_OK;
+}
+
+/**
+ * Fetch one byte.
+ */
+MIMI_RAMFUNC
+static mimi_err_t lz4_byte(mimi_lz4_stream_t* in, uint32_t* value) {
+    mimi_err_t err = lz4_fill(in);
+    if (err != MIMI_OK) {
+        return err;
+    }
+    
+    *value = in->data[in->pos++];
+    return MIMI_OK;
+}
+
+/**
+ * Extend a length field with 255-continued bytes.
+ */
+MIMI_RAMFUNC
+static mimi_err_t lz4_length(mimi_lz4_stream_t* in, uint32_t* length) {
+    uint32_t b;
+    
+    do {
+        mimi_err_t err = lz4_byte(in, &b);
+        if (err != MIMI_OK) {
+            return err;
+        }
+        *length += b;
+        
+        /* Corrupt input cannot wrap the length */
+        if (*length > 0x7FFFFFFF) {
+            return MIMI_ERR_BAD_COMPRESSED;
+        }
+    } while (b == 255);
+    
+    return MIMI_OK;
+}
+
+/*============================================================================
+ * Decoder
+ *============================================================================*/
+
+mimi_err_t mimi_lz4_read_header(const uint8_t* data, uint32_t limit, uint32_t* raw_size) {
+    mimi_lz4_header_t hdr;
+    
+    mimi_memcpy(&hdr, data, sizeof(hdr));
+    
+    if (hdr.magic != MIMI_LZ4_MAGIC || hdr.raw_size > limit) {
+        return MIMI_ERR_BAD_COMPRESSED;
+    }
+    
+    *raw_size = hdr.raw_size;
+    return MIMI_OK;
+}
+
+MIMI_RAMFUNC
+mimi_err_t mimi_lz4_decode_stream(
+    mimi_lz4_stream_t*      in,
+    uint8_t*                dest,
+    uint32_t                raw_size,
+    bool                    verify
+) {
+    uint32_t out = 0;
+    mimi_err_t err;
+    
+    while (!lz4_at_end(in)) {
+        uint32_t token;
+        if ((err = lz4_byte(in, &token)) != MIMI_OK) {
+            return err;
+        }
+        
+        /*--------------------------------------------------------------------
+         * Literals - straight from the input chunk
+         *--------------------------------------------------------------------*/
+        
+        uint32_t length = token >> 4;
+        if (length == 15 && (err = lz4_length(in, &length)) != MIMI_OK) {
+            return err;
+        }
+        
+        if (length > raw_size - out) {
+            return MIMI_ERR_BAD_COMPRESSED;
+        }
+        
+        while (length > 0) {
+            if ((err = lz4_fill(in)) != MIMI_OK) {
+                return err;
+            }
+            
+            uint32_t chunk = in->len - in->pos;
+            if (chunk > length) {
+                chunk = length;
+            }
+            
+            if (verify) {
+                if (mimi_memcmp(dest + out, in->data + in->pos, chunk) != 0) {
+                    return MIMI_ERR_LOAD_FAILED;
+                }
+            } else {
+                mimi_memcpy(dest + out, in->data + in->pos, chunk);
+            }
+            
+            in->pos += chunk;
+            out += chunk;
+            length -= chunk;
+        }
+        
+        /* Last sequence has no match part */
+        if (lz4_at_end(in)) {
+            break;
+        }
+        
+        /*--------------------------------------------------------------------
+         * Match - copied from earlier output
+         *--------------------------------------------------------------------*/
+        
+        uint32_t lo, hi;
+        if ((err = lz4_byte(in, &lo)) != MIMI_OK ||
+            (err = lz4_byte(in, &hi)) != MIMI_OK) {
+            return err;
+        }
+        
+        uint32_t distance = lo | (hi << 8);
+        if (distance == 0 || distance > out) {
+            return MIMI_ERR_BAD_COMPRESSED;
+        }
+        
+        length = token & 0x0F;
+        if (length == 15 && (err = lz4_length(in, &length)) != MIMI_OK) {
+            return err;
+        }
+        length += MIMI_LZ4_MIN_MATCH;
+        
+        if (length > raw_size - out) {
+            return MIMI_ERR_BAD_COMPRESSED;
+        }
+        
+        uint8_t* dst = dest + out;
+        const uint8_t* src = dst - distance;
+        
+        if (verify) {
+            /* Overlap is harmless: both sides are already in memory */
+            if (mimi_memcmp(dst, src, length) != 0) {
+                return MIMI_ERR_LOAD_FAILED;
+            }
+        } else if (distance >= length) {
+            mimi_memcpy(dst, src, length);
+        } else {
+            /* Overlapping run: must replicate byte by byte */
+            for (uint32_t i = 0; i < length; i++) {
+                dst[i] = src[i];
+            }
+        }
+        
+        out += length;
+    }
+    
+    return (out == raw_size) ? MIMI_OK : MIMI_ERR_BAD_COMPRESSED;
+}
+
+/*============================================================================
+ * File Input
+ *============================================================================*/
+
+typedef struct {
+    mimi_lz4_stream_t       stream;     /* Must be first */
+    const mimi_io_ops_t*    io;
+    mimi_file_t             file;
+    uint32_t                offset;     /* File offset of next read */
+    uint32_t                remaining;  /* Compressed bytes not yet read */
+    uint8_t                 buf[MIMI_LZ4_INPUT_SIZE];
+} lz4_file_input_t;
+
+/* Static: the boot stack (4KB) is not the place for a 2KB buffer */
+static lz4_file_input_t s_input MIMI_SCRATCH_X;
+
+/**
+ * Read the next chunk of the file.
+ * The first read runs up to a sector boundary (so the header always
+ * fits in it); later reads are whole aligned buffers.
+ */
+MIMI_RAMFUNC
+static mimi_err_t lz4_file_refill(mimi_lz4_stream_t* stream) {
+    lz4_file_input_t* in = (lz4_file_input_t*)stream;
+    
+    uint32_t chunk = MIMI_LZ4_INPUT_SIZE - (in->offset % MIMI_LZ4_READ_ALIGN);
+    if (chunk > in->remaining) {
+        chunk = in->remaining;
+    }
+    
+    int32_t read_result = in->io->read(in->file, in->offset, in->buf, chunk);
+    if (read_result < 0 || (uint32_t)read_result != chunk) {
+        return MIMI_ERR_READ;
+    }
+    
+    in->offset += chunk;
+    in->remaining -= chunk;
+    
+    stream->data = in->buf;
+    stream->pos = 0;
+    stream->len = chunk;
+    stream->last = (in->remaining == 0);
+    return MIMI_OK;
+}
+
+mimi_err_t mimi_lz4_decode(
+    const mimi_io_ops_t*    io,
+    mimi_file_t             file,
+    uint32_t                offset,
+    uint32_t                size,
+    uint8_t*                dest,
+    uint32_t                limit,
+    bool                    verify,
+    uint32_t*               out_size
+) {
+    lz4_file_input_t* in = &s_input;
+    uint32_t raw_size;
+    mimi_err_t err;
+    
+    if (size < sizeof(mimi_lz4_header_t)) {
+        return MIMI_ERR_BAD_COMPRESSED;
+    }
+    
+    in->stream.refill = lz4_file_refill;
+    in->io = io;
+    in->file = file;
+    in->offset = offset;
+    in->remaining = size;
+    
+    /* Header arrives with the first chunk of input */
+    if ((err = lz4_file_refill(&in->stream)) != MIMI_OK) {
+        return err;
+    }
+    
+    if ((err = mimi_lz4_read_header(in->buf, limit, &raw_size)) != MIMI_OK) {
+        return err;
+    }
+    in->stream.pos = sizeof(mimi_lz4_header_t);
+    
+    err = mimi_lz4_decode_stream(&in->stream, dest, raw_size, verify);
+    if (err != MIMI_OK) {
+        return err;
+    }
+    
+    *out_size = raw_size;
+    return MIMI_OK;
+}
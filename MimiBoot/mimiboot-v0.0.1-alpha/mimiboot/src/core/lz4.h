@@ -0,0 +1,128 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * lz4.h - Streaming LZ4 Segment Decoder
+ * 
+ * Decodes LZ4-compressed PT_LOAD segments (PF_MIMI_LZ4) straight into
+ * their load address while the compressed stream is read forward from
+ * the file. Matches are resolved against the output already written,
+ * so the only RAM used is one small input buffer.
+ * 
+ * Segment file data layout (p_offset .. p_offset + p_filesz):
+ * 
+ *     mimi_lz4_header_t   magic, decoded size
+ *     LZ4 block           raw LZ4 block format, no frame
+ * 
+ * Decoded bytes fill the segment from p_vaddr; p_memsz - raw_size
+ * bytes following them are BSS as usual.
+ */
+
+#ifndef MIMIBOOT_LZ4_H
+#define MIMIBOOT_LZ4_H
+
+#include "loader.h"
+
+/*============================================================================
+ * Format
+ *============================================================================*/
+
+#define MIMI_LZ4_MAGIC      0x345A4C4D  /* "MLZ4" */
+
+/**
+ * Header at the start of a compressed segment's file data.
+ */
+typedef struct {
+    uint32_t    magic;      /* MIMI_LZ4_MAGIC */
+    uint32_t    raw_size;   /* Decoded size in bytes (<= p_memsz) */
+} mimi_lz4_header_t;
+
+_Static_assert(sizeof(mimi_lz4_header_t) == 8, "mimi_lz4_header_t size mismatch");
+
+/* Compressed bytes read per I/O (multiple of the sector size) */
+#define MIMI_LZ4_INPUT_SIZE 2048
+
+/* Reads after the first start on this boundary so no sector is fetched twice */
+#define MIMI_LZ4_READ_ALIGN 512
+
+/* Minimum match length encoded by a sequence token */
+#define MIMI_LZ4_MIN_MATCH  4
+
+/*============================================================================
+ * Decoder
+ *============================================================================*/
+
+/**
+ * Compressed input for mimi_lz4_decode_stream().
+ * 
+ * The decoder consumes data[pos..len) and calls refill for the next
+ * chunk, which must replace data/len and reset pos. last marks the
+ * final chunk: the stream ends when it is used up.
+ */
+typedef struct mimi_lz4_stream mimi_lz4_stream_t;
+
+struct mimi_lz4_stream {
+    mimi_err_t      (*refill)(mimi_lz4_stream_t* stream);
+    const uint8_t*  data;
+    uint32_t        pos;
+    uint32_t        len;
+    bool            last;
+};
+
+/**
+ * Validate a segment header.
+ * 
+ * @param data      Start of the segment's file data (8 bytes, any alignment)
+ * @param limit     Maximum decoded size (segment memsz)
+ * @param raw_size  Output: decoded size
+ * @return          MIMI_OK or MIMI_ERR_BAD_COMPRESSED
+ */
+mimi_err_t mimi_lz4_read_header(const uint8_t* data, uint32_t limit, uint32_t* raw_size);
+
+/**
+ * Decode an LZ4 block from a stream (positioned after the header).
+ * 
+ * In verify mode nothing is written: the decoded stream is compared
+ * against memory at dest instead, which needs no window either since
+ * matches can be checked against the (already verified) bytes before
+ * them.
+ * 
+ * @param in        Input stream
+ * @param dest      Output address
+ * @param raw_size  Decoded size from the header
+ * @param verify    Compare instead of write
+ * @return          MIMI_OK, MIMI_ERR_BAD_COMPRESSED, a refill error,
+ *                  or MIMI_ERR_LOAD_FAILED on a verify mismatch
+ */
+mimi_err_t mimi_lz4_decode_stream(
+    mimi_lz4_stream_t*      in,
+    uint8_t*                dest,
+    uint32_t                raw_size,
+    bool                    verify
+);
+
+/**
+ * Decode a compressed segment read from a file.
+ * 
+ * @param io        I/O operations
+ * @param file      File handle
+ * @param offset    File offset of the compressed data (header)
+ * @param size      Compressed size in bytes, header included
+ * @param dest      Output address
+ * @param limit     Maximum decoded size (segment memsz)
+ * @param verify    Compare instead of write
+ * @param out_size  Output: decoded size
+ * @return          MIMI_OK, MIMI_ERR_READ, MIMI_ERR_BAD_COMPRESSED,
+ *                  or MIMI_ERR_LOAD_FAILED on a verify mismatch
+ */
+mimi_err_t mimi_lz4_decode(
+    const mimi_io_ops_t*    io,
+    mimi_file_t             file,
+    uint32_t                offset,
+    uint32_t                size,
+    uint8_t*                dest,
+    uint32_t                limit,
+    bool                    verify,
+    uint32_t*               out_size
+);
+
+#endif /* MIMIBOOT_LZ4_H */
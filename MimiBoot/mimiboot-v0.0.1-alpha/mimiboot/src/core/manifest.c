@@ -0,0 +1,73 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * manifest.c - Boot Manifest (warm-boot cache)
+ */
+
+#include "manifest.h"
+#include "crc32.h"
+#include "mem.h"
+#include <stddef.h>
+
+/* Bytes covered by the CRC */
+#define MANIFEST_BODY_OFFSET    offsetof(mimi_manifest_t, volume)
+#define MANIFEST_BODY_SIZE      (sizeof(mimi_manifest_t) - MANIFEST_BODY_OFFSET)
+
+static uint32_t manifest_crc(const mimi_manifest_t* manifest) {
+    return mimi_crc32_update(0, (const uint8_t*)manifest + MANIFEST_BODY_OFFSET,
+                             MANIFEST_BODY_SIZE);
+}
+
+void mimi_manifest_seal(mimi_manifest_t* manifest) {
+    manifest->magic = MIMI_MANIFEST_MAGIC;
+    manifest->version = MIMI_MANIFEST_VERSION;
+    manifest->size = sizeof(mimi_manifest_t);
+    
+    /* The handle's live pointer and position mean nothing to the next boot */
+    manifest->image.fs = NULL;
+    manifest->image.current_cluster = manifest->image.start_cluster;
+    manifest->image.position = 0;
+    
+    manifest->crc32 = manifest_crc(manifest);
+}
+
+bool mimi_manifest_valid(const void* data, uint32_t size) {
+    const mimi_manifest_t* manifest = (const mimi_manifest_t*)data;
+    
+    if (data == NULL || size < sizeof(mimi_manifest_t)) {
+        return false;
+    }
+    
+    return manifest->magic == MIMI_MANIFEST_MAGIC &&
+           manifest->version == MIMI_MANIFEST_VERSION &&
+           manifest->size == sizeof(mimi_manifest_t) &&
+           manifest->crc32 == manifest_crc(manifest);
+}
+
+mimi_err_t mimi_manifest_open(
+    const mimi_manifest_t*  manifest,
+    fat32_fs_t*             fs,
+    int                     (*read_sector)(uint32_t, uint8_t*),
+    fat32_file_t*           image
+) {
+    fat32_err_t err = fat32_remount(fs, &manifest->volume, read_sector);
+    
+    if (err == FAT32_OK) {
+        /* Read once if boot.cfg and the image share a directory sector */
+        fat32_stamp_t stamps[2];
+        stamps[0] = manifest->config_stamp;
+        stamps[1] = manifest->image.stamp;
+        err = fat32_check_stamps(fs, stamps, 2);
+    }
+    
+    if (err == FAT32_ERR_IO) {
+        return MIMI_ERR_IO;
+    }
+    if (err != FAT32_OK) {
+        return MIMI_ERR_STALE;
+    }
+    
+    *image = manifest->image;
+    fat32_reopen(fs, image);
+    return MIMI_OK;
+}
@@ -0,0 +1,91 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * manifest.h - Boot Manifest (warm-boot cache)
+ * 
+ * Everything a cold boot works out from the card before the first
+ * segment byte is read: volume geometry, the parsed boot.cfg, the
+ * image's directory entry and cluster map, and its validated load
+ * layout. Saved to non-volatile storage after a successful boot, it
+ * lets the next boot skip the partition table, boot.cfg, directory
+ * walks, FAT chain and program headers.
+ * 
+ * A saved manifest is trusted only while the card agrees with it:
+ * the boot sector must describe the same volume (geometry and serial
+ * number) and the directory entries of boot.cfg and the image must be
+ * byte-identical (size, first cluster, write time). Checking costs
+ * one boot sector read plus one read per distinct directory sector.
+ * 
+ * Not detected: a file rewritten in place by a tool that keeps its
+ * clusters, size and timestamp. Set image_crc to catch that.
+ */
+
+#ifndef MIMIBOOT_MANIFEST_H
+#define MIMIBOOT_MANIFEST_H
+
+#include "loader.h"
+#include "config.h"
+#include "../fs/fat32.h"
+
+/*============================================================================
+ * Format
+ *============================================================================*/
+
+#define MIMI_MANIFEST_MAGIC     0x464E414D  /* "MANF" */
+#define MIMI_MANIFEST_VERSION   4
+
+/**
+ * Saved boot manifest. Only meaningful to the loader build that wrote
+ * it: the size check rejects manifests from builds with other layouts.
+ */
+typedef struct {
+    uint32_t            magic;          /* MIMI_MANIFEST_MAGIC */
+    uint32_t            version;        /* MIMI_MANIFEST_VERSION */
+    uint32_t            size;           /* sizeof(mimi_manifest_t) */
+    uint32_t            crc32;          /* CRC-32 of everything after this field */
+    
+    fat32_volume_t      volume;         /* Mounted volume */
+    fat32_stamp_t       config_stamp;   /* boot.cfg directory entry */
+    mimi_config_t       config;         /* boot.cfg as parsed */
+    fat32_file_t        image;          /* Image handle and cluster map */
+    mimi_elf_layout_t   layout;         /* Image load layout */
+} mimi_manifest_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Fill in the header and CRC once all other fields are set.
+ * 
+ * @param manifest  Manifest to seal
+ */
+void mimi_manifest_seal(mimi_manifest_t* manifest);
+
+/**
+ * Check a stored manifest is intact and written by this build.
+ * 
+ * @param data      Stored bytes (may be erased flash)
+ * @param size      Bytes available at data
+ * @return          true if data holds a sealed manifest
+ */
+bool mimi_manifest_valid(const void* data, uint32_t size);
+
+/**
+ * Mount the card through a manifest and reattach its image.
+ * 
+ * @param manifest      Valid manifest (mimi_manifest_valid)
+ * @param fs            Filesystem context to mount
+ * @param read_sector   Callback to read a 512-byte sector
+ * @param image         Output: image handle, rewound
+ * @return              MIMI_OK, MIMI_ERR_IO, or MIMI_ERR_STALE if the
+ *                      card no longer matches
+ */
+mimi_err_t mimi_manifest_open(
+    const mimi_manifest_t*  manifest,
+    fat32_fs_t*             fs,
+    int                     (*read_sector)(uint32_t, uint8_t*),
+    fat32_file_t*           image
+);
+
+#endif /* MIMIBOOT_MANIFEST_H */
@@ -0,0 +1,222 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * mem.c - Memory Primitives
+ * 
+ * Cortex-M0+ has no unaligned access, so word paths are only taken
+ * when both pointers share alignment. The head is advanced bytewise
+ * to a word boundary, the body moves four words per iteration (which
+ * compiles to ldmia/stmia), and the tail finishes bytewise.
+ * 
+ * On cores with unaligned loads (MIMI_UNALIGNED_LOADS: the RP2350's
+ * M33), buffers of different alignment still go a word at a time:
+ * copies align the destination and load the source unaligned,
+ * compares load both sides unaligned. The M33's DSP instructions
+ * move no more per cycle than LDM/STM, so they have no place here.
+ */
+
+#include "mem.h"
+
+/*============================================================================
+ * Platform Acceleration
+ *============================================================================*/
+
+static mimi_copy4_fn s_copy4 = NULL;
+static mimi_set4_fn  s_set4 = NULL;
+
+void mimi_mem_init(mimi_copy4_fn copy4, mimi_set4_fn set4) {
+    s_copy4 = copy4;
+    s_set4 = set4;
+}
+
+/*============================================================================
+ * Internal Helpers
+ *============================================================================*/
+
+static inline uint32_t misalign(const void* p) {
+    return (uint32_t)(uintptr_t)p & 3;
+}
+
+/*============================================================================
+ * Copy
+ *============================================================================*/
+
+MIMI_RAMFUNC
+void mimi_memcpy(void* dst, const void* src, uint32_t size) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    
+    if (size >= 4 && misalign(d) == misalign(s)) {
+        /* Align head */
+        while (misalign(d) != 0) {
+            *d++ = *s++;
+            size--;
+        }
+        
+        uint32_t* dw = (uint32_t*)(void*)d;
+        const uint32_t* sw = (const uint32_t*)(const void*)s;
+        uint32_t body = size & ~3u;
+        
+        if (s_copy4 != NULL && body >= MIMI_MEM_ACCEL_MIN) {
+            s_copy4(dw, sw, body);
+            dw += body / 4;
+            sw += body / 4;
+        } else {
+            while (body >= 16) {
+                uint32_t w0 = sw[0];
+                uint32_t w1 = sw[1];
+                uint32_t w2 = sw[2];
+                uint32_t w3 = sw[3];
+                dw[0] = w0;
+                dw[1] = w1;
+                dw[2] = w2;
+                dw[3] = w3;
+                dw += 4;
+                sw += 4;
+                body -= 16;
+            }
+            while (body >= 4) {
+                *dw++ = *sw++;
+                body -= 4;
+            }
+        }
+        
+        d = (uint8_t*)dw;
+        s = (const uint8_t*)sw;
+        size &= 3;
+    }
+#if defined(MIMI_UNALIGNED_LOADS)
+    else if (size >= 4) {
+        /* Aligned stores, unaligned loads */
+        while (misalign(d) != 0) {
+            *d++ = *s++;
+            size--;
+        }
+        
+        uint32_t* dw = (uint32_t*)(void*)d;
+        while (size >= 16) {
+            uint32_t w0 = mimi_load32(s);
+            uint32_t w1 = mimi_load32(s + 4);
+            uint32_t w2 = mimi_load32(s + 8);
+            uint32_t w3 = mimi_load32(s + 12);
+            dw[0] = w0;
+            dw[1] = w1;
+            dw[2] = w2;
+            dw[3] = w3;
+            dw += 4;
+            s += 16;
+            size -= 16;
+        }
+        while (size >= 4) {
+            *dw++ = mimi_load32(s);
+            s += 4;
+            size -= 4;
+        }
+        
+        d = (uint8_t*)dw;
+    }
+#endif
+    
+    while (size--) {
+        *d++ = *s++;
+    }
+}
+
+/*============================================================================
+ * Fill
+ *============================================================================*/
+
+MIMI_RAMFUNC
+void mimi_memset(void* dst, uint8_t val, uint32_t size) {
+    uint8_t* d = (uint8_t*)dst;
+    
+    if (size >= 4) {
+        /* Align head */
+        while (misalign(d) != 0) {
+            *d++ = val;
+            size--;
+        }
+        
+        uint32_t* dw = (uint32_t*)(void*)d;
+        uint32_t body = size & ~3u;
+        
+        if (s_set4 != NULL && body >= MIMI_MEM_ACCEL_MIN) {
+            s_set4(dw, val, body);
+            dw += body / 4;
+        } else {
+            uint32_t w = val * 0x01010101u;
+            
+            while (body >= 16) {
+                dw[0] = w;
+                dw[1] = w;
+                dw[2] = w;
+                dw[3] = w;
+                dw += 4;
+                body -= 16;
+            }
+            while (body >= 4) {
+                *dw++ = w;
+                body -= 4;
+            }
+        }
+        
+        d = (uint8_t*)dw;
+        size &= 3;
+    }
+    
+    while (size--) {
+        *d++ = val;
+    }
+}
+
+/*============================================================================
+ * Compare
+ *============================================================================*/
+
+int mimi_memcmp(const void* a, const void* b, uint32_t size) {
+    const uint8_t* pa = (const uint8_t*)a;
+    const uint8_t* pb = (const uint8_t*)b;
+    
+    if (size >= 4 && misalign(pa) == misalign(pb)) {
+        while (misalign(pa) != 0) {
+            if (*pa != *pb) {
+                return (*pa < *pb) ? -1 : 1;
+            }
+            pa++;
+            pb++;
+            size--;
+        }
+        
+        /* Skip equal words; a mismatch is resolved bytewise below */
+        const uint32_t* wa = (const uint32_t*)(const void*)pa;
+        const uint32_t* wb = (const uint32_t*)(const void*)pb;
+        
+        while (size >= 4 && *wa == *wb) {
+            wa++;
+            wb++;
+            size -= 4;
+        }
+        
+        pa = (const uint8_t*)wa;
+        pb = (const uint8_t*)wb;
+    }
+#if defined(MIMI_UNALIGNED_LOADS)
+    else {
+        /* Skip equal words, both sides loaded unaligned */
+        while (size >= 4 && mimi_load32(pa) == mimi_load32(pb)) {
+            pa += 4;
+            pb += 4;
+            size -= 4;
+        }
+    }
+#endif
+    
+    while (size--) {
+        if (*pa != *pb) {
+            return (*pa < *pb) ? -1 : 1;
+        }
+        pa++;
+        pb++;
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * mem.h - Memory Primitives
+ * 
+ * Shared, libc-free memcpy/memset/memcmp used by every layer. Aligned
+ * buffers take word and multi-word paths; large aligned blocks can be
+ * handed to platform routines (e.g. boot ROM) registered at startup.
+ */
+
+#ifndef MIMIBOOT_MEM_H
+#define MIMIBOOT_MEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*============================================================================
+ * Platform Acceleration
+ *============================================================================*/
+
+/**
+ * Word-aligned copy: dst and src 4-byte aligned, n a multiple of 4.
+ */
+typedef void* (*mimi_copy4_fn)(uint32_t* dst, const uint32_t* src, uint32_t n);
+
+/**
+ * Word-aligned fill: dst 4-byte aligned, n a multiple of 4.
+ */
+typedef void* (*mimi_set4_fn)(uint32_t* dst, uint8_t val, uint32_t n);
+
+/* Blocks smaller than this stay on the inline paths */
+#define MIMI_MEM_ACCEL_MIN  64
+
+/**
+ * Register platform copy/fill routines.
+ * 
+ * Either may be NULL, in which case the built-in word loops are used.
+ * Safe to call before or after any other mem function.
+ * 
+ * @param copy4     Aligned copy routine, or NULL
+ * @param set4      Aligned fill routine, or NULL
+ */
+void mimi_mem_init(mimi_copy4_fn copy4, mimi_set4_fn set4);
+
+/*============================================================================
+ * Placement
+ *============================================================================*/
+
+/*
+ * Buffers that belong in a scratch bank (MIMI_MEM_SCRATCH in loader.h):
+ * memory of their own, off the striped SRAM payloads load into, and
+ * out of contention with the bulk copies going there. X takes bounce
+ * buffers and the second core's stack; Y is the boot stack's, and the
+ * linker scripts refuse anything placed there that it would overlap.
+ * The sections are not zeroed at startup; a linker script
+ * that does not place them takes them as ordinary .bss.
+ */
+#if defined(__ELF__)
+#define MIMI_SCRATCH_X  __attribute__((section(".bss.scratch_x")))
+#define MIMI_SCRATCH_Y  __attribute__((section(".bss.scratch_y")))
+#else
+#define MIMI_SCRATCH_X
+#define MIMI_SCRATCH_Y
+#endif
+
+/*
+ * Hot-path code: block reads, FAT cluster walks, copies and decoding.
+ * Startup copies it to SRAM along with .data (the SDK's .time_critical
+ * sections), into the loader's own RAM where no payload segment may
+ * load, so the transfer loops never wait on XIP cache misses or share
+ * the flash interface. Cold code (config, mount, ELF parsing) stays in
+ * flash. Calls back into flash go through linker veneers.
+ */
+#if defined(__ELF__) && defined(__arm__)
+#define MIMI_RAMFUNC    __attribute__((section(".time_critical.mimiboot")))
+#else
+#define MIMI_RAMFUNC
+#endif
+
+/*============================================================================
+ * Unaligned Access
+ *============================================================================*/
+
+/*
+ * The Cortex-M33 (RP2350) loads a word from any address in a single
+ * instruction; the M0+ faults. Where the core allows it, copies and
+ * compares between buffers of different alignment, and the software
+ * CRC, move whole words instead of bytes.
+ */
+#if defined(__ARM_FEATURE_UNALIGNED)
+#define MIMI_UNALIGNED_LOADS    1
+
+typedef struct {
+    uint32_t    word;
+} __attribute__((packed, may_alias)) mimi_unaligned_word_t;
+
+/**
+ * Load a little-endian word from any address.
+ */
+static inline uint32_t mimi_load32(const void* p) {
+    return ((const mimi_unaligned_word_t*)p)->word;
+}
+#endif
+
+/*============================================================================
+ * Primitives
+ *============================================================================*/
+
+/**
+ * Copy memory (regions must not overlap).
+ */
+void mimi_memcpy(void* dst, const void* src, uint32_t size);
+
+/**
+ * Fill memory with a byte value.
+ */
+void mimi_memset(void* dst, uint8_t val, uint32_t size);
+
+/**
+ * Compare memory.
+ * 
+ * @return  0 if equal, <0 or >0 by first differing byte
+ */
+int mimi_memcmp(const void* a, const void* b, uint32_t size);
+
+#endif /* MIMIBOOT_MEM_H */
@@ -0,0 +1,77 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * mimg.h - MimiBoot Native Image Format
+ * 
+ * An optional, pre-laid-out alternative to ELF, produced on the host
+ * by mimiboot_image. Everything the loader would otherwise work out
+ * from the ELF at boot is decided when the image is built:
+ * 
+ *     Sector 0    mimg_header_t, then segment_count mimg_segment_t
+ *     Sector 1..  Segment data, each segment starting on a
+ *                 MIMG_ALIGN boundary, in load order
+ * 
+ * Segments are sorted by load address, which is also their file
+ * order, and never overlap; the loader checks this with one
+ * comparison per segment instead of a pairwise search. All data lies
+ * back to back after the header, so the image streams as one
+ * sector-aligned run and every segment read lands straight in place.
+ * 
+ * Segment data is stored as for ELF: raw, or a mimi_lz4_header_t and
+ * LZ4 block with PF_MIMI_LZ4 set (see lz4.h). BSS is the part of each
+ * segment past its initialized bytes. The header carries the image
+ * CRC (see compute_crc in loader.h); the loaded image is checked
+ * against it when boot.cfg asks for a CRC without giving one.
+ */
+
+#ifndef MIMIBOOT_MIMG_H
+#define MIMIBOOT_MIMG_H
+
+#include <stdint.h>
+
+/*============================================================================
+ * Format
+ *============================================================================*/
+
+#define MIMG_MAGIC          0x474D494D  /* "MIMG" */
+#define MIMG_VERSION        1
+
+/* Alignment of segment data in the file (one sector) */
+#define MIMG_ALIGN          512
+
+/* Segments per image: the table must fit in sector 0 with the header */
+#define MIMG_MAX_SEGMENTS   16
+
+/**
+ * Image header, at file offset 0.
+ */
+typedef struct {
+    uint32_t    magic;          /* MIMG_MAGIC */
+    uint16_t    version;        /* MIMG_VERSION */
+    uint16_t    segment_count;  /* Entries in the segment table */
+    uint32_t    entry;          /* Entry point address */
+    uint32_t    load_base;      /* Lowest load address */
+    uint32_t    load_end;       /* Highest load address + 1 */
+    uint32_t    total_size;     /* Sum of segment memsz */
+    uint32_t    image_crc;      /* Image CRC of the decoded segments */
+    uint32_t    header_crc;     /* crc32 of header and table, this field zero */
+} mimg_header_t;
+
+/**
+ * Segment table entry, following the header.
+ */
+typedef struct {
+    uint32_t    offset;         /* File offset of the data, multiple of MIMG_ALIGN */
+    uint32_t    vaddr;          /* Load address */
+    uint32_t    paddr;          /* Physical (LMA) address */
+    uint32_t    filesz;         /* Bytes stored in the file */
+    uint32_t    memsz;          /* Bytes occupied in memory */
+    uint32_t    flags;          /* PF_* (PF_MIMI_LZ4 if compressed) */
+} mimg_segment_t;
+
+_Static_assert(sizeof(mimg_header_t) == 32, "mimg_header_t size mismatch");
+_Static_assert(sizeof(mimg_segment_t) == 24, "mimg_segment_t size mismatch");
+_Static_assert(sizeof(mimg_header_t) + MIMG_MAX_SEGMENTS * sizeof(mimg_segment_t) <= MIMG_ALIGN,
+               "MIMG header and segment table must fit in one sector");
+
+#endif /* MIMIBOOT_MIMG_H */
@@ -0,0 +1,372 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * pipeline.c - Two-Core Load Pipeline
+ * 
+ * Ownership rules (each field has exactly one writer):
+ * 
+ *     core 0   job_head, slot_head, jobs[], slots[] being filled
+ *     core 1   job_tail, slot_tail, error, error_tag, parked
+ * 
+ * A producer fills an entry, then publishes it by advancing its head
+ * with a release store; the consumer acquires the head before reading
+ * the entry and hands it back by advancing its tail the same way.
+ * On Cortex-M0+ this compiles to plain loads/stores plus DMB.
+ */
+
+#include "pipeline.h"
+#include "mem.h"
+#include <stddef.h>
+
+/*============================================================================
+ * Shared State
+ *============================================================================*/
+
+#define PIPE_OP_ZERO        0
+#define PIPE_OP_COPY        1
+#define PIPE_OP_STREAM      2
+#define PIPE_OP_EXIT        3
+
+typedef struct {
+    uint32_t        op;         /* PIPE_OP_* */
+    uint32_t        kind;       /* MIMI_PIPE_* for streams */
+    uint32_t        tag;
+    uint8_t*        dest;
+    const uint8_t*  src;
+    uint32_t        size;       /* Bytes written or compared */
+} pipe_job_t;
+
+typedef struct {
+    uint32_t        start;      /* First payload byte in buf */
+    uint32_t        len;        /* End of valid data in buf */
+    bool            last;       /* Final chunk of its stream */
+    uint8_t         buf[MIMI_PIPE_SLOT_SIZE];
+} pipe_slot_t;
+
+static struct {
+    bool            active;
+    
+    uint32_t        job_head;
+    uint32_t        job_tail;
+    uint32_t        slot_head;
+    uint32_t        slot_tail;
+    
+    mimi_err_t      error;      /* First job error since the last wait */
+    uint32_t        error_tag;
+    uint32_t        parked;     /* Worker has exited */
+    
+    pipe_job_t      jobs[MIMI_PIPE_JOBS];
+    pipe_slot_t     slots[MIMI_PIPE_SLOTS];
+} s_pipe;
+
+static inline uint32_t load_acquire(const uint32_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(uint32_t* p, uint32_t value) {
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+/*============================================================================
+ * Core 1 - Worker
+ *============================================================================*/
+
+/* Stream input of the running job (worker only) */
+static struct {
+    mimi_lz4_stream_t   stream;
+    bool                held;       /* A slot is checked out */
+} s_input;
+
+MIMI_RAMFUNC
+static void pipe_slot_release(void) {
+    if (s_input.held) {
+        s_input.held = false;
+        store_release(&s_pipe.slot_tail, s_pipe.slot_tail + 1);
+    }
+}
+
+/**
+ * Move to the next chunk of the stream (lz4 refill callback).
+ */
+MIMI_RAMFUNC
+static mimi_err_t pipe_slot_next(mimi_lz4_stream_t* stream) {
+    pipe_slot_release();
+    
+    uint32_t tail = s_pipe.slot_tail;
+    while (load_acquire(&s_pipe.slot_head) == tail) {
+        /* Core 0 is still reading */
+    }
+    
+    const pipe_slot_t* slot = &s_pipe.slots[tail % MIMI_PIPE_SLOTS];
+    stream->data = slot->buf;
+    stream->pos = slot->start;
+    stream->len = slot->len;
+    stream->last = slot->last;
+    s_input.held = true;
+    return MIMI_OK;
+}
+
+/**
+ * Consume a stream job's slots, stopping after its last chunk even if
+ * processing ended early.
+ */
+MIMI_RAMFUNC
+static mimi_err_t pipe_run_stream(const pipe_job_t* job) {
+    mimi_lz4_stream_t* in = &s_input.stream;
+    mimi_err_t err = MIMI_OK;
+    
+    in->refill = pipe_slot_next;
+    in->pos = 0;
+    in->len = 0;
+    in->last = false;
+    
+    if (job->kind == MIMI_PIPE_COMPARE) {
+        uint32_t done = 0;
+        do {
+            pipe_slot_next(in);
+            uint32_t chunk = in->len - in->pos;
+            
+            if (err == MIMI_OK &&
+                (chunk > job->size - done ||
+                 mimi_memcmp(job->dest + done, in->data + in->pos, chunk) != 0)) {
+                err = MIMI_ERR_LOAD_FAILED;
+            }
+            done += chunk;
+        } while (!in->last);
+    } else {
+        err = mimi_lz4_decode_stream(in, job->dest, job->size,
+                                     job->kind == MIMI_PIPE_LZ4_VERIFY);
+    }
+    
+    /* Skip whatever the job left unread */
+    while (!s_input.held || !in->last) {
+        pipe_slot_next(in);
+    }
+    pipe_slot_release();
+    
+    return err;
+}
+
+/**
+ * Worker loop. Returns (parked) on the exit job.
+ */
+MIMI_RAMFUNC
+static void pipe_worker(void) {
+    for (;;) {
+        uint32_t tail = s_pipe.job_tail;
+        while (load_acquire(&s_pipe.job_head) == tail) {
+            /* Idle */
+        }
+        
+        const pipe_job_t* job = &s_pipe.jobs[tail % MIMI_PIPE_JOBS];
+        mimi_err_t err = MIMI_OK;
+        
+        switch (job->op) {
+            case PIPE_OP_ZERO:
+                mimi_memset(job->dest, 0, job->size);
+                break;
+            case PIPE_OP_COPY:
+                mimi_memcpy(job->dest, job->src, job->size);
+                break;
+            case PIPE_OP_STREAM:
+                err = pipe_run_stream(job);
+                break;
+            case PIPE_OP_EXIT:
+            default:
+                store_release(&s_pipe.parked, 1);
+                return;
+        }
+        
+        if (err != MIMI_OK && s_pipe.error == MIMI_OK) {
+            s_pipe.error = err;
+            s_pipe.error_tag = job->tag;
+        }
+        
+        store_release(&s_pipe.job_tail, tail + 1);
+    }
+}
+
+/*============================================================================
+ * Core 0 - Producer
+ *============================================================================*/
+
+MIMI_RAMFUNC
+static void pipe_submit(uint32_t op, uint32_t kind, uint32_t tag,
+                        uint8_t* dest, const uint8_t* src, uint32_t size) {
+    uint32_t head = s_pipe.job_head;
+    while (head - load_acquire(&s_pipe.job_tail) >= MIMI_PIPE_JOBS) {
+        /* Queue full */
+    }
+    
+    pipe_job_t* job = &s_pipe.jobs[head % MIMI_PIPE_JOBS];
+    job->op = op;
+    job->kind = kind;
+    job->tag = tag;
+    job->dest = dest;
+    job->src = src;
+    job->size = size;
+    
+    store_release(&s_pipe.job_head, head + 1);
+}
+
+MIMI_RAMFUNC
+static pipe_slot_t* pipe_slot_acquire(void) {
+    uint32_t head = s_pipe.slot_head;
+    while (head - load_acquire(&s_pipe.slot_tail) >= MIMI_PIPE_SLOTS) {
+        /* All chunks in flight */
+    }
+    return &s_pipe.slots[head % MIMI_PIPE_SLOTS];
+}
+
+MIMI_RAMFUNC
+static void pipe_slot_publish(pipe_slot_t* slot, uint32_t len, bool last) {
+    slot->len = len;
+    slot->last = last;
+    store_release(&s_pipe.slot_head, s_pipe.slot_head + 1);
+}
+
+/*============================================================================
+ * Control
+ *============================================================================*/
+
+bool mimi_pipe_start(mimi_core_launch_fn launch) {
+    if (launch == NULL || s_pipe.active) {
+        return s_pipe.active;
+    }
+    
+    mimi_memset(&s_pipe, 0, sizeof(s_pipe));
+    s_pipe.error = MIMI_OK;
+    
+    /* Rings must be visible before the worker starts */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    
+    if (!launch(pipe_worker)) {
+        return false;
+    }
+    
+    s_pipe.active = true;
+    return true;
+}
+
+bool mimi_pipe_active(void) {
+    return s_pipe.active;
+}
+
+MIMI_RAMFUNC
+mimi_err_t mimi_pipe_wait(uint32_t* tag) {
+    if (!s_pipe.active) {
+        return MIMI_OK;
+    }
+    
+    while (load_acquire(&s_pipe.job_tail) != s_pipe.job_head) {
+        /* Worker busy */
+    }
+    
+    /* Worker is idle: error fields are safe to read and reset */
+    mimi_err_t err = s_pipe.error;
+    if (tag != NULL) {
+        *tag = s_pipe.error_tag;
+    }
+    s_pipe.error = MIMI_OK;
+    return err;
+}
+
+void mimi_pipe_stop(void) {
+    if (!s_pipe.active) {
+        return;
+    }
+    
+    mimi_pipe_wait(NULL);
+    pipe_submit(PIPE_OP_EXIT, 0, 0, NULL, NULL, 0);
+    
+    while (load_acquire(&s_pipe.parked) == 0) {
+        /* Worker finishing */
+    }
+    
+    s_pipe.active = false;
+}
+
+/*============================================================================
+ * Jobs
+ *============================================================================*/
+
+MIMI_RAMFUNC
+void mimi_pipe_zero(void* dest, uint32_t size, uint32_t tag) {
+    if (!s_pipe.active) {
+        mimi_memset(dest, 0, size);
+        return;
+    }
+    pipe_submit(PIPE_OP_ZERO, 0, tag, dest, NULL, size);
+}
+
+MIMI_RAMFUNC
+void mimi_pipe_copy(void* dest, const void* src, uint32_t size, uint32_t tag) {
+    if (!s_pipe.active) {
+        mimi_memcpy(dest, src, size);
+        return;
+    }
+    pipe_submit(PIPE_OP_COPY, 0, tag, dest, src, size);
+}
+
+MIMI_RAMFUNC
+mimi_err_t mimi_pipe_stream(
+    const mimi_io_ops_t*    io,
+    mimi_file_t             file,
+    uint32_t                offset,
+    uint32_t                size,
+    uint8_t*                dest,
+    uint32_t                limit,
+    uint32_t                kind,
+    uint32_t                tag,
+    uint32_t*               raw_size
+) {
+    uint32_t remaining = size;
+    uint32_t total = size;
+    bool first = true;
+    
+    if (kind != MIMI_PIPE_COMPARE && size < sizeof(mimi_lz4_header_t)) {
+        return MIMI_ERR_BAD_COMPRESSED;
+    }
+    
+    while (remaining > 0) {
+        pipe_slot_t* slot = pipe_slot_acquire();
+        
+        /* Same chunking as the single-core decoder: sectors read once */
+        uint32_t chunk = MIMI_PIPE_SLOT_SIZE - (offset % MIMI_LZ4_READ_ALIGN);
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        
+        int32_t read_result = io->read(file, offset, slot->buf, chunk);
+        if (read_result < 0 || (uint32_t)read_result != chunk) {
+            if (!first) {
+                /* Let the worker finish the stream it started */
+                slot->start = 0;
+                pipe_slot_publish(slot, 0, true);
+            }
+            return MIMI_ERR_READ;
+        }
+        
+        slot->start = 0;
+        
+        if (first) {
+            if (kind != MIMI_PIPE_COMPARE) {
+                mimi_err_t err = mimi_lz4_read_header(slot->buf, limit, &total);
+                if (err != MIMI_OK) {
+                    return err;
+                }
+                slot->start = sizeof(mimi_lz4_header_t);
+            }
+            
+            pipe_submit(PIPE_OP_STREAM, kind, tag, dest, NULL, total);
+            first = false;
+        }
+        
+        offset += chunk;
+        remaining -= chunk;
+        pipe_slot_publish(slot, chunk, remaining == 0);
+    }
+    
+    *raw_size = total;
+    return MIMI_OK;
+}
@@ -0,0 +1,134 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * pipeline.h - Two-Core Load Pipeline
+ * 
+ * Core 0 keeps the storage device busy while core 1 does the CPU work
+ * behind it: LZ4 decoding, BSS zeroing, copies from flash and
+ * read-back compares. The cores share two single-producer,
+ * single-consumer rings in RAM:
+ * 
+ *     jobs    work items, executed by core 1 in submission order
+ *     slots   file data read by core 0 for streaming jobs
+ * 
+ * Ring indices are free-running counters published with
+ * release/acquire ordering, so no locks or FIFO traffic are needed.
+ * 
+ * Until mimi_pipe_start() succeeds (or on single-core platforms)
+ * mimi_pipe_zero/mimi_pipe_copy run inline and mimi_pipe_active()
+ * is false, so callers keep their existing single-core paths.
+ */
+
+#ifndef MIMIBOOT_PIPELINE_H
+#define MIMIBOOT_PIPELINE_H
+
+#include "loader.h"
+#include "lz4.h"
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+/* File data chunks in flight (triple buffering) */
+#define MIMI_PIPE_SLOTS         3
+
+/* Bytes per chunk - sector multiple, same as the single-core LZ4 input */
+#define MIMI_PIPE_SLOT_SIZE     MIMI_LZ4_INPUT_SIZE
+
+/* Queued jobs */
+#define MIMI_PIPE_JOBS          8
+
+/**
+ * Streaming job kinds for mimi_pipe_stream().
+ */
+#define MIMI_PIPE_LZ4           0   /* Decode LZ4 segment data into dest */
+#define MIMI_PIPE_LZ4_VERIFY    1   /* Decode and compare against dest */
+#define MIMI_PIPE_COMPARE       2   /* Compare raw file data against dest */
+
+/**
+ * Start a function on the second core (see hal_core1_launch).
+ */
+typedef bool (*mimi_core_launch_fn)(void (*entry)(void));
+
+/*============================================================================
+ * Control
+ *============================================================================*/
+
+/**
+ * Start the worker on the second core.
+ * 
+ * @param launch    Platform launch routine, or NULL for none
+ * @return          true if the pipeline is running
+ */
+bool mimi_pipe_start(mimi_core_launch_fn launch);
+
+/**
+ * Check whether jobs go to the second core.
+ */
+bool mimi_pipe_active(void);
+
+/**
+ * Wait until every submitted job has finished.
+ * 
+ * Returns the first job error since the previous wait (later jobs
+ * still run so the rings drain).
+ * 
+ * @param tag       Output: tag of the failed job (may be NULL)
+ * @return          MIMI_OK or the failing job's error
+ */
+mimi_err_t mimi_pipe_wait(uint32_t* tag);
+
+/**
+ * Drain the pipeline and park the worker.
+ * 
+ * The worker stops touching shared memory before this returns; the
+ * caller then resets the core (hal_core1_reset) before handoff.
+ */
+void mimi_pipe_stop(void);
+
+/*============================================================================
+ * Jobs
+ *============================================================================*/
+
+/**
+ * Zero memory (BSS).
+ */
+void mimi_pipe_zero(void* dest, uint32_t size, uint32_t tag);
+
+/**
+ * Copy memory, e.g. .data from its load address in flash.
+ */
+void mimi_pipe_copy(void* dest, const void* src, uint32_t size, uint32_t tag);
+
+/**
+ * Read a range of the file into the slot ring for core 1 to process.
+ * Pipeline must be active. Returns once the last chunk is queued;
+ * processing errors are reported by mimi_pipe_wait().
+ * 
+ * For the LZ4 kinds the segment header is checked here, so the
+ * decoded size is known before core 1 has finished.
+ * 
+ * @param io        I/O operations
+ * @param file      File handle
+ * @param offset    File offset of the data
+ * @param size      Bytes to stream
+ * @param dest      Memory the job writes or compares
+ * @param limit     Maximum decoded size (LZ4 kinds)
+ * @param kind      MIMI_PIPE_*
+ * @param tag       Caller's job tag (segment index)
+ * @param raw_size  Output: decoded size for LZ4 kinds, else size
+ * @return          MIMI_OK, MIMI_ERR_READ or MIMI_ERR_BAD_COMPRESSED
+ */
+mimi_err_t mimi_pipe_stream(
+    const mimi_io_ops_t*    io,
+    mimi_file_t             file,
+    uint32_t                offset,
+    uint32_t                size,
+    uint8_t*                dest,
+    uint32_t                limit,
+    uint32_t                kind,
+    uint32_t                tag,
+    uint32_t*               raw_size
+);
+
+#endif /* MIMIBOOT_PIPELINE_H */
@@ -0,0 +1,112 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * probe.c - Image Probe (validate every candidate before loading one)
+ */
+
+#include "probe.h"
+#include "profile.h"
+
+/*============================================================================
+ * Helper Functions
+ *============================================================================*/
+
+static bool path_equal(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+/*============================================================================
+ * Header I/O (handles are fat32_file_t)
+ *============================================================================*/
+
+static int32_t probe_io_read(mimi_file_t file, uint32_t offset, void* buffer, uint32_t size) {
+    fat32_file_t* f = (fat32_file_t*)file;
+    
+    if (fat32_seek(f, offset) != FAT32_OK) {
+        return -1;
+    }
+    return fat32_read(f, buffer, size);
+}
+
+static int32_t probe_io_size(mimi_file_t file) {
+    return fat32_size((fat32_file_t*)file);
+}
+
+static const mimi_io_ops_t s_probe_io = {
+    .read = probe_io_read,
+    .size = probe_io_size,
+};
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+void mimi_probe_init(mimi_probe_set_t* set) {
+    set->count = 0;
+}
+
+bool mimi_probe_add(mimi_probe_set_t* set, const char* path) {
+    if (path == NULL || path[0] == '\0') {
+        return false;
+    }
+    
+    if (mimi_probe_find(set, path) != NULL) {
+        return true;
+    }
+    
+    if (set->count >= MIMI_PROBE_MAX) {
+        return false;
+    }
+    
+    mimi_probe_t* probe = &set->images[set->count++];
+    probe->path = path;
+    probe->status = MIMI_ERR_NOT_FOUND;
+    return true;
+}
+
+void mimi_probe_run(
+    mimi_probe_set_t*           set,
+    fat32_fs_t*                 fs,
+    const mimi_loader_config_t* config
+) {
+    /* Every lookup first, so they share the directory scans */
+    mimi_profile_begin(MIMI_PHASE_FILE_OPEN);
+    for (uint32_t i = 0; i < set->count; i++) {
+        mimi_probe_t* probe = &set->images[i];
+        
+        fat32_err_t err = fat32_open(fs, probe->path, &probe->file);
+        if (err == FAT32_OK) {
+            probe->status = MIMI_OK;
+        } else {
+            probe->status = (err == FAT32_ERR_IO) ? MIMI_ERR_IO : MIMI_ERR_NOT_FOUND;
+        }
+    }
+    mimi_profile_end(MIMI_PHASE_FILE_OPEN);
+    
+    /* Then the headers, nothing written to the load addresses */
+    mimi_loader_config_t parse_config = *config;
+    parse_config.io = &s_probe_io;
+    
+    mimi_profile_begin(MIMI_PHASE_PARSE);
+    for (uint32_t i = 0; i < set->count; i++) {
+        mimi_probe_t* probe = &set->images[i];
+        
+        if (probe->status == MIMI_OK) {
+            probe->status = mimi_elf_parse(&parse_config, &probe->file, &probe->layout);
+        }
+    }
+    mimi_profile_end(MIMI_PHASE_PARSE);
+}
+
+const mimi_probe_t* mimi_probe_find(const mimi_probe_set_t* set, const char* path) {
+    for (uint32_t i = 0; i < set->count; i++) {
+        if (path_equal(set->images[i].path, path)) {
+            return &set->images[i];
+        }
+    }
+    return NULL;
+}
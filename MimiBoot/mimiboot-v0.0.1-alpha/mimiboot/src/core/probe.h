@@ -0,0 +1,100 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * probe.h - Image Probe (validate every candidate before loading one)
+ * 
+ * Opens each configured image (the boot image, the fallback, boot menu
+ * entries) and parses its ELF header and program headers before any
+ * of them is loaded. All directory lookups are done first, back to
+ * back, so images in the same directory are found by one scan through
+ * the FAT32 directory cache. The results are kept: whichever image is
+ * finally booted, its file handle and validated layout are ready and
+ * loading it costs no further lookups or header reads.
+ * 
+ * A fallback chosen because the primary is missing or invalid is then
+ * exactly as fast to load as the primary would have been.
+ */
+
+#ifndef MIMIBOOT_PROBE_H
+#define MIMIBOOT_PROBE_H
+
+#include "loader.h"
+#include "../fs/fat32.h"
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#ifndef MIMI_PROBE_MAX
+#define MIMI_PROBE_MAX      4       /* Images probed per boot */
+#endif
+
+/*============================================================================
+ * Probe Results
+ *============================================================================*/
+
+/**
+ * One probed image.
+ */
+typedef struct {
+    const char*         path;       /* Image path (not copied) */
+    mimi_err_t          status;     /* MIMI_OK if found and the layout is valid */
+    fat32_file_t        file;       /* Open handle (status not MIMI_ERR_NOT_FOUND) */
+    mimi_elf_layout_t   layout;     /* Validated layout (status MIMI_OK) */
+} mimi_probe_t;
+
+/**
+ * Images probed for one boot.
+ */
+typedef struct {
+    uint32_t            count;
+    mimi_probe_t        images[MIMI_PROBE_MAX];
+} mimi_probe_set_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Start an empty probe set.
+ * 
+ * @param set       Probe set
+ */
+void mimi_probe_init(mimi_probe_set_t* set);
+
+/**
+ * Add an image to probe. Duplicate paths are added once.
+ * 
+ * @param set       Probe set
+ * @param path      Image path, must stay valid while the set is used
+ * @return          true if the path is in the set
+ */
+bool mimi_probe_add(mimi_probe_set_t* set, const char* path);
+
+/**
+ * Open every image in the set, then read and validate their headers.
+ * 
+ * The loader configuration is used for validation (memory regions,
+ * XIP) in place of a load, its I/O operations are not: the probe reads
+ * the fat32_file_t handles itself.
+ * 
+ * @param set       Probe set
+ * @param fs        Mounted filesystem
+ * @param config    Loader configuration the chosen image will load with
+ */
+void mimi_probe_run(
+    mimi_probe_set_t*           set,
+    fat32_fs_t*                 fs,
+    const mimi_loader_config_t* config
+);
+
+/**
+ * Look up a probed image by path.
+ * 
+ * @param set       Probe set after mimi_probe_run
+ * @param path      Image path
+ * @return          Probe result, or NULL if the path was not probed
+ */
+const mimi_probe_t* mimi_probe_find(const mimi_probe_set_t* set, const char* path);
+
+#endif /* MIMIBOOT_PROBE_H */
@@ -0,0 +1,76 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * profile.c - Boot Phase Profiling
+ */
+
+#include "profile.h"
+#include "mem.h"
+#include <stddef.h>
+
+/*============================================================================
+ * Static State
+ *============================================================================*/
+
+static mimi_boot_profile_t* s_profile = NULL;
+static uint32_t (*s_now_us)(void) = NULL;
+
+/* Entry time of the phase currently open in each slot */
+static uint32_t s_phase_entry[MIMI_PHASE_MAX];
+
+/*============================================================================
+ * API
+ *============================================================================*/
+
+void mimi_profile_start(mimi_boot_profile_t* profile, uint32_t (*now_us)(void)) {
+    mimi_memset(profile, 0, sizeof(*profile));
+    profile->magic = MIMI_PROFILE_MAGIC;
+    profile->version = MIMI_PROFILE_VERSION;
+    profile->struct_size = sizeof(mimi_boot_profile_t);
+    profile->phase_count = MIMI_PHASE_COUNT;
+    
+    s_profile = profile;
+    s_now_us = now_us;
+}
+
+uint32_t mimi_profile_now(void) {
+    return (s_now_us != NULL) ? s_now_us() : 0;
+}
+
+void mimi_profile_begin(uint32_t phase) {
+    if (s_profile == NULL || phase >= MIMI_PHASE_MAX) {
+        return;
+    }
+    
+    uint32_t now = s_now_us();
+    s_phase_entry[phase] = now;
+    
+    if (s_profile->phases[phase].start_us == 0) {
+        s_profile->phases[phase].start_us = now;
+    }
+}
+
+void mimi_profile_end(uint32_t phase) {
+    if (s_profile == NULL || phase >= MIMI_PHASE_MAX) {
+        return;
+    }
+    
+    s_profile->phases[phase].duration_us += s_now_us() - s_phase_entry[phase];
+}
+
+void mimi_profile_segment(uint32_t index, uint32_t us) {
+    if (s_profile == NULL) {
+        return;
+    }
+    
+    if (index < MIMI_PROFILE_SEGMENTS) {
+        s_profile->segment_us[index] = us;
+    }
+    if (index + 1 > s_profile->segment_count) {
+        s_profile->segment_count = index + 1;
+    }
+}
+
+mimi_boot_profile_t* mimi_profile_get(void) {
+    return s_profile;
+}
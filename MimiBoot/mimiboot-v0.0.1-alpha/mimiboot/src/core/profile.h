@@ -0,0 +1,51 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * profile.h - Boot Phase Profiling
+ * 
+ * Records per-phase timestamps into a mimi_boot_profile_t that is
+ * handed to the payload. A single profile is active at a time; all
+ * calls are no-ops until mimi_profile_start has been called, so core
+ * modules can be instrumented unconditionally.
+ */
+
+#ifndef MIMIBOOT_PROFILE_H
+#define MIMIBOOT_PROFILE_H
+
+#include <stdint.h>
+#include "../../include/mimiboot/handoff.h"
+
+/**
+ * Start profiling into profile.
+ * 
+ * @param profile   Profile to fill (cleared here)
+ * @param now_us    Microsecond time source
+ */
+void mimi_profile_start(mimi_boot_profile_t* profile, uint32_t (*now_us)(void));
+
+/**
+ * Current time from the profile's time source (0 if inactive).
+ */
+uint32_t mimi_profile_now(void);
+
+/**
+ * Mark entry into a phase (MIMI_PHASE_*).
+ */
+void mimi_profile_begin(uint32_t phase);
+
+/**
+ * Mark exit from a phase; the elapsed time is accumulated.
+ */
+void mimi_profile_end(uint32_t phase);
+
+/**
+ * Record copy time of one segment, in load order.
+ */
+void mimi_profile_segment(uint32_t index, uint32_t us);
+
+/**
+ * Get the active profile (NULL if inactive).
+ */
+mimi_boot_profile_t* mimi_profile_get(void);
+
+#endif /* MIMIBOOT_PROFILE_H */
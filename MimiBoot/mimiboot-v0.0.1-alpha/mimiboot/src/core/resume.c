@@ -0,0 +1,136 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * resume.c - Fast Resume (restart the image already in RAM)
+ */
+
+#include "resume.h"
+#include "crc32.h"
+#include "mem.h"
+
+/*============================================================================
+ * Segment Classes
+ *============================================================================*/
+
+/**
+ * Check whether a segment is rebuilt on resume (writable RAM) rather
+ * than expected to be unchanged.
+ */
+static bool resume_rebuilt(const mimi_seg_desc_t* seg) {
+    return (seg->flags & PF_W) != 0 && seg->source != MIMI_SEG_IN_PLACE;
+}
+
+/**
+ * CRC-32 of every segment that is not rebuilt, in layout order. RAM
+ * segments are covered to memsz, in-place ones to filesz.
+ */
+static uint32_t resume_crc(const mimi_elf_layout_t* layout) {
+    uint32_t crc = 0;
+    
+    for (uint32_t i = 0; i < layout->segment_count; i++) {
+        const mimi_seg_desc_t* seg = &layout->segments[i];
+        
+        if (!resume_rebuilt(seg)) {
+            uint32_t size = (seg->source == MIMI_SEG_IN_PLACE) ? seg->filesz : seg->memsz;
+            crc = mimi_crc32_update(crc, (const void*)(uintptr_t)seg->vaddr, size);
+        }
+    }
+    
+    return crc;
+}
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+bool mimi_resume_supported(const mimi_elf_layout_t* layout) {
+    for (uint32_t i = 0; i < layout->segment_count; i++) {
+        const mimi_seg_desc_t* seg = &layout->segments[i];
+        
+        /* .data from the file (or decoded from it) needs the card */
+        if (resume_rebuilt(seg) && seg->filesz > 0 &&
+            (seg->source != MIMI_SEG_FROM_FLASH || (seg->flags & PF_MIMI_LZ4))) {
+            return false;
+        }
+    }
+    
+    return layout->segment_count > 0;
+}
+
+void mimi_resume_arm(mimi_resume_record_t* record, const mimi_manifest_t* manifest) {
+    record->magic = MIMI_RESUME_MAGIC;
+    record->manifest_crc = manifest->crc32;
+    record->image_crc = resume_crc(&manifest->layout);
+}
+
+mimi_err_t mimi_resume(
+    const mimi_resume_record_t* record,
+    const mimi_manifest_t*      manifest,
+    mimi_load_result_t*         result
+) {
+    const mimi_elf_layout_t* layout = &manifest->layout;
+    
+    if (record->magic != MIMI_RESUME_MAGIC ||
+        record->manifest_crc != manifest->crc32 ||
+        !mimi_resume_supported(layout)) {
+        return MIMI_ERR_STALE;
+    }
+    
+    if (resume_crc(layout) != record->image_crc) {
+        return MIMI_ERR_CRC_MISMATCH;
+    }
+    
+    mimi_memset(result, 0, sizeof(*result));
+    result->entry = layout->entry;
+    result->load_base = layout->load_base;
+    result->load_end = layout->load_end;
+    result->total_size = layout->total_size;
+    
+    for (uint32_t i = 0; i < layout->segment_count; i++) {
+        const mimi_seg_desc_t* seg = &layout->segments[i];
+        mimi_segment_info_t* info = &result->segments[i];
+        
+        info->vaddr = seg->vaddr;
+        info->size = seg->memsz;
+        info->flags = seg->flags;
+        info->loaded = true;
+        
+        if (seg->source == MIMI_SEG_IN_PLACE) {
+            if (result->xip_base == 0 || seg->vaddr < result->xip_base) {
+                result->xip_base = seg->vaddr;
+            }
+            if (seg->vaddr + seg->memsz > result->xip_end) {
+                result->xip_end = seg->vaddr + seg->memsz;
+            }
+            result->bytes_in_place += seg->filesz;
+            info->init_size = seg->filesz;
+            continue;
+        }
+        
+        if (!resume_rebuilt(seg)) {
+            /* Checked above, BSS tail included */
+            info->init_size = seg->memsz;
+            continue;
+        }
+        
+        /* .data again from its LMA, then .bss */
+        mimi_memcpy((void*)(uintptr_t)seg->vaddr, (const void*)(uintptr_t)seg->paddr,
+                    seg->filesz);
+        result->bytes_copied += seg->filesz;
+        info->init_size = seg->filesz;
+        
+        uint32_t bss_size = seg->memsz - seg->filesz;
+        if (bss_size > 0) {
+            if (manifest->config.zero_bss) {
+                mimi_memset((void*)(uintptr_t)(seg->vaddr + seg->filesz), 0, bss_size);
+                result->bytes_zeroed += bss_size;
+            } else {
+                result->bytes_unzeroed += bss_size;
+            }
+        }
+    }
+    
+    result->segment_count = layout->segment_count;
+    result->status = MIMI_OK;
+    return MIMI_OK;
+}
@@ -0,0 +1,86 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * resume.h - Fast Resume (restart the image already in RAM)
+ * 
+ * SRAM keeps its contents across watchdog and software resets, so a
+ * payload that crashes or reboots itself is usually still intact in
+ * memory. Before handing off, the loader arms a small record in the
+ * platform's retained registers: a CRC of every segment the payload
+ * cannot modify, and the CRC of the boot manifest that describes the
+ * layout. On the next soft reset the record, manifest and CRC are
+ * checked and the image is restarted without touching storage.
+ * 
+ * Writable segments are rebuilt rather than trusted: .data is copied
+ * again from its load address in flash and .bss is zeroed again. An
+ * image whose .data comes from the file cannot be rebuilt without the
+ * card and is never armed.
+ * 
+ * Any mismatch (power-on, a payload or the loader's own startup having
+ * written over the image, a manifest from another boot) falls back to
+ * a normal boot.
+ */
+
+#ifndef MIMIBOOT_RESUME_H
+#define MIMIBOOT_RESUME_H
+
+#include "loader.h"
+#include "manifest.h"
+
+/*============================================================================
+ * Record
+ *============================================================================*/
+
+#define MIMI_RESUME_MAGIC       0x4D555352  /* "RSUM" */
+
+/**
+ * Resume record, kept in retained words 0 to MIMI_RESUME_WORDS - 1.
+ */
+typedef struct {
+    uint32_t    magic;          /* MIMI_RESUME_MAGIC, 0 when disarmed */
+    uint32_t    manifest_crc;   /* crc32 of the manifest holding the layout */
+    uint32_t    image_crc;      /* CRC-32 of the segments left in place */
+} mimi_resume_record_t;
+
+#define MIMI_RESUME_WORDS       (sizeof(mimi_resume_record_t) / sizeof(uint32_t))
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Check whether a layout can be restarted from RAM.
+ * 
+ * @param layout    Load layout
+ * @return          true if every writable segment with data is copied
+ *                  from flash (or the segment is BSS only)
+ */
+bool mimi_resume_supported(const mimi_elf_layout_t* layout);
+
+/**
+ * Fill in a record for the image just loaded from a manifest's layout.
+ * 
+ * @param record    Output: armed record
+ * @param manifest  Valid manifest whose layout was loaded
+ */
+void mimi_resume_arm(mimi_resume_record_t* record, const mimi_manifest_t* manifest);
+
+/**
+ * Check an image left in RAM and rebuild its writable segments.
+ * 
+ * Nothing is written unless the record, manifest and CRC all match.
+ * BSS is zeroed again if the manifest's config has zero_bss set.
+ * 
+ * @param record    Record read from the retained words
+ * @param manifest  Valid manifest
+ * @param result    Output: load result as for a normal load (no image CRC)
+ * @return          MIMI_OK, MIMI_ERR_STALE if the record does not belong
+ *                  to this manifest, or MIMI_ERR_CRC_MISMATCH if RAM changed
+ */
+mimi_err_t mimi_resume(
+    const mimi_resume_record_t* record,
+    const mimi_manifest_t*      manifest,
+    mimi_load_result_t*         result
+);
+
+#endif /* MIMIBOOT_RESUME_H */
@@ -0,0 +1,176 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * blkcache.c - Block Cache Between FAT32 and Storage
+ */
+
+#include "blkcache.h"
+#include "../core/mem.h"
+
+/* Unused tag, and no previous request */
+#define BLKCACHE_EMPTY      0xFFFFFFFF
+
+/*============================================================================
+ * Cache Lines
+ *============================================================================*/
+
+/**
+ * Find a cached sector, marking it most recently used.
+ */
+MIMI_RAMFUNC
+static const uint8_t* line_find(blkcache_t* cache, uint32_t sector) {
+    uint32_t set = sector % BLKCACHE_SETS;
+    
+    for (uint32_t way = 0; way < BLKCACHE_WAYS; way++) {
+        if (cache->tag[set][way] == sector) {
+            cache->used[set][way] = ++cache->tick;
+            return cache->data[set][way];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Claim the least recently used line of a sector's set.
+ */
+MIMI_RAMFUNC
+static uint8_t* line_claim(blkcache_t* cache, uint32_t sector, uint32_t* way_out) {
+    uint32_t set = sector % BLKCACHE_SETS;
+    uint32_t victim = 0;
+    
+    for (uint32_t way = 1; way < BLKCACHE_WAYS; way++) {
+        if (cache->used[set][way] < cache->used[set][victim]) {
+            victim = way;
+        }
+    }
+    
+    cache->tag[set][victim] = sector;
+    cache->used[set][victim] = ++cache->tick;
+    *way_out = victim;
+    return cache->data[set][victim];
+}
+
+/*============================================================================
+ * Read-Ahead Window
+ *============================================================================*/
+
+#if BLKCACHE_READAHEAD > 0
+
+/**
+ * Find a sector in the read-ahead window.
+ */
+MIMI_RAMFUNC
+static const uint8_t* ahead_find(const blkcache_t* cache, uint32_t sector) {
+    if (cache->ahead_count == 0 || sector < cache->ahead_start ||
+        sector - cache->ahead_start >= cache->ahead_count) {
+        return NULL;
+    }
+    return cache->ahead[sector - cache->ahead_start];
+}
+
+/**
+ * Refill the window starting at sector.
+ */
+MIMI_RAMFUNC
+static bool ahead_fill(blkcache_t* cache, uint32_t sector) {
+    cache->ahead_count = 0;
+    
+    if (cache->read_sectors(sector, cache->ahead[0], BLKCACHE_READAHEAD) != 0) {
+        return false;
+    }
+    
+    cache->ahead_start = sector;
+    cache->ahead_count = BLKCACHE_READAHEAD;
+    cache->ahead_reads++;
+    return true;
+}
+
+#endif
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+void blkcache_init(
+    blkcache_t* cache,
+    int (*read_sector)(uint32_t, uint8_t*),
+    int (*read_sectors)(uint32_t, uint8_t*, uint32_t)
+) {
+    mimi_memset(cache, 0, sizeof(*cache));
+    cache->read_sector = read_sector;
+    cache->read_sectors = read_sectors;
+    cache->last_sector = BLKCACHE_EMPTY;
+    
+    for (uint32_t set = 0; set < BLKCACHE_SETS; set++) {
+        for (uint32_t way = 0; way < BLKCACHE_WAYS; way++) {
+            cache->tag[set][way] = BLKCACHE_EMPTY;
+        }
+    }
+}
+
+MIMI_RAMFUNC
+int blkcache_read(blkcache_t* cache, uint32_t sector, uint8_t* buffer) {
+    if (cache->last_sector != BLKCACHE_EMPTY && sector == cache->last_sector + 1) {
+        cache->run++;
+    } else {
+        cache->run = 0;
+    }
+    cache->last_sector = sector;
+    
+    const uint8_t* data = line_find(cache, sector);
+    if (data != NULL) {
+        cache->hits++;
+        mimi_memcpy(buffer, data, 512);
+        return 0;
+    }
+    
+    uint32_t way;
+    uint8_t* line;
+
+#if BLKCACHE_READAHEAD > 0
+    data = ahead_find(cache, sector);
+    if (data != NULL) {
+        cache->hits++;
+        line = line_claim(cache, sector, &way);
+        mimi_memcpy(line, data, 512);
+        mimi_memcpy(buffer, data, 512);
+        return 0;
+    }
+#endif
+    
+    cache->misses++;
+
+#if BLKCACHE_READAHEAD > 0
+    /* Far enough into a forward walk: assume it continues */
+    if (cache->run >= BLKCACHE_STREAM && cache->read_sectors != NULL &&
+        ahead_fill(cache, sector)) {
+        line = line_claim(cache, sector, &way);
+        mimi_memcpy(line, cache->ahead[0], 512);
+        mimi_memcpy(buffer, cache->ahead[0], 512);
+        return 0;
+    }
+#endif
+    
+    line = line_claim(cache, sector, &way);
+    if (cache->read_sector(sector, line) != 0) {
+        cache->tag[sector % BLKCACHE_SETS][way] = BLKCACHE_EMPTY;
+        return -1;
+    }
+    
+    mimi_memcpy(buffer, line, 512);
+    return 0;
+}
+
+MIMI_RAMFUNC
+int blkcache_read_run(blkcache_t* cache, uint32_t sector, uint8_t* buffer, uint32_t count) {
+    if (cache->read_sectors != NULL) {
+        return cache->read_sectors(sector, buffer, count);
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (cache->read_sector(sector + i, buffer + (i * 512)) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
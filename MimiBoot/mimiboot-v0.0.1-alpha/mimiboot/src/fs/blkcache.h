@@ -0,0 +1,119 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * blkcache.h - Block Cache Between FAT32 and Storage
+ * 
+ * Small set-associative cache for single-sector reads (boot sector,
+ * FAT and directory sectors, the ELF header and partial sectors at
+ * segment boundaries), shared by everything above it so no layer
+ * fetches the same sector twice.
+ * 
+ * When single-sector reads walk forward through consecutive sectors
+ * (a long FAT chain, a file of one-sector clusters), the next
+ * BLKCACHE_READAHEAD sectors are fetched with one multi-block read.
+ * A short pair such as the ELF header and program headers does not
+ * count: their file data follows as a bulk read of its own.
+ * 
+ * Multi-sector reads are bulk file data headed for its load address
+ * and pass straight through.
+ */
+
+#ifndef MIMIBOOT_BLKCACHE_H
+#define MIMIBOOT_BLKCACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#ifndef BLKCACHE_SETS
+#define BLKCACHE_SETS       2       /* Sets, indexed by sector number */
+#endif
+
+#ifndef BLKCACHE_WAYS
+#define BLKCACHE_WAYS       2       /* Sectors per set (LRU replacement) */
+#endif
+
+#ifndef BLKCACHE_READAHEAD
+#define BLKCACHE_READAHEAD  4       /* Sectors fetched ahead of a sequential walk (0 = off) */
+#endif
+
+#ifndef BLKCACHE_STREAM
+#define BLKCACHE_STREAM     2       /* Consecutive steps that count as a sequential walk */
+#endif
+
+/*============================================================================
+ * Cache Context
+ *============================================================================*/
+
+typedef struct {
+    /* Storage callbacks */
+    int (*read_sector)(uint32_t sector, uint8_t* buffer);
+    int (*read_sectors)(uint32_t sector, uint8_t* buffer, uint32_t count);  /* Optional */
+    
+    /* Cached sectors */
+    uint32_t tag[BLKCACHE_SETS][BLKCACHE_WAYS];     /* Sector held, or empty */
+    uint32_t used[BLKCACHE_SETS][BLKCACHE_WAYS];    /* Access tick, for LRU */
+    uint8_t  data[BLKCACHE_SETS][BLKCACHE_WAYS][512];
+    uint32_t tick;
+    
+    /* Read-ahead window */
+    uint32_t last_sector;           /* Previous single-sector request */
+    uint32_t run;                   /* Consecutive steps of +1 ending at last_sector */
+    uint32_t ahead_start;           /* First sector in the window */
+    uint32_t ahead_count;           /* Sectors in the window (0 if empty) */
+#if BLKCACHE_READAHEAD > 0
+    uint8_t  ahead[BLKCACHE_READAHEAD][512];
+#endif
+    
+    /* Statistics */
+    uint32_t hits;                  /* Reads served from the cache or window */
+    uint32_t misses;                /* Reads that went to storage */
+    uint32_t ahead_reads;           /* Read-ahead transfers issued */
+
+} blkcache_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Initialize an empty cache.
+ * 
+ * @param cache         Cache context
+ * @param read_sector   Callback to read one 512-byte sector
+ * @param read_sectors  Callback to read consecutive sectors, or NULL
+ *                      (no read-ahead, bulk reads go sector by sector)
+ */
+void blkcache_init(
+    blkcache_t* cache,
+    int (*read_sector)(uint32_t, uint8_t*),
+    int (*read_sectors)(uint32_t, uint8_t*, uint32_t)
+);
+
+/**
+ * Read one sector through the cache.
+ * 
+ * @param cache     Cache context
+ * @param sector    Sector number
+ * @param buffer    Destination (512 bytes)
+ * @return          0 on success, negative on error
+ */
+int blkcache_read(blkcache_t* cache, uint32_t sector, uint8_t* buffer);
+
+/**
+ * Read consecutive sectors straight from storage into buffer.
+ * 
+ * Not cached: used for file data read into its final location.
+ * 
+ * @param cache     Cache context
+ * @param sector    First sector
+ * @param buffer    Destination (count * 512 bytes)
+ * @param count     Number of sectors
+ * @return          0 on success, negative on error
+ */
+int blkcache_read_run(blkcache_t* cache, uint32_t sector, uint8_t* buffer, uint32_t count);
+
+#endif /* MIMIBOOT_BLKCACHE_H */
@@ -7,6 +7,7 @@
  */
 
 #include "fat32.h"
+#include "../core/mem.h"
 #include <stddef.h>
 
 /*============================================================================
@@ -22,6 +23,7 @@
 #define BPB_TOT_SEC_32          32
 #define BPB_FAT_SZ_32           36
 #define BPB_ROOT_CLUS           44
+#define BPB_VOL_ID              67
 #define BPB_FS_TYPE             82
 
 /* Directory entry offsets */
@@ -53,6 +55,9 @@
 #define FAT32_EOC               0x0FFFFFF8
 #define FAT32_BAD               0x0FFFFFF7
 
+/* Unused FAT cache slot */
+#define FAT_CACHE_EMPTY         0xFFFFFFFF
+
 /*============================================================================
  * Internal Helpers - No libc dependency
  *============================================================================*/
@@ -84,10 +89,6 @@ static char to_upper(char c) {
     return c;
 }
 
-static void mem_zero(void* p, uint32_t size) {
-    uint8_t* d = (uint8_t*)p;
-    while (size--) *d++ = 0;
-}
 
 /*============================================================================
  * Cluster Operations
@@ -96,22 +97,50 @@ static void mem_zero(void* p, uint32_t size) {
 /**
  * Convert cluster number to first sector of that cluster.
  */
+MIMI_RAMFUNC
 static uint32_t cluster_to_sector(fat32_fs_t* fs, uint32_t cluster) {
     return fs->data_start + (cluster - 2) * fs->sectors_per_cluster;
 }
 
+/**
+ * Get a FAT sector through the per-filesystem cache.
+ * Returns NULL on read failure.
+ */
+MIMI_RAMFUNC
+static const uint8_t* fat_cached_sector(fat32_fs_t* fs, uint32_t sector) {
+    for (uint32_t i = 0; i < FAT32_FAT_CACHE; i++) {
+        if (fs->fat_cache_sector[i] == sector) {
+            return fs->fat_cache[i];
+        }
+    }
+    
+    uint32_t slot = fs->fat_cache_next;
+    fs->fat_cache_next = (slot + 1) % FAT32_FAT_CACHE;
+    fs->fat_reads++;
+    
+    if (fs->read_sector(sector, fs->fat_cache[slot]) != 0) {
+        fs->fat_cache_sector[slot] = FAT_CACHE_EMPTY;
+        return NULL;
+    }
+    
+    fs->fat_cache_sector[slot] = sector;
+    return fs->fat_cache[slot];
+}
+
 /**
  * Read next cluster number from FAT.
  */
+MIMI_RAMFUNC
 static uint32_t fat_next_cluster(fat32_fs_t* fs, uint32_t cluster) {
-    uint8_t buffer[512];
-    
     /* Calculate FAT sector and offset */
     uint32_t fat_offset = cluster * 4;
     uint32_t fat_sector = fs->fat_start + (fat_offset / 512);
     uint32_t entry_offset = fat_offset % 512;
     
-    if (fs->read_sector(fat_sector, buffer) != 0) {
+    fs->fat_lookups++;
+    
+    const uint8_t* buffer = fat_cached_sector(fs, fat_sector);
+    if (buffer == NULL) {
         return FAT32_EOC;
     }
     
@@ -122,47 +151,113 @@ static uint32_t fat_next_cluster(fat32_fs_t* fs, uint32_t cluster) {
 /**
  * Check if cluster number indicates end of chain.
  */
+MIMI_RAMFUNC
 static bool is_eoc(uint32_t cluster) {
     return cluster >= FAT32_EOC || cluster < 2;
 }
 
+/**
+ * Read consecutive sectors, using the multi-sector callback if available.
+ */
+MIMI_RAMFUNC
+static int read_run(fat32_fs_t* fs, uint32_t sector, uint8_t* buffer, uint32_t count) {
+    if (fs->read_sectors != NULL && count > 1) {
+        return fs->read_sectors(sector, buffer, count);
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (fs->read_sector(sector + i, buffer + (i * 512)) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 /*============================================================================
- * Mount
+ * Cluster Map
  *============================================================================*/
 
-fat32_err_t fat32_mount(fat32_fs_t* fs, int (*read_sector)(uint32_t, uint8_t*)) {
-    uint8_t buffer[512];
-    
-    mem_zero(fs, sizeof(fat32_fs_t));
-    fs->read_sector = read_sector;
+/**
+ * Build the file's extent list by walking its cluster chain once.
+ */
+static void build_cluster_map(fat32_file_t* file) {
+    fat32_fs_t* fs = file->fs;
+    uint32_t cluster = file->start_cluster;
     
-    /* Read MBR to find partition */
-    if (read_sector(0, buffer) != 0) {
-        return FAT32_ERR_IO;
+    /* Files stop at their size; directories run to end of chain */
+    uint32_t limit = 0xFFFFFFFF;
+    if (!(file->attr & FAT32_ATTR_DIRECTORY)) {
+        limit = (file->file_size + fs->cluster_size - 1) / fs->cluster_size;
     }
     
-    /* Check for MBR signature */
-    if (buffer[510] != 0x55 || buffer[511] != 0xAA) {
-        return FAT32_ERR_NOT_FAT32;
-    }
+    file->extent_count = 0;
+    file->extents_complete = false;
     
-    /* Check partition table entry 0 */
-    /* Partition entry at offset 446, type at +4, LBA start at +8 */
-    uint8_t part_type = buffer[446 + 4];
-    uint32_t part_start = read_u32(&buffer[446 + 8]);
+    uint32_t mapped = 0;
+    while (cluster >= 2 && !is_eoc(cluster) && mapped < limit) {
+        fat32_extent_t* ext = NULL;
+        if (file->extent_count > 0) {
+            ext = &file->extents[file->extent_count - 1];
+        }
+        
+        if (ext != NULL && cluster == ext->start + ext->count) {
+            ext->count++;
+        } else if (file->extent_count < FAT32_MAX_EXTENTS) {
+            ext = &file->extents[file->extent_count++];
+            ext->start = cluster;
+            ext->count = 1;
+        } else {
+            /* Out of extents - remainder resolved through the FAT */
+            return;
+        }
+        
+        mapped++;
+        if (mapped < limit) {
+            cluster = fat_next_cluster(fs, cluster);
+        }
+    }
     
-    if (part_type == 0x0B || part_type == 0x0C) {
-        /* FAT32 partition */
-        fs->partition_start = part_start;
-    } else if (buffer[0] == 0xEB || buffer[0] == 0xE9) {
-        /* No MBR, boot sector is at sector 0 (superfloppy) */
-        fs->partition_start = 0;
-    } else {
-        return FAT32_ERR_NOT_FAT32;
+    file->extents_complete = true;
+}
+
+/**
+ * Next cluster in a file's chain, from the cluster map when possible.
+ */
+MIMI_RAMFUNC
+static uint32_t file_next_cluster(fat32_file_t* file, uint32_t cluster) {
+    for (uint32_t i = 0; i < file->extent_count; i++) {
+        const fat32_extent_t* ext = &file->extents[i];
+        
+        if (cluster < ext->start || cluster >= ext->start + ext->count) {
+            continue;
+        }
+        
+        if (cluster + 1 < ext->start + ext->count) {
+            return cluster + 1;
+        }
+        if (i + 1 < file->extent_count) {
+            return file->extents[i + 1].start;
+        }
+        if (file->extents_complete) {
+            return FAT32_EOC;
+        }
+        break;
     }
     
-    /* Read boot sector */
-    if (read_sector(fs->partition_start, buffer) != 0) {
+    return fat_next_cluster(file->fs, cluster);
+}
+
+/*============================================================================
+ * Mount
+ *============================================================================*/
+
+/**
+ * Read and parse the boot sector at fs->partition_start.
+ */
+static fat32_err_t read_boot_sector(fat32_fs_t* fs) {
+    uint8_t buffer[512];
+    
+    if (fs->read_sector(fs->partition_start, buffer) != 0) {
         return FAT32_ERR_IO;
     }
     
@@ -178,6 +273,7 @@ fat32_err_t fat32_mount(fat32_fs_t* fs, int (*read_sector)(uint32_t, uint8_t*))
     fs->fat_count = buffer[BPB_NUM_FATS];
     fs->sectors_per_fat = read_u32(&buffer[BPB_FAT_SZ_32]);
     fs->root_cluster = read_u32(&buffer[BPB_ROOT_CLUS]);
+    fs->volume_id = read_u32(&buffer[BPB_VOL_ID]);
     
     uint32_t tot_sec_16 = read_u16(&buffer[BPB_TOT_SEC_16]);
     fs->total_sectors = (tot_sec_16 != 0) ? tot_sec_16 : read_u32(&buffer[BPB_TOT_SEC_32]);
@@ -195,6 +291,82 @@ fat32_err_t fat32_mount(fat32_fs_t* fs, int (*read_sector)(uint32_t, uint8_t*))
     return FAT32_OK;
 }
 
+static void mount_init(fat32_fs_t* fs, int (*read_sector)(uint32_t, uint8_t*)) {
+    mimi_memset(fs, 0, sizeof(fat32_fs_t));
+    fs->read_sector = read_sector;
+    
+    for (uint32_t i = 0; i < FAT32_FAT_CACHE; i++) {
+        fs->fat_cache_sector[i] = FAT_CACHE_EMPTY;
+    }
+}
+
+fat32_err_t fat32_mount(fat32_fs_t* fs, int (*read_sector)(uint32_t, uint8_t*)) {
+    uint8_t buffer[512];
+    
+    mount_init(fs, read_sector);
+    
+    /* Read MBR to find partition */
+    if (read_sector(0, buffer) != 0) {
+        return FAT32_ERR_IO;
+    }
+    
+    /* Check for MBR signature */
+    if (buffer[510] != 0x55 || buffer[511] != 0xAA) {
+        return FAT32_ERR_NOT_FAT32;
+    }
+    
+    /* Check partition table entry 0 */
+    /* Partition entry at offset 446, type at +4, LBA start at +8 */
+    uint8_t part_type = buffer[446 + 4];
+    uint32_t part_start = read_u32(&buffer[446 + 8]);
+    
+    if (part_type == 0x0B || part_type == 0x0C) {
+        /* FAT32 partition */
+        fs->partition_start = part_start;
+    } else if (buffer[0] == 0xEB || buffer[0] == 0xE9) {
+        /* No MBR, boot sector is at sector 0 (superfloppy) */
+        fs->partition_start = 0;
+    } else {
+        return FAT32_ERR_NOT_FAT32;
+    }
+    
+    return read_boot_sector(fs);
+}
+
+void fat32_get_volume(const fat32_fs_t* fs, fat32_volume_t* vol) {
+    vol->partition_start = fs->partition_start;
+    vol->sectors_per_cluster = fs->sectors_per_cluster;
+    vol->reserved_sectors = fs->reserved_sectors;
+    vol->fat_count = fs->fat_count;
+    vol->sectors_per_fat = fs->sectors_per_fat;
+    vol->root_cluster = fs->root_cluster;
+    vol->total_sectors = fs->total_sectors;
+    vol->volume_id = fs->volume_id;
+}
+
+fat32_err_t fat32_remount(fat32_fs_t* fs, const fat32_volume_t* vol,
+                          int (*read_sector)(uint32_t, uint8_t*)) {
+    mount_init(fs, read_sector);
+    fs->partition_start = vol->partition_start;
+    
+    fat32_err_t err = read_boot_sector(fs);
+    if (err != FAT32_OK) {
+        return err;
+    }
+    
+    fat32_volume_t now;
+    fat32_get_volume(fs, &now);
+    if (mimi_memcmp(&now, vol, sizeof(now)) != 0) {
+        return FAT32_ERR_INVALID;
+    }
+    
+    return FAT32_OK;
+}
+
+void fat32_set_multi_read(fat32_fs_t* fs, int (*read_sectors)(uint32_t, uint8_t*, uint32_t)) {
+    fs->read_sectors = read_sectors;
+}
+
 /*============================================================================
  * Directory Operations
  *============================================================================*/
@@ -235,9 +407,156 @@ static bool name_match(const char* name, const char* pattern) {
     return *name == *pattern;
 }
 
+/**
+ * Record where a short entry lives and what it holds.
+ */
+static void make_stamp(uint32_t sector, uint32_t offset, const uint8_t* entry,
+                       fat32_stamp_t* stamp) {
+    stamp->sector = sector;
+    stamp->offset = offset;
+    mimi_memcpy(stamp->entry, entry, 32);
+    
+    /* Updated by some hosts on every read */
+    stamp->entry[DIR_LST_ACC_DATE] = 0;
+    stamp->entry[DIR_LST_ACC_DATE + 1] = 0;
+}
+
+/**
+ * Fill a directory entry result from a short entry.
+ */
+static void dirent_from_stamp(const fat32_stamp_t* stamp, const char* name,
+                              fat32_dirent_t* out) {
+    const uint8_t* entry = stamp->entry;
+    
+    out->stamp = *stamp;
+    out->size = read_u32(&entry[DIR_FILE_SIZE]);
+    out->cluster = ((uint32_t)read_u16(&entry[DIR_FST_CLUS_HI]) << 16) |
+                   read_u16(&entry[DIR_FST_CLUS_LO]);
+    out->attr = entry[DIR_ATTR];
+    out->is_dir = (out->attr & FAT32_ATTR_DIRECTORY) != 0;
+    
+    int len = str_len(name);
+    for (int i = 0; i <= len; i++) {
+        out->name[i] = name[i];
+    }
+}
+
+/*============================================================================
+ * Directory Cache
+ *============================================================================*/
+
+/**
+ * Hash a name case-insensitively, two independent ways. Both must
+ * match for a cache hit, so a false hit needs a 64-bit collision
+ * within one directory.
+ */
+static void name_hash(const char* name, uint32_t* hash, uint32_t* check) {
+    uint32_t fnv = 2166136261u;
+    uint32_t djb = 5381;
+    
+    for (; *name; name++) {
+        uint8_t c = (uint8_t)to_upper(*name);
+        fnv = (fnv ^ c) * 16777619u;
+        djb = (djb * 33) ^ c;
+    }
+    
+    *hash = fnv;
+    *check = djb;
+}
+
+/**
+ * Look a name up in the cache.
+ */
+static fat32_dir_cache_t* dir_cache_find(
+    fat32_fs_t* fs,
+    uint32_t dir_cluster,
+    uint32_t hash,
+    uint32_t check
+) {
+    for (uint32_t i = 0; i < FAT32_DIR_CACHE; i++) {
+        fat32_dir_cache_t* c = &fs->dir_cache[i];
+        if (c->hash == hash && c->check == check && c->dir_cluster == dir_cluster) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Remember an entry seen while scanning dir_cluster. Entries that
+ * were looked up are only replaced once nothing else is left, so a
+ * scan past many files does not flush the path being opened.
+ */
+static void dir_cache_insert(
+    fat32_fs_t* fs,
+    uint32_t dir_cluster,
+    const char* name,
+    const fat32_stamp_t* stamp,
+    bool looked_up
+) {
+    uint32_t hash, check;
+    name_hash(name, &hash, &check);
+    
+    fat32_dir_cache_t* c = dir_cache_find(fs, dir_cluster, hash, check);
+    if (c != NULL) {
+        c->looked_up |= looked_up;
+        return;
+    }
+    
+    uint32_t slot = fs->dir_cache_next;
+    for (uint32_t i = 0; i < FAT32_DIR_CACHE; i++) {
+        uint32_t candidate = (fs->dir_cache_next + i) % FAT32_DIR_CACHE;
+        if (!fs->dir_cache[candidate].looked_up) {
+            slot = candidate;
+            break;
+        }
+    }
+    
+    c = &fs->dir_cache[slot];
+    fs->dir_cache_next = (slot + 1) % FAT32_DIR_CACHE;
+    
+    /* Evicting part of a complete directory makes it incomplete */
+    if (c->dir_cluster != 0 && c->dir_cluster == fs->dir_complete) {
+        fs->dir_complete = 0;
+    }
+    
+    c->dir_cluster = dir_cluster;
+    c->hash = hash;
+    c->check = check;
+    c->looked_up = looked_up;
+    c->stamp = *stamp;
+}
+
+/**
+ * A scan reached the end of dir_cluster. If every regular entry it
+ * passed is still cached, later misses there need no scan.
+ */
+static void dir_cache_scanned(fat32_fs_t* fs, uint32_t dir_cluster, uint32_t entries) {
+    uint32_t cached = 0;
+    
+    for (uint32_t i = 0; i < FAT32_DIR_CACHE; i++) {
+        if (fs->dir_cache[i].dir_cluster == dir_cluster) {
+            cached++;
+        }
+    }
+    
+    if (cached == entries) {
+        fs->dir_complete = dir_cluster;
+    }
+}
+
+/*============================================================================
+ * Directory Scan
+ *============================================================================*/
+
 /**
  * Search directory for entry by name.
- * Returns cluster of found entry, or 0 if not found.
+ * 
+ * Answered from the directory cache when possible. Otherwise the
+ * directory is scanned from the start, remembering every entry
+ * passed; each read fetches twice as many sectors as the previous
+ * one (up to FAT32_DIR_BATCH, within the cluster), so small
+ * directories cost one sector and large ones few transfers.
  */
 static fat32_err_t find_in_dir(
     fat32_fs_t* fs,
@@ -245,29 +564,56 @@ static fat32_err_t find_in_dir(
     const char* name,
     fat32_dirent_t* out
 ) {
-    uint8_t buffer[512];
+    uint32_t hash, check;
+    name_hash(name, &hash, &check);
+    
+    fat32_dir_cache_t* hit = dir_cache_find(fs, dir_cluster, hash, check);
+    if (hit != NULL) {
+        hit->looked_up = true;
+        fs->dir_hits++;
+        dirent_from_stamp(&hit->stamp, name, out);
+        return FAT32_OK;
+    }
+    if (fs->dir_complete == dir_cluster) {
+        fs->dir_hits++;
+        return FAT32_ERR_NOT_FOUND;
+    }
+    
     char entry_name[FAT32_MAX_NAME];
     char lfn_buffer[FAT32_MAX_NAME];
-    int lfn_index = 0;
     bool lfn_valid = false;
+    uint32_t entries = 0;
+    uint32_t batch = 1;
     
-    mem_zero(lfn_buffer, sizeof(lfn_buffer));
+    mimi_memset(lfn_buffer, 0, sizeof(lfn_buffer));
     
     uint32_t cluster = dir_cluster;
     
     while (!is_eoc(cluster)) {
         uint32_t sector = cluster_to_sector(fs, cluster);
+        uint32_t count;
         
-        for (uint32_t s = 0; s < fs->sectors_per_cluster; s++) {
-            if (fs->read_sector(sector + s, buffer) != 0) {
+        for (uint32_t s = 0; s < fs->sectors_per_cluster; s += count) {
+            count = fs->sectors_per_cluster - s;
+            if (count > batch) {
+                count = batch;
+            }
+            
+            if (read_run(fs, sector + s, fs->dir_buf, count) != 0) {
                 return FAT32_ERR_IO;
             }
+            fs->dir_reads += count;
             
-            for (int e = 0; e < 16; e++) {
-                uint8_t* entry = &buffer[e * 32];
+            if (batch < FAT32_DIR_BATCH) {
+                batch *= 2;
+            }
+            
+            for (uint32_t e = 0; e < count * 16; e++) {
+                uint8_t* entry = &fs->dir_buf[e * 32];
                 
                 /* Check for end of directory */
                 if (entry[0] == 0x00) {
+                    dir_cache_scanned(fs, dir_cluster, entries);
                     return FAT32_ERR_NOT_FOUND;
                 }
                 
@@ -285,7 +631,7 @@ static fat32_err_t find_in_dir(
                     
                     if (ord & LFN_LAST_ENTRY) {
                         /* Start of LFN sequence */
-                        mem_zero(lfn_buffer, sizeof(lfn_buffer));
+                        mimi_memset(lfn_buffer, 0, sizeof(lfn_buffer));
                         lfn_valid = true;
                     }
                     
@@ -331,19 +677,16 @@ static fat32_err_t find_in_dir(
                 
                 lfn_valid = false;
                 
+                fat32_stamp_t stamp;
+                make_stamp(sector + s + e / 16, (e % 16) * 32, entry, &stamp);
+                
+                bool match = name_match(entry_name, name);
+                dir_cache_insert(fs, dir_cluster, entry_name, &stamp, match);
+                entries++;
+                
                 /* Check for match */
-                if (name_match(entry_name, name)) {
-                    out->size = read_u32(&entry[DIR_FILE_SIZE]);
-                    out->cluster = ((uint32_t)read_u16(&entry[DIR_FST_CLUS_HI]) << 16) |
-                                   read_u16(&entry[DIR_FST_CLUS_LO]);
-                    out->attr = attr;
-                    out->is_dir = (attr & FAT32_ATTR_DIRECTORY) != 0;
-                    
-                    int len = str_len(entry_name);
-                    for (int i = 0; i <= len; i++) {
-                        out->name[i] = entry_name[i];
-                    }
-                    
+                if (match) {
+                    dirent_from_stamp(&stamp, entry_name, out);
                     return FAT32_OK;
                 }
             }
@@ -352,6 +695,7 @@ static fat32_err_t find_in_dir(
         cluster = fat_next_cluster(fs, cluster);
     }
     
+    dir_cache_scanned(fs, dir_cluster, entries);
     return FAT32_ERR_NOT_FOUND;
 }
 
@@ -363,7 +707,7 @@ fat32_err_t fat32_open(fat32_fs_t* fs, const char* path, fat32_file_t* file) {
     fat32_dirent_t dirent;
     uint32_t current_cluster = fs->root_cluster;
     
-    mem_zero(file, sizeof(fat32_file_t));
+    mimi_memset(file, 0, sizeof(fat32_file_t));
     
     /* Skip leading slash */
     if (*path == '/') path++;
@@ -376,6 +720,7 @@ fat32_err_t fat32_open(fat32_fs_t* fs, const char* path, fat32_file_t* file) {
         file->file_size = 0;
         file->position = 0;
         file->attr = FAT32_ATTR_DIRECTORY;
+        build_cluster_map(file);
         return FAT32_OK;
     }
     
@@ -414,10 +759,50 @@ fat32_err_t fat32_open(fat32_fs_t* fs, const char* path, fat32_file_t* file) {
     file->file_size = dirent.size;
     file->position = 0;
     file->attr = dirent.attr;
+    file->stamp = dirent.stamp;
+    
+    build_cluster_map(file);
+    
+    return FAT32_OK;
+}
+
+fat32_err_t fat32_check_stamps(fat32_fs_t* fs, const fat32_stamp_t* stamps, uint32_t count) {
+    uint8_t buffer[512];
+    uint32_t loaded = 0;
+    bool have = false;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const fat32_stamp_t* stamp = &stamps[i];
+        fat32_stamp_t now;
+        
+        if (stamp->sector == 0 || stamp->offset > 512 - 32) {
+            return FAT32_ERR_INVALID;
+        }
+        
+        if (!have || stamp->sector != loaded) {
+            if (fs->read_sector(stamp->sector, buffer) != 0) {
+                return FAT32_ERR_IO;
+            }
+            loaded = stamp->sector;
+            have = true;
+        }
+        
+        make_stamp(stamp->sector, stamp->offset, &buffer[stamp->offset], &now);
+        if (mimi_memcmp(&now, stamp, sizeof(now)) != 0) {
+            return FAT32_ERR_INVALID;
+        }
+    }
     
     return FAT32_OK;
 }
 
+void fat32_reopen(fat32_fs_t* fs, fat32_file_t* file) {
+    file->fs = fs;
+    file->current_cluster = file->start_cluster;
+    file->position = 0;
+}
+
+MIMI_RAMFUNC
 int32_t fat32_read(fat32_file_t* file, void* buffer, uint32_t size) {
     uint8_t sector_buf[512];
     uint8_t* out = (uint8_t*)buffer;
@@ -443,29 +828,69 @@ int32_t fat32_read(fat32_file_t* file, void* buffer, uint32_t size) {
         uint32_t cluster_offset = file->position % fs->cluster_size;
         uint32_t sector_in_cluster = cluster_offset / 512;
         uint32_t offset_in_sector = cluster_offset % 512;
-        
-        /* Read sector */
         uint32_t sector = cluster_to_sector(fs, file->current_cluster) + sector_in_cluster;
+        
+        if (offset_in_sector == 0 && (size - bytes_read) >= 512) {
+            /*
+             * Whole sectors - read straight into the caller's buffer.
+             * Extend the run across physically contiguous clusters so
+             * the storage layer can stream it with one multi-block read.
+             */
+            uint32_t want = (size - bytes_read) / 512;
+            uint32_t run = fs->sectors_per_cluster - sector_in_cluster;
+            uint32_t run_end = file->current_cluster;   /* Last cluster in run */
+            uint32_t after = 0;                         /* Cluster following run_end */
+            
+            if (fs->read_sectors != NULL) {
+                while (run < want) {
+                    after = file_next_cluster(file, run_end);
+                    if (after != run_end + 1) {
+                        break;
+                    }
+                    run_end = after;
+                    after = 0;
+                    run += fs->sectors_per_cluster;
+                }
+            }
+            
+            if (run > want) {
+                run = want;
+            }
+            
+            if (read_run(fs, sector, out + bytes_read, run) != 0) {
+                return (bytes_read > 0) ? (int32_t)bytes_read : FAT32_ERR_IO;
+            }
+            
+            bytes_read += run * 512;
+            file->position += run * 512;
+            
+            /* Leave current_cluster at the cluster holding the new position */
+            if ((file->position % fs->cluster_size) == 0) {
+                file->current_cluster = (after != 0) ? after : file_next_cluster(file, run_end);
+            } else {
+                file->current_cluster = run_end;
+            }
+            continue;
+        }
+        
+        /* Partial sector - bounce through sector buffer */
         if (fs->read_sector(sector, sector_buf) != 0) {
-            return (bytes_read > 0) ? bytes_read : FAT32_ERR_IO;
+            return (bytes_read > 0) ? (int32_t)bytes_read : FAT32_ERR_IO;
         }
         
-        /* Copy data from sector */
         uint32_t copy_len = 512 - offset_in_sector;
         if (copy_len > (size - bytes_read)) {
             copy_len = size - bytes_read;
         }
         
-        for (uint32_t i = 0; i < copy_len; i++) {
-            out[bytes_read + i] = sector_buf[offset_in_sector + i];
-        }
+        mimi_memcpy(out + bytes_read, sector_buf + offset_in_sector, copy_len);
         
         bytes_read += copy_len;
         file->position += copy_len;
         
         /* Move to next cluster if needed */
         if ((file->position % fs->cluster_size) == 0) {
-            file->current_cluster = fat_next_cluster(fs, file->current_cluster);
+            file->current_cluster = file_next_cluster(file, file->current_cluster);
         }
     }
     
@@ -482,10 +907,34 @@ fat32_err_t fat32_seek(fat32_file_t* file, uint32_t offset) {
     /* Determine target cluster */
     uint32_t target_cluster_index = offset / fs->cluster_size;
     
-    /* Walk cluster chain from start */
-    uint32_t cluster = file->start_cluster;
-    for (uint32_t i = 0; i < target_cluster_index && !is_eoc(cluster); i++) {
-        cluster = fat_next_cluster(fs, cluster);
+    /* Locate it in the cluster map */
+    uint32_t base = 0;
+    for (uint32_t i = 0; i < file->extent_count; i++) {
+        const fat32_extent_t* ext = &file->extents[i];
+        
+        if (target_cluster_index < base + ext->count) {
+            file->current_cluster = ext->start + (target_cluster_index - base);
+            file->position = offset;
+            return FAT32_OK;
+        }
+        base += ext->count;
+    }
+    
+    /* Past the mapped chain */
+    uint32_t cluster = FAT32_EOC;
+    if (!file->extents_complete) {
+        /* Walk the unmapped tail from the last mapped cluster */
+        if (file->extent_count > 0) {
+            const fat32_extent_t* last = &file->extents[file->extent_count - 1];
+            cluster = last->start + last->count - 1;
+            base--;
+        } else {
+            cluster = file->start_cluster;
+        }
+        
+        for (uint32_t i = base; i < target_cluster_index && !is_eoc(cluster); i++) {
+            cluster = fat_next_cluster(fs, cluster);
+        }
     }
     
     file->current_cluster = cluster;
@@ -24,6 +24,11 @@
 #define FAT32_MAX_PATH      256
 #define FAT32_MAX_NAME      256
 
+#define FAT32_MAX_EXTENTS   16      /* Cluster runs mapped per open file */
+#define FAT32_FAT_CACHE     2       /* FAT sectors cached per filesystem */
+#define FAT32_DIR_CACHE     32      /* Directory entries remembered per filesystem */
+#define FAT32_DIR_BATCH     4       /* Most directory sectors read per transfer */
+
 /*============================================================================
  * Error Codes
  *============================================================================*/
@@ -43,6 +48,31 @@ typedef enum {
  * Filesystem Context
  *============================================================================*/
 
+/**
+ * Location and contents of the directory entry a file was opened from.
+ * 
+ * Rewriting, replacing, moving or deleting the file changes the entry
+ * (size, first cluster, write time), so a saved stamp that still
+ * matches the card means the file and its cluster chain are unchanged.
+ */
+typedef struct {
+    uint32_t sector;            /* Sector holding the short entry (0 for root) */
+    uint32_t offset;            /* Byte offset of the entry in that sector */
+    uint8_t  entry[32];         /* Raw entry, last-access date cleared */
+} fat32_stamp_t;
+
+/**
+ * Directory entry remembered from an earlier scan, keyed by two
+ * independent hashes of the case-folded name.
+ */
+typedef struct {
+    uint32_t      dir_cluster;  /* Directory holding the entry (0 if unused) */
+    uint32_t      hash;         /* FNV-1a of the name */
+    uint32_t      check;        /* djb2 of the name */
+    bool          looked_up;    /* Opened by name, not just passed by a scan */
+    fat32_stamp_t stamp;        /* Short entry and where it lives */
+} fat32_dir_cache_t;
+
 typedef struct {
     /* Partition geometry */
     uint32_t partition_start;       /* First sector of partition */
@@ -53,21 +83,68 @@ typedef struct {
     uint32_t sectors_per_fat;
     uint32_t root_cluster;
     uint32_t total_sectors;
+    uint32_t volume_id;             /* Serial number set when formatted */
     
     /* Computed values */
     uint32_t fat_start;             /* First sector of FAT */
     uint32_t data_start;            /* First sector of data region */
     uint32_t cluster_size;          /* Bytes per cluster */
     
-    /* Read callback */
-    int (*read_sector)(uint32_t sector, uint8_t* buffer);
+    /* Statistics */
+    uint32_t fat_lookups;           /* FAT entry lookups */
+    uint32_t fat_reads;             /* FAT sectors read from storage */
+    uint32_t dir_reads;             /* Directory sectors read from storage */
+    uint32_t dir_hits;              /* Lookups answered by the directory cache */
+    
+    /* FAT sector cache (round-robin replacement) */
+    uint32_t fat_cache_sector[FAT32_FAT_CACHE];
+    uint32_t fat_cache_next;
+    uint8_t  fat_cache[FAT32_FAT_CACHE][512];
     
+    /*
+     * Directory entry cache (round-robin replacement, sparing entries
+     * that were looked up). Every entry a scan passes is remembered,
+     * so later opens in the same directory skip the scan. A directory
+     * whose entries all fit is marked complete, and misses in it need
+     * no scan either.
+     */
+    fat32_dir_cache_t dir_cache[FAT32_DIR_CACHE];
+    uint32_t dir_cache_next;
+    uint32_t dir_complete;          /* Directory cached in full (0 if none) */
+    uint8_t  dir_buf[FAT32_DIR_BATCH * 512];
+    
+    /* Read callbacks */
+    int (*read_sector)(uint32_t sector, uint8_t* buffer);
+    int (*read_sectors)(uint32_t sector, uint8_t* buffer, uint32_t count);  /* Optional */
+
 } fat32_fs_t;
 
+/**
+ * Saved geometry of a mounted volume, for fat32_remount().
+ */
+typedef struct {
+    uint32_t partition_start;
+    uint32_t sectors_per_cluster;
+    uint32_t reserved_sectors;
+    uint32_t fat_count;
+    uint32_t sectors_per_fat;
+    uint32_t root_cluster;
+    uint32_t total_sectors;
+    uint32_t volume_id;
+} fat32_volume_t;
+
 /*============================================================================
  * File Handle
  *============================================================================*/
 
+/**
+ * Run of physically contiguous clusters.
+ */
+typedef struct {
+    uint32_t start;             /* First cluster of run */
+    uint32_t count;             /* Clusters in run */
+} fat32_extent_t;
+
 typedef struct {
     fat32_fs_t* fs;
     uint32_t start_cluster;     /* First cluster of file */
@@ -75,6 +152,16 @@ typedef struct {
     uint32_t file_size;         /* Total file size */
     uint32_t position;          /* Current read position */
     uint8_t  attr;              /* File attributes */
+    fat32_stamp_t stamp;        /* Directory entry the file was opened from */
+    
+    /*
+     * Cluster map, built once at open. If the chain has more than
+     * FAT32_MAX_EXTENTS fragments, the tail beyond the last extent
+     * falls back to (cached) FAT lookups.
+     */
+    uint32_t       extent_count;
+    bool           extents_complete;    /* Map covers the whole chain */
+    fat32_extent_t extents[FAT32_MAX_EXTENTS];
 } fat32_file_t;
 
 /*============================================================================
@@ -87,6 +174,7 @@ typedef struct {
     uint32_t    cluster;
     uint8_t     attr;
     bool        is_dir;
+    fat32_stamp_t stamp;
 } fat32_dirent_t;
 
 /* Attribute flags */
@@ -111,10 +199,48 @@ typedef struct {
  */
 fat32_err_t fat32_mount(fat32_fs_t* fs, int (*read_sector)(uint32_t, uint8_t*));
 
+/**
+ * Save the geometry of a mounted filesystem.
+ * 
+ * @param fs            Mounted filesystem
+ * @param vol           Output geometry
+ */
+void fat32_get_volume(const fat32_fs_t* fs, fat32_volume_t* vol);
+
+/**
+ * Mount a volume whose geometry was saved by fat32_get_volume().
+ * 
+ * Reads only the boot sector, skipping the partition table, and
+ * checks it still describes the same volume (geometry and serial).
+ * 
+ * @param fs            Filesystem context to initialize
+ * @param vol           Saved geometry
+ * @param read_sector   Callback to read a 512-byte sector
+ * @return              FAT32_OK, FAT32_ERR_IO, or FAT32_ERR_INVALID
+ *                      if the card has been reformatted or swapped
+ */
+fat32_err_t fat32_remount(fat32_fs_t* fs, const fat32_volume_t* vol,
+                          int (*read_sector)(uint32_t, uint8_t*));
+
+/**
+ * Register a multi-sector read callback.
+ * 
+ * Optional. When set, fat32_read detects runs of physically
+ * contiguous clusters and fetches each run with a single call
+ * instead of one read_sector call per sector.
+ * 
+ * @param fs            Mounted filesystem
+ * @param read_sectors  Callback to read count consecutive 512-byte sectors
+ */
+void fat32_set_multi_read(fat32_fs_t* fs, int (*read_sectors)(uint32_t, uint8_t*, uint32_t));
+
 /**
  * Open a file by path.
  * 
- * Path uses forward slashes, e.g., "/boot/kernel.elf"
+ * Path uses forward slashes, e.g., "/boot/kernel.elf". Directories
+ * are scanned through the directory cache: a scan reads one sector,
+ * then ever larger multi-sector runs (up to FAT32_DIR_BATCH) while
+ * the entry is not found.
  * 
  * @param fs    Mounted filesystem
  * @param path  File path (absolute)
@@ -123,6 +249,31 @@ fat32_err_t fat32_mount(fat32_fs_t* fs, int (*read_sector)(uint32_t, uint8_t*));
  */
 fat32_err_t fat32_open(fat32_fs_t* fs, const char* path, fat32_file_t* file);
 
+/**
+ * Check saved directory entry stamps against the card.
+ * 
+ * Reads each stamp's sector once (consecutive stamps in the same
+ * sector share the read).
+ * 
+ * @param fs        Mounted filesystem
+ * @param stamps    Stamps from fat32_file_t.stamp
+ * @param count     Number of stamps
+ * @return          FAT32_OK if all match, FAT32_ERR_INVALID if any
+ *                  entry changed, FAT32_ERR_IO on read failure
+ */
+fat32_err_t fat32_check_stamps(fat32_fs_t* fs, const fat32_stamp_t* stamps, uint32_t count);
+
+/**
+ * Reattach a saved file handle to a (re)mounted filesystem.
+ * 
+ * The handle is rewound; its cluster map is used as saved, nothing
+ * is read. The caller must have checked file->stamp first.
+ * 
+ * @param fs    Mounted filesystem
+ * @param file  Handle saved after fat32_open()
+ */
+void fat32_reopen(fat32_fs_t* fs, fat32_file_t* file);
+
 /**
  * Read bytes from an open file.
  * 
@@ -136,6 +287,9 @@ int32_t fat32_read(fat32_file_t* file, void* buffer, uint32_t size);
 /**
  * Seek to position in file.
  * 
+ * Resolved from the cluster map without touching the card, unless
+ * the target lies beyond a fragmented file's mapped extents.
+ * 
  * @param file      Open file handle
  * @param offset    Byte offset from start
  * @return          FAT32_OK on success
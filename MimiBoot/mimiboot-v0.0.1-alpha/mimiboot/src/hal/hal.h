@@ -20,21 +20,39 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdarg.h>
+#include "../core/mem.h"
+#include "../core/crc32.h"
+#include "../core/loader.h"
 
 /*============================================================================
  * Platform Information
  *============================================================================*/
 
+/* Entries in mimi_platform_info_t.ram_regions */
+#define HAL_MAX_RAM_REGIONS 6
+
 /**
  * Platform information structure.
  * Filled by hal_get_platform_info().
+ * 
+ * ram_base/ram_size span all of RAM. ram_regions splits it by bank,
+ * marked MIMI_MEM_STRIPED or MIMI_MEM_SCRATCH, with the parts holding
+ * the loader's own data, buffers and stacks marked MIMI_MEM_LOADER so
+ * no payload segment is placed over them.
  */
 typedef struct {
     /* Memory layout */
     uint32_t    ram_base;       /* RAM base address */
     uint32_t    ram_size;       /* RAM size in bytes */
+    const mimi_mem_region_t* ram_regions;   /* RAM by bank, ascending (see above) */
+    uint32_t    ram_region_count;   /* At most HAL_MAX_RAM_REGIONS */
     uint32_t    loader_base;    /* MimiBoot flash location */
     uint32_t    loader_size;    /* MimiBoot flash size */
+    uint32_t    xip_base;       /* Flash window free for XIP payloads */
+    uint32_t    xip_size;       /* Size of that window (0 if no XIP) */
+    uint32_t    nv_base;        /* Flash kept for the image cache and non-volatile blocks */
+    uint32_t    nv_size;        /* Size of that area (0 if none) */
     
     /* System state */
     uint32_t    sys_clock_hz;   /* Current system clock frequency */
@@ -44,7 +62,7 @@ typedef struct {
     /* Platform identification */
     uint32_t    chip_id;        /* Chip identification (if available) */
     const char* platform_name;  /* Human-readable name */
-    
+
 } mimi_platform_info_t;
 
 /*============================================================================
@@ -72,6 +90,24 @@ int hal_init_early(void);
  */
 void hal_get_platform_info(mimi_platform_info_t* info);
 
+/**
+ * Get platform-optimized memory routines.
+ * 
+ * Used to back mimi_memcpy/mimi_memset for large aligned blocks
+ * (e.g. BSS zeroing). Set either pointer to NULL if unavailable.
+ * 
+ * @param copy4     Output: aligned copy routine, or NULL
+ * @param set4      Output: aligned fill routine, or NULL
+ */
+void hal_get_mem_accel(mimi_copy4_fn* copy4, mimi_set4_fn* set4);
+
+/**
+ * Get a hardware CRC-32 routine for mimi_crc32_update.
+ * 
+ * @return  CRC routine, or NULL to use the software table
+ */
+mimi_crc32_fn hal_get_crc_accel(void);
+
 /*============================================================================
  * Console (Debug Output)
  *============================================================================*/
@@ -89,10 +125,28 @@ int hal_console_init(void);
 /**
  * Write a character to console.
  * 
+ * Output may be buffered: the character is queued and sent in the
+ * background, and the call only waits when the buffer is full.
+ * 
  * @param c     Character to write
  */
 void hal_console_putc(char c);
 
+/**
+ * Wait until all queued console output has been sent.
+ * 
+ * Call before anything that stops the console: a jump to the payload,
+ * a reset or a halt.
+ */
+void hal_console_flush(void);
+
+/**
+ * Read a character from console without waiting.
+ * 
+ * @return  Character received, or -1 if none is pending
+ */
+int hal_console_getc(void);
+
 /**
  * Write a string to console.
  * 
@@ -111,11 +165,23 @@ void hal_console_puts(const char* s);
  * - %c: character
  * - %%: literal %
  * 
+ * Numbers take a field width, padded with spaces or, after a 0, with
+ * zeros (%8u, %08X).
+ * 
  * @param fmt   Format string
  * @param ...   Arguments
  */
 void hal_console_printf(const char* fmt, ...);
 
+/**
+ * Write formatted output to console, arguments as a va_list
+ * (see hal_console_printf).
+ * 
+ * @param fmt   Format string
+ * @param args  Arguments
+ */
+void hal_console_vprintf(const char* fmt, va_list args);
+
 /*============================================================================
  * Timing
  *============================================================================*/
@@ -164,6 +230,14 @@ typedef struct {
     const char* name;           /* Device name */
 } hal_storage_info_t;
 
+/**
+ * Storage access counters (cumulative since init).
+ */
+typedef struct {
+    uint32_t    commands;       /* Commands issued to the device */
+    uint32_t    blocks_read;    /* Blocks transferred to the host */
+} hal_storage_stats_t;
+
 /**
  * Initialize storage subsystem.
  * 
@@ -197,6 +271,16 @@ void hal_storage_close(hal_storage_t dev);
  */
 int hal_storage_info(hal_storage_t dev, hal_storage_info_t* info);
 
+/**
+ * Get storage access counters.
+ * 
+ * Used for boot profiling. Platforms without counters report zeros.
+ * 
+ * @param dev   Storage device handle
+ * @param stats Output: access counters
+ */
+void hal_storage_get_stats(hal_storage_t dev, hal_storage_stats_t* stats);
+
 /**
  * Read bytes from storage.
  * 
@@ -208,6 +292,21 @@ int hal_storage_info(hal_storage_t dev, hal_storage_info_t* info);
  */
 int32_t hal_storage_read(hal_storage_t dev, uint32_t offset, void* buffer, uint32_t size);
 
+/**
+ * Read whole blocks from storage.
+ * 
+ * Reads count consecutive sector_size blocks directly into buffer.
+ * Multi-block requests should be issued to the device as a single
+ * streaming transfer where the hardware supports it.
+ * 
+ * @param dev       Storage device handle
+ * @param block     First block number
+ * @param buffer    Destination buffer (count * sector_size bytes)
+ * @param count     Number of blocks to read
+ * @return          0 on success, negative on error
+ */
+int hal_storage_read_blocks(hal_storage_t dev, uint32_t block, void* buffer, uint32_t count);
+
 /*============================================================================
  * GPIO (minimal interface for storage)
  *============================================================================*/
@@ -286,6 +385,20 @@ int hal_spi_init(hal_spi_t* spi, uint32_t instance, const hal_spi_config_t* conf
  */
 int hal_spi_transfer(hal_spi_t spi, const uint8_t* tx, uint8_t* rx, uint32_t len);
 
+/**
+ * Receive bytes over SPI while clocking out 0xFF.
+ * 
+ * Bulk receive path for storage data phases. Platforms with a DMA
+ * engine should stream the whole transfer at line rate rather than
+ * polling byte by byte.
+ * 
+ * @param spi       SPI handle
+ * @param rx        Receive buffer (no alignment requirement)
+ * @param len       Number of bytes to receive
+ * @return          0 on success, negative on error
+ */
+int hal_spi_receive(hal_spi_t spi, uint8_t* rx, uint32_t len);
+
 /**
  * Set SPI clock frequency.
  * 
@@ -295,6 +408,147 @@ int hal_spi_transfer(hal_spi_t spi, const uint8_t* tx, uint8_t* rx, uint32_t len
  */
 uint32_t hal_spi_set_clock(hal_spi_t spi, uint32_t clock_hz);
 
+/*============================================================================
+ * Second Core
+ *============================================================================*/
+
+/**
+ * Start a function on the second core.
+ * 
+ * entry runs on a small private stack (about 1KB) with no interrupts
+ * enabled. If it returns, the core sleeps until hal_core1_reset().
+ * 
+ * @param entry     Function to run
+ * @return          true if started, false if there is no second core
+ */
+bool hal_core1_launch(void (*entry)(void));
+
+/**
+ * Put the second core back in its power-on state.
+ * 
+ * Called before handoff so the payload finds core 1 exactly as the
+ * boot ROM left it. Safe to call if it was never launched.
+ */
+void hal_core1_reset(void);
+
+/*============================================================================
+ * Non-Volatile Storage
+ *============================================================================*/
+
+/* Non-volatile blocks, one flash sector each */
+#define HAL_NV_MANIFEST     0   /* Boot manifest (core/manifest.h) */
+#define HAL_NV_LOG          1   /* Boot attempt log (core/bootstate.h) */
+#define HAL_NV_CONFIG       2   /* Compiled boot.cfg (core/config.h) */
+#define HAL_NV_BLOCKS       3
+
+/**
+ * Get a non-volatile block.
+ * 
+ * @param block HAL_NV_* block
+ * @param size  Output: block size in bytes (0 if none)
+ * @return      Block contents, memory-mapped, or NULL if none
+ */
+const void* hal_nv_data(uint32_t block, uint32_t* size);
+
+/**
+ * Replace the contents of a non-volatile block.
+ * 
+ * Erases the block, then programs size bytes from data, which must
+ * be in RAM; size 0 only erases. Flash is unreadable while this runs,
+ * so core 1 must be stopped.
+ * 
+ * @param block HAL_NV_* block
+ * @param data  Bytes to store
+ * @param size  Number of bytes (at most the block size)
+ * @return      0 on success, negative on error
+ */
+int hal_nv_write(uint32_t block, const void* data, uint32_t size);
+
+/**
+ * Program bytes into a non-volatile block without rewriting it.
+ * 
+ * Without erase, only bytes still erased (0xFF) may be programmed;
+ * everything else in the block is left as it is. The bytes must not
+ * cross a 256-byte boundary. Same restrictions as hal_nv_write.
+ * 
+ * @param block   HAL_NV_* block
+ * @param offset  Offset in the block
+ * @param data    Bytes to store
+ * @param size    Number of bytes
+ * @param erase   Erase the whole block first
+ * @return        0 on success, negative on error
+ */
+int hal_nv_append(uint32_t block, uint32_t offset, const void* data, uint32_t size, bool erase);
+
+/*============================================================================
+ * Image Cache
+ *============================================================================*/
+
+/**
+ * Get the flash area kept for a copy of the last image loaded in full,
+ * the base of delta images (core/delta.h).
+ * 
+ * @param size  Output: area size in bytes (0 if none)
+ * @return      Area contents, memory-mapped, or NULL if none
+ */
+const void* hal_cache_data(uint32_t* size);
+
+/**
+ * Program bytes into the image cache.
+ * 
+ * Erases every sector the bytes cover, then programs them from data,
+ * which must be in RAM; size 0 only erases the sector at offset.
+ * Same restrictions as hal_nv_write.
+ * 
+ * @param offset    Offset in the cache, a multiple of 4096 (one sector)
+ * @param data      Bytes to store
+ * @param size      Number of bytes
+ * @return          0 on success, negative on error
+ */
+int hal_cache_write(uint32_t offset, const void* data, uint32_t size);
+
+/*============================================================================
+ * Retained Registers
+ *============================================================================*/
+
+/**
+ * Get the number of retained words.
+ * 
+ * Retained words keep their value across warm and watchdog resets and
+ * read as zero after power-on. Used to recognise a payload that is
+ * still intact in RAM (see core/resume.h).
+ * 
+ * @return  Number of words (0 if the platform has none)
+ */
+uint32_t hal_retain_count(void);
+
+/**
+ * Read a retained word.
+ * 
+ * @param index  Word index (below hal_retain_count())
+ * @return       Stored value
+ */
+uint32_t hal_retain_get(uint32_t index);
+
+/**
+ * Write a retained word.
+ * 
+ * @param index  Word index (below hal_retain_count())
+ * @param value  Value to store
+ */
+void hal_retain_set(uint32_t index, uint32_t value);
+
+/**
+ * Get the address of a retained word.
+ * 
+ * Handed to the payload so it can update the word without the HAL
+ * (see MIMI_HANDOFF_CONFIRM).
+ * 
+ * @param index  Word index (below hal_retain_count())
+ * @return       Address, or 0 if the word does not exist
+ */
+uint32_t hal_retain_addr(uint32_t index);
+
 /*============================================================================
  * System Control
  *============================================================================*/
@@ -318,6 +572,15 @@ void hal_system_reset(void);
 __attribute__((noreturn))
 void hal_system_halt(void);
 
+/**
+ * Record that the loader is handing off to a payload, as the last step
+ * before the jump. A reset the payload causes without the watchdog
+ * (SYSRESETREQ, lockup) leaves no trace of its own on some chips; the
+ * record lets hal_get_platform_info report it as MIMI_BOOT_WARM rather
+ * than as the power-on before it.
+ */
+void hal_handoff_mark(void);
+
 /*============================================================================
  * LED Indicator (optional)
  *============================================================================*/
@@ -1,10 +1,13 @@
 /**
  * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
  * 
- * hal_rp2040.c - RP2040/RP2350 Hardware Abstraction Layer
+ * hal_rp2040.c - RP2040 Hardware Abstraction Layer
  * 
- * This file implements the HAL interface for Raspberry Pi Pico
- * and Pico 2 (RP2040/RP2350) microcontrollers.
+ * This file implements the HAL interface for the Raspberry Pi Pico
+ * (RP2040) microcontroller. The Pico 2 (RP2350) has its own backend
+ * in hal/rp2350; what the two chips share (console, GPIO, SPI,
+ * storage, second core, flash and retained words) is in
+ * rp2xxx_common.c.
  * 
  * While we use Pico SDK for compilation convenience, this implementation
  * accesses hardware registers directly to keep the code portable and
@@ -12,80 +15,31 @@
  * 
  * Memory Map (RP2040):
  * - Flash: 0x10000000, typically 2MB (external QSPI)
- * - SRAM:  0x20000000, 264KB (striped across 6 banks)
+ * - SRAM:  0x20000000, 256KB striped across 4 banks, then two 4KB
+ *          scratch banks at 0x20040000 and 0x20041000
  * - Peripherals: 0x40000000+
  */
 
-#include "../hal.h"
-#include "rp2040_regs.h"
-#include <stdarg.h>
+#include "../rp2xxx_common.h"
 
 /*============================================================================
  * Platform Constants
  *============================================================================*/
 
-/* Default clock after boot ROM - 125MHz on RP2040 */
-#define XOSC_MHZ            12
-#define SYS_CLK_HZ          125000000
-
-/* UART for console */
-#define CONSOLE_UART        UART0_BASE
-#define CONSOLE_BAUD        115200
-#define CONSOLE_TX_PIN      0
-#define CONSOLE_RX_PIN      1
-
-/* SD Card SPI pins (directly defined for now, make configurable later) */
-#define SD_SPI_INST         0           /* SPI0 */
-#define SD_CS_PIN           5
-#define SD_SCK_PIN          2
-#define SD_MOSI_PIN         3
-#define SD_MISO_PIN         4
-
-/* LED pin (Pico onboard) */
-#define LED_PIN             25
-
-/* Memory layout */
-#define FLASH_BASE          0x10000000
-#define SRAM_BASE           0x20000000
-
-#if defined(TARGET_RP2350)
-#define SRAM_SIZE           (520 * 1024)    /* 520KB on RP2350 */
-#else
 #define SRAM_SIZE           (264 * 1024)    /* 264KB on RP2040 */
-#endif
 
-/* MimiBoot occupies first 16KB of flash (after boot2) */
-#define LOADER_OFFSET       0x100           /* After boot2 */
-#define LOADER_SIZE         (16 * 1024)
+/* Striped main banks, then two 4KB scratch banks (SRAM4/5) */
+#define SCRATCH_BANK_SIZE   (4 * 1024)
+#define STRIPED_SIZE        (SRAM_SIZE - 2 * SCRATCH_BANK_SIZE)
+#define SCRATCH_X_BASE      (SRAM_BASE + STRIPED_SIZE)
+#define SCRATCH_Y_BASE      (SCRATCH_X_BASE + SCRATCH_BANK_SIZE)
 
 /*============================================================================
  * Static State
  *============================================================================*/
 
-static uint32_t s_sys_clock_hz = SYS_CLK_HZ;
-static bool s_console_initialized = false;
 static bool s_timer_initialized = false;
 
-/*============================================================================
- * Register Access Helpers
- *============================================================================*/
-
-static inline void reg_write(uint32_t addr, uint32_t val) {
-    *(volatile uint32_t*)addr = val;
-}
-
-static inline uint32_t reg_read(uint32_t addr) {
-    return *(volatile uint32_t*)addr;
-}
-
-static inline void reg_set_bits(uint32_t addr, uint32_t bits) {
-    *(volatile uint32_t*)(addr + REG_ALIAS_SET_BITS) = bits;
-}
-
-static inline void reg_clear_bits(uint32_t addr, uint32_t bits) {
-    *(volatile uint32_t*)(addr + REG_ALIAS_CLR_BITS) = bits;
-}
-
 /*============================================================================
  * Initialization
  *============================================================================*/
@@ -107,6 +61,7 @@ int hal_init_early(void) {
         (1 << RESET_PADS_BANK0) |
         (1 << RESET_UART0) |
         (1 << RESET_SPI0) |
+        (1 << RESET_DMA) |
         (1 << RESET_TIMER);
     
     /* Assert reset */
@@ -126,490 +81,168 @@ int hal_init_early(void) {
     return 0;
 }
 
-void hal_get_platform_info(mimi_platform_info_t* info) {
-    info->ram_base = SRAM_BASE;
-    info->ram_size = SRAM_SIZE;
-    info->loader_base = FLASH_BASE + LOADER_OFFSET;
-    info->loader_size = LOADER_SIZE;
-    info->sys_clock_hz = s_sys_clock_hz;
-    
-    /* Read reset reason from watchdog scratch or VREG */
-    /* For now, assume cold boot */
-    info->reset_reason = MIMI_BOOT_COLD;
-    
-    /* We'll set boot source when storage is mounted */
-    info->boot_source = MIMI_SOURCE_SD;
-    
-    /* Read chip ID from ROM */
-#if defined(TARGET_RP2350)
-    info->chip_id = 0x2350;
-    info->platform_name = "RP2350";
-#else
-    info->chip_id = 0x2040;
-    info->platform_name = "RP2040";
-#endif
-}
-
-/*============================================================================
- * Console (UART)
- *============================================================================*/
-
-int hal_console_init(void) {
-    if (s_console_initialized) {
-        return 0;
-    }
-    
-    /* Configure TX pin for UART function */
-    /* GPIO function select: UART = 2 */
-    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(CONSOLE_TX_PIN), 2);
-    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(CONSOLE_RX_PIN), 2);
-    
-    /* Configure UART */
-    /* Baud rate divisor: UARTIBRD and UARTFBRD */
-    /* Baud = UARTCLK / (16 * (IBRD + FBRD/64)) */
-    /* UARTCLK = sys_clk typically */
-    uint32_t baud_div = (s_sys_clock_hz * 4) / CONSOLE_BAUD;
-    uint32_t ibrd = baud_div >> 6;
-    uint32_t fbrd = baud_div & 0x3F;
-    
-    reg_write(CONSOLE_UART + UART_IBRD_OFFSET, ibrd);
-    reg_write(CONSOLE_UART + UART_FBRD_OFFSET, fbrd);
-    
-    /* 8N1, FIFO enabled */
-    reg_write(CONSOLE_UART + UART_LCR_H_OFFSET, 
-        UART_LCR_H_WLEN_8 | UART_LCR_H_FEN);
-    
-    /* Enable UART, TX, RX */
-    reg_write(CONSOLE_UART + UART_CR_OFFSET,
-        UART_CR_UARTEN | UART_CR_TXE | UART_CR_RXE);
-    
-    s_console_initialized = true;
-    return 0;
-}
-
-void hal_console_putc(char c) {
-    if (!s_console_initialized) return;
-    
-    /* Wait for TX FIFO not full */
-    while (reg_read(CONSOLE_UART + UART_FR_OFFSET) & UART_FR_TXFF) {
-        /* spin */
-    }
-    
-    reg_write(CONSOLE_UART + UART_DR_OFFSET, c);
-}
+/*
+ * The loader's share of striped SRAM, from linker/mimiboot_rp2040.ld.
+ * Without it (the SDK's default layout) data and BSS sit at the bottom.
+ */
+extern char __loader_ram_start__[] __attribute__((weak));
+extern char __loader_ram_end__[] __attribute__((weak));
+extern char __bss_end__[];
 
-void hal_console_puts(const char* s) {
-    while (*s) {
-        if (*s == '\n') {
-            hal_console_putc('\r');
-        }
-        hal_console_putc(*s++);
-    }
-}
+static mimi_mem_region_t s_ram_regions[HAL_MAX_RAM_REGIONS];
 
-/* Minimal printf implementation */
-static void print_uint(uint32_t val, int base, int uppercase) {
-    char buf[12];
-    int i = 0;
-    const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
-    
-    if (val == 0) {
-        hal_console_putc('0');
-        return;
-    }
+/**
+ * Split SRAM into the regions the loader may use, bank by bank.
+ */
+static uint32_t ram_regions_build(void) {
+    const uint32_t rwx = MIMI_MEM_READ | MIMI_MEM_WRITE | MIMI_MEM_EXEC | MIMI_MEM_RAM;
     
-    while (val > 0) {
-        buf[i++] = digits[val % base];
-        val /= base;
+    uint32_t lo = SRAM_BASE;
+    uint32_t hi = (uint32_t)(uintptr_t)__bss_end__;
+    if (__loader_ram_start__ != NULL && __loader_ram_end__ != NULL) {
+        lo = (uint32_t)(uintptr_t)__loader_ram_start__;
+        hi = (uint32_t)(uintptr_t)__loader_ram_end__;
     }
+    hi = (hi + 3) & ~3u;
     
-    while (i > 0) {
-        hal_console_putc(buf[--i]);
+    uint32_t n = 0;
+    if (lo > SRAM_BASE) {
+        s_ram_regions[n++] = (mimi_mem_region_t){ SRAM_BASE, lo - SRAM_BASE, rwx | MIMI_MEM_STRIPED };
     }
-}
-
-static void print_int(int32_t val) {
-    if (val < 0) {
-        hal_console_putc('-');
-        val = -val;
-    }
-    print_uint((uint32_t)val, 10, 0);
-}
-
-void hal_console_printf(const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    
-    while (*fmt) {
-        if (*fmt != '%') {
-            if (*fmt == '\n') hal_console_putc('\r');
-            hal_console_putc(*fmt++);
-            continue;
-        }
-        
-        fmt++;
-        switch (*fmt) {
-            case 'd':
-            case 'i':
-                print_int(va_arg(args, int32_t));
-                break;
-            case 'u':
-                print_uint(va_arg(args, uint32_t), 10, 0);
-                break;
-            case 'x':
-                print_uint(va_arg(args, uint32_t), 16, 0);
-                break;
-            case 'X':
-                print_uint(va_arg(args, uint32_t), 16, 1);
-                break;
-            case 's':
-                hal_console_puts(va_arg(args, const char*));
-                break;
-            case 'c':
-                hal_console_putc((char)va_arg(args, int));
-                break;
-            case '%':
-                hal_console_putc('%');
-                break;
-            default:
-                hal_console_putc('%');
-                hal_console_putc(*fmt);
-                break;
-        }
-        fmt++;
+    s_ram_regions[n++] = (mimi_mem_region_t){ lo, hi - lo, rwx | MIMI_MEM_STRIPED | MIMI_MEM_LOADER };
+    if (hi < SCRATCH_X_BASE) {
+        s_ram_regions[n++] = (mimi_mem_region_t){ hi, SCRATCH_X_BASE - hi, rwx | MIMI_MEM_STRIPED };
     }
     
-    va_end(args);
+    /* Core 1 stack and bounce buffers (MIMI_SCRATCH_X), core 0 stack */
+    s_ram_regions[n++] = (mimi_mem_region_t){
+        SCRATCH_X_BASE, SCRATCH_BANK_SIZE, rwx | MIMI_MEM_SCRATCH | MIMI_MEM_LOADER };
+    s_ram_regions[n++] = (mimi_mem_region_t){
+        SCRATCH_Y_BASE, SCRATCH_BANK_SIZE, rwx | MIMI_MEM_SCRATCH | MIMI_MEM_LOADER };
+    return n;
 }
 
-/*============================================================================
- * Timing
- *============================================================================*/
-
-uint32_t hal_get_time_us(void) {
-    /* RP2040 timer runs at 1MHz */
-    return reg_read(TIMER_BASE + TIMER_TIMELR_OFFSET);
-}
-
-void hal_delay_us(uint32_t us) {
-    uint32_t start = hal_get_time_us();
-    while ((hal_get_time_us() - start) < us) {
-        /* spin */
-    }
-}
-
-void hal_delay_ms(uint32_t ms) {
-    hal_delay_us(ms * 1000);
-}
-
-/*============================================================================
- * GPIO
- *============================================================================*/
-
-void hal_gpio_set_mode(uint32_t pin, hal_gpio_mode_t mode) {
-    /* Configure pad */
-    uint32_t pad_ctrl = PADS_BANK0_GPIO_OD_DISABLE;  /* No output disable */
-    
-    switch (mode) {
-        case HAL_GPIO_INPUT:
-            pad_ctrl |= PADS_BANK0_GPIO_IE;
-            break;
-        case HAL_GPIO_INPUT_PULLUP:
-            pad_ctrl |= PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_PUE;
-            break;
-        case HAL_GPIO_INPUT_PULLDOWN:
-            pad_ctrl |= PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_PDE;
-            break;
-        case HAL_GPIO_OUTPUT:
-            pad_ctrl |= PADS_BANK0_GPIO_IE;  /* IE still needed for readback */
-            break;
-        case HAL_GPIO_ALT_FUNC:
-            pad_ctrl |= PADS_BANK0_GPIO_IE;
-            break;
-    }
+void hal_get_platform_info(mimi_platform_info_t* info) {
+    uint32_t xip_offset = loader_flash_end();
     
-    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(pin), pad_ctrl);
+    info->ram_base = SRAM_BASE;
+    info->ram_size = SRAM_SIZE;
+    info->ram_regions = s_ram_regions;
+    info->ram_region_count = ram_regions_build();
+    info->loader_base = FLASH_BASE + LOADER_OFFSET;
+    info->loader_size = xip_offset - LOADER_OFFSET;
+    info->xip_base = FLASH_BASE + xip_offset;
+    info->xip_size = CACHE_OFFSET - xip_offset;
+    info->nv_base = FLASH_BASE + CACHE_OFFSET;
+    info->nv_size = FLASH_SIZE - CACHE_OFFSET;
+    info->sys_clock_hz = SYS_CLK_HZ;
     
-    /* Configure function */
-    if (mode == HAL_GPIO_OUTPUT || mode == HAL_GPIO_INPUT || 
-        mode == HAL_GPIO_INPUT_PULLUP || mode == HAL_GPIO_INPUT_PULLDOWN) {
-        /* SIO function = 5 */
-        reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(pin), 5);
-        
-        if (mode == HAL_GPIO_OUTPUT) {
-            /* Enable output */
-            reg_set_bits(SIO_BASE + SIO_GPIO_OE_OFFSET, (1 << pin));
-        } else {
-            /* Disable output */
-            reg_clear_bits(SIO_BASE + SIO_GPIO_OE_OFFSET, (1 << pin));
-        }
-    }
-}
-
-void hal_gpio_write(uint32_t pin, bool state) {
-    if (state) {
-        reg_write(SIO_BASE + SIO_GPIO_OUT_SET_OFFSET, (1 << pin));
+    /*
+     * The watchdog records its own resets (hal_system_reset forces one).
+     * CHIP_RESET records power-on, the RUN pin and debugger restarts,
+     * but keeps saying so through every processor reset after them, so
+     * it is only asked when the loader has not handed off since: with
+     * the handoff mark still set, the payload reset the processors
+     * itself (SYSRESETREQ), a warm reset.
+     */
+    uint32_t wd_reason = reg_read(WATCHDOG_BASE + WATCHDOG_REASON_OFFSET);
+    uint32_t chip_reset = reg_read(VREG_AND_CHIP_RESET_BASE + CHIP_RESET_OFFSET);
+    
+    if (wd_reason & WATCHDOG_REASON_TIMER) {
+        info->reset_reason = MIMI_BOOT_WATCHDOG;
+    } else if (wd_reason & WATCHDOG_REASON_FORCE) {
+        info->reset_reason = MIMI_BOOT_WARM;
+    } else if (rp2xxx_handoff_marked()) {
+        info->reset_reason = MIMI_BOOT_WARM;
+    } else if (chip_reset & CHIP_RESET_HAD_PSM_RESTART) {
+        info->reset_reason = MIMI_BOOT_DEBUG;
+    } else if (chip_reset & CHIP_RESET_HAD_RUN) {
+        info->reset_reason = MIMI_BOOT_EXTERNAL;
+    } else if (chip_reset & CHIP_RESET_HAD_POR) {
+        info->reset_reason = MIMI_BOOT_COLD;
     } else {
-        reg_write(SIO_BASE + SIO_GPIO_OUT_CLR_OFFSET, (1 << pin));
+        info->reset_reason = MIMI_BOOT_WARM;
     }
-}
-
-bool hal_gpio_read(uint32_t pin) {
-    return (reg_read(SIO_BASE + SIO_GPIO_IN_OFFSET) & (1 << pin)) != 0;
-}
-
-/*============================================================================
- * SPI
- *============================================================================*/
-
-/* SPI state */
-typedef struct {
-    uint32_t base;
-    uint32_t clock_hz;
-} spi_state_t;
-
-static spi_state_t s_spi_state[2];
-
-int hal_spi_init(hal_spi_t* spi, uint32_t instance, const hal_spi_config_t* config) {
-    if (instance > 1) return -1;
-    
-    uint32_t base = (instance == 0) ? SPI0_BASE : SPI1_BASE;
-    spi_state_t* state = &s_spi_state[instance];
-    state->base = base;
-    
-    /* Reset SPI */
-    uint32_t reset_bit = (instance == 0) ? (1 << RESET_SPI0) : (1 << RESET_SPI1);
-    reg_set_bits(RESETS_BASE + RESETS_RESET_OFFSET, reset_bit);
-    reg_clear_bits(RESETS_BASE + RESETS_RESET_OFFSET, reset_bit);
-    while (!(reg_read(RESETS_BASE + RESETS_RESET_DONE_OFFSET) & reset_bit)) {}
-    
-    /* Configure clock */
-    hal_spi_set_clock(state, config->clock_hz);
-    
-    /* Configure format: 8 bits, SPI mode, Motorola format */
-    uint32_t cr0 = (7 << 0);  /* 8 bit data */
-    
-    /* SPI mode (CPOL, CPHA) */
-    if (config->mode & 1) cr0 |= SPI_SSPCR0_SPH;  /* CPHA */
-    if (config->mode & 2) cr0 |= SPI_SSPCR0_SPO;  /* CPOL */
-    
-    reg_write(base + SPI_SSPCR0_OFFSET, cr0);
-    
-    /* Enable SPI */
-    reg_write(base + SPI_SSPCR1_OFFSET, SPI_SSPCR1_SSE);
     
-    *spi = state;
-    return 0;
-}
-
-uint32_t hal_spi_set_clock(hal_spi_t spi, uint32_t clock_hz) {
-    spi_state_t* state = (spi_state_t*)spi;
-    
-    /* SSPCLK = sys_clk / (CPSDVSR * (1 + SCR)) */
-    /* CPSDVSR must be even, 2-254 */
-    /* SCR is 0-255 */
-    
-    uint32_t prescale = 2;
-    while (prescale <= 254) {
-        uint32_t scr = (s_sys_clock_hz / (prescale * clock_hz)) - 1;
-        if (scr <= 255) {
-            reg_write(state->base + SPI_SSPCPSR_OFFSET, prescale);
-            uint32_t cr0 = reg_read(state->base + SPI_SSPCR0_OFFSET);
-            cr0 = (cr0 & 0xFF) | (scr << 8);
-            reg_write(state->base + SPI_SSPCR0_OFFSET, cr0);
-            state->clock_hz = s_sys_clock_hz / (prescale * (scr + 1));
-            return state->clock_hz;
-        }
-        prescale += 2;
-    }
-    
-    /* Couldn't achieve requested frequency */
-    return 0;
-}
-
-int hal_spi_transfer(hal_spi_t spi, const uint8_t* tx, uint8_t* rx, uint32_t len) {
-    spi_state_t* state = (spi_state_t*)spi;
-    uint32_t base = state->base;
-    
-    for (uint32_t i = 0; i < len; i++) {
-        /* Wait for TX FIFO not full */
-        while (reg_read(base + SPI_SSPSR_OFFSET) & SPI_SSPSR_BSY) {}
-        
-        /* Write data */
-        uint8_t out = tx ? tx[i] : 0xFF;
-        reg_write(base + SPI_SSPDR_OFFSET, out);
-        
-        /* Wait for RX data */
-        while (!(reg_read(base + SPI_SSPSR_OFFSET) & SPI_SSPSR_RNE)) {}
-        
-        /* Read data */
-        uint8_t in = reg_read(base + SPI_SSPDR_OFFSET) & 0xFF;
-        if (rx) rx[i] = in;
-    }
+    /* We'll set boot source when storage is mounted */
+#if defined(MIMIBOOT_SDIO)
+    info->boot_source = MIMI_SOURCE_SDIO;
+#else
+    info->boot_source = MIMI_SOURCE_SD;
+#endif
     
-    return 0;
+    info->chip_id = 0x2040;
+    info->platform_name = "RP2040";
 }
 
-/*============================================================================
- * Storage - delegates to SD card driver
- *============================================================================*/
-
-/* Forward declarations - implemented in sd_spi.c */
-extern int sd_init(void);
-extern int sd_read_blocks(uint32_t block, uint8_t* buffer, uint32_t count);
-extern uint32_t sd_get_block_count(void);
-
-static bool s_storage_initialized = false;
-static uint32_t s_sd_block_count = 0;
-
-int hal_storage_init(void) {
-    if (s_storage_initialized) return 0;
-    
-    /* Configure SPI pins for SD card */
-    /* CS as GPIO output */
-    hal_gpio_set_mode(SD_CS_PIN, HAL_GPIO_OUTPUT);
-    hal_gpio_write(SD_CS_PIN, true);  /* CS high (deselected) */
-    
-    /* SCK, MOSI, MISO as SPI function */
-    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(SD_SCK_PIN), 1);   /* SPI */
-    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(SD_MOSI_PIN), 1);
-    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(SD_MISO_PIN), 1);
-    
-    /* Configure pads */
-    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(SD_SCK_PIN),
-        PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_DRIVE_4MA);
-    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(SD_MOSI_PIN),
-        PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_DRIVE_4MA);
-    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(SD_MISO_PIN),
-        PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_PUE);  /* Pull-up on MISO */
-    
-    /* Initialize SPI at slow speed for SD init */
-    hal_spi_config_t spi_cfg = {
-        .clock_hz = 400000,     /* 400kHz for init */
-        .mode = 0,
-        .msb_first = true
-    };
-    
-    hal_spi_t spi;
-    if (hal_spi_init(&spi, SD_SPI_INST, &spi_cfg) != 0) {
-        return -1;
-    }
+/**
+ * Find a boot ROM function by its two-character code.
+ */
+void* rp2xxx_rom_func_lookup(char c1, char c2) {
+    rom_table_lookup_fn lookup =
+        (rom_table_lookup_fn)(uintptr_t)*(const uint16_t*)ROM_TABLE_LOOKUP_PTR;
+    uint16_t* table = (uint16_t*)(uintptr_t)*(const uint16_t*)ROM_FUNC_TABLE_PTR;
     
-    s_storage_initialized = true;
-    return 0;
+    return lookup(table, ROM_TABLE_CODE(c1, c2));
 }
 
-int hal_storage_open(hal_storage_t* dev) {
-    if (!s_storage_initialized) {
-        if (hal_storage_init() != 0) return -1;
-    }
-    
-    /* Initialize SD card */
-    if (sd_init() != 0) {
-        return -1;
-    }
-    
-    /* Speed up SPI after init */
-    hal_spi_set_clock(&s_spi_state[SD_SPI_INST], 25000000);  /* 25MHz */
-    
-    s_sd_block_count = sd_get_block_count();
-    
-    *dev = (void*)1;  /* Non-null handle */
-    return 0;
+void hal_get_mem_accel(mimi_copy4_fn* copy4, mimi_set4_fn* set4) {
+    /* Hand-tuned Thumb routines in the boot ROM */
+    *copy4 = (mimi_copy4_fn)rp2xxx_rom_func_lookup('C', '4');  /* memcpy44 */
+    *set4 = (mimi_set4_fn)rp2xxx_rom_func_lookup('S', '4');    /* memset4 */
 }
 
-void hal_storage_close(hal_storage_t dev) {
-    (void)dev;
-    /* Nothing to do for SD */
-}
+/* Write target of CRC transfers - the data itself is discarded */
+static uint32_t s_crc_sink;
 
-int hal_storage_info(hal_storage_t dev, hal_storage_info_t* info) {
-    (void)dev;
-    info->sector_size = 512;
-    info->sector_count = s_sd_block_count;
-    info->total_size = s_sd_block_count * 512;
-    info->readonly = false;
-    info->name = "SD Card";
-    return 0;
+MIMI_RAMFUNC
+static uint32_t bit_reverse(uint32_t x) {
+    x = ((x >> 1) & 0x55555555) | ((x & 0x55555555) << 1);
+    x = ((x >> 2) & 0x33333333) | ((x & 0x33333333) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F) | ((x & 0x0F0F0F0F) << 4);
+    x = ((x >> 8) & 0x00FF00FF) | ((x & 0x00FF00FF) << 8);
+    return (x >> 16) | (x << 16);
 }
 
-int32_t hal_storage_read(hal_storage_t dev, uint32_t offset, void* buffer, uint32_t size) {
-    (void)dev;
-    
-    uint8_t* buf = (uint8_t*)buffer;
-    uint32_t block = offset / 512;
-    uint32_t block_offset = offset % 512;
-    uint32_t bytes_read = 0;
-    uint8_t temp_block[512];
-    
-    while (bytes_read < size) {
-        /* Read block */
-        if (sd_read_blocks(block, temp_block, 1) != 0) {
-            return -1;
-        }
-        
-        /* Copy relevant portion */
-        uint32_t copy_start = (bytes_read == 0) ? block_offset : 0;
-        uint32_t copy_len = 512 - copy_start;
-        if (copy_len > (size - bytes_read)) {
-            copy_len = size - bytes_read;
-        }
-        
-        for (uint32_t i = 0; i < copy_len; i++) {
-            buf[bytes_read + i] = temp_block[copy_start + i];
-        }
-        
-        bytes_read += copy_len;
-        block++;
+/**
+ * CRC-32 through the DMA sniffer: a channel reads the block into a
+ * dummy word at a byte per clock and the sniffer accumulates it.
+ */
+MIMI_RAMFUNC
+static uint32_t hal_crc32_dma(uint32_t crc, const void* data, uint32_t size) {
+    uint32_t ch = DMA_CH_BASE(CRC_DMA_CHAN);
+    
+    /* Accumulator runs MSB-first over reversed bytes: seed accordingly */
+    reg_write(DMA_BASE + DMA_SNIFF_DATA_OFFSET, bit_reverse(~crc));
+    reg_write(DMA_BASE + DMA_SNIFF_CTRL_OFFSET,
+        DMA_SNIFF_CTRL_EN | DMA_SNIFF_CTRL_DMACH(CRC_DMA_CHAN) |
+        DMA_SNIFF_CTRL_CALC_CRC32R | DMA_SNIFF_CTRL_OUT_REV | DMA_SNIFF_CTRL_OUT_INV);
+    
+    reg_write(ch + DMA_CH_READ_ADDR_OFFSET, (uint32_t)(uintptr_t)data);
+    reg_write(ch + DMA_CH_WRITE_ADDR_OFFSET, (uint32_t)(uintptr_t)&s_crc_sink);
+    reg_write(ch + DMA_CH_TRANS_COUNT_OFFSET, size);
+    reg_write(ch + DMA_CH_CTRL_TRIG_OFFSET,
+        DMA_CTRL_EN | DMA_CTRL_DATA_SIZE_BYTE | DMA_CTRL_INCR_READ |
+        DMA_CTRL_CHAIN_TO(CRC_DMA_CHAN) | DMA_CTRL_TREQ_SEL(DREQ_FORCE) |
+        DMA_CTRL_IRQ_QUIET | DMA_CTRL_SNIFF_EN);
+    
+    while (reg_read(ch + DMA_CH_CTRL_TRIG_OFFSET) & DMA_CTRL_BUSY) {
+        /* spin */
     }
     
-    return bytes_read;
+    return reg_read(DMA_BASE + DMA_SNIFF_DATA_OFFSET);
 }
 
-/*============================================================================
- * System Control
- *============================================================================*/
-
-__attribute__((noreturn))
-void hal_system_reset(void) {
-    /* Use watchdog for reset */
-    reg_write(WATCHDOG_BASE + WATCHDOG_CTRL_OFFSET, 
-        WATCHDOG_CTRL_TRIGGER);
-    
-    while (1) {
-        __asm__ volatile ("wfi");
-    }
-}
-
-__attribute__((noreturn))
-void hal_system_halt(void) {
-    /* Blink LED forever */
-    hal_gpio_set_mode(LED_PIN, HAL_GPIO_OUTPUT);
-    
-    while (1) {
-        hal_led_blink(3, 100, 100);
-        hal_delay_ms(1000);
-    }
+mimi_crc32_fn hal_get_crc_accel(void) {
+    return hal_crc32_dma;
 }
 
 /*============================================================================
- * LED
+ * Timing
  *============================================================================*/
 
-void hal_led_set(bool on) {
-    static bool led_initialized = false;
-    if (!led_initialized) {
-        hal_gpio_set_mode(LED_PIN, HAL_GPIO_OUTPUT);
-        led_initialized = true;
-    }
-    hal_gpio_write(LED_PIN, on);
-}
-
-void hal_led_blink(uint32_t count, uint32_t on_ms, uint32_t off_ms) {
-    for (uint32_t i = 0; i < count; i++) {
-        hal_led_set(true);
-        hal_delay_ms(on_ms);
-        hal_led_set(false);
-        hal_delay_ms(off_ms);
-    }
+MIMI_RAMFUNC
+uint32_t hal_get_time_us(void) {
+    /* RP2040 timer runs at 1MHz */
+    return reg_read(TIMER_BASE + TIMER_TIMELR_OFFSET);
 }
@@ -28,6 +28,27 @@
 #define IOPORT_BASE         0xD0000000
 #define CORTEX_M_BASE       0xE0000000
 
+/*============================================================================
+ * Boot ROM Function Table
+ *============================================================================*/
+
+#define ROM_FUNC_TABLE_PTR      0x00000014  /* uint16_t pointer to function table */
+#define ROM_DATA_TABLE_PTR      0x00000016  /* uint16_t pointer to data table */
+#define ROM_TABLE_LOOKUP_PTR    0x00000018  /* uint16_t pointer to lookup function */
+
+#define ROM_TABLE_CODE(c1, c2)  ((uint32_t)(c1) | ((uint32_t)(c2) << 8))
+
+typedef void* (*rom_table_lookup_fn)(uint16_t* table, uint32_t code);
+
+/* Flash programming routines ('IF', 'EX', 'RE', 'RP', 'FC') */
+typedef void (*rom_void_fn)(void);
+typedef void (*rom_flash_erase_fn)(uint32_t addr, uint32_t count, uint32_t block_size, uint8_t block_cmd);
+typedef void (*rom_flash_program_fn)(uint32_t addr, const uint8_t* data, uint32_t count);
+
+#define FLASH_PAGE_SIZE         256         /* Program granularity */
+#define FLASH_SECTOR_SIZE       4096        /* Erase granularity */
+#define FLASH_SECTOR_ERASE_CMD  0x20
+
 /*============================================================================
  * Register Aliases (atomic access)
  *============================================================================*/
@@ -142,6 +163,15 @@
 #define SIO_GPIO_OE_SET_OFFSET      0x24
 #define SIO_GPIO_OE_CLR_OFFSET      0x28
 #define SIO_GPIO_OE_XOR_OFFSET      0x2C
+#define SIO_FIFO_ST_OFFSET          0x50    /* Inter-core FIFO status */
+#define SIO_FIFO_WR_OFFSET          0x54    /* Write to the other core */
+#define SIO_FIFO_RD_OFFSET          0x58    /* Read from the other core */
+
+/* FIFO_ST bits */
+#define SIO_FIFO_ST_ROE             (1 << 3)    /* Read on empty (sticky) */
+#define SIO_FIFO_ST_WOF             (1 << 2)    /* Write on full (sticky) */
+#define SIO_FIFO_ST_RDY             (1 << 1)    /* TX FIFO not full */
+#define SIO_FIFO_ST_VLD             (1 << 0)    /* RX FIFO not empty */
 
 /*============================================================================
  * UART
@@ -193,6 +223,10 @@
 #define UART_CR_LBE         (1 << 7)    /* Loopback enable */
 #define UART_CR_UARTEN      (1 << 0)    /* UART enable */
 
+/* DMA control register bits */
+#define UART_DMACR_TXDMAE   (1 << 1)    /* TX DMA enable */
+#define UART_DMACR_RXDMAE   (1 << 0)    /* RX DMA enable */
+
 /*============================================================================
  * SPI
  *============================================================================*/
@@ -233,6 +267,139 @@
 #define SPI_SSPSR_TNF           (1 << 1)    /* TX FIFO not full */
 #define SPI_SSPSR_TFE           (1 << 0)    /* TX FIFO empty */
 
+/* DMA control bits */
+#define SPI_SSPDMACR_TXDMAE     (1 << 1)    /* TX DMA enable */
+#define SPI_SSPDMACR_RXDMAE     (1 << 0)    /* RX DMA enable */
+
+/*============================================================================
+ * DMA
+ *============================================================================*/
+
+#define DMA_BASE            0x50000000
+
+/* Per-channel registers (channel n at DMA_BASE + n * DMA_CH_STRIDE) */
+#define DMA_CH_STRIDE           0x40
+#define DMA_CH_BASE(n)          (DMA_BASE + (n) * DMA_CH_STRIDE)
+
+#define DMA_CH_READ_ADDR_OFFSET     0x00
+#define DMA_CH_WRITE_ADDR_OFFSET    0x04
+#define DMA_CH_TRANS_COUNT_OFFSET   0x08
+#define DMA_CH_CTRL_TRIG_OFFSET     0x0C    /* Control (write triggers) */
+#define DMA_CH_AL1_CTRL_OFFSET      0x10    /* Control (no trigger) */
+
+/* Global registers */
+#define DMA_MULTI_CHAN_TRIGGER_OFFSET   0x430
+#define DMA_SNIFF_CTRL_OFFSET           0x434
+#define DMA_SNIFF_DATA_OFFSET           0x438
+#define DMA_CHAN_ABORT_OFFSET           0x444
+
+/* CTRL bits */
+#define DMA_CTRL_EN                 (1 << 0)
+#define DMA_CTRL_HIGH_PRIORITY      (1 << 1)
+#define DMA_CTRL_DATA_SIZE_BYTE     (0 << 2)
+#define DMA_CTRL_DATA_SIZE_HALFWORD (1 << 2)
+#define DMA_CTRL_DATA_SIZE_WORD     (2 << 2)
+#define DMA_CTRL_INCR_READ          (1 << 4)
+#define DMA_CTRL_INCR_WRITE         (1 << 5)
+#define DMA_CTRL_RING_SIZE(n)       ((n) << 6)      /* Wrap at 1 << n bytes */
+#define DMA_CTRL_RING_SEL           (1 << 10)       /* Wrap write, not read */
+#define DMA_CTRL_CHAIN_TO(n)        ((n) << 11)     /* Chain to self = none */
+#define DMA_CTRL_TREQ_SEL(n)        ((n) << 15)
+#define DMA_CTRL_IRQ_QUIET          (1 << 21)
+#define DMA_CTRL_BSWAP              (1 << 22)
+#define DMA_CTRL_SNIFF_EN           (1 << 23)
+#define DMA_CTRL_BUSY               (1 << 24)
+#define DMA_CTRL_WRITE_ERROR        (1 << 29)
+#define DMA_CTRL_READ_ERROR         (1 << 30)
+#define DMA_CTRL_AHB_ERROR          (1u << 31)
+
+/* SNIFF_CTRL bits */
+#define DMA_SNIFF_CTRL_EN           (1 << 0)
+#define DMA_SNIFF_CTRL_DMACH(n)     ((n) << 1)
+#define DMA_SNIFF_CTRL_CALC_CRC32R  (1 << 5)        /* CRC-32, bit-reversed data */
+#define DMA_SNIFF_CTRL_OUT_REV      (1 << 10)       /* Result bit-reversed on read */
+#define DMA_SNIFF_CTRL_OUT_INV      (1 << 11)       /* Result inverted on read */
+
+/* Transfer request (DREQ) sources */
+#define DREQ_PIO0_TX(sm)    (sm)
+#define DREQ_PIO0_RX(sm)    (4 + (sm))
+#define DREQ_SPI0_TX        16
+#define DREQ_SPI0_RX        17
+#define DREQ_SPI1_TX        18
+#define DREQ_SPI1_RX        19
+#define DREQ_UART0_TX       20
+#define DREQ_UART0_RX       21
+#define DREQ_FORCE          0x3F    /* Unpaced (memory-to-memory) */
+
+/*============================================================================
+ * PIO
+ *============================================================================*/
+
+#define PIO0_BASE           0x50200000
+#define PIO1_BASE           0x50300000
+
+#define PIO_CTRL_OFFSET             0x000
+#define PIO_FSTAT_OFFSET            0x004
+#define PIO_FDEBUG_OFFSET           0x008
+#define PIO_FLEVEL_OFFSET           0x00C
+#define PIO_TXF_OFFSET(sm)          (0x010 + (sm) * 4)
+#define PIO_RXF_OFFSET(sm)          (0x020 + (sm) * 4)
+#define PIO_IRQ_OFFSET              0x030
+#define PIO_INPUT_SYNC_BYPASS_OFFSET 0x038
+#define PIO_INSTR_MEM_OFFSET(n)     (0x048 + (n) * 4)
+
+/* Per state machine registers */
+#define PIO_SM_STRIDE               0x18
+#define PIO_SM_CLKDIV_OFFSET(sm)    (0x0C8 + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_EXECCTRL_OFFSET(sm)  (0x0CC + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_SHIFTCTRL_OFFSET(sm) (0x0D0 + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_ADDR_OFFSET(sm)      (0x0D4 + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_INSTR_OFFSET(sm)     (0x0D8 + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_PINCTRL_OFFSET(sm)   (0x0DC + (sm) * PIO_SM_STRIDE)
+
+#define PIO_INSTR_MEM_SIZE          32
+
+/* CTRL bits */
+#define PIO_CTRL_SM_ENABLE(sm)      (1 << (sm))
+#define PIO_CTRL_SM_RESTART(sm)     (1 << (4 + (sm)))
+#define PIO_CTRL_CLKDIV_RESTART(sm) (1 << (8 + (sm)))
+
+/* FSTAT bits */
+#define PIO_FSTAT_RXFULL(sm)        (1 << (sm))
+#define PIO_FSTAT_RXEMPTY(sm)       (1 << (8 + (sm)))
+#define PIO_FSTAT_TXFULL(sm)        (1 << (16 + (sm)))
+#define PIO_FSTAT_TXEMPTY(sm)       (1 << (24 + (sm)))
+
+/* CLKDIV fields (16.8 fixed point) */
+#define PIO_CLKDIV_INT_SHIFT        16
+#define PIO_CLKDIV_FRAC_SHIFT       8
+
+/* EXECCTRL fields */
+#define PIO_EXECCTRL_JMP_PIN(n)     ((n) << 24)
+#define PIO_EXECCTRL_WRAP_TOP(n)    ((n) << 12)
+#define PIO_EXECCTRL_WRAP_BOTTOM(n) ((n) << 7)
+#define PIO_EXECCTRL_STATUS_RX      (1 << 4)    /* STATUS from RX level (else TX) */
+#define PIO_EXECCTRL_STATUS_N(n)    (n)
+
+/* SHIFTCTRL fields */
+#define PIO_SHIFTCTRL_FJOIN_RX      (1u << 31)
+#define PIO_SHIFTCTRL_FJOIN_TX      (1 << 30)
+#define PIO_SHIFTCTRL_PULL_THRESH(n) (((n) & 0x1F) << 25)   /* 0 = 32 */
+#define PIO_SHIFTCTRL_PUSH_THRESH(n) (((n) & 0x1F) << 20)   /* 0 = 32 */
+#define PIO_SHIFTCTRL_OUT_SHIFTDIR_RIGHT (1 << 19)
+#define PIO_SHIFTCTRL_IN_SHIFTDIR_RIGHT  (1 << 18)
+#define PIO_SHIFTCTRL_AUTOPULL      (1 << 17)
+#define PIO_SHIFTCTRL_AUTOPUSH      (1 << 16)
+
+/* PINCTRL fields */
+#define PIO_PINCTRL_SIDESET_COUNT(n) ((n) << 29)
+#define PIO_PINCTRL_SET_COUNT(n)    ((n) << 26)
+#define PIO_PINCTRL_OUT_COUNT(n)    ((n) << 20)
+#define PIO_PINCTRL_IN_BASE(n)      ((n) << 15)
+#define PIO_PINCTRL_SIDESET_BASE(n) ((n) << 10)
+#define PIO_PINCTRL_SET_BASE(n)     ((n) << 5)
+#define PIO_PINCTRL_OUT_BASE(n)     (n)
+
 /*============================================================================
  * Timer
  *============================================================================*/
@@ -283,13 +450,28 @@
 #define WATCHDOG_CTRL_PAUSE_DBG0    (1 << 25)
 #define WATCHDOG_CTRL_PAUSE_JTAG    (1 << 24)
 
+/* REASON bits (cleared by power-on and RUN-pin resets) */
+#define WATCHDOG_REASON_TIMER       (1 << 0)
+#define WATCHDOG_REASON_FORCE       (1 << 1)
+
 /*============================================================================
  * PSM (Power-on State Machine) / VREG_AND_CHIP_RESET
  *============================================================================*/
 
+#define PSM_BASE                    0x40010000
+
+#define PSM_FRCE_OFF_OFFSET         0x04
+
+#define PSM_PROC1                   (1 << 16)
+
 #define VREG_AND_CHIP_RESET_BASE    0x40064000
 
-#define CHIP_RESET_OFFSET           0x00
+#define CHIP_RESET_OFFSET           0x08
+
+/* CHIP_RESET bits */
+#define CHIP_RESET_HAD_POR          (1 << 8)
+#define CHIP_RESET_HAD_RUN          (1 << 16)
+#define CHIP_RESET_HAD_PSM_RESTART  (1 << 20)
 
 /*============================================================================
  * Cortex-M0+ Core Registers
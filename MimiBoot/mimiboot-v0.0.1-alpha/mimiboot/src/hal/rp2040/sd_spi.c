@@ -10,7 +10,11 @@
  */
 
 #include "../hal.h"
+#if defined(TARGET_RP2350)
+#include "../rp2350/rp2350_regs.h"
+#else
 #include "rp2040_regs.h"
+#endif
 #include <stddef.h>
 
 /*============================================================================
@@ -20,6 +24,7 @@
 /* Commands */
 #define CMD0    0       /* GO_IDLE_STATE */
 #define CMD1    1       /* SEND_OP_COND (MMC) */
+#define CMD6    6       /* SWITCH_FUNC */
 #define CMD8    8       /* SEND_IF_COND */
 #define CMD9    9       /* SEND_CSD */
 #define CMD10   10      /* SEND_CID */
@@ -53,6 +58,9 @@
 #define SD_CMD_TIMEOUT      100
 #define SD_READ_TIMEOUT     100000
 
+/* Blocks read with CRC checking to qualify a clock rate */
+#define SD_CLOCK_PROBE_READS    4
+
 /*============================================================================
  * Pin Configuration (must match hal_rp2040.c)
  *============================================================================*/
@@ -67,7 +75,12 @@
 static struct {
     bool initialized;
     bool sdhc;              /* SDHC/SDXC (block addressing) vs SD (byte addressing) */
+    bool check_crc;         /* Verify data CRC16 on block reads */
     uint32_t block_count;
+    
+    /* Statistics */
+    uint32_t cmd_count;     /* Commands sent */
+    uint32_t blocks_read;   /* Data blocks received */
 } s_sd;
 
 /*============================================================================
@@ -92,19 +105,30 @@ static inline void sd_cs_high(void) {
     hal_gpio_write(SD_CS_PIN, true);
 }
 
+MIMI_RAMFUNC
 static uint8_t sd_spi_byte(uint8_t out) {
     uint8_t in;
     hal_spi_transfer(&s_spi_state[SD_SPI_INST], &out, &in, 1);
     return in;
 }
 
+MIMI_RAMFUNC
 static void sd_spi_bytes(const uint8_t* tx, uint8_t* rx, uint32_t len) {
     hal_spi_transfer(&s_spi_state[SD_SPI_INST], tx, rx, len);
 }
 
+/**
+ * Receive a data block (DMA-driven where the HAL supports it).
+ */
+MIMI_RAMFUNC
+static int sd_spi_receive(uint8_t* rx, uint32_t len) {
+    return hal_spi_receive(&s_spi_state[SD_SPI_INST], rx, len);
+}
+
 /**
  * Wait for card to be ready (not busy).
  */
+MIMI_RAMFUNC
 static int sd_wait_ready(uint32_t timeout) {
     for (uint32_t i = 0; i < timeout; i++) {
         if (sd_spi_byte(0xFF) == 0xFF) {
@@ -121,6 +145,7 @@ static int sd_wait_ready(uint32_t timeout) {
 /**
  * Calculate CRC7 for SD commands.
  */
+MIMI_RAMFUNC
 static uint8_t sd_crc7(const uint8_t* data, uint32_t len) {
     uint8_t crc = 0;
     for (uint32_t i = 0; i < len; i++) {
@@ -139,6 +164,7 @@ static uint8_t sd_crc7(const uint8_t* data, uint32_t len) {
 /**
  * Send SD command and get R1 response.
  */
+MIMI_RAMFUNC
 static uint8_t sd_command(uint8_t cmd, uint32_t arg) {
     uint8_t frame[6];
     uint8_t resp;
@@ -148,6 +174,8 @@ static uint8_t sd_command(uint8_t cmd, uint32_t arg) {
         return 0xFF;
     }
     
+    s_sd.cmd_count++;
+    
     /* Build command frame */
     frame[0] = 0x40 | cmd;
     frame[1] = (arg >> 24) & 0xFF;
@@ -191,6 +219,7 @@ int sd_init(void) {
     
     s_sd.initialized = false;
     s_sd.sdhc = false;
+    s_sd.check_crc = false;
     s_sd.block_count = 0;
     
     /* CS high, send 80+ clock pulses to wake up card */
@@ -256,7 +285,7 @@ int sd_init(void) {
         
         /* Check CCS bit (bit 30 of OCR) */
         s_sd.sdhc = (ocr[0] & 0x40) != 0;
-        
+    
     } else if (resp == (R1_IDLE_STATE | R1_ILLEGAL_CMD)) {
         /* SD v1.x or MMC card */
         s_sd.sdhc = false;
@@ -291,7 +320,7 @@ int sd_init(void) {
             sd_cs_high();
             return -6;
         }
-        
+    
     } else {
         sd_cs_high();
         return -7;
@@ -346,6 +375,64 @@ int sd_init(void) {
  * Block Read
  *============================================================================*/
 
+/**
+ * Calculate CRC16-CCITT (XMODEM) as used by the SD data phase.
+ */
+MIMI_RAMFUNC
+static uint16_t sd_crc16(const uint8_t* data, uint32_t len) {
+    uint16_t crc = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc >> 8) | (crc << 8));
+        crc ^= data[i];
+        crc ^= (crc & 0xFF) >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0xFF) << 5;
+    }
+    return crc;
+}
+
+/**
+ * Receive one data block: wait for the start token, read the payload
+ * and its CRC16. The CRC is only checked when s_sd.check_crc is set.
+ * 
+ * @return  0 on success, -1 token timeout, -2 error token,
+ *          -3 transfer error, -4 CRC mismatch
+ */
+MIMI_RAMFUNC
+static int sd_read_data(uint8_t* buffer, uint32_t len) {
+    uint8_t resp = 0xFF;
+    
+    /* Wait for data token */
+    for (int i = 0; i < SD_READ_TIMEOUT; i++) {
+        resp = sd_spi_byte(0xFF);
+        if (resp == DATA_TOKEN_CMD17) break;
+        if ((resp & 0xF0) == 0x00) {
+            /* Error token */
+            return -2;
+        }
+    }
+    
+    if (resp != DATA_TOKEN_CMD17) {
+        return -1;
+    }
+    
+    /* Read data */
+    if (sd_spi_receive(buffer, len) != 0) {
+        return -3;
+    }
+    
+    /* CRC16 follows the data, MSB first */
+    uint16_t crc = (uint16_t)(sd_spi_byte(0xFF) << 8);
+    crc |= sd_spi_byte(0xFF);
+    
+    if (s_sd.check_crc && crc != sd_crc16(buffer, len)) {
+        return -4;
+    }
+    
+    return 0;
+}
+
+MIMI_RAMFUNC
 int sd_read_blocks(uint32_t block, uint8_t* buffer, uint32_t count) {
     if (!s_sd.initialized) {
         return -1;
@@ -364,29 +451,11 @@ int sd_read_blocks(uint32_t block, uint8_t* buffer, uint32_t count) {
             return -2;
         }
         
-        /* Wait for data token */
-        for (int i = 0; i < SD_READ_TIMEOUT; i++) {
-            resp = sd_spi_byte(0xFF);
-            if (resp == DATA_TOKEN_CMD17) break;
-            if ((resp & 0xF0) == 0x00) {
-                /* Error token */
-                sd_cs_high();
-                return -3;
-            }
-        }
-        
-        if (resp != DATA_TOKEN_CMD17) {
+        if (sd_read_data(buffer, 512) != 0) {
             sd_cs_high();
-            return -4;
+            return -3;
         }
-        
-        /* Read data */
-        sd_spi_bytes(NULL, buffer, 512);
-        
-        /* Skip CRC */
-        sd_spi_byte(0xFF);
-        sd_spi_byte(0xFF);
-        
+    
     } else {
         /* Multiple block read */
         resp = sd_command(CMD18, addr);
@@ -396,24 +465,11 @@ int sd_read_blocks(uint32_t block, uint8_t* buffer, uint32_t count) {
         }
         
         for (uint32_t b = 0; b < count; b++) {
-            /* Wait for data token */
-            for (int i = 0; i < SD_READ_TIMEOUT; i++) {
-                resp = sd_spi_byte(0xFF);
-                if (resp == DATA_TOKEN_CMD18) break;
-            }
-            
-            if (resp != DATA_TOKEN_CMD18) {
+            if (sd_read_data(buffer + (b * 512), 512) != 0) {
                 sd_command(CMD12, 0);
                 sd_cs_high();
                 return -6;
             }
-            
-            /* Read data */
-            sd_spi_bytes(NULL, buffer + (b * 512), 512);
-            
-            /* Skip CRC */
-            sd_spi_byte(0xFF);
-            sd_spi_byte(0xFF);
         }
         
         /* Stop transmission */
@@ -422,9 +478,112 @@ int sd_read_blocks(uint32_t block, uint8_t* buffer, uint32_t count) {
     }
     
     sd_cs_high();
+    s_sd.blocks_read += count;
     return 0;
 }
 
+/*============================================================================
+ * Clock Negotiation
+ *============================================================================*/
+
+/**
+ * Ask the card to switch to high-speed timing (CMD6, function group 1).
+ * 
+ * Best effort: SD v1.0 cards and cards without high-speed support
+ * simply stay in default-speed mode.
+ * 
+ * @return  0 if the card reports high-speed mode active, negative otherwise
+ */
+static int sd_switch_high_speed(void) {
+    uint8_t status[64];
+    
+    sd_cs_low();
+    
+    /* Mode 1 (switch), groups 6-2 unchanged, group 1 = function 1 */
+    if (sd_command(CMD6, 0x80FFFFF1) != 0) {
+        sd_cs_high();
+        return -1;
+    }
+    
+    int err = sd_read_data(status, sizeof(status));
+    sd_cs_high();
+    
+    /* 8 clocks for the card to apply the new timing */
+    sd_spi_byte(0xFF);
+    
+    if (err != 0) {
+        return -2;
+    }
+    
+    /* Bits 379:376 - function selected in group 1 */
+    return ((status[16] & 0x0F) == 1) ? 0 : -3;
+}
+
+/**
+ * Read a few blocks with CRC checking enabled at the current clock.
+ */
+static bool sd_probe_clock(void) {
+    uint8_t buffer[512];
+    bool ok = true;
+    
+    s_sd.check_crc = true;
+    
+    for (int i = 0; i < SD_CLOCK_PROBE_READS && ok; i++) {
+        ok = (sd_read_blocks(0, buffer, 1) == 0);
+    }
+    
+    s_sd.check_crc = false;
+    
+    if (!ok) {
+        /* Let the card finish/abandon whatever it was sending */
+        for (int i = 0; i < 16; i++) {
+            sd_spi_byte(0xFF);
+        }
+    }
+    
+    return ok;
+}
+
+uint32_t sd_negotiate_clock(uint32_t max_hz, uint32_t safe_hz) {
+    hal_spi_t spi = &s_spi_state[SD_SPI_INST];
+    
+    if (!s_sd.initialized) {
+        return 0;
+    }
+    
+    /* Give the card its best shot at the faster clocks */
+    if (max_hz > safe_hz) {
+        sd_switch_high_speed();
+    }
+    
+    /*
+     * Walk down the achievable SPI clocks from max_hz. Each step asks for
+     * just below the previous actual rate, so hal_spi_set_clock lands on
+     * the next lower divider.
+     */
+    uint32_t request = max_hz;
+    while (request > safe_hz) {
+        uint32_t actual = hal_spi_set_clock(spi, request);
+        if (actual == 0 || actual <= safe_hz) {
+            break;
+        }
+        
+        if (sd_probe_clock()) {
+            return actual;
+        }
+        
+        request = actual - 1;
+    }
+    
+    /* Spec-guaranteed default-speed clock */
+    uint32_t actual = hal_spi_set_clock(spi, safe_hz);
+    if (actual == 0 || !sd_probe_clock()) {
+        return 0;
+    }
+    
+    return actual;
+}
+
 /*============================================================================
  * Utility Functions
  *============================================================================*/
@@ -440,3 +599,8 @@ bool sd_is_initialized(void) {
 bool sd_is_sdhc(void) {
     return s_sd.sdhc;
 }
+
+void sd_get_stats(uint32_t* commands, uint32_t* blocks_read) {
+    *commands = s_sd.cmd_count;
+    *blocks_read = s_sd.blocks_read;
+}
@@ -0,0 +1,298 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * hal_rp2350.c - RP2350 Hardware Abstraction Layer
+ * 
+ * This file implements the HAL interface for the Raspberry Pi Pico 2
+ * (RP2350, Arm Cortex-M33 cores in secure mode).
+ * 
+ * Only what differs from the RP2040 lives here; the console, GPIO,
+ * SPI, storage, second core, flash and retained words are shared
+ * (rp2xxx_common.c), as are the SD drivers, all built against
+ * rp2350_regs.h. What differs:
+ * - 150MHz system clock (SDK default), so the SPI, PIO (SDIO) and
+ *   UART dividers all start from a faster clock
+ * - Two striped SRAM groups, published as separate regions
+ * - No boot ROM memcpy: the M33 word loops in core/mem.c are used
+ * - The DMA sniffer CRC runs a word per transfer
+ * - No boot2: the boot ROM leaves the XIP setup function in boot RAM
+ * 
+ * Memory Map (RP2350):
+ * - Flash: 0x10000000, 4MB on Pico 2 (external QSPI)
+ * - SRAM:  0x20000000, 512KB as two groups of four striped banks
+ *          (SRAM0-3, SRAM4-7), then two 4KB scratch banks at
+ *          0x20080000 and 0x20081000 (SRAM8/9)
+ * - Peripherals: 0x40000000+
+ */
+
+#include "../rp2xxx_common.h"
+
+/*============================================================================
+ * Platform Constants
+ *============================================================================*/
+
+#define SRAM_SIZE           (520 * 1024)
+
+/* Two striped groups, then two 4KB scratch banks (SRAM8/9) */
+#define SCRATCH_BANK_SIZE   (4 * 1024)
+#define STRIPED_SIZE        (SRAM_SIZE - 2 * SCRATCH_BANK_SIZE)
+#define SRAM_GROUP1_BASE    (SRAM_BASE + SRAM_GROUP_SIZE)
+#define SCRATCH_X_BASE      (SRAM_BASE + STRIPED_SIZE)
+#define SCRATCH_Y_BASE      (SCRATCH_X_BASE + SCRATCH_BANK_SIZE)
+
+/*============================================================================
+ * Static State
+ *============================================================================*/
+
+static bool s_timer_initialized = false;
+
+/*============================================================================
+ * Initialization
+ *============================================================================*/
+
+int hal_init_early(void) {
+    /*
+     * By the time we run, the SDK runtime has the system in a usable
+     * state:
+     * - XOSC running
+     * - PLLs configured for 150MHz
+     * - Clocks distributed, tick generators (TIMER0) at 1MHz
+     *
+     * We just need to ensure peripherals we use are reset
+     * and out of reset state.
+     */
+    
+    /* Reset GPIO, UART, SPI, Timer - then release */
+    uint32_t reset_mask =
+        (1 << RESET_IO_BANK0) |
+        (1 << RESET_PADS_BANK0) |
+        (1 << RESET_UART0) |
+        (1 << RESET_SPI0) |
+        (1 << RESET_DMA) |
+        (1 << RESET_TIMER0);
+    
+    /* Assert reset */
+    reg_set_bits(RESETS_BASE + RESETS_RESET_OFFSET, reset_mask);
+    
+    /* Deassert reset */
+    reg_clear_bits(RESETS_BASE + RESETS_RESET_OFFSET, reset_mask);
+    
+    /* Wait for reset done */
+    while ((reg_read(RESETS_BASE + RESETS_RESET_DONE_OFFSET) & reset_mask) != reset_mask) {
+        /* spin */
+    }
+    
+    /* Initialize timer for timing functions */
+    s_timer_initialized = true;
+    
+    return 0;
+}
+
+/*
+ * The loader's share of striped SRAM, from linker/mimiboot_rp2350.ld.
+ * Without it (the SDK's default layout) data and BSS sit at the bottom.
+ */
+extern char __loader_ram_start__[] __attribute__((weak));
+extern char __loader_ram_end__[] __attribute__((weak));
+extern char __bss_end__[];
+
+static mimi_mem_region_t s_ram_regions[HAL_MAX_RAM_REGIONS];
+
+/**
+ * Add the free striped SRAM from lo to hi, split where one group of
+ * banks ends and the next begins.
+ */
+static uint32_t ram_regions_add_striped(uint32_t n, uint32_t lo, uint32_t hi) {
+    const uint32_t rwx = MIMI_MEM_READ | MIMI_MEM_WRITE | MIMI_MEM_EXEC | MIMI_MEM_RAM;
+    
+    if (lo < SRAM_GROUP1_BASE && hi > SRAM_GROUP1_BASE) {
+        s_ram_regions[n++] = (mimi_mem_region_t){ lo, SRAM_GROUP1_BASE - lo, rwx | MIMI_MEM_STRIPED };
+        lo = SRAM_GROUP1_BASE;
+    }
+    if (lo < hi) {
+        s_ram_regions[n++] = (mimi_mem_region_t){ lo, hi - lo, rwx | MIMI_MEM_STRIPED };
+    }
+    return n;
+}
+
+/**
+ * Split SRAM into the regions the loader may use, bank by bank.
+ * The loader's part is one region wherever it falls, so the free
+ * striped SRAM around it splits into at most three.
+ */
+static uint32_t ram_regions_build(void) {
+    const uint32_t rwx = MIMI_MEM_READ | MIMI_MEM_WRITE | MIMI_MEM_EXEC | MIMI_MEM_RAM;
+    
+    uint32_t lo = SRAM_BASE;
+    uint32_t hi = (uint32_t)(uintptr_t)__bss_end__;
+    if (__loader_ram_start__ != NULL && __loader_ram_end__ != NULL) {
+        lo = (uint32_t)(uintptr_t)__loader_ram_start__;
+        hi = (uint32_t)(uintptr_t)__loader_ram_end__;
+    }
+    hi = (hi + 3) & ~3u;
+    
+    uint32_t n = ram_regions_add_striped(0, SRAM_BASE, lo);
+    s_ram_regions[n++] = (mimi_mem_region_t){ lo, hi - lo, rwx | MIMI_MEM_STRIPED | MIMI_MEM_LOADER };
+    n = ram_regions_add_striped(n, hi, SCRATCH_X_BASE);
+    
+    /* Core 1 stack and bounce buffers (MIMI_SCRATCH_X), core 0 stack */
+    s_ram_regions[n++] = (mimi_mem_region_t){
+        SCRATCH_X_BASE, SCRATCH_BANK_SIZE, rwx | MIMI_MEM_SCRATCH | MIMI_MEM_LOADER };
+    s_ram_regions[n++] = (mimi_mem_region_t){
+        SCRATCH_Y_BASE, SCRATCH_BANK_SIZE, rwx | MIMI_MEM_SCRATCH | MIMI_MEM_LOADER };
+    return n;
+}
+
+void hal_get_platform_info(mimi_platform_info_t* info) {
+    uint32_t xip_offset = loader_flash_end();
+    
+    info->ram_base = SRAM_BASE;
+    info->ram_size = SRAM_SIZE;
+    info->ram_regions = s_ram_regions;
+    info->ram_region_count = ram_regions_build();
+    info->loader_base = FLASH_BASE + LOADER_OFFSET;
+    info->loader_size = xip_offset - LOADER_OFFSET;
+    info->xip_base = FLASH_BASE + xip_offset;
+    info->xip_size = CACHE_OFFSET - xip_offset;
+    info->nv_base = FLASH_BASE + CACHE_OFFSET;
+    info->nv_size = FLASH_SIZE - CACHE_OFFSET;
+    info->sys_clock_hz = SYS_CLK_HZ;
+    
+    /*
+     * The watchdog records its own resets (hal_system_reset forces one).
+     * POWMAN's CHIP_RESET records power-on and brown-out, the RUN pin
+     * and debugger resets, and like the RP2040's keeps them through the
+     * processor resets that follow. With the handoff mark still set
+     * the payload reset the processors itself (SYSRESETREQ, lockup),
+     * a warm reset; CHIP_RESET is only asked without it.
+     */
+    uint32_t wd_reason = reg_read(WATCHDOG_BASE + WATCHDOG_REASON_OFFSET);
+    uint32_t chip_reset = reg_read(POWMAN_BASE + POWMAN_CHIP_RESET_OFFSET);
+    
+    if (wd_reason & WATCHDOG_REASON_TIMER) {
+        info->reset_reason = MIMI_BOOT_WATCHDOG;
+    } else if (wd_reason & WATCHDOG_REASON_FORCE) {
+        info->reset_reason = MIMI_BOOT_WARM;
+    } else if (rp2xxx_handoff_marked()) {
+        info->reset_reason = MIMI_BOOT_WARM;
+    } else if (chip_reset & POWMAN_CHIP_RESET_HAD_DP_RESET_REQ) {
+        info->reset_reason = MIMI_BOOT_DEBUG;
+    } else if (chip_reset & POWMAN_CHIP_RESET_HAD_RUN_LOW) {
+        info->reset_reason = MIMI_BOOT_EXTERNAL;
+    } else if (chip_reset & (POWMAN_CHIP_RESET_HAD_POR | POWMAN_CHIP_RESET_HAD_BOR)) {
+        info->reset_reason = MIMI_BOOT_COLD;
+    } else {
+        info->reset_reason = MIMI_BOOT_WARM;
+    }
+    
+    /* We'll set boot source when storage is mounted */
+#if defined(MIMIBOOT_SDIO)
+    info->boot_source = MIMI_SOURCE_SDIO;
+#else
+    info->boot_source = MIMI_SOURCE_SD;
+#endif
+    
+    info->chip_id = 0x2350;
+    info->platform_name = "RP2350";
+}
+
+/**
+ * Find a secure Arm boot ROM function by its two-character code.
+ */
+void* rp2xxx_rom_func_lookup(char c1, char c2) {
+    rom_table_lookup_fn lookup =
+        (rom_table_lookup_fn)(uintptr_t)*(const uint16_t*)ROM_TABLE_LOOKUP_PTR;
+    
+    return lookup(ROM_TABLE_CODE(c1, c2), RT_FLAG_FUNC_ARM_SEC);
+}
+
+void hal_get_mem_accel(mimi_copy4_fn* copy4, mimi_set4_fn* set4) {
+    /*
+     * The RP2350 boot ROM has no memcpy44/memset4. The M33's own loops
+     * in core/mem.c (ldm/stm bodies, unaligned word loads) are as fast.
+     */
+    *copy4 = NULL;
+    *set4 = NULL;
+}
+
+/* Write target of CRC transfers - the data itself is discarded */
+static uint32_t s_crc_sink;
+
+/* A single RBIT on the M33 */
+MIMI_RAMFUNC
+static uint32_t bit_reverse(uint32_t x) {
+    uint32_t r;
+    __asm__ ("rbit %0, %1" : "=r"(r) : "r"(x));
+    return r;
+}
+
+/**
+ * Run count transfers of the given size (DMA_CTRL_DATA_SIZE_*) from
+ * data through the DMA sniffer, continuing from crc.
+ */
+MIMI_RAMFUNC
+static uint32_t crc_dma_run(uint32_t crc, const void* data, uint32_t count, uint32_t data_size) {
+    uint32_t ch = DMA_CH_BASE(CRC_DMA_CHAN);
+    
+    /* Accumulator runs MSB-first over reversed data: seed accordingly */
+    reg_write(DMA_BASE + DMA_SNIFF_DATA_OFFSET, bit_reverse(~crc));
+    reg_write(DMA_BASE + DMA_SNIFF_CTRL_OFFSET,
+        DMA_SNIFF_CTRL_EN | DMA_SNIFF_CTRL_DMACH(CRC_DMA_CHAN) |
+        DMA_SNIFF_CTRL_CALC_CRC32R | DMA_SNIFF_CTRL_OUT_REV | DMA_SNIFF_CTRL_OUT_INV);
+    
+    reg_write(ch + DMA_CH_READ_ADDR_OFFSET, (uint32_t)(uintptr_t)data);
+    reg_write(ch + DMA_CH_WRITE_ADDR_OFFSET, (uint32_t)(uintptr_t)&s_crc_sink);
+    reg_write(ch + DMA_CH_TRANS_COUNT_OFFSET, count);
+    reg_write(ch + DMA_CH_CTRL_TRIG_OFFSET,
+        DMA_CTRL_EN | data_size | DMA_CTRL_INCR_READ |
+        DMA_CTRL_CHAIN_TO(CRC_DMA_CHAN) | DMA_CTRL_TREQ_SEL(DREQ_FORCE) |
+        DMA_CTRL_IRQ_QUIET | DMA_CTRL_SNIFF_EN);
+    
+    while (reg_read(ch + DMA_CH_CTRL_TRIG_OFFSET) & DMA_CTRL_BUSY) {
+        /* spin */
+    }
+    
+    return reg_read(DMA_BASE + DMA_SNIFF_DATA_OFFSET);
+}
+
+/**
+ * CRC-32 through the DMA sniffer: a channel reads the block into a
+ * dummy word and the sniffer accumulates it. The aligned body goes a
+ * word per transfer; bit-reversing a little-endian word feeds its
+ * bytes in memory order, so the result matches the bytewise CRC.
+ * Unaligned head and tail bytes take a transfer each.
+ */
+MIMI_RAMFUNC
+static uint32_t hal_crc32_dma(uint32_t crc, const void* data, uint32_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t head = (4 - ((uint32_t)(uintptr_t)p & 3)) & 3;
+    
+    if (head > 0) {
+        crc = crc_dma_run(crc, p, head, DMA_CTRL_DATA_SIZE_BYTE);
+        p += head;
+        size -= head;
+    }
+    if (size >= 4) {
+        crc = crc_dma_run(crc, p, size / 4, DMA_CTRL_DATA_SIZE_WORD);
+        p += size & ~3u;
+        size &= 3;
+    }
+    if (size > 0) {
+        crc = crc_dma_run(crc, p, size, DMA_CTRL_DATA_SIZE_BYTE);
+    }
+    return crc;
+}
+
+mimi_crc32_fn hal_get_crc_accel(void) {
+    return hal_crc32_dma;
+}
+
+/*============================================================================
+ * Timing
+ *============================================================================*/
+
+MIMI_RAMFUNC
+uint32_t hal_get_time_us(void) {
+    /* TIMER0 runs at 1MHz */
+    return reg_read(TIMER0_BASE + TIMER_TIMELR_OFFSET);
+}
@@ -0,0 +1,517 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * rp2350_regs.h - RP2350 Hardware Register Definitions
+ * 
+ * Direct register definitions for RP2350 peripherals, as used from
+ * the Arm (Cortex-M33, secure) cores. Names follow rp2040_regs.h, so
+ * the shared SD drivers build against either header; values match the
+ * RP2350 datasheet. Where blocks were renamed (TIMER0, POWMAN) the
+ * RP2350 names are used.
+ */
+
+#ifndef MIMIBOOT_RP2350_REGS_H
+#define MIMIBOOT_RP2350_REGS_H
+
+#include <stdint.h>
+
+/*============================================================================
+ * Memory Map
+ *============================================================================*/
+
+#define ROM_BASE            0x00000000
+#define XIP_BASE            0x10000000
+#define XIP_MAIN_BASE       0x10000000
+#define SRAM_BASE           0x20000000
+#define SRAM_STRIPED_BASE   0x20000000
+#define SRAM_STRIPED_END    0x20080000
+
+/* SRAM0-3 and SRAM4-7 are striped as two separate groups */
+#define SRAM_GROUP_SIZE     (256 * 1024)
+
+#define APB_BASE            0x40000000
+#define AHB_BASE            0x50000000
+#define IOPORT_BASE         0xD0000000
+#define CORTEX_M_BASE       0xE0000000
+
+/* Boot RAM: the boot ROM leaves the flash XIP setup function here */
+#define BOOTRAM_BASE        0x400E0000
+
+/*============================================================================
+ * Boot ROM Function Table
+ *============================================================================*/
+
+#define ROM_TABLE_LOOKUP_PTR    0x00000016  /* uint16_t pointer to lookup function (Arm) */
+
+#define ROM_TABLE_CODE(c1, c2)  ((uint32_t)(c1) | ((uint32_t)(c2) << 8))
+
+/* Lookup flags: entry points callable from the secure Arm core */
+#define RT_FLAG_FUNC_ARM_SEC    0x0004
+
+typedef void* (*rom_table_lookup_fn)(uint32_t code, uint32_t mask);
+
+/* Flash programming routines ('IF', 'EX', 'RE', 'RP', 'FC') */
+typedef void (*rom_void_fn)(void);
+typedef void (*rom_flash_erase_fn)(uint32_t addr, uint32_t count, uint32_t block_size, uint8_t block_cmd);
+typedef void (*rom_flash_program_fn)(uint32_t addr, const uint8_t* data, uint32_t count);
+
+#define FLASH_PAGE_SIZE         256         /* Program granularity */
+#define FLASH_SECTOR_SIZE       4096        /* Erase granularity */
+#define FLASH_SECTOR_ERASE_CMD  0x20
+
+/*============================================================================
+ * Register Aliases (atomic access)
+ *============================================================================*/
+
+#define REG_ALIAS_NORMAL    0x0000
+#define REG_ALIAS_XOR_BITS  0x1000
+#define REG_ALIAS_SET_BITS  0x2000
+#define REG_ALIAS_CLR_BITS  0x3000
+
+/*============================================================================
+ * Resets
+ *============================================================================*/
+
+#define RESETS_BASE         0x40020000
+
+#define RESETS_RESET_OFFSET         0x00
+#define RESETS_WDSEL_OFFSET         0x04
+#define RESETS_RESET_DONE_OFFSET    0x08
+
+/* Reset bit indices */
+#define RESET_ADC           0
+#define RESET_BUSCTRL       1
+#define RESET_DMA           2
+#define RESET_HSTX          3
+#define RESET_I2C0          4
+#define RESET_I2C1          5
+#define RESET_IO_BANK0      6
+#define RESET_IO_QSPI       7
+#define RESET_JTAG          8
+#define RESET_PADS_BANK0    9
+#define RESET_PADS_QSPI     10
+#define RESET_PIO0          11
+#define RESET_PIO1          12
+#define RESET_PIO2          13
+#define RESET_PLL_SYS       14
+#define RESET_PLL_USB       15
+#define RESET_PWM           16
+#define RESET_SHA256        17
+#define RESET_SPI0          18
+#define RESET_SPI1          19
+#define RESET_SYSCFG        20
+#define RESET_SYSINFO       21
+#define RESET_TBMAN         22
+#define RESET_TIMER0        23
+#define RESET_TIMER1        24
+#define RESET_TRNG          25
+#define RESET_UART0         26
+#define RESET_UART1         27
+#define RESET_USBCTRL       28
+
+/*============================================================================
+ * IO Bank 0 (GPIO control)
+ *============================================================================*/
+
+#define IO_BANK0_BASE       0x40028000
+
+/* GPIO control register offset for pin n */
+#define IO_BANK0_GPIO_STATUS(n) (0x000 + (n) * 8)
+#define IO_BANK0_GPIO_CTRL(n)   (0x004 + (n) * 8)
+
+/* CTRL register fields */
+#define IO_BANK0_GPIO_CTRL_FUNCSEL_MASK     0x1F
+#define IO_BANK0_GPIO_CTRL_OUTOVER_MASK     (0x3 << 12)
+#define IO_BANK0_GPIO_CTRL_OEOVER_MASK      (0x3 << 14)
+#define IO_BANK0_GPIO_CTRL_INOVER_MASK      (0x3 << 16)
+#define IO_BANK0_GPIO_CTRL_IRQOVER_MASK     (0x3 << 28)
+
+/* Function select values */
+#define GPIO_FUNC_HSTX      0
+#define GPIO_FUNC_SPI       1
+#define GPIO_FUNC_UART      2
+#define GPIO_FUNC_I2C       3
+#define GPIO_FUNC_PWM       4
+#define GPIO_FUNC_SIO       5
+#define GPIO_FUNC_PIO0      6
+#define GPIO_FUNC_PIO1      7
+#define GPIO_FUNC_PIO2      8
+#define GPIO_FUNC_GPCK      9
+#define GPIO_FUNC_USB       10
+#define GPIO_FUNC_UART_AUX  11
+#define GPIO_FUNC_NULL      0x1F
+
+/*============================================================================
+ * Pads Bank 0
+ *============================================================================*/
+
+#define PADS_BANK0_BASE     0x40038000
+
+#define PADS_BANK0_VOLTAGE_SELECT_OFFSET    0x00
+#define PADS_BANK0_GPIO_OFFSET(n)           (0x04 + (n) * 4)
+
+/*
+ * Pad control fields. Pads come out of reset isolated (ISO set); the
+ * HAL and SD drivers write whole pad words with ISO clear, connecting them.
+ */
+#define PADS_BANK0_GPIO_ISO         (1 << 8)    /* Pad isolation */
+#define PADS_BANK0_GPIO_OD_DISABLE  (1 << 7)    /* Output disable */
+#define PADS_BANK0_GPIO_IE          (1 << 6)    /* Input enable */
+#define PADS_BANK0_GPIO_DRIVE_2MA   (0 << 4)
+#define PADS_BANK0_GPIO_DRIVE_4MA   (1 << 4)
+#define PADS_BANK0_GPIO_DRIVE_8MA   (2 << 4)
+#define PADS_BANK0_GPIO_DRIVE_12MA  (3 << 4)
+#define PADS_BANK0_GPIO_PUE         (1 << 3)    /* Pull-up enable */
+#define PADS_BANK0_GPIO_PDE         (1 << 2)    /* Pull-down enable */
+#define PADS_BANK0_GPIO_SCHMITT     (1 << 1)    /* Schmitt trigger */
+#define PADS_BANK0_GPIO_SLEWFAST    (1 << 0)    /* Slew rate fast */
+
+/*============================================================================
+ * SIO (Single-cycle IO)
+ *============================================================================*/
+
+#define SIO_BASE            0xD0000000
+
+#define SIO_CPUID_OFFSET            0x00
+#define SIO_GPIO_IN_OFFSET          0x04
+#define SIO_GPIO_HI_IN_OFFSET       0x08
+#define SIO_GPIO_OUT_OFFSET         0x10
+#define SIO_GPIO_OUT_SET_OFFSET     0x18
+#define SIO_GPIO_OUT_CLR_OFFSET     0x20
+#define SIO_GPIO_OUT_XOR_OFFSET     0x28
+#define SIO_GPIO_OE_OFFSET          0x30
+#define SIO_GPIO_OE_SET_OFFSET      0x38
+#define SIO_GPIO_OE_CLR_OFFSET      0x40
+#define SIO_GPIO_OE_XOR_OFFSET      0x48
+#define SIO_FIFO_ST_OFFSET          0x50    /* Inter-core FIFO status */
+#define SIO_FIFO_WR_OFFSET          0x54    /* Write to the other core */
+#define SIO_FIFO_RD_OFFSET          0x58    /* Read from the other core */
+
+/* FIFO_ST bits */
+#define SIO_FIFO_ST_ROE             (1 << 3)    /* Read on empty (sticky) */
+#define SIO_FIFO_ST_WOF             (1 << 2)    /* Write on full (sticky) */
+#define SIO_FIFO_ST_RDY             (1 << 1)    /* TX FIFO not full */
+#define SIO_FIFO_ST_VLD             (1 << 0)    /* RX FIFO not empty */
+
+/*============================================================================
+ * UART
+ *============================================================================*/
+
+#define UART0_BASE          0x40070000
+#define UART1_BASE          0x40078000
+
+#define UART_DR_OFFSET      0x00    /* Data register */
+#define UART_RSR_OFFSET     0x04    /* Receive status */
+#define UART_FR_OFFSET      0x18    /* Flag register */
+#define UART_ILPR_OFFSET    0x20    /* IrDA low-power counter */
+#define UART_IBRD_OFFSET    0x24    /* Integer baud rate */
+#define UART_FBRD_OFFSET    0x28    /* Fractional baud rate */
+#define UART_LCR_H_OFFSET   0x2C    /* Line control */
+#define UART_CR_OFFSET      0x30    /* Control register */
+#define UART_IFLS_OFFSET    0x34    /* Interrupt FIFO level select */
+#define UART_IMSC_OFFSET    0x38    /* Interrupt mask */
+#define UART_RIS_OFFSET     0x3C    /* Raw interrupt status */
+#define UART_MIS_OFFSET     0x40    /* Masked interrupt status */
+#define UART_ICR_OFFSET     0x44    /* Interrupt clear */
+#define UART_DMACR_OFFSET   0x48    /* DMA control */
+
+/* Flag register bits */
+#define UART_FR_TXFE        (1 << 7)    /* TX FIFO empty */
+#define UART_FR_RXFF        (1 << 6)    /* RX FIFO full */
+#define UART_FR_TXFF        (1 << 5)    /* TX FIFO full */
+#define UART_FR_RXFE        (1 << 4)    /* RX FIFO empty */
+#define UART_FR_BUSY        (1 << 3)    /* UART busy */
+
+/* Line control bits */
+#define UART_LCR_H_SPS      (1 << 7)    /* Stick parity select */
+#define UART_LCR_H_WLEN_5   (0 << 5)
+#define UART_LCR_H_WLEN_6   (1 << 5)
+#define UART_LCR_H_WLEN_7   (2 << 5)
+#define UART_LCR_H_WLEN_8   (3 << 5)
+#define UART_LCR_H_FEN      (1 << 4)    /* FIFO enable */
+#define UART_LCR_H_STP2     (1 << 3)    /* Two stop bits */
+#define UART_LCR_H_EPS      (1 << 2)    /* Even parity select */
+#define UART_LCR_H_PEN      (1 << 1)    /* Parity enable */
+#define UART_LCR_H_BRK      (1 << 0)    /* Send break */
+
+/* Control register bits */
+#define UART_CR_CTSEN       (1 << 15)
+#define UART_CR_RTSEN       (1 << 14)
+#define UART_CR_RTS         (1 << 11)
+#define UART_CR_RXE         (1 << 9)    /* Receive enable */
+#define UART_CR_TXE         (1 << 8)    /* Transmit enable */
+#define UART_CR_LBE         (1 << 7)    /* Loopback enable */
+#define UART_CR_UARTEN      (1 << 0)    /* UART enable */
+
+/* DMA control register bits */
+#define UART_DMACR_TXDMAE   (1 << 1)    /* TX DMA enable */
+#define UART_DMACR_RXDMAE   (1 << 0)    /* RX DMA enable */
+
+/*============================================================================
+ * SPI
+ *============================================================================*/
+
+#define SPI0_BASE           0x40080000
+#define SPI1_BASE           0x40088000
+
+#define SPI_SSPCR0_OFFSET   0x00    /* Control register 0 */
+#define SPI_SSPCR1_OFFSET   0x04    /* Control register 1 */
+#define SPI_SSPDR_OFFSET    0x08    /* Data register */
+#define SPI_SSPSR_OFFSET    0x0C    /* Status register */
+#define SPI_SSPCPSR_OFFSET  0x10    /* Clock prescale */
+#define SPI_SSPIMSC_OFFSET  0x14    /* Interrupt mask */
+#define SPI_SSPRIS_OFFSET   0x18    /* Raw interrupt status */
+#define SPI_SSPMIS_OFFSET   0x1C    /* Masked interrupt status */
+#define SPI_SSPICR_OFFSET   0x20    /* Interrupt clear */
+#define SPI_SSPDMACR_OFFSET 0x24    /* DMA control */
+
+/* CR0 bits */
+#define SPI_SSPCR0_SCR_SHIFT    8   /* Serial clock rate */
+#define SPI_SSPCR0_SPH          (1 << 7)    /* Clock phase */
+#define SPI_SSPCR0_SPO          (1 << 6)    /* Clock polarity */
+#define SPI_SSPCR0_FRF_MOTO     (0 << 4)    /* Motorola SPI */
+#define SPI_SSPCR0_FRF_TI       (1 << 4)    /* TI sync serial */
+#define SPI_SSPCR0_FRF_NM       (2 << 4)    /* National Microwire */
+#define SPI_SSPCR0_DSS_MASK     0xF         /* Data size select */
+
+/* CR1 bits */
+#define SPI_SSPCR1_SOD          (1 << 3)    /* Slave output disable */
+#define SPI_SSPCR1_MS           (1 << 2)    /* Master/slave select */
+#define SPI_SSPCR1_SSE          (1 << 1)    /* SSP enable */
+#define SPI_SSPCR1_LBM          (1 << 0)    /* Loopback mode */
+
+/* Status bits */
+#define SPI_SSPSR_BSY           (1 << 4)    /* Busy */
+#define SPI_SSPSR_RFF           (1 << 3)    /* RX FIFO full */
+#define SPI_SSPSR_RNE           (1 << 2)    /* RX FIFO not empty */
+#define SPI_SSPSR_TNF           (1 << 1)    /* TX FIFO not full */
+#define SPI_SSPSR_TFE           (1 << 0)    /* TX FIFO empty */
+
+/* DMA control bits */
+#define SPI_SSPDMACR_TXDMAE     (1 << 1)    /* TX DMA enable */
+#define SPI_SSPDMACR_RXDMAE     (1 << 0)    /* RX DMA enable */
+
+/*============================================================================
+ * DMA
+ *============================================================================*/
+
+#define DMA_BASE            0x50000000
+
+/* Per-channel registers (channel n at DMA_BASE + n * DMA_CH_STRIDE) */
+#define DMA_CH_STRIDE           0x40
+#define DMA_CH_BASE(n)          (DMA_BASE + (n) * DMA_CH_STRIDE)
+
+#define DMA_CH_READ_ADDR_OFFSET     0x00
+#define DMA_CH_WRITE_ADDR_OFFSET    0x04
+#define DMA_CH_TRANS_COUNT_OFFSET   0x08    /* Count in bits 27:0, mode 0 = normal */
+#define DMA_CH_CTRL_TRIG_OFFSET     0x0C    /* Control (write triggers) */
+#define DMA_CH_AL1_CTRL_OFFSET      0x10    /* Control (no trigger) */
+
+/* Global registers (16 channels: four interrupt groups come first) */
+#define DMA_MULTI_CHAN_TRIGGER_OFFSET   0x450
+#define DMA_SNIFF_CTRL_OFFSET           0x454
+#define DMA_SNIFF_DATA_OFFSET           0x458
+#define DMA_CHAN_ABORT_OFFSET           0x464
+
+/* CTRL bits (reverse address increments push the RP2040 fields up) */
+#define DMA_CTRL_EN                 (1 << 0)
+#define DMA_CTRL_HIGH_PRIORITY      (1 << 1)
+#define DMA_CTRL_DATA_SIZE_BYTE     (0 << 2)
+#define DMA_CTRL_DATA_SIZE_HALFWORD (1 << 2)
+#define DMA_CTRL_DATA_SIZE_WORD     (2 << 2)
+#define DMA_CTRL_INCR_READ          (1 << 4)
+#define DMA_CTRL_INCR_READ_REV      (1 << 5)
+#define DMA_CTRL_INCR_WRITE         (1 << 6)
+#define DMA_CTRL_INCR_WRITE_REV     (1 << 7)
+#define DMA_CTRL_RING_SIZE(n)       ((n) << 8)      /* Wrap at 1 << n bytes */
+#define DMA_CTRL_RING_SEL           (1 << 12)       /* Wrap write, not read */
+#define DMA_CTRL_CHAIN_TO(n)        ((n) << 13)     /* Chain to self = none */
+#define DMA_CTRL_TREQ_SEL(n)        ((n) << 17)
+#define DMA_CTRL_IRQ_QUIET          (1 << 23)
+#define DMA_CTRL_BSWAP              (1 << 24)
+#define DMA_CTRL_SNIFF_EN           (1 << 25)
+#define DMA_CTRL_BUSY               (1 << 26)
+#define DMA_CTRL_WRITE_ERROR        (1 << 29)
+#define DMA_CTRL_READ_ERROR         (1 << 30)
+#define DMA_CTRL_AHB_ERROR          (1u << 31)
+
+/* SNIFF_CTRL bits */
+#define DMA_SNIFF_CTRL_EN           (1 << 0)
+#define DMA_SNIFF_CTRL_DMACH(n)     ((n) << 1)
+#define DMA_SNIFF_CTRL_CALC_CRC32R  (1 << 5)        /* CRC-32, bit-reversed data */
+#define DMA_SNIFF_CTRL_OUT_REV      (1 << 10)       /* Result bit-reversed on read */
+#define DMA_SNIFF_CTRL_OUT_INV      (1 << 11)       /* Result inverted on read */
+
+/* Transfer request (DREQ) sources */
+#define DREQ_PIO0_TX(sm)    (sm)
+#define DREQ_PIO0_RX(sm)    (4 + (sm))
+#define DREQ_SPI0_TX        24
+#define DREQ_SPI0_RX        25
+#define DREQ_SPI1_TX        26
+#define DREQ_SPI1_RX        27
+#define DREQ_UART0_TX       28
+#define DREQ_UART0_RX       29
+#define DREQ_FORCE          0x3F    /* Unpaced (memory-to-memory) */
+
+/*============================================================================
+ * PIO
+ *============================================================================*/
+
+#define PIO0_BASE           0x50200000
+#define PIO1_BASE           0x50300000
+#define PIO2_BASE           0x50400000
+
+#define PIO_CTRL_OFFSET             0x000
+#define PIO_FSTAT_OFFSET            0x004
+#define PIO_FDEBUG_OFFSET           0x008
+#define PIO_FLEVEL_OFFSET           0x00C
+#define PIO_TXF_OFFSET(sm)          (0x010 + (sm) * 4)
+#define PIO_RXF_OFFSET(sm)          (0x020 + (sm) * 4)
+#define PIO_IRQ_OFFSET              0x030
+#define PIO_INPUT_SYNC_BYPASS_OFFSET 0x038
+#define PIO_INSTR_MEM_OFFSET(n)     (0x048 + (n) * 4)
+
+/* Per state machine registers */
+#define PIO_SM_STRIDE               0x18
+#define PIO_SM_CLKDIV_OFFSET(sm)    (0x0C8 + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_EXECCTRL_OFFSET(sm)  (0x0CC + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_SHIFTCTRL_OFFSET(sm) (0x0D0 + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_ADDR_OFFSET(sm)      (0x0D4 + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_INSTR_OFFSET(sm)     (0x0D8 + (sm) * PIO_SM_STRIDE)
+#define PIO_SM_PINCTRL_OFFSET(sm)   (0x0DC + (sm) * PIO_SM_STRIDE)
+
+#define PIO_INSTR_MEM_SIZE          32
+
+/* CTRL bits */
+#define PIO_CTRL_SM_ENABLE(sm)      (1 << (sm))
+#define PIO_CTRL_SM_RESTART(sm)     (1 << (4 + (sm)))
+#define PIO_CTRL_CLKDIV_RESTART(sm) (1 << (8 + (sm)))
+
+/* FSTAT bits */
+#define PIO_FSTAT_RXFULL(sm)        (1 << (sm))
+#define PIO_FSTAT_RXEMPTY(sm)       (1 << (8 + (sm)))
+#define PIO_FSTAT_TXFULL(sm)        (1 << (16 + (sm)))
+#define PIO_FSTAT_TXEMPTY(sm)       (1 << (24 + (sm)))
+
+/* CLKDIV fields (16.8 fixed point) */
+#define PIO_CLKDIV_INT_SHIFT        16
+#define PIO_CLKDIV_FRAC_SHIFT       8
+
+/* EXECCTRL fields (STATUS_SEL is two bits wide on RP2350) */
+#define PIO_EXECCTRL_JMP_PIN(n)     ((n) << 24)
+#define PIO_EXECCTRL_WRAP_TOP(n)    ((n) << 12)
+#define PIO_EXECCTRL_WRAP_BOTTOM(n) ((n) << 7)
+#define PIO_EXECCTRL_STATUS_RX      (1 << 5)    /* STATUS from RX level (else TX) */
+#define PIO_EXECCTRL_STATUS_N(n)    (n)
+
+/* SHIFTCTRL fields */
+#define PIO_SHIFTCTRL_FJOIN_RX      (1u << 31)
+#define PIO_SHIFTCTRL_FJOIN_TX      (1 << 30)
+#define PIO_SHIFTCTRL_PULL_THRESH(n) (((n) & 0x1F) << 25)   /* 0 = 32 */
+#define PIO_SHIFTCTRL_PUSH_THRESH(n) (((n) & 0x1F) << 20)   /* 0 = 32 */
+#define PIO_SHIFTCTRL_OUT_SHIFTDIR_RIGHT (1 << 19)
+#define PIO_SHIFTCTRL_IN_SHIFTDIR_RIGHT  (1 << 18)
+#define PIO_SHIFTCTRL_AUTOPULL      (1 << 17)
+#define PIO_SHIFTCTRL_AUTOPUSH      (1 << 16)
+
+/* PINCTRL fields */
+#define PIO_PINCTRL_SIDESET_COUNT(n) ((n) << 29)
+#define PIO_PINCTRL_SET_COUNT(n)    ((n) << 26)
+#define PIO_PINCTRL_OUT_COUNT(n)    ((n) << 20)
+#define PIO_PINCTRL_IN_BASE(n)      ((n) << 15)
+#define PIO_PINCTRL_SIDESET_BASE(n) ((n) << 10)
+#define PIO_PINCTRL_SET_BASE(n)     ((n) << 5)
+#define PIO_PINCTRL_OUT_BASE(n)     (n)
+
+/*============================================================================
+ * Timer (TIMER0, 1MHz from the tick generator the SDK starts)
+ *============================================================================*/
+
+#define TIMER0_BASE         0x400B0000
+
+#define TIMER_TIMEHW_OFFSET     0x00    /* Time high (write) */
+#define TIMER_TIMELW_OFFSET     0x04    /* Time low (write) */
+#define TIMER_TIMEHR_OFFSET     0x08    /* Time high (read) */
+#define TIMER_TIMELR_OFFSET     0x0C    /* Time low (read) */
+#define TIMER_TIMERAWH_OFFSET   0x24
+#define TIMER_TIMERAWL_OFFSET   0x28
+
+/*============================================================================
+ * Watchdog
+ *============================================================================*/
+
+#define WATCHDOG_BASE       0x400D8000
+
+#define WATCHDOG_CTRL_OFFSET        0x00
+#define WATCHDOG_LOAD_OFFSET        0x04
+#define WATCHDOG_REASON_OFFSET      0x08
+#define WATCHDOG_SCRATCH0_OFFSET    0x0C
+#define WATCHDOG_SCRATCH1_OFFSET    0x10
+#define WATCHDOG_SCRATCH2_OFFSET    0x14
+#define WATCHDOG_SCRATCH3_OFFSET    0x18
+#define WATCHDOG_SCRATCH4_OFFSET    0x1C
+#define WATCHDOG_SCRATCH5_OFFSET    0x20
+#define WATCHDOG_SCRATCH6_OFFSET    0x24
+#define WATCHDOG_SCRATCH7_OFFSET    0x28
+
+/* CTRL bits */
+#define WATCHDOG_CTRL_TRIGGER       (1 << 31)
+#define WATCHDOG_CTRL_ENABLE        (1 << 30)
+#define WATCHDOG_CTRL_PAUSE_DBG1    (1 << 26)
+#define WATCHDOG_CTRL_PAUSE_DBG0    (1 << 25)
+#define WATCHDOG_CTRL_PAUSE_JTAG    (1 << 24)
+
+/* REASON bits (cleared by power-on and RUN-pin resets) */
+#define WATCHDOG_REASON_TIMER       (1 << 0)
+#define WATCHDOG_REASON_FORCE       (1 << 1)
+
+/*============================================================================
+ * PSM (Power-on State Machine) / POWMAN
+ *============================================================================*/
+
+#define PSM_BASE                    0x40018000
+
+#define PSM_FRCE_OFF_OFFSET         0x04
+
+#define PSM_PROC1                   (1 << 24)
+
+#define POWMAN_BASE                 0x40100000
+
+#define POWMAN_CHIP_RESET_OFFSET    0x2C
+
+/* CHIP_RESET bits */
+#define POWMAN_CHIP_RESET_HAD_POR           (1 << 16)
+#define POWMAN_CHIP_RESET_HAD_BOR           (1 << 17)
+#define POWMAN_CHIP_RESET_HAD_RUN_LOW       (1 << 18)
+#define POWMAN_CHIP_RESET_HAD_DP_RESET_REQ  (1 << 19)   /* Debug port reset request */
+
+/*============================================================================
+ * Cortex-M33 Core Registers
+ *============================================================================*/
+
+#define PPB_BASE            0xE0000000
+
+/* SysTick */
+#define SYST_CSR            (PPB_BASE + 0xE010)
+#define SYST_RVR            (PPB_BASE + 0xE014)
+#define SYST_CVR            (PPB_BASE + 0xE018)
+#define SYST_CALIB          (PPB_BASE + 0xE01C)
+
+/* NVIC */
+#define NVIC_ISER           (PPB_BASE + 0xE100)
+#define NVIC_ICER           (PPB_BASE + 0xE180)
+#define NVIC_ISPR           (PPB_BASE + 0xE200)
+#define NVIC_ICPR           (PPB_BASE + 0xE280)
+#define NVIC_IPR0           (PPB_BASE + 0xE400)
+
+/* SCB */
+#define SCB_CPUID           (PPB_BASE + 0xED00)
+#define SCB_ICSR            (PPB_BASE + 0xED04)
+#define SCB_VTOR            (PPB_BASE + 0xED08)
+#define SCB_AIRCR           (PPB_BASE + 0xED0C)
+#define SCB_SCR             (PPB_BASE + 0xED10)
+
+#define SCB_AIRCR_VECTKEY   0x05FA0000
+#define SCB_AIRCR_SYSRESETREQ (1 << 2)
+
+#endif /* MIMIBOOT_RP2350_REGS_H */
@@ -0,0 +1,988 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * rp2xxx_common.c - HAL Code Shared by the RP2040 and RP2350
+ * 
+ * The RP2350 keeps the RP2040's UART, SSP, DMA, SIO, watchdog and
+ * boot ROM flash routines with the same programming model, so
+ * everything built on them lives here once and is compiled against
+ * the target's register header (rp2xxx_common.h). The backends keep
+ * what differs: reset and clock setup, the SRAM map, reset reasons,
+ * boot ROM lookup, copy and CRC acceleration, and the timer.
+ */
+
+#include "rp2xxx_common.h"
+#include <stdarg.h>
+
+/*============================================================================
+ * Static State
+ *============================================================================*/
+
+static bool s_console_initialized = false;
+
+/*============================================================================
+ * Console (UART)
+ *============================================================================*/
+
+/* Free-running indices: head is written by putc, tail is the first byte not sent */
+static char s_tx_ring[CONSOLE_RING_SIZE] __attribute__((aligned(CONSOLE_RING_SIZE)));
+static uint32_t s_tx_head;
+static uint32_t s_tx_tail;
+static uint32_t s_tx_sending;   /* Bytes from tail in the running transfer */
+
+int hal_console_init(void) {
+    if (s_console_initialized) {
+        return 0;
+    }
+    
+    /* Configure TX pin for UART function */
+    /* GPIO function select: UART = 2 */
+    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(CONSOLE_TX_PIN), 2);
+    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(CONSOLE_RX_PIN), 2);
+    
+    /* Connect the pads: the RP2350's come out of reset isolated, input off */
+    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(CONSOLE_TX_PIN),
+        PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_DRIVE_4MA);
+    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(CONSOLE_RX_PIN),
+        PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_PUE);  /* Idle high when unconnected */
+    
+    /* Configure UART */
+    /* Baud rate divisor: UARTIBRD and UARTFBRD */
+    /* Baud = UARTCLK / (16 * (IBRD + FBRD/64)) */
+    /* UARTCLK = sys_clk typically */
+    uint32_t baud_div = (SYS_CLK_HZ * 4) / CONSOLE_BAUD;
+    uint32_t ibrd = baud_div >> 6;
+    uint32_t fbrd = baud_div & 0x3F;
+    
+    reg_write(CONSOLE_UART + UART_IBRD_OFFSET, ibrd);
+    reg_write(CONSOLE_UART + UART_FBRD_OFFSET, fbrd);
+    
+    /* 8N1, FIFO enabled */
+    reg_write(CONSOLE_UART + UART_LCR_H_OFFSET, 
+        UART_LCR_H_WLEN_8 | UART_LCR_H_FEN);
+    
+    /* Enable UART, TX, RX; TX paced by DMA */
+    reg_write(CONSOLE_UART + UART_DMACR_OFFSET, UART_DMACR_TXDMAE);
+    reg_write(CONSOLE_UART + UART_CR_OFFSET,
+        UART_CR_UARTEN | UART_CR_TXE | UART_CR_RXE);
+    
+    s_console_initialized = true;
+    return 0;
+}
+
+/**
+ * Retire the finished transfer and start one for everything queued
+ * since. The read address wraps with the ring, so a single transfer
+ * covers the whole backlog. Bytes queued while a transfer runs go out
+ * with the next console call, or at hal_console_flush.
+ */
+static void console_kick(void) {
+    uint32_t ch = DMA_CH_BASE(CONSOLE_DMA_CHAN);
+    
+    if (reg_read(ch + DMA_CH_CTRL_TRIG_OFFSET) & DMA_CTRL_BUSY) {
+        return;
+    }
+    
+    s_tx_tail += s_tx_sending;
+    s_tx_sending = s_tx_head - s_tx_tail;
+    if (s_tx_sending == 0) {
+        return;
+    }
+    
+    reg_write(ch + DMA_CH_READ_ADDR_OFFSET,
+        (uint32_t)(uintptr_t)&s_tx_ring[s_tx_tail & (CONSOLE_RING_SIZE - 1)]);
+    reg_write(ch + DMA_CH_WRITE_ADDR_OFFSET, CONSOLE_UART + UART_DR_OFFSET);
+    reg_write(ch + DMA_CH_TRANS_COUNT_OFFSET, s_tx_sending);
+    reg_write(ch + DMA_CH_CTRL_TRIG_OFFSET,
+        DMA_CTRL_EN | DMA_CTRL_DATA_SIZE_BYTE | DMA_CTRL_INCR_READ |
+        DMA_CTRL_RING_SIZE(CONSOLE_RING_BITS) | DMA_CTRL_CHAIN_TO(CONSOLE_DMA_CHAN) |
+        DMA_CTRL_TREQ_SEL(DREQ_UART0_TX) | DMA_CTRL_IRQ_QUIET);
+}
+
+void hal_console_putc(char c) {
+    if (!s_console_initialized) return;
+    
+    /* Ring full: only the transfer under way can make room */
+    while (s_tx_head - s_tx_tail == CONSOLE_RING_SIZE) {
+        console_kick();
+    }
+    
+    s_tx_ring[s_tx_head & (CONSOLE_RING_SIZE - 1)] = c;
+    s_tx_head++;
+    console_kick();
+}
+
+void hal_console_flush(void) {
+    if (!s_console_initialized) return;
+    
+    while (s_tx_head != s_tx_tail) {
+        console_kick();
+    }
+    
+    /* Last bytes through the FIFO and out of the shift register */
+    while (reg_read(CONSOLE_UART + UART_FR_OFFSET) & UART_FR_BUSY) {
+        /* spin */
+    }
+}
+
+int hal_console_getc(void) {
+    if (!s_console_initialized) return -1;
+    
+    /* Pollers keep the TX ring moving too */
+    console_kick();
+    
+    if (reg_read(CONSOLE_UART + UART_FR_OFFSET) & UART_FR_RXFE) {
+        return -1;
+    }
+    return (int)(reg_read(CONSOLE_UART + UART_DR_OFFSET) & 0xFF);
+}
+
+void hal_console_puts(const char* s) {
+    while (*s) {
+        if (*s == '\n') {
+            hal_console_putc('\r');
+        }
+        hal_console_putc(*s++);
+    }
+}
+
+/* Minimal printf implementation */
+static void print_uint(uint32_t val, int base, int uppercase, int width, char pad) {
+    char buf[12];
+    int i = 0;
+    const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+    
+    do {
+        buf[i++] = digits[val % base];
+        val /= base;
+    } while (val > 0);
+    
+    while (width > i) {
+        hal_console_putc(pad);
+        width--;
+    }
+    
+    while (i > 0) {
+        hal_console_putc(buf[--i]);
+    }
+}
+
+static void print_int(int32_t val, int width, char pad) {
+    if (val < 0) {
+        hal_console_putc('-');
+        val = -val;
+        width--;
+    }
+    print_uint((uint32_t)val, 10, 0, width, pad);
+}
+
+void hal_console_vprintf(const char* fmt, va_list args) {
+    while (*fmt) {
+        if (*fmt != '%') {
+            if (*fmt == '\n') hal_console_putc('\r');
+            hal_console_putc(*fmt++);
+            continue;
+        }
+        
+        fmt++;
+        
+        /* Field width, space or zero padded: %8u, %08X */
+        char pad = ' ';
+        int width = 0;
+        if (*fmt == '0') {
+            pad = '0';
+            fmt++;
+        }
+        while (*fmt >= '0' && *fmt <= '9') {
+            width = width * 10 + (*fmt++ - '0');
+        }
+        if (*fmt == '\0') {
+            break;
+        }
+        
+        switch (*fmt) {
+            case 'd':
+            case 'i':
+                print_int(va_arg(args, int32_t), width, pad);
+                break;
+            case 'u':
+                print_uint(va_arg(args, uint32_t), 10, 0, width, pad);
+                break;
+            case 'x':
+                print_uint(va_arg(args, uint32_t), 16, 0, width, pad);
+                break;
+            case 'X':
+                print_uint(va_arg(args, uint32_t), 16, 1, width, pad);
+                break;
+            case 's':
+                hal_console_puts(va_arg(args, const char*));
+                break;
+            case 'c':
+                hal_console_putc((char)va_arg(args, int));
+                break;
+            case '%':
+                hal_console_putc('%');
+                break;
+            default:
+                hal_console_putc('%');
+                hal_console_putc(*fmt);
+                break;
+        }
+        fmt++;
+    }
+}
+
+void hal_console_printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    hal_console_vprintf(fmt, args);
+    va_end(args);
+}
+
+/*============================================================================
+ * Timing
+ *============================================================================*/
+
+void hal_delay_us(uint32_t us) {
+    uint32_t start = hal_get_time_us();
+    while ((hal_get_time_us() - start) < us) {
+        /* spin */
+    }
+}
+
+void hal_delay_ms(uint32_t ms) {
+    hal_delay_us(ms * 1000);
+}
+
+/*============================================================================
+ * GPIO
+ *============================================================================*/
+
+void hal_gpio_set_mode(uint32_t pin, hal_gpio_mode_t mode) {
+    /* Configure pad: OD_DISABLE turns the output driver off, inputs only */
+    uint32_t pad_ctrl = PADS_BANK0_GPIO_IE;  /* IE also needed for output readback */
+    
+    switch (mode) {
+        case HAL_GPIO_INPUT:
+            pad_ctrl |= PADS_BANK0_GPIO_OD_DISABLE;
+            break;
+        case HAL_GPIO_INPUT_PULLUP:
+            pad_ctrl |= PADS_BANK0_GPIO_OD_DISABLE | PADS_BANK0_GPIO_PUE;
+            break;
+        case HAL_GPIO_INPUT_PULLDOWN:
+            pad_ctrl |= PADS_BANK0_GPIO_OD_DISABLE | PADS_BANK0_GPIO_PDE;
+            break;
+        case HAL_GPIO_OUTPUT:
+        case HAL_GPIO_ALT_FUNC:
+            break;
+    }
+    
+    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(pin), pad_ctrl);
+    
+    /* Configure function */
+    if (mode == HAL_GPIO_OUTPUT || mode == HAL_GPIO_INPUT || 
+        mode == HAL_GPIO_INPUT_PULLUP || mode == HAL_GPIO_INPUT_PULLDOWN) {
+        /* SIO function = 5 */
+        reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(pin), 5);
+        
+        /* SIO has no atomic aliases: it has set/clear registers instead */
+        if (mode == HAL_GPIO_OUTPUT) {
+            /* Enable output */
+            reg_write(SIO_BASE + SIO_GPIO_OE_SET_OFFSET, (1 << pin));
+        } else {
+            /* Disable output */
+            reg_write(SIO_BASE + SIO_GPIO_OE_CLR_OFFSET, (1 << pin));
+        }
+    }
+}
+
+void hal_gpio_write(uint32_t pin, bool state) {
+    if (state) {
+        reg_write(SIO_BASE + SIO_GPIO_OUT_SET_OFFSET, (1 << pin));
+    } else {
+        reg_write(SIO_BASE + SIO_GPIO_OUT_CLR_OFFSET, (1 << pin));
+    }
+}
+
+bool hal_gpio_read(uint32_t pin) {
+    return (reg_read(SIO_BASE + SIO_GPIO_IN_OFFSET) & (1 << pin)) != 0;
+}
+
+/*============================================================================
+ * SPI
+ *============================================================================*/
+
+/* SPI state (shared with sd_spi.c) */
+typedef struct {
+    uint32_t base;
+    uint32_t clock_hz;
+} spi_state_t;
+
+spi_state_t s_spi_state[2];
+
+/* Fill byte fed to the TX DMA channel - must live in RAM for DMA reads */
+static uint8_t s_spi_fill_byte = 0xFF;
+
+int hal_spi_init(hal_spi_t* spi, uint32_t instance, const hal_spi_config_t* config) {
+    if (instance > 1) return -1;
+    
+    uint32_t base = (instance == 0) ? SPI0_BASE : SPI1_BASE;
+    spi_state_t* state = &s_spi_state[instance];
+    state->base = base;
+    
+    /* Reset SPI */
+    uint32_t reset_bit = (instance == 0) ? (1 << RESET_SPI0) : (1 << RESET_SPI1);
+    reg_set_bits(RESETS_BASE + RESETS_RESET_OFFSET, reset_bit);
+    reg_clear_bits(RESETS_BASE + RESETS_RESET_OFFSET, reset_bit);
+    while (!(reg_read(RESETS_BASE + RESETS_RESET_DONE_OFFSET) & reset_bit)) {}
+    
+    /* Configure clock */
+    hal_spi_set_clock(state, config->clock_hz);
+    
+    /* Configure format: 8 bits, SPI mode, Motorola format */
+    uint32_t cr0 = (7 << 0);  /* 8 bit data */
+    
+    /* SPI mode (CPOL, CPHA) */
+    if (config->mode & 1) cr0 |= SPI_SSPCR0_SPH;  /* CPHA */
+    if (config->mode & 2) cr0 |= SPI_SSPCR0_SPO;  /* CPOL */
+    
+    reg_write(base + SPI_SSPCR0_OFFSET, cr0);
+    
+    /* Enable SPI */
+    reg_write(base + SPI_SSPCR1_OFFSET, SPI_SSPCR1_SSE);
+    
+    /* Let the SSP raise DREQs for hal_spi_receive */
+    reg_write(base + SPI_SSPDMACR_OFFSET, SPI_SSPDMACR_TXDMAE | SPI_SSPDMACR_RXDMAE);
+    
+    *spi = state;
+    return 0;
+}
+
+uint32_t hal_spi_set_clock(hal_spi_t spi, uint32_t clock_hz) {
+    spi_state_t* state = (spi_state_t*)spi;
+    
+    /* SSPCLK = sys_clk / (CPSDVSR * (1 + SCR)) */
+    /* CPSDVSR must be even, 2-254 */
+    /* SCR is 0-255 */
+    
+    if (clock_hz == 0) {
+        return 0;
+    }
+    
+    /* Round the divider up so the result never exceeds clock_hz */
+    uint32_t prescale = 2;
+    while (prescale <= 254) {
+        uint32_t div = prescale * clock_hz;
+        uint32_t scr = ((SYS_CLK_HZ + div - 1) / div) - 1;
+        if (scr <= 255) {
+            reg_write(state->base + SPI_SSPCPSR_OFFSET, prescale);
+            uint32_t cr0 = reg_read(state->base + SPI_SSPCR0_OFFSET);
+            cr0 = (cr0 & 0xFF) | (scr << 8);
+            reg_write(state->base + SPI_SSPCR0_OFFSET, cr0);
+            state->clock_hz = SYS_CLK_HZ / (prescale * (scr + 1));
+            return state->clock_hz;
+        }
+        prescale += 2;
+    }
+    
+    /* Couldn't achieve requested frequency */
+    return 0;
+}
+
+MIMI_RAMFUNC
+int hal_spi_transfer(hal_spi_t spi, const uint8_t* tx, uint8_t* rx, uint32_t len) {
+    spi_state_t* state = (spi_state_t*)spi;
+    uint32_t base = state->base;
+    uint32_t tx_count = 0;
+    uint32_t rx_count = 0;
+    
+    /*
+     * Pipelined transfer: keep the TX FIFO primed up to its depth and
+     * drain RX in bursts, so the SPI clock never idles between bytes.
+     * Limiting bytes in flight to the FIFO depth guarantees the RX
+     * FIFO cannot overflow.
+     */
+    while (rx_count < len) {
+        uint32_t status = reg_read(base + SPI_SSPSR_OFFSET);
+        
+        while (tx_count < len && (tx_count - rx_count) < SPI_FIFO_DEPTH &&
+               (status & SPI_SSPSR_TNF)) {
+            reg_write(base + SPI_SSPDR_OFFSET, tx ? tx[tx_count] : 0xFF);
+            tx_count++;
+            status = reg_read(base + SPI_SSPSR_OFFSET);
+        }
+        
+        while (rx_count < len && (status & SPI_SSPSR_RNE)) {
+            uint8_t in = reg_read(base + SPI_SSPDR_OFFSET) & 0xFF;
+            if (rx) rx[rx_count] = in;
+            rx_count++;
+            status = reg_read(base + SPI_SSPSR_OFFSET);
+        }
+    }
+    
+    return 0;
+}
+
+MIMI_RAMFUNC
+int hal_spi_receive(hal_spi_t spi, uint8_t* rx, uint32_t len) {
+    spi_state_t* state = (spi_state_t*)spi;
+    uint32_t base = state->base;
+    
+    if (len == 0) {
+        return 0;
+    }
+    
+    uint32_t dreq_tx = (base == SPI0_BASE) ? DREQ_SPI0_TX : DREQ_SPI1_TX;
+    uint32_t dreq_rx = (base == SPI0_BASE) ? DREQ_SPI0_RX : DREQ_SPI1_RX;
+    uint32_t tx_ch = DMA_CH_BASE(SPI_DMA_TX_CHAN);
+    uint32_t rx_ch = DMA_CH_BASE(SPI_DMA_RX_CHAN);
+    
+    /* Discard anything left in the RX FIFO */
+    while (reg_read(base + SPI_SSPSR_OFFSET) & SPI_SSPSR_RNE) {
+        (void)reg_read(base + SPI_SSPDR_OFFSET);
+    }
+    
+    /*
+     * RX channel: SSPDR -> buffer, paced by RX DREQ. High priority so
+     * the RX FIFO never overflows while TX keeps the line busy.
+     */
+    reg_write(rx_ch + DMA_CH_READ_ADDR_OFFSET, base + SPI_SSPDR_OFFSET);
+    reg_write(rx_ch + DMA_CH_WRITE_ADDR_OFFSET, (uint32_t)(uintptr_t)rx);
+    reg_write(rx_ch + DMA_CH_TRANS_COUNT_OFFSET, len);
+    reg_write(rx_ch + DMA_CH_AL1_CTRL_OFFSET,
+        DMA_CTRL_EN | DMA_CTRL_HIGH_PRIORITY | DMA_CTRL_DATA_SIZE_BYTE |
+        DMA_CTRL_INCR_WRITE | DMA_CTRL_CHAIN_TO(SPI_DMA_RX_CHAN) |
+        DMA_CTRL_TREQ_SEL(dreq_rx) | DMA_CTRL_IRQ_QUIET);
+    
+    /* TX channel: constant 0xFF -> SSPDR, paced by TX DREQ */
+    reg_write(tx_ch + DMA_CH_READ_ADDR_OFFSET, (uint32_t)(uintptr_t)&s_spi_fill_byte);
+    reg_write(tx_ch + DMA_CH_WRITE_ADDR_OFFSET, base + SPI_SSPDR_OFFSET);
+    reg_write(tx_ch + DMA_CH_TRANS_COUNT_OFFSET, len);
+    reg_write(tx_ch + DMA_CH_AL1_CTRL_OFFSET,
+        DMA_CTRL_EN | DMA_CTRL_DATA_SIZE_BYTE |
+        DMA_CTRL_CHAIN_TO(SPI_DMA_TX_CHAN) |
+        DMA_CTRL_TREQ_SEL(dreq_tx) | DMA_CTRL_IRQ_QUIET);
+    
+    /* Start both channels in the same cycle */
+    reg_write(DMA_BASE + DMA_MULTI_CHAN_TRIGGER_OFFSET,
+        (1 << SPI_DMA_TX_CHAN) | (1 << SPI_DMA_RX_CHAN));
+    
+    /* RX completes last - once it is idle every byte has been clocked in */
+    while (reg_read(rx_ch + DMA_CH_CTRL_TRIG_OFFSET) & DMA_CTRL_BUSY) {
+        /* spin */
+    }
+    
+    if (reg_read(rx_ch + DMA_CH_CTRL_TRIG_OFFSET) & DMA_CTRL_AHB_ERROR) {
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*============================================================================
+ * Storage - delegates to SD card driver
+ *============================================================================*/
+
+/* Forward declarations - implemented in sd_spi.c or sd_sdio.c */
+#if defined(MIMIBOOT_SDIO)
+extern int sd_bus_init(void);
+#endif
+extern int sd_init(void);
+extern int sd_read_blocks(uint32_t block, uint8_t* buffer, uint32_t count);
+extern uint32_t sd_get_block_count(void);
+extern uint32_t sd_negotiate_clock(uint32_t max_hz, uint32_t safe_hz);
+extern void sd_get_stats(uint32_t* commands, uint32_t* blocks_read);
+
+static bool s_storage_initialized = false;
+static uint32_t s_sd_block_count = 0;
+
+int hal_storage_init(void) {
+    if (s_storage_initialized) return 0;
+
+#if defined(MIMIBOOT_SDIO)
+    /* PIO0 drives CLK, CMD and DAT0-3; the driver owns the pins */
+    if (sd_bus_init() != 0) {
+        return -1;
+    }
+#else
+    /* Configure SPI pins for SD card */
+    /* CS as GPIO output */
+    hal_gpio_set_mode(SD_CS_PIN, HAL_GPIO_OUTPUT);
+    hal_gpio_write(SD_CS_PIN, true);  /* CS high (deselected) */
+    
+    /* SCK, MOSI, MISO as SPI function */
+    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(SD_SCK_PIN), 1);   /* SPI */
+    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(SD_MOSI_PIN), 1);
+    reg_write(IO_BANK0_BASE + IO_BANK0_GPIO_CTRL(SD_MISO_PIN), 1);
+    
+    /* Configure pads */
+    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(SD_SCK_PIN),
+        PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_DRIVE_4MA);
+    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(SD_MOSI_PIN),
+        PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_DRIVE_4MA);
+    reg_write(PADS_BANK0_BASE + PADS_BANK0_GPIO_OFFSET(SD_MISO_PIN),
+        PADS_BANK0_GPIO_IE | PADS_BANK0_GPIO_PUE);  /* Pull-up on MISO */
+    
+    /* Initialize SPI at slow speed for SD init */
+    hal_spi_config_t spi_cfg = {
+        .clock_hz = 400000,     /* 400kHz for init */
+        .mode = 0,
+        .msb_first = true
+    };
+    
+    hal_spi_t spi;
+    if (hal_spi_init(&spi, SD_SPI_INST, &spi_cfg) != 0) {
+        return -1;
+    }
+#endif
+    
+    s_storage_initialized = true;
+    return 0;
+}
+
+int hal_storage_open(hal_storage_t* dev) {
+    if (!s_storage_initialized) {
+        if (hal_storage_init() != 0) return -1;
+    }
+    
+    /* Initialize SD card */
+    if (sd_init() != 0) {
+        return -1;
+    }
+
+#if defined(MIMIBOOT_SDIO)
+    /* High speed if the card takes CMD6, else default speed */
+    if (sd_negotiate_clock(SD_SDIO_MAX_HZ, SD_SDIO_SAFE_HZ) == 0) {
+        return -1;
+    }
+#else
+    /*
+     * Speed up SPI after init. Try the fastest clocks first and fall
+     * back when the card or wiring produces CRC or token errors.
+     */
+    if (sd_negotiate_clock(SD_SPI_MAX_HZ, SD_SPI_SAFE_HZ) == 0) {
+        return -1;
+    }
+#endif
+    
+    s_sd_block_count = sd_get_block_count();
+    
+    *dev = (void*)1;  /* Non-null handle */
+    return 0;
+}
+
+void hal_storage_close(hal_storage_t dev) {
+    (void)dev;
+    /* Nothing to do for SD */
+}
+
+int hal_storage_info(hal_storage_t dev, hal_storage_info_t* info) {
+    (void)dev;
+    info->sector_size = 512;
+    info->sector_count = s_sd_block_count;
+    info->total_size = s_sd_block_count * 512;
+    info->readonly = false;
+#if defined(MIMIBOOT_SDIO)
+    info->name = "SD Card (SDIO)";
+#else
+    info->name = "SD Card";
+#endif
+    return 0;
+}
+
+void hal_storage_get_stats(hal_storage_t dev, hal_storage_stats_t* stats) {
+    (void)dev;
+    sd_get_stats(&stats->commands, &stats->blocks_read);
+}
+
+MIMI_RAMFUNC
+int32_t hal_storage_read(hal_storage_t dev, uint32_t offset, void* buffer, uint32_t size) {
+    (void)dev;
+    
+    uint8_t* buf = (uint8_t*)buffer;
+    uint32_t block = offset / 512;
+    uint32_t block_offset = offset % 512;
+    uint32_t bytes_read = 0;
+    uint8_t temp_block[512];
+    
+    while (bytes_read < size) {
+        uint32_t remaining = size - bytes_read;
+        
+        if (block_offset == 0 && remaining >= 512) {
+            /* Whole blocks - let the card write straight into the caller's buffer */
+            uint32_t count = remaining / 512;
+            if (sd_read_blocks(block, buf + bytes_read, count) != 0) {
+                return -1;
+            }
+            
+            bytes_read += count * 512;
+            block += count;
+            continue;
+        }
+        
+        /* Partial block - bounce through temporary buffer */
+        if (sd_read_blocks(block, temp_block, 1) != 0) {
+            return -1;
+        }
+        
+        uint32_t copy_len = 512 - block_offset;
+        if (copy_len > remaining) {
+            copy_len = remaining;
+        }
+        
+        mimi_memcpy(buf + bytes_read, temp_block + block_offset, copy_len);
+        
+        bytes_read += copy_len;
+        block_offset = 0;
+        block++;
+    }
+    
+    return bytes_read;
+}
+
+MIMI_RAMFUNC
+int hal_storage_read_blocks(hal_storage_t dev, uint32_t block, void* buffer, uint32_t count) {
+    (void)dev;
+    
+    if (count == 0) {
+        return 0;
+    }
+    
+    /* count > 1 is streamed with CMD18 by the SD driver */
+    return (sd_read_blocks(block, (uint8_t*)buffer, count) == 0) ? 0 : -1;
+}
+
+/*============================================================================
+ * Second Core
+ *============================================================================*/
+
+#define CORE1_STACK_WORDS   256     /* 1KB */
+
+static uint32_t s_core1_stack[CORE1_STACK_WORDS] __attribute__((aligned(8))) MIMI_SCRATCH_X;
+static void (*s_core1_entry)(void);
+
+static void fifo_drain(void) {
+    while (reg_read(SIO_BASE + SIO_FIFO_ST_OFFSET) & SIO_FIFO_ST_VLD) {
+        (void)reg_read(SIO_BASE + SIO_FIFO_RD_OFFSET);
+    }
+}
+
+static void fifo_push(uint32_t value) {
+    while (!(reg_read(SIO_BASE + SIO_FIFO_ST_OFFSET) & SIO_FIFO_ST_RDY)) {
+        /* spin */
+    }
+    reg_write(SIO_BASE + SIO_FIFO_WR_OFFSET, value);
+    __asm__ volatile ("sev");
+}
+
+static uint32_t fifo_pop(void) {
+    while (!(reg_read(SIO_BASE + SIO_FIFO_ST_OFFSET) & SIO_FIFO_ST_VLD)) {
+        __asm__ volatile ("wfe");
+    }
+    return reg_read(SIO_BASE + SIO_FIFO_RD_OFFSET);
+}
+
+/**
+ * First code on core 1: run the entry, then sleep if it returns.
+ */
+static void core1_trampoline(void) {
+    s_core1_entry();
+    
+    while (1) {
+        __asm__ volatile ("wfe");
+    }
+}
+
+bool hal_core1_launch(void (*entry)(void)) {
+    /* Start from a known state: core 1 waiting in the boot ROM */
+    hal_core1_reset();
+    
+    s_core1_entry = entry;
+    
+    /*
+     * Boot ROM launch handshake: each word is echoed back by core 1;
+     * any mismatch restarts the sequence. The zeros flush stale FIFO
+     * contents on both sides.
+     */
+    const uint32_t cmds[6] = {
+        0, 0, 1,
+        reg_read(SCB_VTOR),
+        (uint32_t)&s_core1_stack[CORE1_STACK_WORDS],
+        (uint32_t)core1_trampoline,
+    };
+    
+    uint32_t seq = 0;
+    while (seq < 6) {
+        uint32_t cmd = cmds[seq];
+        if (cmd == 0) {
+            fifo_drain();
+            __asm__ volatile ("sev");
+        }
+        fifo_push(cmd);
+        
+        seq = (fifo_pop() == cmd) ? seq + 1 : 0;
+    }
+    
+    return true;
+}
+
+void hal_core1_reset(void) {
+    /* Pulse power-on reset of processor 1 */
+    reg_set_bits(PSM_BASE + PSM_FRCE_OFF_OFFSET, PSM_PROC1);
+    while (!(reg_read(PSM_BASE + PSM_FRCE_OFF_OFFSET) & PSM_PROC1)) {
+        /* spin */
+    }
+    fifo_drain();
+    reg_clear_bits(PSM_BASE + PSM_FRCE_OFF_OFFSET, PSM_PROC1);
+    
+    /* Boot ROM on core 1 announces itself with a 0 */
+    (void)fifo_pop();
+    
+    /* Leave the FIFO empty with no sticky errors */
+    fifo_drain();
+    reg_write(SIO_BASE + SIO_FIFO_ST_OFFSET, SIO_FIFO_ST_ROE | SIO_FIFO_ST_WOF);
+}
+
+/*============================================================================
+ * Non-Volatile Storage (last flash sectors)
+ *============================================================================*/
+
+/* Boot ROM flash routines, looked up while XIP still works */
+typedef struct {
+    rom_void_fn             connect;        /* connect_internal_flash */
+    rom_void_fn             exit_xip;       /* flash_exit_xip */
+    rom_flash_erase_fn      erase;          /* flash_range_erase */
+    rom_flash_program_fn    program;        /* flash_range_program */
+    rom_void_fn             flush_cache;    /* flash_flush_cache */
+    rom_void_fn             enter_xip;      /* XIP setup copy: restores fast XIP */
+} nv_rom_t;
+
+/*
+ * The XIP setup function (boot2 on the RP2040, the boot ROM's copy in
+ * boot RAM on the RP2350), copied out so the fast XIP setup can be
+ * replayed afterwards
+ */
+static uint32_t s_xip_setup_copy[64];
+
+/* Tail of a write that does not fill a whole page */
+static uint8_t s_nv_page[FLASH_PAGE_SIZE];
+
+/**
+ * Optionally erase the sector at offset, then program whole pages
+ * from data and one page from s_nv_page after them. Lives in .data
+ * (RAM) and calls only boot ROM code: nothing can be fetched from
+ * flash until XIP is back.
+ */
+__attribute__((section(".data.nv_program"), noinline))
+static void nv_program(const nv_rom_t* rom, uint32_t offset, bool erase,
+                       const uint8_t* data, uint32_t full, bool tail) {
+    rom->connect();
+    rom->exit_xip();
+    if (erase) {
+        rom->erase(offset & ~(uint32_t)(FLASH_SECTOR_SIZE - 1), FLASH_SECTOR_SIZE,
+                   FLASH_SECTOR_SIZE, FLASH_SECTOR_ERASE_CMD);
+    }
+    
+    if (full > 0) {
+        rom->program(offset, data, full);
+    }
+    if (tail) {
+        rom->program(offset + full, s_nv_page, FLASH_PAGE_SIZE);
+    }
+    
+    rom->flush_cache();
+    rom->enter_xip();
+}
+
+static void nv_rom_init(nv_rom_t* rom) {
+    rom->connect = (rom_void_fn)rp2xxx_rom_func_lookup('I', 'F');
+    rom->exit_xip = (rom_void_fn)rp2xxx_rom_func_lookup('E', 'X');
+    rom->erase = (rom_flash_erase_fn)rp2xxx_rom_func_lookup('R', 'E');
+    rom->program = (rom_flash_program_fn)rp2xxx_rom_func_lookup('R', 'P');
+    rom->flush_cache = (rom_void_fn)rp2xxx_rom_func_lookup('F', 'C');
+    rom->enter_xip = (rom_void_fn)((uintptr_t)s_xip_setup_copy + 1);
+    
+    mimi_memcpy(s_xip_setup_copy, (const void*)(uintptr_t)XIP_SETUP_BASE, sizeof(s_xip_setup_copy));
+}
+
+const void* hal_nv_data(uint32_t block, uint32_t* size) {
+    if (block >= HAL_NV_BLOCKS) {
+        *size = 0;
+        return NULL;
+    }
+    
+    *size = FLASH_SECTOR_SIZE;
+    return (const void*)(uintptr_t)(FLASH_BASE + NV_BLOCK_OFFSET(block));
+}
+
+int hal_nv_write(uint32_t block, const void* data, uint32_t size) {
+    if (block >= HAL_NV_BLOCKS || size > FLASH_SECTOR_SIZE) {
+        return -1;
+    }
+    
+    nv_rom_t rom;
+    nv_rom_init(&rom);
+    
+    /* Whole pages straight from data, the rest padded with erased bytes */
+    uint32_t full = size & ~(uint32_t)(FLASH_PAGE_SIZE - 1);
+    bool tail = size > full;
+    if (tail) {
+        mimi_memset(s_nv_page, 0xFF, FLASH_PAGE_SIZE);
+        mimi_memcpy(s_nv_page, (const uint8_t*)data + full, size - full);
+    }
+    
+    nv_program(&rom, NV_BLOCK_OFFSET(block), true, (const uint8_t*)data, full, tail);
+    return 0;
+}
+
+int hal_nv_append(uint32_t block, uint32_t offset, const void* data, uint32_t size, bool erase) {
+    uint32_t page = offset & ~(uint32_t)(FLASH_PAGE_SIZE - 1);
+    
+    if (block >= HAL_NV_BLOCKS || size == 0 || offset + size > FLASH_SECTOR_SIZE ||
+        offset + size > page + FLASH_PAGE_SIZE) {
+        return -1;
+    }
+    
+    nv_rom_t rom;
+    nv_rom_init(&rom);
+    
+    /* Erased bytes around the record leave the rest of the page as it is */
+    mimi_memset(s_nv_page, 0xFF, FLASH_PAGE_SIZE);
+    mimi_memcpy(s_nv_page + (offset - page), data, size);
+    
+    nv_program(&rom, NV_BLOCK_OFFSET(block) + page, erase, NULL, 0, true);
+    return 0;
+}
+
+/*============================================================================
+ * Image Cache (below the non-volatile sectors)
+ *============================================================================*/
+
+const void* hal_cache_data(uint32_t* size) {
+    *size = CACHE_SIZE;
+    return (const void*)(uintptr_t)(FLASH_BASE + CACHE_OFFSET);
+}
+
+int hal_cache_write(uint32_t offset, const void* data, uint32_t size) {
+    if (offset % FLASH_SECTOR_SIZE != 0 || offset > CACHE_SIZE || size > CACHE_SIZE - offset) {
+        return -1;
+    }
+    
+    nv_rom_t rom;
+    nv_rom_init(&rom);
+    
+    /* A sector at a time, so XIP (and the console) come back in between */
+    const uint8_t* src = (const uint8_t*)data;
+    uint32_t done = 0;
+    do {
+        uint32_t chunk = size - done;
+        if (chunk > FLASH_SECTOR_SIZE) {
+            chunk = FLASH_SECTOR_SIZE;
+        }
+        
+        uint32_t full = chunk & ~(uint32_t)(FLASH_PAGE_SIZE - 1);
+        bool tail = chunk > full;
+        if (tail) {
+            mimi_memset(s_nv_page, 0xFF, FLASH_PAGE_SIZE);
+            mimi_memcpy(s_nv_page, src + done + full, chunk - full);
+        }
+        
+        nv_program(&rom, CACHE_OFFSET + offset + done, true,
+                   (full > 0) ? src + done : NULL, full, tail);
+        done += chunk;
+    } while (done < size);
+    
+    return 0;
+}
+
+/*============================================================================
+ * Retained Registers (watchdog scratch)
+ *============================================================================*/
+
+uint32_t hal_retain_count(void) {
+    return RETAIN_WORDS;
+}
+
+uint32_t hal_retain_get(uint32_t index) {
+    if (index >= RETAIN_WORDS) {
+        return 0;
+    }
+    return reg_read(WATCHDOG_BASE + WATCHDOG_SCRATCH0_OFFSET + index * 4);
+}
+
+void hal_retain_set(uint32_t index, uint32_t value) {
+    if (index < RETAIN_WORDS) {
+        reg_write(WATCHDOG_BASE + WATCHDOG_SCRATCH0_OFFSET + index * 4, value);
+    }
+}
+
+uint32_t hal_retain_addr(uint32_t index) {
+    if (index >= RETAIN_WORDS) {
+        return 0;
+    }
+    return WATCHDOG_BASE + WATCHDOG_SCRATCH0_OFFSET + index * 4;
+}
+
+void hal_handoff_mark(void) {
+    reg_write(HANDOFF_MARK_ADDR, HANDOFF_MARK);
+}
+
+bool rp2xxx_handoff_marked(void) {
+    static bool checked = false;
+    static bool marked = false;
+    
+    if (!checked) {
+        marked = reg_read(HANDOFF_MARK_ADDR) == HANDOFF_MARK;
+        reg_write(HANDOFF_MARK_ADDR, 0);
+        checked = true;
+    }
+    return marked;
+}
+
+/*============================================================================
+ * System Control
+ *============================================================================*/
+
+__attribute__((noreturn))
+void hal_system_reset(void) {
+    /* Use watchdog for reset */
+    reg_write(WATCHDOG_BASE + WATCHDOG_CTRL_OFFSET, 
+        WATCHDOG_CTRL_TRIGGER);
+    
+    while (1) {
+        __asm__ volatile ("wfi");
+    }
+}
+
+__attribute__((noreturn))
+void hal_system_halt(void) {
+    /* Blink LED forever */
+    hal_gpio_set_mode(LED_PIN, HAL_GPIO_OUTPUT);
+    
+    while (1) {
+        hal_led_blink(3, 100, 100);
+        hal_delay_ms(1000);
+    }
+}
+
+/*============================================================================
+ * LED
+ *============================================================================*/
+
+void hal_led_set(bool on) {
+    static bool led_initialized = false;
+    if (!led_initialized) {
+        hal_gpio_set_mode(LED_PIN, HAL_GPIO_OUTPUT);
+        led_initialized = true;
+    }
+    hal_gpio_write(LED_PIN, on);
+}
+
+void hal_led_blink(uint32_t count, uint32_t on_ms, uint32_t off_ms) {
+    for (uint32_t i = 0; i < count; i++) {
+        hal_led_set(true);
+        hal_delay_ms(on_ms);
+        hal_led_set(false);
+        hal_delay_ms(off_ms);
+    }
+}
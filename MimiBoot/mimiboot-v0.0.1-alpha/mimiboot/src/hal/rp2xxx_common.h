@@ -0,0 +1,181 @@
+/**
+ * MimiBoot - Minimal Second-Stage Bootloader for ARM Cortex-M
+ * 
+ * rp2xxx_common.h - Shared RP2040/RP2350 HAL Definitions
+ * 
+ * Private to the two RP backends (hal_rp2040.c, hal_rp2350.c) and the
+ * code they share (rp2xxx_common.c): board wiring, the flash layout,
+ * register access and the few chip services the shared code calls.
+ * Everything is built against the register header of the target chip.
+ */
+
+#ifndef MIMIBOOT_RP2XXX_COMMON_H
+#define MIMIBOOT_RP2XXX_COMMON_H
+
+#include "hal.h"
+#if defined(TARGET_RP2350)
+#include "rp2350/rp2350_regs.h"
+#else
+#include "rp2040/rp2040_regs.h"
+#endif
+#include "../../include/mimiboot/handoff.h"
+
+/*============================================================================
+ * Platform Constants
+ *============================================================================*/
+
+#if defined(TARGET_RP2350)
+/* Clock set up by the SDK runtime - 150MHz on RP2350 */
+#define SYS_CLK_HZ          150000000
+#define FLASH_SIZE          (4 * 1024 * 1024)   /* Pico 2 */
+/* No boot2: MimiBoot starts at the beginning of flash */
+#define LOADER_OFFSET       0x000
+/* XIP setup function the boot ROM leaves in boot RAM */
+#define XIP_SETUP_BASE      BOOTRAM_BASE
+#else
+/* Default clock after boot ROM - 125MHz on RP2040 */
+#define SYS_CLK_HZ          125000000
+#define FLASH_SIZE          (2 * 1024 * 1024)   /* Pico */
+/* MimiBoot starts after boot2 */
+#define LOADER_OFFSET       0x100
+/* boot2, the XIP setup at the start of flash */
+#define XIP_SETUP_BASE      FLASH_BASE
+#endif
+
+#define XOSC_MHZ            12
+
+/* UART for console */
+#define CONSOLE_UART        UART0_BASE
+#define CONSOLE_BAUD        115200
+#define CONSOLE_TX_PIN      0
+#define CONSOLE_RX_PIN      1
+
+/* Console TX ring, drained by DMA: a power of two, aligned to its size */
+#define CONSOLE_RING_BITS   10
+#define CONSOLE_RING_SIZE   (1u << CONSOLE_RING_BITS)
+#define CONSOLE_DMA_CHAN    4
+
+/* SD Card SPI pins (same wiring on the Pico and Pico 2) */
+#define SD_SPI_INST         0           /* SPI0 */
+#define SD_CS_PIN           5
+#define SD_SCK_PIN          2
+#define SD_MOSI_PIN         3
+#define SD_MISO_PIN         4
+
+/* SD card SPI clock: highest rate to try, and spec default-speed limit */
+#define SD_SPI_MAX_HZ       (SYS_CLK_HZ / 2)
+#define SD_SPI_SAFE_HZ      25000000
+
+/* SD card SDIO clock (MIMIBOOT_SDIO): high speed, and default-speed limit */
+#define SD_SDIO_MAX_HZ      50000000
+#define SD_SDIO_SAFE_HZ     25000000
+
+/* SSP FIFO depth (TX and RX) */
+#define SPI_FIFO_DEPTH      8
+
+/* DMA channels used for the SPI data phase */
+#define SPI_DMA_TX_CHAN     0
+#define SPI_DMA_RX_CHAN     1
+
+/* DMA channel fed through the CRC sniffer */
+#define CRC_DMA_CHAN        2
+
+/* LED pin (Pico and Pico 2 onboard) */
+#define LED_PIN             25
+
+/* Memory layout */
+#define FLASH_BASE          0x10000000
+
+/*
+ * Everything past the loader is available to XIP payloads, from the
+ * sector after its last byte (__loader_flash_end__ in the linker
+ * scripts; the first 16KB when linked without them)...
+ */
+#define XIP_PAYLOAD_OFFSET  0x4000
+
+/* ...except the last sectors, one per non-volatile block, manifest last... */
+#define NV_OFFSET           (FLASH_SIZE - HAL_NV_BLOCKS * FLASH_SECTOR_SIZE)
+#define NV_BLOCK_OFFSET(b)  (FLASH_SIZE - ((b) + 1) * FLASH_SECTOR_SIZE)
+
+/* ...and the image cache below them (a payload's worth of RAM, segment padding too) */
+#if defined(TARGET_RP2350)
+#define CACHE_SIZE          (512 * 1024)
+#else
+#define CACHE_SIZE          (256 * 1024)
+#endif
+#define CACHE_OFFSET        (NV_OFFSET - CACHE_SIZE)
+
+/*
+ * Watchdog scratch registers 0-3 are retained words. 4-7 carry boot
+ * ROM reboot requests, read only with the ROM's magic in 4; 7 marks
+ * the loader's handoff otherwise.
+ */
+#define RETAIN_WORDS        4
+#define HANDOFF_MARK_ADDR   (WATCHDOG_BASE + WATCHDOG_SCRATCH7_OFFSET)
+#define HANDOFF_MARK        0x4F44484D  /* "MHDO" */
+
+/*============================================================================
+ * Register Access Helpers
+ *============================================================================*/
+
+static inline void reg_write(uint32_t addr, uint32_t val) {
+    *(volatile uint32_t*)addr = val;
+}
+
+static inline uint32_t reg_read(uint32_t addr) {
+    return *(volatile uint32_t*)addr;
+}
+
+static inline void reg_set_bits(uint32_t addr, uint32_t bits) {
+    *(volatile uint32_t*)(addr + REG_ALIAS_SET_BITS) = bits;
+}
+
+static inline void reg_clear_bits(uint32_t addr, uint32_t bits) {
+    *(volatile uint32_t*)(addr + REG_ALIAS_CLR_BITS) = bits;
+}
+
+/*============================================================================
+ * Loader Flash
+ *============================================================================*/
+
+extern char __loader_flash_end__[] __attribute__((weak));
+
+/**
+ * Offset of the first flash sector past MimiBoot, where the XIP
+ * payload window begins.
+ */
+static inline uint32_t loader_flash_end(void) {
+    if (__loader_flash_end__ != NULL) {
+        return (uint32_t)(uintptr_t)__loader_flash_end__ - FLASH_BASE;
+    }
+    return XIP_PAYLOAD_OFFSET;
+}
+
+/*============================================================================
+ * Chip Services (in hal_rp2040.c / hal_rp2350.c)
+ *============================================================================*/
+
+/**
+ * Find a boot ROM function by its two-character code.
+ * 
+ * @param c1    First character of the code
+ * @param c2    Second character of the code
+ * @return      Function address, or NULL if the ROM has none
+ */
+void* rp2xxx_rom_func_lookup(char c1, char c2);
+
+/*============================================================================
+ * Shared Services (in rp2xxx_common.c)
+ *============================================================================*/
+
+/**
+ * Check whether the loader handed off to a payload since the last chip
+ * reset: the watchdog scratch registers are cleared by power-on, the
+ * RUN pin and debugger resets, but not by the processor resets a
+ * payload causes. The mark is consumed on the first call.
+ * 
+ * @return      true if hal_handoff_mark ran before this reset
+ */
+bool rp2xxx_handoff_marked(void);
+
+#endif /* MIMIBOOT_RP2XXX_COMMON_H */
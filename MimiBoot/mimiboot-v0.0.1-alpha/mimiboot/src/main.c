@@ -7,21 +7,35 @@
  * 
  * 1. Early hardware init (clocks, GPIO)
  * 2. Console init (UART for debug output)
- * 3. Storage init (SD card over SPI)
- * 4. Mount filesystem (FAT32)
- * 5. Load configuration (boot.cfg)
- * 6. Load ELF image into RAM
- * 7. Build handoff structure
- * 8. Jump to payload
+ * 3. After a soft reset, restart the image still in RAM (skip 4-8)
+ *    unless it has reset too often without confirming a good boot
+ * 4. Storage init (SD card over SPI)
+ * 5. Check the boot manifest; if the card still matches it, skip 6-7
+ * 6. Mount filesystem (FAT32)
+ * 7. Load configuration (boot.cfg, or its compiled copy in flash)
+ * 8. Load ELF image into RAM, or rebuild it from a delta against the
+ *    previous image (still in RAM, or cached in flash), then the extra
+ *    files boot.cfg loads with it
+ * 9. Build handoff structure
+ * 10. Jump to payload
  * 
  * If anything fails, we either retry, load fallback, or halt with
- * an error indication (LED blink pattern).
+ * an error indication (LED blink pattern). An image that keeps
+ * resetting before it confirms its boot (MIMI_HANDOFF_CONFIRM) is
+ * replaced by the fallback after max_retries attempts.
  */
 
 #include "core/loader.h"
 #include "core/config.h"
 #include "core/handoff.h"
+#include "core/mem.h"
+#include "core/crc32.h"
+#include "core/profile.h"
+#include "core/pipeline.h"
+#include "core/boot_flow.h"
+#include "core/logbuf.h"
 #include "hal/hal.h"
+#include "fs/blkcache.h"
 #include "fs/fat32.h"
 #include "../include/mimiboot/handoff.h"
 
@@ -53,13 +67,20 @@
 static fat32_fs_t       s_fs;
 static mimi_config_t    s_config;
 static mimi_handoff_t   s_handoff __attribute__((aligned(256)));
+static mimi_boot_profile_t s_profile __attribute__((aligned(4)));
+
+/* Boot messages handed to the payload (mimi_logbuf_t) */
+#define LOGBUF_SIZE             2048
+static uint32_t         s_logbuf[LOGBUF_SIZE / sizeof(uint32_t)];
 
 /*============================================================================
  * Logging
  *============================================================================*/
 
+/* Every message goes to the log buffer; the console gets what the config asks for */
 #define LOG(fmt, ...) \
     do { \
+        mimi_logbuf_add(fmt, ##__VA_ARGS__); \
         if (!s_config.quiet) { \
             hal_console_printf(fmt, ##__VA_ARGS__); \
         } \
@@ -67,6 +88,7 @@ static mimi_handoff_t   s_handoff __attribute__((aligned(256)));
 
 #define LOG_VERBOSE(fmt, ...) \
     do { \
+        mimi_logbuf_add(fmt, ##__VA_ARGS__); \
         if (s_config.verbose && !s_config.quiet) { \
             hal_console_printf(fmt, ##__VA_ARGS__); \
         } \
@@ -79,70 +101,158 @@ static mimi_handoff_t   s_handoff __attribute__((aligned(256)));
 /* Global storage handle for callbacks */
 static hal_storage_t s_storage;
 
+/* Sector cache between FAT32 and storage */
+static blkcache_t s_blkcache;
+
+/**
+ * Single-block read from the card, for the block cache.
+ */
+static int storage_read_sector(uint32_t sector, uint8_t* buffer) {
+    return hal_storage_read_blocks(s_storage, sector, buffer, 1);
+}
+
+/**
+ * Multi-block read from the card (read-ahead and contiguous cluster runs).
+ */
+static int storage_read_sectors(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    return hal_storage_read_blocks(s_storage, sector, buffer, count);
+}
+
 /**
  * Sector read callback for FAT32 driver.
  */
 static int fs_read_sector(uint32_t sector, uint8_t* buffer) {
-    int32_t result = hal_storage_read(s_storage, sector * 512, buffer, 512);
-    return (result == 512) ? 0 : -1;
+    return blkcache_read(&s_blkcache, sector, buffer);
 }
 
 /**
- * File read callback for config loader.
+ * Multi-sector read callback for FAT32 driver (contiguous cluster runs).
  */
-static int config_read_file(const char* path, char* buffer, uint32_t max_size) {
-    fat32_file_t file;
-    
-    fat32_err_t err = fat32_open(&s_fs, path, &file);
-    if (err != FAT32_OK) {
-        return -1;
-    }
+static int fs_read_sectors(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    return blkcache_read_run(&s_blkcache, sector, buffer, count);
+}
+
+/**
+ * Mount the FAT32 volume (cold boots, and warm boots that leave the
+ * manifest's image).
+ * 
+ * @return  true if mounted
+ */
+static bool fs_mount(void) {
+    LOG("Mounting filesystem...\n");
     
-    uint32_t size = fat32_size(&file);
-    if (size > max_size - 1) {
-        size = max_size - 1;
+    mimi_profile_begin(MIMI_PHASE_MOUNT);
+    if (fat32_mount(&s_fs, fs_read_sector) != FAT32_OK) {
+        return false;
     }
     
-    int32_t read = fat32_read(&file, buffer, size);
-    if (read < 0) {
-        return read;
-    }
+    fat32_set_multi_read(&s_fs, fs_read_sectors);
+    mimi_profile_end(MIMI_PHASE_MOUNT);
     
-    buffer[read] = '\0';
-    return read;
+    LOG_VERBOSE("Filesystem mounted\n");
+    LOG_VERBOSE("Cluster size: %u bytes\n", s_fs.cluster_size);
+    return true;
 }
 
 /*============================================================================
- * I/O Operations for ELF Loader
+ * Boot Flow Services
  *============================================================================*/
 
-typedef struct {
-    fat32_file_t file;
-} loader_file_ctx_t;
+/**
+ * Boot flow messages, through the same filters as LOG and LOG_VERBOSE.
+ */
+static void flow_log(bool verbose, const char* fmt, ...) {
+    va_list args;
+    
+    va_start(args, fmt);
+    mimi_logbuf_vadd(fmt, args);
+    va_end(args);
+    
+    if (!s_config.quiet && (s_config.verbose || !verbose)) {
+        va_start(args, fmt);
+        hal_console_vprintf(fmt, args);
+        va_end(args);
+    }
+}
 
-static loader_file_ctx_t s_loader_ctx;
+static const mimi_flow_ops_t s_flow_ops = {
+    .nv_data = hal_nv_data,
+    .nv_write = hal_nv_write,
+    .nv_append = hal_nv_append,
+    .cache_data = hal_cache_data,
+    .cache_write = hal_cache_write,
+    .retain_count = hal_retain_count,
+    .retain_get = hal_retain_get,
+    .retain_set = hal_retain_set,
+    .retain_addr = hal_retain_addr,
+    .log = flow_log,
+};
 
-static int32_t loader_io_read(mimi_file_t file, uint32_t offset, void* buffer, uint32_t size) {
-    loader_file_ctx_t* ctx = (loader_file_ctx_t*)file;
+/*============================================================================
+ * Boot Menu
+ *============================================================================*/
+
+/* Wait for a choice after any other key, so noise on RX cannot stop the boot for good */
+#define BOOT_MENU_IDLE_MS       30000
+
+/**
+ * Offer the boot menu when it has a countdown or a choice key is
+ * already waiting; otherwise this costs one UART status read. Entry 0
+ * is the boot image, 1.. are the menu images. A number boots its
+ * entry, Enter the default. Any other key stops the countdown; the
+ * default is then booted after BOOT_MENU_IDLE_MS without a key.
+ * 
+ * @param image_path    Boot image, shown as entry 0
+ * @return              Entry to boot
+ */
+static uint32_t boot_menu(const char* image_path) {
+    int key = hal_console_getc();
+    bool choice = (key >= '0' && key <= '9') || key == '\r' || key == '\n';
     
-    fat32_err_t err = fat32_seek(&ctx->file, offset);
-    if (err != FAT32_OK) {
-        return -1;
+    /* Without a countdown only a choice opens the menu */
+    if (s_config.timeout_ms == 0 && !choice) {
+        return 0;
     }
     
-    return fat32_read(&ctx->file, buffer, size);
-}
-
-static int32_t loader_io_size(mimi_file_t file) {
-    loader_file_ctx_t* ctx = (loader_file_ctx_t*)file;
-    return fat32_size(&ctx->file);
+    uint32_t count = 1 + s_config.image_count;
+    uint32_t pick = (s_config.default_index < count) ? s_config.default_index : 0;
+    
+    LOG("\nBoot menu:\n");
+    LOG("  0) %s\n", image_path);
+    for (uint32_t i = 0; i < s_config.image_count; i++) {
+        const mimi_image_entry_t* entry = &s_config.images[i];
+        const char* name = MIMI_CONFIG_STR(&s_config, entry->name);
+        LOG("  %u) %s\n", i + 1, *name ? name : MIMI_CONFIG_STR(&s_config, entry->path));
+    }
+    LOG("Press 0-%u, Enter for %u (%u ms)\n", count - 1, pick, s_config.timeout_ms);
+    
+    uint32_t start_us = hal_get_time_us();
+    uint32_t wait_ms = s_config.timeout_ms;
+    bool waiting = false;
+    
+    while (1) {
+        if (key >= '0' && key < '0' + (int)count) {
+            return (uint32_t)(key - '0');
+        }
+        if (key == '\r' || key == '\n') {
+            return pick;
+        }
+        if (key >= 0) {
+            /* Every further key restarts the wait */
+            if (!waiting) {
+                waiting = true;
+                LOG("Waiting for a choice (%u ms)\n", BOOT_MENU_IDLE_MS);
+            }
+            wait_ms = BOOT_MENU_IDLE_MS;
+            start_us = hal_get_time_us();
+        }
+        if ((hal_get_time_us() - start_us) / 1000 >= wait_ms) {
+            return pick;
+        }
+        key = hal_console_getc();
+    }
 }
 
-static const mimi_io_ops_t s_loader_io = {
-    .read = loader_io_read,
-    .size = loader_io_size,
-};
-
 /*============================================================================
  * Boot Failure Handler
  *============================================================================*/
@@ -151,6 +261,7 @@ __attribute__((noreturn))
 static void boot_fail(int blink_code, const char* message) {
     LOG("\n[FAIL] %s\n", message);
     LOG("Blink code: %d\n", blink_code);
+    hal_console_flush();
     
     /* Blink error pattern forever */
     while (1) {
@@ -159,6 +270,110 @@ static void boot_fail(int blink_code, const char* message) {
     }
 }
 
+/*============================================================================
+ * Handoff
+ *============================================================================*/
+
+/**
+ * Build the handoff structure and jump to the loaded image.
+ * 
+ * @param load_result   Loaded (or resumed) image
+ * @param platform      Platform information
+ * @param image_path    Image path, for the handoff filename
+ * @param boot_start_us Time at reset
+ * @param load_time_us  Time spent loading
+ * @param resumed       Image was restarted from RAM, storage untouched
+ */
+__attribute__((noreturn))
+static void boot_payload(
+    const mimi_load_result_t*   load_result,
+    const mimi_platform_info_t* platform,
+    const char*                 image_path,
+    uint32_t                    boot_start_us,
+    uint32_t                    load_time_us,
+    bool                        resumed
+) {
+    LOG_VERBOSE("\nPreparing handoff...\n");
+    
+    mimi_profile_begin(MIMI_PHASE_HANDOFF);
+    
+    /* Extract filename for handoff */
+    const char* filename = image_path;
+    const char* p = image_path;
+    while (*p) {
+        if (*p == '/') filename = p + 1;
+        p++;
+    }
+    
+    mimi_handoff_build(&s_handoff, load_result, platform, filename);
+    if (resumed) {
+        s_handoff.boot_flags |= MIMI_FLAG_RESUMED;
+    }
+    
+    uint32_t blob_count;
+    const mimi_blob_t* blobs = mimi_flow_blobs(&blob_count);
+    for (uint32_t i = 0; i < blob_count; i++) {
+        if (!mimi_handoff_attach_blob(&s_handoff, blobs[i].addr, blobs[i].size, blobs[i].index)) {
+            LOG("[WARN] No handoff region left for load item %u\n", blobs[i].index);
+        }
+    }
+    
+    /* Counters for the boot profile (none if storage was never opened) */
+    if (!resumed) {
+        hal_storage_stats_t storage_stats;
+        hal_storage_get_stats(s_storage, &storage_stats);
+        
+        s_profile.storage_cmds = storage_stats.commands;
+        s_profile.sectors_read = storage_stats.blocks_read;
+        s_profile.fat_lookups = s_fs.fat_lookups;
+        s_profile.fat_reads = s_fs.fat_reads;
+        s_profile.block_hits = s_blkcache.hits;
+        s_profile.block_misses = s_blkcache.misses;
+        s_profile.readahead_reads = s_blkcache.ahead_reads;
+    }
+    s_profile.bytes_copied = load_result->bytes_copied;
+    s_profile.bytes_zeroed = load_result->bytes_zeroed;
+    
+    mimi_handoff_attach_profile(&s_handoff, &s_profile);
+    mimi_handoff_attach_confirm(&s_handoff, s_config.boot_count,
+                                mimi_flow_status()->confirm_addr);
+    mimi_profile_end(MIMI_PHASE_HANDOFF);
+    
+    uint32_t total_boot_time_us = hal_get_time_us() - boot_start_us;
+    s_handoff.boot_time_us = total_boot_time_us;
+    s_handoff.loader_time_us = load_time_us;
+    
+    LOG_VERBOSE("Handoff structure at: 0x%08X\n", (uint32_t)&s_handoff);
+    LOG_VERBOSE("Total boot time: %u us (%u ms)\n", 
+        total_boot_time_us, total_boot_time_us / 1000);
+    LOG_VERBOSE("  Storage: %u cmds, %u sectors; FAT: %u lookups, %u reads\n",
+        s_profile.storage_cmds, s_profile.sectors_read,
+        s_profile.fat_lookups, s_profile.fat_reads);
+    LOG_VERBOSE("  Block cache: %u hits, %u misses, %u read-ahead\n",
+        s_profile.block_hits, s_profile.block_misses, s_profile.readahead_reads);
+    
+    LOG("\n");
+    LOG(">>> Jumping to payload at 0x%08X\n", load_result->entry);
+    LOG("========================================\n\n");
+    
+    /* Nothing is logged past this point */
+    if (s_config.logbuf) {
+        uint32_t log_size;
+        const mimi_logbuf_t* log = mimi_logbuf_get(&log_size);
+        mimi_handoff_attach_logbuf(&s_handoff, log, log_size);
+    }
+    
+    /* Drain the console: the payload may reconfigure the UART */
+    hal_console_flush();
+    
+    /* Set LED off before handoff */
+    hal_led_set(false);
+    
+    /* Point of no return: a reset from here on is the payload's */
+    hal_handoff_mark();
+    mimi_handoff_jump(&s_handoff, load_result->entry);
+}
+
 /*============================================================================
  * Main Boot Sequence
  *============================================================================*/
@@ -179,6 +394,15 @@ int main(void) {
     }
     
     boot_start_us = hal_get_time_us();
+    mimi_profile_start(&s_profile, hal_get_time_us);
+    mimi_logbuf_start((mimi_logbuf_t*)s_logbuf, sizeof(s_logbuf));
+    
+    /* Route large copies/fills through platform-optimized routines */
+    mimi_copy4_fn copy4;
+    mimi_set4_fn set4;
+    hal_get_mem_accel(&copy4, &set4);
+    mimi_mem_init(copy4, set4);
+    mimi_crc32_init(hal_get_crc_accel());
     
     /* Initialize configuration with defaults */
     mimi_config_init(&s_config);
@@ -189,6 +413,9 @@ int main(void) {
     /* Get platform information */
     hal_get_platform_info(&platform);
     
+    /* Unconfirmed boots behind us, before anything overwrites the count */
+    mimi_flow_init(&s_flow_ops, &s_fs, &s_config);
+    
     /*------------------------------------------------------------------------
      * Phase 2: Banner and System Info
      *------------------------------------------------------------------------*/
@@ -205,22 +432,57 @@ int main(void) {
         platform.ram_base, 
         platform.ram_base + platform.ram_size,
         platform.ram_size / 1024);
+    for (uint32_t i = 0; i < platform.ram_region_count; i++) {
+        const mimi_mem_region_t* r = &platform.ram_regions[i];
+        LOG_VERBOSE("  0x%08X - 0x%08X %s%s\n", r->base, r->base + r->size,
+            (r->flags & MIMI_MEM_SCRATCH) ? "scratch" : "striped",
+            (r->flags & MIMI_MEM_LOADER) ? ", loader" : "");
+    }
+    if (platform.xip_size > 0) {
+        LOG_VERBOSE("XIP window: 0x%08X - 0x%08X\n",
+            platform.xip_base, platform.xip_base + platform.xip_size);
+    }
     LOG_VERBOSE("Clock: %u MHz\n", platform.sys_clock_hz / 1000000);
     LOG_VERBOSE("\n");
     
     /*------------------------------------------------------------------------
-     * Phase 3: Storage Initialization
+     * Phase 3: Fast Resume
+     *------------------------------------------------------------------------*/
+    
+    if (platform.reset_reason & (MIMI_BOOT_WARM | MIMI_BOOT_WATCHDOG)) {
+        uint32_t resume_start_us = hal_get_time_us();
+        
+        if (mimi_flow_resume(&load_result)) {
+            LOG("Resuming image in RAM (%s reset)\n",
+                (platform.reset_reason & MIMI_BOOT_WATCHDOG) ? "watchdog" : "soft");
+            boot_payload(&load_result, &platform,
+                         MIMI_CONFIG_STR(&s_config, s_config.image_path), boot_start_us,
+                         hal_get_time_us() - resume_start_us, true);
+        }
+    }
+    
+    /* Whatever happens next may replace the image in RAM */
+    mimi_flow_resume_disarm();
+    
+    /*------------------------------------------------------------------------
+     * Phase 4: Storage Initialization
      *------------------------------------------------------------------------*/
     
     LOG("Initializing storage...\n");
     
+    mimi_profile_begin(MIMI_PHASE_STORAGE_INIT);
     if (hal_storage_init() != 0) {
         boot_fail(BLINK_STORAGE_FAIL, "Storage init failed");
     }
+    mimi_profile_end(MIMI_PHASE_STORAGE_INIT);
     
+    mimi_profile_begin(MIMI_PHASE_SD_INIT);
     if (hal_storage_open(&s_storage) != 0) {
         boot_fail(BLINK_STORAGE_FAIL, "SD card not found");
     }
+    mimi_profile_end(MIMI_PHASE_SD_INIT);
+    
+    blkcache_init(&s_blkcache, storage_read_sector, storage_read_sectors);
     
     hal_storage_info_t storage_info;
     hal_storage_info(s_storage, &storage_info);
@@ -229,40 +491,46 @@ int main(void) {
     LOG_VERBOSE("Capacity: %u MB\n", storage_info.total_size / (1024 * 1024));
     
     /*------------------------------------------------------------------------
-     * Phase 4: Mount Filesystem
+     * Phase 5: Boot Manifest
      *------------------------------------------------------------------------*/
     
-    LOG("Mounting filesystem...\n");
+    bool warm = mimi_flow_warm(fs_read_sector, fs_read_sectors);
+    
+    /*------------------------------------------------------------------------
+     * Phase 6: Mount Filesystem
+     *------------------------------------------------------------------------*/
     
-    fat32_err_t fs_err = fat32_mount(&s_fs, fs_read_sector);
-    if (fs_err != FAT32_OK) {
+    if (!warm && !fs_mount()) {
         boot_fail(BLINK_FS_FAIL, "FAT32 mount failed");
     }
     
-    LOG_VERBOSE("Filesystem mounted\n");
-    LOG_VERBOSE("Cluster size: %u bytes\n", s_fs.cluster_size);
-    
     /*------------------------------------------------------------------------
-     * Phase 5: Load Configuration
+     * Phase 7: Load Configuration
      *------------------------------------------------------------------------*/
     
-    LOG("Loading configuration...\n");
-    
-    int cfg_result = mimi_config_load(&s_config, config_read_file, MIMI_DEFAULT_CONFIG);
-    
-    if (cfg_result < 0) {
-        LOG_VERBOSE("No boot.cfg found, using defaults\n");
-    } else {
-        LOG_VERBOSE("Configuration loaded\n");
-    }
-    
-    LOG_VERBOSE("Boot image: %s\n", s_config.image_path);
-    if (s_config.has_fallback) {
-        LOG_VERBOSE("Fallback: %s\n", s_config.fallback_path);
+    if (!warm) {
+        LOG("Loading configuration...\n");
+        
+        mimi_profile_begin(MIMI_PHASE_CONFIG);
+        int cfg_result = mimi_flow_config_load(MIMI_DEFAULT_CONFIG);
+        mimi_profile_end(MIMI_PHASE_CONFIG);
+        
+        if (cfg_result < 0) {
+            LOG_VERBOSE("No boot.cfg found, using defaults\n");
+        } else if (cfg_result > 0) {
+            LOG_VERBOSE("Configuration loaded (compiled copy)\n");
+        } else {
+            LOG_VERBOSE("Configuration loaded\n");
+        }
+        
+        LOG_VERBOSE("Boot image: %s\n", MIMI_CONFIG_STR(&s_config, s_config.image_path));
+        if (s_config.has_fallback) {
+            LOG_VERBOSE("Fallback: %s\n", MIMI_CONFIG_STR(&s_config, s_config.fallback_path));
+        }
     }
     
     /*------------------------------------------------------------------------
-     * Phase 6: Optional Boot Delay
+     * Phase 8: Optional Boot Delay and Menu
      *------------------------------------------------------------------------*/
     
     if (s_config.boot_delay_ms > 0) {
@@ -270,71 +538,101 @@ int main(void) {
         hal_delay_ms(s_config.boot_delay_ms);
     }
     
-    /*------------------------------------------------------------------------
-     * Phase 7: Load ELF Image
-     *------------------------------------------------------------------------*/
-    
-    /* Mark boot attempt */
-    mimi_config_boot_attempt(&s_config);
-    
-    /* Get image path */
+    /* Get image path (attempts are counted once the image is chosen) */
     const char* image_path = mimi_config_get_image(&s_config);
     if (image_path == NULL) {
         boot_fail(BLINK_FILE_NOT_FOUND, "No boot image configured");
     }
     
-    LOG("Loading: %s\n", image_path);
-    
-    /* Open ELF file */
-    fs_err = fat32_open(&s_fs, image_path, &s_loader_ctx.file);
-    if (fs_err != FAT32_OK) {
-        /* Try fallback if available */
-        if (s_config.has_fallback && s_config.fallback_path[0] != '\0') {
-            LOG("Primary image not found, trying fallback...\n");
-            image_path = s_config.fallback_path;
-            fs_err = fat32_open(&s_fs, image_path, &s_loader_ctx.file);
-        }
+    uint32_t menu_pick = boot_menu(image_path);
+    if (menu_pick > 0) {
+        image_path = MIMI_CONFIG_STR(&s_config, s_config.images[menu_pick - 1].path);
         
-        if (fs_err != FAT32_OK) {
-            boot_fail(BLINK_FILE_NOT_FOUND, "Boot image not found");
+        /* The manifest only knows its own image: look this one up */
+        if (warm) {
+            warm = false;
+            if (!fs_mount()) {
+                boot_fail(BLINK_FS_FAIL, "FAT32 mount failed");
+            }
         }
     }
     
-    uint32_t file_size = fat32_size(&s_loader_ctx.file);
-    LOG_VERBOSE("File size: %u bytes\n", file_size);
+    /*------------------------------------------------------------------------
+     * Phase 9: Load ELF Image
+     *------------------------------------------------------------------------*/
     
-    /* Configure loader */
-    mimi_mem_region_t ram_region = {
-        .base = platform.ram_base,
-        .size = platform.ram_size,
-        .flags = MIMI_MEM_READ | MIMI_MEM_WRITE | MIMI_MEM_EXEC | MIMI_MEM_RAM,
-    };
+    LOG("Loading: %s\n", image_path);
+    
+    /* Configure loader: RAM bank by bank, skipping what the loader holds */
+    mimi_mem_region_t regions[HAL_MAX_RAM_REGIONS + 1];
+    uint32_t region_count = 0;
+    
+    for (uint32_t i = 0; i < platform.ram_region_count; i++) {
+        regions[region_count++] = platform.ram_regions[i];
+    }
+    
+    bool use_xip = s_config.xip && platform.xip_size > 0;
+    if (use_xip) {
+        /* Payload flash: programmed separately, executed in place */
+        regions[region_count++] = (mimi_mem_region_t){
+            .base = platform.xip_base,
+            .size = platform.xip_size,
+            .flags = MIMI_MEM_READ | MIMI_MEM_EXEC | MIMI_MEM_FLASH,
+        };
+    }
     
     mimi_loader_config_t loader_config = {
-        .regions = &ram_region,
-        .region_count = 1,
-        .io = &s_loader_io,
+        .regions = regions,
+        .region_count = region_count,
+        .io = &mimi_flow_io,
         .validate_addresses = true,
-        .zero_bss = true,
+        .zero_bss = s_config.zero_bss,
         .verify_after_load = s_config.verify,
+        .allow_xip = use_xip,
+        .compute_crc = s_config.crc || s_config.has_image_crc || s_config.has_delta,
+        .check_crc = s_config.has_image_crc,
+        .expected_crc = s_config.image_crc,
     };
     
-    /* Load ELF */
+    /* Core 1 decodes, zeroes and verifies behind the card reads */
+    if (s_config.multicore && mimi_pipe_start(hal_core1_launch)) {
+        LOG_VERBOSE("Pipeline: core 1 running\n");
+    }
+    
+    /* Load ELF (a warm boot reuses the manifest's validated layout) */
     uint32_t load_start_us = hal_get_time_us();
     
-    err = mimi_elf_load(&loader_config, &s_loader_ctx, &load_result);
+    err = mimi_flow_load(&image_path, &loader_config, menu_pick > 0, &load_result);
     
     uint32_t load_time_us = hal_get_time_us() - load_start_us;
     
+    /* Payload gets core 1 in its power-on state; flash writes need it idle */
+    if (mimi_pipe_active()) {
+        mimi_pipe_stop();
+        hal_core1_reset();
+    }
+    
     if (err != MIMI_OK) {
         LOG("[ERROR] ELF load failed: %s\n", mimi_strerror(err));
         
+        if (warm) {
+            /* The card changed in a way the manifest cannot see: go cold */
+            LOG("Dropping boot manifest and restarting\n");
+            hal_nv_write(HAL_NV_MANIFEST, NULL, 0);
+            hal_console_flush();
+            hal_system_reset();
+        }
+        
         /* Try to give more specific error */
         switch (err) {
+            case MIMI_ERR_NOT_FOUND:
+                boot_fail(BLINK_FILE_NOT_FOUND, "Boot image not found");
+                break;
             case MIMI_ERR_NOT_ELF:
             case MIMI_ERR_NOT_ELF32:
             case MIMI_ERR_NOT_ARM:
             case MIMI_ERR_NOT_EXEC:
+            case MIMI_ERR_BAD_HEADER:
                 boot_fail(BLINK_ELF_INVALID, mimi_strerror(err));
                 break;
             case MIMI_ERR_ADDR_INVALID:
@@ -361,48 +659,37 @@ int main(void) {
     LOG_VERBOSE("  Segments:    %u\n", load_result.segment_count);
     LOG_VERBOSE("  Copied:      %u bytes\n", load_result.bytes_copied);
     LOG_VERBOSE("  Zeroed:      %u bytes (BSS)\n", load_result.bytes_zeroed);
+    if (load_result.bytes_unzeroed > 0) {
+        LOG_VERBOSE("  Unzeroed:    %u bytes (BSS, left to payload)\n",
+            load_result.bytes_unzeroed);
+    }
+    if (load_result.bytes_compressed > 0) {
+        LOG_VERBOSE("  LZ4 input:   %u bytes\n", load_result.bytes_compressed);
+    }
+    if (load_result.bytes_in_place > 0) {
+        LOG_VERBOSE("  In place:    %u bytes (XIP 0x%08X - 0x%08X)\n",
+            load_result.bytes_in_place, load_result.xip_base, load_result.xip_end);
+    }
+    if (load_result.has_crc) {
+        LOG_VERBOSE("  CRC32:       0x%08X%s\n", load_result.crc32,
+            s_config.has_image_crc ? " (checked)" : "");
+    }
     LOG_VERBOSE("  Load time:   %u us\n", load_time_us);
     
-    /*------------------------------------------------------------------------
-     * Phase 8: Build Handoff Structure
-     *------------------------------------------------------------------------*/
-    
-    LOG_VERBOSE("\nPreparing handoff...\n");
-    
-    /* Extract filename for handoff */
-    const char* filename = image_path;
-    const char* p = image_path;
-    while (*p) {
-        if (*p == '/') filename = p + 1;
-        p++;
+    /* Extra files ride along with the boot image */
+    err = mimi_flow_blobs_load(image_path, &loader_config);
+    if (err != MIMI_OK) {
+        boot_fail(BLINK_LOAD_FAIL, mimi_strerror(err));
     }
     
-    mimi_handoff_build(&s_handoff, &load_result, &platform, filename);
-    
-    uint32_t total_boot_time_us = hal_get_time_us() - boot_start_us;
-    s_handoff.boot_time_us = total_boot_time_us;
-    s_handoff.loader_time_us = load_time_us;
-    
-    LOG_VERBOSE("Handoff structure at: 0x%08X\n", (uint32_t)&s_handoff);
-    LOG_VERBOSE("Total boot time: %u us (%u ms)\n", 
-        total_boot_time_us, total_boot_time_us / 1000);
+    /* Manifest, image cache, attempt count and resume record for the next boot */
+    mimi_flow_finish(image_path, &load_result, menu_pick > 0);
     
     /*------------------------------------------------------------------------
-     * Phase 9: Jump to Payload
+     * Phase 10: Handoff and Jump to Payload
      *------------------------------------------------------------------------*/
     
-    LOG("\n");
-    LOG(">>> Jumping to payload at 0x%08X\n", load_result.entry);
-    LOG("========================================\n\n");
-    
-    /* Small delay to let UART flush */
-    hal_delay_ms(10);
-    
-    /* Set LED off before handoff */
-    hal_led_set(false);
-    
-    /* Point of no return */
-    mimi_handoff_jump(&s_handoff, load_result.entry);
+    boot_payload(&load_result, &platform, image_path, boot_start_us, load_time_us, false);
     
     /* Never reached */
     return 0;
@@ -0,0 +1,376 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * delta_pack.c - Delta Image Builder
+ */
+
+#include "delta_pack.h"
+#include "lz4_pack.h"
+#include "mimg_pack.h"
+#include "core/crc32.h"
+#include "core/delta.h"
+#include "core/elf.h"
+#include "core/mimg.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK           MIMG_ALIGN
+#define ALIGN_UP(x)     (((x) + BLOCK - 1) & ~(uint32_t)(BLOCK - 1))
+
+/*============================================================================
+ * Base Image
+ *============================================================================*/
+
+/**
+ * Base segment usable as a source of blocks: its initialized bytes as
+ * they are loaded.
+ */
+typedef struct {
+    uint32_t        vaddr;
+    uint32_t        size;
+    const uint8_t*  data;
+} base_seg_t;
+
+/**
+ * Hash of every block-sized window in the base, for blocks that moved.
+ */
+typedef struct {
+    uint32_t        hash;
+    uint32_t        addr;
+} window_t;
+
+typedef struct {
+    base_seg_t      segs[MIMG_MAX_SEGMENTS];
+    uint32_t        seg_count;
+    window_t*       windows;
+    uint32_t        window_count;
+} base_t;
+
+/* Polynomial rolling hash over BLOCK bytes */
+#define HASH_MUL        0x01000193u
+
+static uint32_t hash_block(const uint8_t* data) {
+    uint32_t h = 0;
+    for (uint32_t i = 0; i < BLOCK; i++) {
+        h = h * HASH_MUL + data[i];
+    }
+    return h;
+}
+
+static int window_cmp(const void* a, const void* b) {
+    const window_t* x = (const window_t*)a;
+    const window_t* y = (const window_t*)b;
+    if (x->hash != y->hash) {
+        return (x->hash < y->hash) ? -1 : 1;
+    }
+    return (x->addr < y->addr) ? -1 : (x->addr > y->addr);
+}
+
+static int base_index(base_t* base) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < base->seg_count; i++) {
+        count += (base->segs[i].size >= BLOCK) ? base->segs[i].size - BLOCK + 1 : 0;
+    }
+    
+    base->windows = malloc((count + 1) * sizeof(window_t));
+    if (base->windows == NULL) {
+        return -1;
+    }
+    
+    /* h(i+1) = (h(i) - d[i] * MUL^(BLOCK-1)) * MUL + d[i+BLOCK] */
+    uint32_t top = 1;
+    for (uint32_t i = 1; i < BLOCK; i++) {
+        top *= HASH_MUL;
+    }
+    
+    for (uint32_t i = 0; i < base->seg_count; i++) {
+        const base_seg_t* seg = &base->segs[i];
+        if (seg->size < BLOCK) {
+            continue;
+        }
+        
+        uint32_t h = hash_block(seg->data);
+        for (uint32_t at = 0; ; at++) {
+            base->windows[base->window_count++] = (window_t){ h, seg->vaddr + at };
+            if (at + BLOCK >= seg->size) {
+                break;
+            }
+            h = (h - seg->data[at] * top) * HASH_MUL + seg->data[at + BLOCK];
+        }
+    }
+    qsort(base->windows, base->window_count, sizeof(window_t), window_cmp);
+    return 0;
+}
+
+/**
+ * Find the base segment holding [addr, addr + size).
+ */
+static const base_seg_t* base_find(const base_t* base, uint32_t addr, uint32_t size) {
+    for (uint32_t i = 0; i < base->seg_count; i++) {
+        const base_seg_t* seg = &base->segs[i];
+        if (addr >= seg->vaddr && addr - seg->vaddr <= seg->size &&
+            size <= seg->size - (addr - seg->vaddr)) {
+            return seg;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Find a base address holding a block: where the target loads
+ * it if they are still there, else any match from the window index.
+ * 
+ * @return  true with *addr set if found
+ */
+static bool base_match(const base_t* base, const uint8_t* data, uint32_t target_addr,
+                       uint32_t* addr) {
+    const base_seg_t* seg = base_find(base, target_addr, BLOCK);
+    if (seg != NULL && memcmp(seg->data + (target_addr - seg->vaddr), data, BLOCK) == 0) {
+        *addr = target_addr;
+        return true;
+    }
+    if (base->window_count == 0) {
+        return false;
+    }
+    
+    window_t key = { hash_block(data), 0 };
+    uint32_t lo = 0;
+    uint32_t hi = base->window_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (window_cmp(&base->windows[mid], &key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    for (; lo < base->window_count && base->windows[lo].hash == key.hash; lo++) {
+        const base_seg_t* at = base_find(base, base->windows[lo].addr, BLOCK);
+        if (memcmp(at->data + (base->windows[lo].addr - at->vaddr), data, BLOCK) == 0) {
+            *addr = base->windows[lo].addr;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*============================================================================
+ * Runs
+ *============================================================================*/
+
+/**
+ * A stretch of the target, before it is placed in the delta.
+ */
+typedef struct {
+    uint32_t        offset;         /* Target offset */
+    uint32_t        size;
+    uint32_t        source;         /* Base address (base runs) */
+    bool            from_base;
+    bool            in_place;       /* source is the target's own load address */
+    uint32_t        target_seg;     /* Runs never span segments of either image */
+    const base_seg_t* base_seg;
+} piece_t;
+
+static bool piece_joins(const piece_t* a, const piece_t* b) {
+    if (a->from_base != b->from_base) {
+        return false;
+    }
+    if (!a->from_base) {
+        return true;
+    }
+    return a->target_seg == b->target_seg && a->base_seg == b->base_seg &&
+           a->in_place == b->in_place && a->source + a->size == b->source;
+}
+
+/**
+ * Merge neighbouring pieces in place.
+ * 
+ * @return  New count
+ */
+static uint32_t pieces_merge(piece_t* pieces, uint32_t count) {
+    uint32_t out = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (out > 0 && piece_joins(&pieces[out - 1], &pieces[i])) {
+            pieces[out - 1].size += pieces[i].size;
+        } else {
+            pieces[out++] = pieces[i];
+        }
+    }
+    return out;
+}
+
+/**
+ * Fit the table: turn the shortest base runs back into literal data
+ * until there are no more than MIMI_DELTA_MAX_RUNS.
+ */
+static uint32_t pieces_limit(piece_t* pieces, uint32_t count) {
+    count = pieces_merge(pieces, count);
+    
+    while (count > MIMI_DELTA_MAX_RUNS) {
+        uint32_t shortest = count;
+        for (uint32_t i = 0; i < count; i++) {
+            if (pieces[i].from_base &&
+                (shortest == count || pieces[i].size < pieces[shortest].size)) {
+                shortest = i;
+            }
+        }
+        pieces[shortest].from_base = false;
+        count = pieces_merge(pieces, count);
+    }
+    return count;
+}
+
+/*============================================================================
+ * Delta Builder
+ *============================================================================*/
+
+static mimg_header_t image_header(const uint8_t* image) {
+    mimg_header_t hdr;
+    memcpy(&hdr, image, sizeof(hdr));
+    return hdr;
+}
+
+static mimg_segment_t image_segment(const uint8_t* image, uint32_t index) {
+    mimg_segment_t seg;
+    memcpy(&seg, image + sizeof(mimg_header_t) + index * sizeof(seg), sizeof(seg));
+    return seg;
+}
+
+/**
+ * Split the target into pieces, one per block: taken from the base
+ * if found there, else literal (headers and padding always are).
+ * 
+ * @return  Piece count, limited to MIMI_DELTA_MAX_RUNS
+ */
+static uint32_t delta_pieces(const base_t* base, const uint8_t* target, uint32_t target_size,
+                             piece_t* pieces) {
+    mimg_header_t hdr = image_header(target);
+    uint32_t count = 0;
+    
+    for (uint32_t offset = 0; offset < target_size; offset += BLOCK) {
+        piece_t* p = &pieces[count++];
+        *p = (piece_t){ .offset = offset, .size = BLOCK };
+        
+        for (uint32_t i = 0; i < hdr.segment_count; i++) {
+            mimg_segment_t seg = image_segment(target, i);
+            
+            /* XIP segments are never copied, so there is nothing to save */
+            if (offset < seg.offset || offset - seg.offset >= seg.filesz ||
+                seg.filesz - (offset - seg.offset) < BLOCK || LZ4_PACK_IN_XIP(seg.vaddr)) {
+                continue;
+            }
+            
+            uint32_t addr = seg.vaddr + (offset - seg.offset);
+            uint32_t source;
+            if (base_match(base, target + offset, addr, &source)) {
+                p->from_base = true;
+                p->source = source;
+                p->in_place = (source == addr);
+                p->target_seg = i;
+                p->base_seg = base_find(base, source, BLOCK);
+            }
+        }
+    }
+    return pieces_limit(pieces, count);
+}
+
+/**
+ * Lay out the delta: header, run table, then the literal pieces, each
+ * at its run's sector alignment.
+ * 
+ * @return  malloc'd delta, or NULL
+ */
+static uint8_t* delta_write(const piece_t* pieces, uint32_t count, const uint8_t* target,
+                            uint32_t target_size, uint32_t base_crc,
+                            uint32_t* out_size, uint32_t* literal_size) {
+    uint32_t data_start = ALIGN_UP(sizeof(mimi_delta_header_t) + count * sizeof(mimi_delta_run_t));
+    uint8_t* out = calloc(1, data_start + target_size + count * BLOCK);
+    if (out == NULL) {
+        return NULL;
+    }
+    
+    mimi_delta_header_t hdr = {
+        .magic = MIMI_DELTA_MAGIC,
+        .version = MIMI_DELTA_VERSION,
+        .run_count = (uint16_t)count,
+        .flags = MIMI_DELTA_IN_PLACE,
+        .image_size = target_size,
+        .base_crc = base_crc,
+    };
+    
+    uint32_t pos = data_start;
+    uint32_t ref_crc = 0;
+    *literal_size = 0;
+    
+    for (uint32_t r = 0; r < count; r++) {
+        const piece_t* p = &pieces[r];
+        mimi_delta_run_t run = {
+            .offset = p->offset,
+            .size = p->size,
+        };
+        
+        if (p->from_base) {
+            run.source = p->source;
+            run.flags = MIMI_DELTA_RUN_BASE;
+            ref_crc = mimi_crc32_update(ref_crc,
+                                        p->base_seg->data + (p->source - p->base_seg->vaddr),
+                                        p->size);
+            if (!p->in_place) {
+                hdr.flags &= ~MIMI_DELTA_IN_PLACE;
+            }
+        } else {
+            pos += (p->offset - pos) & (BLOCK - 1);
+            run.source = pos;
+            memcpy(out + pos, target + p->offset, p->size);
+            pos += p->size;
+            *literal_size += p->size;
+        }
+        memcpy(out + sizeof(hdr) + r * sizeof(run), &run, sizeof(run));
+    }
+    
+    hdr.ref_crc = ref_crc;
+    hdr.header_crc = mimi_crc32_update(mimi_crc32_update(0, &hdr, sizeof(hdr)),
+                                       out + sizeof(hdr), count * sizeof(mimi_delta_run_t));
+    memcpy(out, &hdr, sizeof(hdr));
+    *out_size = pos;
+    return out;
+}
+
+uint8_t* delta_pack(const uint8_t* base_elf, uint32_t base_elf_size,
+                    const uint8_t* target_elf, uint32_t target_elf_size,
+                    bool cache_only, uint32_t* out_size, uint32_t* literal_size) {
+    uint32_t base_size, target_size;
+    uint8_t* base_image = mimg_pack_elf(base_elf, base_elf_size, false, &base_size);
+    uint8_t* target = mimg_pack_elf(target_elf, target_elf_size, false, &target_size);
+    piece_t* pieces = malloc((target_size / BLOCK + 1) * sizeof(piece_t));
+    uint8_t* out = NULL;
+    base_t base = { 0 };
+    
+    if (base_image != NULL && target != NULL && pieces != NULL) {
+        /* Segments the target's loader copies to RAM (XIP ones stay in flash) */
+        mimg_header_t base_hdr = image_header(base_image);
+        for (uint32_t i = 0; i < base_hdr.segment_count; i++) {
+            mimg_segment_t seg = image_segment(base_image, i);
+            if (LZ4_PACK_IN_XIP(seg.vaddr) || seg.filesz == 0 ||
+                (!cache_only && (seg.flags & PF_W))) {
+                continue;
+            }
+            base.segs[base.seg_count++] = (base_seg_t){
+                seg.vaddr, seg.filesz, base_image + seg.offset,
+            };
+        }
+        
+        if (!cache_only || base_index(&base) == 0) {
+            uint32_t count = delta_pieces(&base, target, target_size, pieces);
+            out = delta_write(pieces, count, target, target_size, base_hdr.image_crc,
+                              out_size, literal_size);
+        }
+    }
+    
+    free(base.windows);
+    free(pieces);
+    free(base_image);
+    free(target);
+    return out;
+}
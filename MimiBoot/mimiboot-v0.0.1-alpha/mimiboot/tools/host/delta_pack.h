@@ -0,0 +1,40 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * delta_pack.h - Delta Image Builder
+ * 
+ * Builds the delta format read by src/core/delta.c: the target as a
+ * native image, with every sector of segment data the base already
+ * holds taken from the base instead of stored.
+ */
+
+#ifndef MIMIBOOT_DELTA_PACK_H
+#define MIMIBOOT_DELTA_PACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Build a delta turning base into target.
+ * 
+ * By default only blocks found at the same address in read-only base
+ * segments are reused, so the delta can be applied against the base
+ * still in RAM after a reset as well as against the image cache. With
+ * cache_only set, blocks are also searched for anywhere in the base,
+ * writable segments included, and the delta needs the image cache.
+ * 
+ * @param base          Base ELF (as loaded last, in full)
+ * @param base_size     Base size
+ * @param target        Target ELF
+ * @param target_size   Target size
+ * @param cache_only    Allow base blocks that moved or may change in RAM
+ * @param out_size      Output: delta size
+ * @param literal_size  Output: bytes of the target stored in the delta
+ * @return              malloc'd delta, or NULL if either input is not a
+ *                      usable ELF32 executable
+ */
+uint8_t* delta_pack(const uint8_t* base, uint32_t base_size,
+                    const uint8_t* target, uint32_t target_size,
+                    bool cache_only, uint32_t* out_size, uint32_t* literal_size);
+
+#endif /* MIMIBOOT_DELTA_PACK_H */
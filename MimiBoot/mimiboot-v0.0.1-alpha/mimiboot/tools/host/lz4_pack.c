@@ -0,0 +1,249 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * lz4_pack.c - LZ4 Segment Compressor
+ * 
+ * Hash-chain LZ4 block compressor. Boot time is dominated by storage
+ * reads, so ratio matters far more than compression speed here: every
+ * position's candidates are searched to a fixed depth and the longest
+ * match wins.
+ */
+
+#include "lz4_pack.h"
+#include "core/elf.h"
+#include "core/lz4.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*============================================================================
+ * Block Compressor
+ *============================================================================*/
+
+/* LZ4 block end conditions (kept so any standard decoder accepts the output) */
+#define MFLIMIT         12      /* Last match starts at least this far from the end */
+#define LASTLITERALS    5       /* Trailing bytes that are always literals */
+
+#define MAX_DISTANCE    65535
+#define HASH_BITS       16
+#define CHAIN_DEPTH     256
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint8_t* put_length(uint8_t* op, uint32_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+/**
+ * Emit one sequence. match_len == 0 emits the final literals-only sequence.
+ */
+static uint8_t* put_sequence(uint8_t* op, const uint8_t* literals, uint32_t literal_len,
+                             uint32_t distance, uint32_t match_len) {
+    uint8_t* token = op++;
+    uint32_t lit_nibble = (literal_len >= 15) ? 15 : literal_len;
+    uint32_t match_nibble = 0;
+    
+    if (literal_len >= 15) {
+        op = put_length(op, literal_len - 15);
+    }
+    memcpy(op, literals, literal_len);
+    op += literal_len;
+    
+    if (match_len > 0) {
+        uint32_t ml = match_len - MIMI_LZ4_MIN_MATCH;
+        
+        *op++ = (uint8_t)distance;
+        *op++ = (uint8_t)(distance >> 8);
+        
+        match_nibble = (ml >= 15) ? 15 : ml;
+        if (ml >= 15) {
+            op = put_length(op, ml - 15);
+        }
+    }
+    
+    *token = (uint8_t)((lit_nibble << 4) | match_nibble);
+    return op;
+}
+
+uint32_t lz4_pack_block(const uint8_t* src, uint32_t size, uint8_t* dst) {
+    uint8_t* op = dst;
+    uint32_t anchor = 0;
+    
+    if (size > MFLIMIT) {
+        int32_t* head = malloc(sizeof(int32_t) << HASH_BITS);
+        int32_t* prev = malloc(sizeof(int32_t) * size);
+        if (head == NULL || prev == NULL) {
+            free(head);
+            free(prev);
+            return 0;
+        }
+        memset(head, 0xFF, sizeof(int32_t) << HASH_BITS);
+        
+        uint32_t search_end = size - MFLIMIT;
+        uint32_t match_end = size - LASTLITERALS;
+        uint32_t ip = 0;
+        uint32_t inserted = 0;
+        
+        while (ip < search_end) {
+            /* Bring the chains up to date */
+            for (; inserted <= ip; inserted++) {
+                uint32_t h = hash4(read32(src + inserted));
+                prev[inserted] = head[h];
+                head[h] = (int32_t)inserted;
+            }
+            
+            uint32_t best_len = 0;
+            uint32_t best_dist = 0;
+            uint32_t word = read32(src + ip);
+            int32_t cand = prev[ip];
+            
+            for (uint32_t depth = 0; cand >= 0 && depth < CHAIN_DEPTH; depth++) {
+                uint32_t dist = ip - (uint32_t)cand;
+                if (dist > MAX_DISTANCE) {
+                    break;
+                }
+                
+                if (read32(src + cand) == word) {
+                    uint32_t len = MIMI_LZ4_MIN_MATCH;
+                    while (ip + len < match_end && src[cand + len] == src[ip + len]) {
+                        len++;
+                    }
+                    if (len > best_len) {
+                        best_len = len;
+                        best_dist = dist;
+                    }
+                }
+                cand = prev[cand];
+            }
+            
+            if (best_len >= MIMI_LZ4_MIN_MATCH) {
+                op = put_sequence(op, src + anchor, ip - anchor, best_dist, best_len);
+                ip += best_len;
+                anchor = ip;
+            } else {
+                ip++;
+            }
+        }
+        
+        free(head);
+        free(prev);
+    }
+    
+    op = put_sequence(op, src + anchor, size - anchor, 0, 0);
+    return (uint32_t)(op - dst);
+}
+
+uint32_t lz4_pack_segment(const uint8_t* data, uint32_t size, uint8_t* dst) {
+    if (size < LZ4_PACK_MIN_SIZE) {
+        return 0;
+    }
+    
+    uint32_t packed = lz4_pack_block(data, size, dst + sizeof(mimi_lz4_header_t));
+    if (packed == 0 || packed + sizeof(mimi_lz4_header_t) >= size) {
+        return 0;
+    }
+    
+    mimi_lz4_header_t hdr = { MIMI_LZ4_MAGIC, size };
+    memcpy(dst, &hdr, sizeof(hdr));
+    return packed + (uint32_t)sizeof(mimi_lz4_header_t);
+}
+
+/*============================================================================
+ * ELF Packing
+ *============================================================================*/
+
+uint8_t* lz4_pack_elf(const uint8_t* elf, uint32_t size, uint32_t* out_size) {
+    Elf32_Ehdr eh;
+    
+    if (size < sizeof(eh)) {
+        return NULL;
+    }
+    memcpy(&eh, elf, sizeof(eh));
+    
+    if (!ELF_MAGIC_VALID(&eh) || eh.e_ident[EI_CLASS] != ELFCLASS32 ||
+        eh.e_phentsize != sizeof(Elf32_Phdr) ||
+        eh.e_phoff + (uint32_t)eh.e_phnum * sizeof(Elf32_Phdr) > size) {
+        return NULL;
+    }
+    
+    /* Worst case: every segment stored as is */
+    uint32_t capacity = sizeof(Elf32_Ehdr) + eh.e_phnum * sizeof(Elf32_Phdr);
+    for (uint32_t i = 0; i < eh.e_phnum; i++) {
+        Elf32_Phdr ph;
+        memcpy(&ph, elf + eh.e_phoff + i * sizeof(ph), sizeof(ph));
+        if (ph.p_type == PT_LOAD) {
+            if (ph.p_offset > size || ph.p_filesz > size - ph.p_offset) {
+                return NULL;
+            }
+            capacity += LZ4_PACK_BOUND(ph.p_filesz) + sizeof(mimi_lz4_header_t) + 4;
+        }
+    }
+    
+    uint8_t* out = calloc(1, capacity);
+    if (out == NULL) {
+        return NULL;
+    }
+    
+    uint32_t phnum = 0;
+    for (uint32_t i = 0; i < eh.e_phnum; i++) {
+        Elf32_Phdr ph;
+        memcpy(&ph, elf + eh.e_phoff + i * sizeof(ph), sizeof(ph));
+        phnum += (ph.p_type == PT_LOAD);
+    }
+    
+    uint32_t offset = sizeof(Elf32_Ehdr) + phnum * sizeof(Elf32_Phdr);
+    uint32_t index = 0;
+    
+    for (uint32_t i = 0; i < eh.e_phnum; i++) {
+        Elf32_Phdr ph;
+        memcpy(&ph, elf + eh.e_phoff + i * sizeof(ph), sizeof(ph));
+        if (ph.p_type != PT_LOAD) {
+            continue;
+        }
+        
+        const uint8_t* data = elf + ph.p_offset;
+        bool xip = LZ4_PACK_IN_XIP(ph.p_vaddr);
+        
+        offset = (offset + 3) & ~3u;
+        ph.p_offset = offset;
+        ph.p_align = 4;
+        
+        uint32_t packed = xip ? 0 : lz4_pack_segment(data, ph.p_filesz, out + offset);
+        if (packed > 0) {
+            ph.p_filesz = packed;
+            ph.p_flags |= PF_MIMI_LZ4;
+            data = NULL;
+        }
+        
+        if (data != NULL) {
+            memcpy(out + offset, data, ph.p_filesz);
+        }
+        offset += ph.p_filesz;
+        
+        memcpy(out + sizeof(Elf32_Ehdr) + index * sizeof(ph), &ph, sizeof(ph));
+        index++;
+    }
+    
+    eh.e_phoff = sizeof(Elf32_Ehdr);
+    eh.e_phnum = (uint16_t)phnum;
+    eh.e_shoff = 0;
+    eh.e_shnum = 0;
+    eh.e_shentsize = 0;
+    eh.e_shstrndx = 0;
+    memcpy(out, &eh, sizeof(eh));
+    
+    *out_size = offset;
+    return out;
+}
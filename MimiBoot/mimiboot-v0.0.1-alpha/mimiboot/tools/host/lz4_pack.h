@@ -0,0 +1,71 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * lz4_pack.h - LZ4 Segment Compressor
+ * 
+ * Produces the compressed PT_LOAD format decoded by src/core/lz4.c:
+ * each worthwhile segment's file data is replaced by a
+ * mimi_lz4_header_t followed by a raw LZ4 block, and PF_MIMI_LZ4 is
+ * set in its p_flags. Output is standard LZ4 (any LZ4 block decoder
+ * can unpack it given the header's raw size).
+ */
+
+#ifndef MIMIBOOT_LZ4_PACK_H
+#define MIMIBOOT_LZ4_PACK_H
+
+#include <stdint.h>
+
+/* Segments smaller than this are stored as is */
+#define LZ4_PACK_MIN_SIZE   256
+
+/*
+ * Segments linked into the XIP window run from flash and must stay
+ * byte-identical to what is programmed there.
+ */
+#define LZ4_PACK_XIP_BASE   0x10000000u
+#define LZ4_PACK_XIP_END    0x20000000u
+#define LZ4_PACK_IN_XIP(vaddr)  ((vaddr) >= LZ4_PACK_XIP_BASE && (vaddr) < LZ4_PACK_XIP_END)
+
+/**
+ * Worst-case compressed size of n bytes.
+ */
+#define LZ4_PACK_BOUND(n)   ((n) + (n) / 255 + 16)
+
+/**
+ * Compress one block.
+ * 
+ * @param src       Input
+ * @param size      Input size
+ * @param dst       Output, at least LZ4_PACK_BOUND(size) bytes
+ * @return          Compressed size
+ */
+uint32_t lz4_pack_block(const uint8_t* src, uint32_t size, uint8_t* dst);
+
+/**
+ * Compress one segment's file data into the PF_MIMI_LZ4 format
+ * (mimi_lz4_header_t and LZ4 block).
+ * 
+ * @param data      Segment file data
+ * @param size      Its size
+ * @param dst       Output, at least LZ4_PACK_BOUND(size) + 8 bytes
+ * @return          Bytes written, or 0 if the data is too small or does
+ *                  not shrink (store it as is)
+ */
+uint32_t lz4_pack_segment(const uint8_t* data, uint32_t size, uint8_t* dst);
+
+/**
+ * Compress the PT_LOAD segments of an ELF executable.
+ * 
+ * The output keeps the ELF header and PT_LOAD program headers only;
+ * section headers and other segments are dropped since the loader
+ * never reads them. Segments that do not shrink are left uncompressed.
+ * 
+ * @param elf       Input image
+ * @param size      Input size
+ * @param out_size  Output: packed image size
+ * @return          malloc'd packed image, or NULL if the input is not a
+ *                  usable ELF32 executable
+ */
+uint8_t* lz4_pack_elf(const uint8_t* elf, uint32_t size, uint32_t* out_size);
+
+#endif /* MIMIBOOT_LZ4_PACK_H */
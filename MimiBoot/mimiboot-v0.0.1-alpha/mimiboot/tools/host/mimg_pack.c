@@ -0,0 +1,177 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * mimg_pack.c - Native Image Builder
+ */
+
+#include "mimg_pack.h"
+#include "lz4_pack.h"
+#include "core/crc32.h"
+#include "core/loader.h"
+#include "core/lz4.h"
+#include "core/mimg.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*============================================================================
+ * In-Memory File
+ *============================================================================*/
+
+typedef struct {
+    const uint8_t*  data;
+    uint32_t        size;
+} mem_file_t;
+
+static int32_t mem_read(mimi_file_t file, uint32_t offset, void* buffer, uint32_t size) {
+    const mem_file_t* f = (const mem_file_t*)file;
+    
+    if (offset > f->size || size > f->size - offset) {
+        return -1;
+    }
+    memcpy(buffer, f->data + offset, size);
+    return (int32_t)size;
+}
+
+static int32_t mem_size(mimi_file_t file) {
+    return (int32_t)((const mem_file_t*)file)->size;
+}
+
+static const mimi_io_ops_t s_mem_io = {
+    .read = mem_read,
+    .size = mem_size,
+};
+
+#define ALIGN_UP(x)     (((x) + MIMG_ALIGN - 1) & ~(uint32_t)(MIMG_ALIGN - 1))
+
+/*============================================================================
+ * Image Builder
+ *============================================================================*/
+
+/**
+ * Get a segment's initialized bytes, decoding LZ4 input.
+ * 
+ * @return  Data (malloc'd into *owned if decoded), or NULL on error
+ */
+static const uint8_t* segment_data(const mem_file_t* file, const mimi_seg_desc_t* seg,
+                                   uint32_t* raw_size, uint8_t** owned) {
+    *owned = NULL;
+    
+    if (!(seg->flags & PF_MIMI_LZ4)) {
+        if (seg->offset > file->size || seg->filesz > file->size - seg->offset) {
+            return NULL;
+        }
+        *raw_size = seg->filesz;
+        return file->data + seg->offset;
+    }
+    
+    *owned = malloc(seg->memsz + 1);
+    if (*owned == NULL ||
+        mimi_lz4_decode(&s_mem_io, (mimi_file_t)file, seg->offset, seg->filesz,
+                        *owned, seg->memsz, false, raw_size) != MIMI_OK) {
+        free(*owned);
+        *owned = NULL;
+        return NULL;
+    }
+    return *owned;
+}
+
+uint8_t* mimg_pack_elf(const uint8_t* elf, uint32_t size, bool compress, uint32_t* out_size) {
+    mem_file_t file = { elf, size };
+    
+    /* No regions: addresses are checked by the target's loader */
+    mimi_loader_config_t config = {
+        .io = &s_mem_io,
+    };
+    
+    static mimi_elf_layout_t layout;
+    if (mimi_elf_parse(&config, &file, &layout) != MIMI_OK ||
+        layout.segment_count > MIMG_MAX_SEGMENTS) {
+        return NULL;
+    }
+    
+    /* Load order: by address (insertion sort - counts are tiny) */
+    uint32_t order[MIMI_MAX_SEGMENTS];
+    for (uint32_t i = 0; i < layout.segment_count; i++) {
+        uint32_t pos = i;
+        while (pos > 0 && layout.segments[order[pos - 1]].vaddr > layout.segments[i].vaddr) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = i;
+    }
+    
+    /* Worst case: every segment stored as is, plus padding */
+    uint32_t capacity = MIMG_ALIGN;
+    for (uint32_t i = 0; i < layout.segment_count; i++) {
+        const mimi_seg_desc_t* seg = &layout.segments[i];
+        capacity += ALIGN_UP(LZ4_PACK_BOUND(seg->memsz) + sizeof(mimi_lz4_header_t));
+    }
+    
+    uint8_t* out = calloc(1, capacity);
+    if (out == NULL) {
+        return NULL;
+    }
+    
+    mimg_header_t hdr = {
+        .magic = MIMG_MAGIC,
+        .version = MIMG_VERSION,
+        .segment_count = (uint16_t)layout.segment_count,
+        .entry = layout.entry,
+        .load_base = layout.load_base,
+        .load_end = layout.load_end,
+        .total_size = layout.total_size,
+    };
+    
+    uint32_t offset = MIMG_ALIGN;
+    uint32_t addr_end = 0;
+    uint32_t crc = 0;
+    
+    for (uint32_t i = 0; i < layout.segment_count; i++) {
+        const mimi_seg_desc_t* seg = &layout.segments[order[i]];
+        
+        if (seg->vaddr < addr_end) {
+            free(out);
+            return NULL;
+        }
+        addr_end = seg->vaddr + seg->memsz;
+        
+        uint32_t raw_size;
+        uint8_t* owned;
+        const uint8_t* data = segment_data(&file, seg, &raw_size, &owned);
+        if (data == NULL) {
+            free(out);
+            return NULL;
+        }
+        crc = mimi_crc32_update(crc, data, raw_size);
+        
+        mimg_segment_t entry = {
+            .offset = offset,
+            .vaddr = seg->vaddr,
+            .paddr = seg->paddr,
+            .filesz = raw_size,
+            .memsz = seg->memsz,
+            .flags = seg->flags & ~PF_MIMI_LZ4,
+        };
+        
+        uint32_t packed = (compress && !LZ4_PACK_IN_XIP(seg->vaddr))
+                        ? lz4_pack_segment(data, raw_size, out + offset) : 0;
+        if (packed > 0) {
+            entry.filesz = packed;
+            entry.flags |= PF_MIMI_LZ4;
+        } else {
+            memcpy(out + offset, data, raw_size);
+        }
+        free(owned);
+        
+        memcpy(out + sizeof(hdr) + i * sizeof(entry), &entry, sizeof(entry));
+        offset = ALIGN_UP(offset + entry.filesz);
+    }
+    *out_size = offset;
+    
+    hdr.image_crc = crc;
+    hdr.header_crc = mimi_crc32_update(mimi_crc32_update(0, &hdr, sizeof(hdr)),
+                                       out + sizeof(hdr),
+                                       layout.segment_count * sizeof(mimg_segment_t));
+    memcpy(out, &hdr, sizeof(hdr));
+    return out;
+}
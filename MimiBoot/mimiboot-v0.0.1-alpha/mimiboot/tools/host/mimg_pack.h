@@ -0,0 +1,35 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * mimg_pack.h - Native Image Builder
+ * 
+ * Converts an ELF executable into the MimiBoot native image format
+ * (src/core/mimg.h): PT_LOAD segments sorted by load address, each
+ * starting on a sector boundary right after the previous one, with
+ * the image CRC recorded in the header.
+ */
+
+#ifndef MIMIBOOT_MIMG_PACK_H
+#define MIMIBOOT_MIMG_PACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Build a native image from an ELF executable.
+ * 
+ * The ELF is parsed by the loader itself, so the input may already be
+ * LZ4-packed by mimiboot_pack; such segments are decoded first. With
+ * compress set, every segment that shrinks is stored LZ4-compressed
+ * (execute-in-place segments never are).
+ * 
+ * @param elf       Input image
+ * @param size      Input size
+ * @param compress  LZ4-compress segment data
+ * @param out_size  Output: native image size
+ * @return          malloc'd native image, or NULL if the input is not a
+ *                  usable ELF32 executable or has overlapping segments
+ */
+uint8_t* mimg_pack_elf(const uint8_t* elf, uint32_t size, bool compress, uint32_t* out_size);
+
+#endif /* MIMIBOOT_MIMG_PACK_H */
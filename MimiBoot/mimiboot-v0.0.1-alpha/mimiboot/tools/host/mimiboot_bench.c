@@ -0,0 +1,851 @@
+/**
+ * MimiBoot - Host Simulation
+ * 
+ * mimiboot_bench.c - Loader and FAT32 I/O Benchmarks
+ * 
+ * Builds synthetic card images covering the layouts that matter for
+ * boot time, boots each one and reports storage commands, sectors,
+ * FAT traffic and simulated storage time. Loaded memory is checked
+ * byte for byte against the ELF.
+ * 
+ * Usage:
+ *     mimiboot_bench                  Print results
+ *     mimiboot_bench -c baseline      Fail if any counter exceeds the baseline
+ *     mimiboot_bench -w baseline      Write current counters as the baseline
+ *     mimiboot_bench -d dir           Also save each card image to dir
+ */
+
+#include "sim_boot.h"
+#include "sim_image.h"
+#include "sim_storage.h"
+#include "lz4_pack.h"
+#include "mimg_pack.h"
+#include "delta_pack.h"
+#include "core/elf.h"
+#include "core/bootstate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*============================================================================
+ * Scenarios
+ *============================================================================*/
+
+#define KB(n)           ((n) * 1024u)
+#define CARD_SECTORS    65536           /* 32 MB */
+
+typedef struct {
+    const char*     name;
+    const char*     path;               /* Image path on the card */
+    uint32_t        sectors_per_cluster;
+    sim_frag_t      frag;
+    uint32_t        dir_fill;           /* Filler entries per directory */
+    bool            verify;
+    bool            xip;                /* Payload pre-programmed in flash */
+    bool            compress;           /* Store the image LZ4-packed */
+    bool            native;             /* Store it as a native image (mimiboot_image) */
+    bool            multicore;          /* Pipeline to a second (host) core */
+    const char*     config;             /* boot.cfg contents (image chosen by it) */
+    bool            warm;               /* Measure the second boot (boot manifest) */
+    bool            config_cache;       /* Measure the second boot (compiled boot.cfg) */
+    bool            resume;             /* ...after a watchdog reset, RAM kept */
+    const char*     delta;              /* Delta to the ELF; the image is an older build */
+    bool            delta_cache;        /* ...for the image cache only, RAM cleared */
+    struct {
+        const char* path;
+        uint32_t    addr;
+        uint32_t    size;
+    }               loads[2];           /* Files for the config's load lines, in order */
+    const char*     broken;             /* Path of a corrupt primary (fallback expected) */
+    uint32_t        broken_phoff;       /* ...the ELF's own header with this e_phoff instead */
+    const char*     crashing;           /* Path of a primary that never confirms (same ELF) */
+    sim_elf_spec_t  elf;
+} scenario_t;
+
+static const scenario_t s_scenarios[] = {
+    {
+        .name = "contiguous",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "fragmented",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .frag = { 2, 1 },
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "small_clusters",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 1,
+        .frag = { 7, 1 },
+        .elf = {
+            .entry = 0x20000101, .seg_count = 1,
+            .segs = {
+                { 0x20000000, KB(64), KB(64), PF_R | PF_X },
+            },
+        },
+    },
+    {
+        .name = "large_bss",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(8), KB(8),   PF_R | PF_X },
+                { 0x20002000, KB(1), KB(224), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "many_segments",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 12, .align = 16,
+            .segs = {
+                { 0x20000000, 3000, 3000, PF_R | PF_X },
+                { 0x20001000, 2100, 2500, PF_R | PF_W },
+                { 0x20002000, 5000, 5000, PF_R },
+                { 0x20004000, 700,  900,  PF_R | PF_W },
+                { 0x20005000, 4096, 4096, PF_R | PF_X },
+                { 0x20006000, 1234, 4000, PF_R | PF_W },
+                { 0x20008000, 9000, 9000, PF_R },
+                { 0x2000B000, 64,   64,   PF_R },
+                { 0x2000C000, 2048, 8192, PF_R | PF_W },
+                { 0x20010000, 777,  777,  PF_R | PF_X },
+                { 0x20011000, 3333, 3333, PF_R },
+                { 0x20012000, 100,  2000, PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "native_segments",
+        .path = "/boot/kernel.mim",
+        .sectors_per_cluster = 8,
+        .native = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 12, .align = 16,
+            .segs = {
+                { 0x20000000, 3000, 3000, PF_R | PF_X },
+                { 0x20001000, 2100, 2500, PF_R | PF_W },
+                { 0x20002000, 5000, 5000, PF_R },
+                { 0x20004000, 700,  900,  PF_R | PF_W },
+                { 0x20005000, 4096, 4096, PF_R | PF_X },
+                { 0x20006000, 1234, 4000, PF_R | PF_W },
+                { 0x20008000, 9000, 9000, PF_R },
+                { 0x2000B000, 64,   64,   PF_R },
+                { 0x2000C000, 2048, 8192, PF_R | PF_W },
+                { 0x20010000, 777,  777,  PF_R | PF_X },
+                { 0x20011000, 3333, 3333, PF_R },
+                { 0x20012000, 100,  2000, PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "deep_path",
+        .path = "/sys/boot/images/rel/v1/arm/m0/kernel.elf",
+        .sectors_per_cluster = 8,
+        .dir_fill = 40,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 1,
+            .segs = {
+                { 0x20000000, KB(16), KB(16), PF_R | PF_X },
+            },
+        },
+    },
+    {
+        .name = "xip",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .xip = true,
+        .elf = {
+            .entry = 0x10004101, .seg_count = 2,
+            .segs = {
+                { 0x10004000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20000000, KB(8),  KB(24), PF_R | PF_W, 0x1001C000 },
+            },
+        },
+    },
+    {
+        .name = "compressed",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .compress = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2, .compressible = true,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "native_lz4",
+        .path = "/boot/kernel.mim",
+        .sectors_per_cluster = 8,
+        .compress = true,
+        .native = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2, .compressible = true,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "compressed_verify",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .compress = true,
+        .verify = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2, .compressible = true,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "verify",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .verify = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "multicore_lz4",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .compress = true,
+        .verify = true,
+        .multicore = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2, .compressible = true,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "multicore_verify",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .verify = true,
+        .multicore = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "fallback",
+        .path = "/boot/recovery.elf",
+        .sectors_per_cluster = 8,
+        .broken = "/boot/kernel.elf",
+        .config = "image = /boot/kernel.elf\nfallback = /boot/recovery.elf\n",
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "bad_phoff",
+        .path = "/boot/recovery.elf",
+        .sectors_per_cluster = 8,
+        .broken = "/boot/kernel.elf",
+        .broken_phoff = 0xFFFFFFF0,
+        .config = "image = /boot/kernel.elf\nfallback = /boot/recovery.elf\n",
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "crash_loop",
+        .path = "/boot/recovery.elf",
+        .sectors_per_cluster = 8,
+        .crashing = "/boot/kernel.elf",
+        .config = "image = /boot/kernel.elf\nfallback = /boot/recovery.elf\n"
+                  "max_retries = 2\nmanifest = 1\n",
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "cached_config",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .config = "# Board defaults\n"
+                  "image = /boot/kernel.elf\nfallback = /boot/recovery.elf\n"
+                  "timeout = 3000\ndelay = 0\nbaudrate = 115200\nverbose = 0\n"
+                  "verify = 0\nzero_bss = 1\nmax_retries = 3\nmanifest = 0\n",
+        .config_cache = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "cold_manifest",
+        .path = "/sys/boot/images/rel/v1/arm/m0/kernel.elf",
+        .sectors_per_cluster = 8,
+        .dir_fill = 40,
+        .frag = { 2, 1 },
+        .config = "image = /sys/boot/images/rel/v1/arm/m0/kernel.elf\nmanifest = 1\n",
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "warm_manifest",
+        .path = "/sys/boot/images/rel/v1/arm/m0/kernel.elf",
+        .sectors_per_cluster = 8,
+        .dir_fill = 40,
+        .frag = { 2, 1 },
+        .config = "image = /sys/boot/images/rel/v1/arm/m0/kernel.elf\nmanifest = 1\n",
+        .warm = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "resume",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .config = "image = /boot/kernel.elf\nmanifest = 1\nresume = 1\n",
+        .warm = true,
+        .resume = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, 0,      KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "delta_ram",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .config = "image = /boot/kernel.elf\npatch = /boot/kernel.mdl\n",
+        .delta = "/boot/kernel.mdl",
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "delta_flash",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .config = "image = /boot/kernel.elf\npatch = /boot/kernel.mdl\n",
+        .delta = "/boot/kernel.mdl",
+        .delta_cache = true,
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+    {
+        .name = "co_load",
+        .path = "/boot/kernel.elf",
+        .sectors_per_cluster = 8,
+        .config = "image = /boot/kernel.elf\n"
+                  "load = /boot/core1.bin 0x20020000\n"
+                  "load = /boot/table.bin 0x20028000\n",
+        .loads = {
+            { "/boot/core1.bin", 0x20020000, KB(16) },
+            { "/boot/table.bin", 0x20028000, 6000 },
+        },
+        .elf = {
+            .entry = 0x20000101, .seg_count = 2,
+            .segs = {
+                { 0x20000000, KB(96), KB(96), PF_R | PF_X },
+                { 0x20018000, KB(8),  KB(24), PF_R | PF_W },
+            },
+        },
+    },
+};
+
+#define SCENARIO_COUNT  (sizeof(s_scenarios) / sizeof(s_scenarios[0]))
+
+/*============================================================================
+ * Image Construction
+ *============================================================================*/
+
+/**
+ * Add filler files to every directory on the way to path, so lookups
+ * have to scan past them.
+ */
+static int add_dir_fill(sim_volume_t* vol, const char* path, uint32_t count) {
+    char dir[128];
+    const char* p = path;
+    
+    while ((p = strchr(p + 1, '/')) != NULL) {
+        size_t len = (size_t)(p - path);
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+        
+        for (uint32_t i = 0; i < count; i++) {
+            char file[160];
+            snprintf(file, sizeof(file), "%s/F%05u.DAT", dir, i);
+            if (sim_volume_add_file(vol, file, "x", 1, NULL) != 0) {
+                return -1;
+            }
+        }
+    }
+    
+    /* Root as well */
+    for (uint32_t i = 0; i < count; i++) {
+        char file[32];
+        snprintf(file, sizeof(file), "/R%05u.DAT", i);
+        if (sim_volume_add_file(vol, file, "x", 1, NULL) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * An older build of an ELF: a few bytes changed every 32KB of each
+ * segment's data, as by a small fix.
+ */
+static uint8_t* older_build(const uint8_t* elf, uint32_t size) {
+    uint8_t* old = malloc(size);
+    if (old == NULL) {
+        return NULL;
+    }
+    memcpy(old, elf, size);
+    
+    Elf32_Ehdr eh;
+    memcpy(&eh, elf, sizeof(eh));
+    for (uint32_t i = 0; i < eh.e_phnum; i++) {
+        Elf32_Phdr ph;
+        memcpy(&ph, elf + eh.e_phoff + i * sizeof(ph), sizeof(ph));
+        for (uint32_t at = 100; ph.p_type == PT_LOAD && at < ph.p_filesz; at += KB(32)) {
+            old[ph.p_offset + at] ^= 0xFF;
+        }
+    }
+    return old;
+}
+
+#define LOAD_COUNT      (sizeof(((scenario_t*)0)->loads) / sizeof(((scenario_t*)0)->loads[0]))
+
+/* Contents of a load item: distinct per item and per byte */
+static uint8_t load_byte(uint32_t item, uint32_t i) {
+    return (uint8_t)((i * 7 + (i >> 8) + item * 0x35) ^ 0x5C);
+}
+
+/**
+ * Add the load items, last first, so their card order is not the
+ * order they are configured in.
+ */
+static int add_loads(const scenario_t* sc, sim_volume_t* vol) {
+    for (uint32_t n = LOAD_COUNT; n-- > 0; ) {
+        if (sc->loads[n].path == NULL) {
+            continue;
+        }
+        
+        uint8_t* data = malloc(sc->loads[n].size);
+        if (data == NULL) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < sc->loads[n].size; i++) {
+            data[i] = load_byte(n, i);
+        }
+        int rc = sim_volume_add_file(vol, sc->loads[n].path, data, sc->loads[n].size, NULL);
+        free(data);
+        if (rc != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Check every load item in RAM.
+ * 
+ * @return  Items configured, or -1 if one is wrong
+ */
+static int check_loads(const scenario_t* sc) {
+    int count = 0;
+    for (uint32_t n = 0; n < LOAD_COUNT && sc->loads[n].path != NULL; n++) {
+        const uint8_t* ram = (const uint8_t*)(uintptr_t)sc->loads[n].addr;
+        for (uint32_t i = 0; i < sc->loads[n].size; i++) {
+            if (ram[i] != load_byte(n, i)) {
+                return -1;
+            }
+        }
+        count++;
+    }
+    return count;
+}
+
+/* Truncated header: a primary that fails to parse */
+static const uint8_t s_broken[] = { 0x7F, 'E', 'L', 'F', 1, 1, 1, 0 };
+
+/*
+ * A valid ELF header whose phdr table offset is out of range, padded
+ * to the loader's first read. The offset plus the table size wraps in
+ * 32 bits, so a single bound check would take the table from outside
+ * the header buffer.
+ */
+static uint8_t* bad_phoff_header(const uint8_t* elf, uint32_t phoff, uint32_t* size) {
+    Elf32_Ehdr eh;
+    uint8_t* head = calloc(1, 512);
+    if (head == NULL) {
+        return NULL;
+    }
+    memcpy(&eh, elf, sizeof(eh));
+    eh.e_phoff = phoff;
+    memcpy(head, &eh, sizeof(eh));
+    *size = 512;
+    return head;
+}
+
+static int build_card(const scenario_t* sc, sim_volume_t* vol, uint8_t** elf) {
+    uint32_t elf_size;
+    
+    *elf = sim_elf_build(&sc->elf, &elf_size);
+    if (*elf == NULL) {
+        return -1;
+    }
+    
+    /* The card gets the packed image; loads are checked against the original */
+    uint8_t* packed = NULL;
+    uint8_t* delta = NULL;
+    uint32_t delta_size = 0;
+    const uint8_t* image = *elf;
+    if (sc->delta != NULL) {
+        uint32_t literal_size;
+        packed = older_build(*elf, elf_size);
+        delta = (packed != NULL) ? delta_pack(packed, elf_size, *elf, elf_size, sc->delta_cache,
+                                              &delta_size, &literal_size) : NULL;
+        if (delta == NULL) {
+            free(packed);
+            return -1;
+        }
+        image = packed;
+    } else if (sc->native) {
+        packed = mimg_pack_elf(*elf, elf_size, sc->compress, &elf_size);
+        if (packed == NULL) {
+            return -1;
+        }
+        image = packed;
+    } else if (sc->compress) {
+        packed = lz4_pack_elf(*elf, elf_size, &elf_size);
+        if (packed == NULL) {
+            return -1;
+        }
+        image = packed;
+    }
+    
+    /* The corrupt primary, unless it is the short header */
+    const uint8_t* broken = s_broken;
+    uint32_t broken_size = sizeof(s_broken);
+    uint8_t* bad_head = NULL;
+    if (sc->broken_phoff != 0) {
+        bad_head = bad_phoff_header(*elf, sc->broken_phoff, &broken_size);
+        if (bad_head == NULL) {
+            free(packed);
+            free(delta);
+            return -1;
+        }
+        broken = bad_head;
+    }
+    
+    if (sim_volume_create(vol, CARD_SECTORS, sc->sectors_per_cluster) != 0) {
+        free(packed);
+        free(delta);
+        free(bad_head);
+        return -1;
+    }
+    
+    /* Directories first, then filler, so the image lands at the end */
+    char dir[128];
+    snprintf(dir, sizeof(dir), "%s", sc->path);
+    *strrchr(dir, '/') = '\0';
+    int rc = 0;
+    if ((sc->config != NULL &&
+         sim_volume_add_file(vol, "/boot.cfg", sc->config, strlen(sc->config), NULL) != 0) ||
+        (dir[0] != '\0' && sim_volume_mkdir(vol, dir) != 0) ||
+        (sc->broken != NULL &&
+         sim_volume_add_file(vol, sc->broken, broken, broken_size, NULL) != 0) ||
+        (sc->crashing != NULL &&
+         sim_volume_add_file(vol, sc->crashing, image, elf_size, NULL) != 0) ||
+        (sc->delta != NULL &&
+         sim_volume_add_file(vol, sc->delta, delta, delta_size, NULL) != 0) ||
+        add_loads(sc, vol) != 0 ||
+        (sc->dir_fill > 0 && add_dir_fill(vol, sc->path, sc->dir_fill) != 0) ||
+        sim_volume_add_file(vol, sc->path, image, elf_size,
+                            sc->frag.run_clusters ? &sc->frag : NULL) != 0) {
+        rc = -1;
+    }
+    
+    free(packed);
+    free(delta);
+    free(bad_head);
+    if (rc == 0) {
+        sim_volume_finish(vol);
+    }
+    return rc;
+}
+
+/*============================================================================
+ * Baseline
+ *============================================================================*/
+
+typedef struct {
+    uint32_t    commands;
+    uint32_t    sectors;
+    uint32_t    fat_reads;
+} counters_t;
+
+static bool baseline_lookup(const char* file, const char* name, counters_t* out) {
+    FILE* f = fopen(file, "r");
+    if (f == NULL) {
+        return false;
+    }
+    
+    char line[256];
+    char key[64];
+    bool found = false;
+    
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (line[0] == '#') {
+            continue;
+        }
+        if (sscanf(line, "%63s %u %u %u", key, &out->commands,
+                   &out->sectors, &out->fat_reads) == 4 && strcmp(key, name) == 0) {
+            found = true;
+            break;
+        }
+    }
+    
+    fclose(f);
+    return found;
+}
+
+/*============================================================================
+ * Main
+ *============================================================================*/
+
+int main(int argc, char** argv) {
+    const char* check_path = NULL;
+    const char* write_path = NULL;
+    const char* dump_dir = NULL;
+    int opt;
+    
+    while ((opt = getopt(argc, argv, "c:w:d:")) != -1) {
+        switch (opt) {
+            case 'c': check_path = optarg; break;
+            case 'w': write_path = optarg; break;
+            case 'd': dump_dir = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-c baseline] [-w baseline] [-d dir]\n", argv[0]);
+                return 2;
+        }
+    }
+    
+    if (sim_target_map() != 0) {
+        fprintf(stderr, "cannot map target RAM at 0x%08X\n", SIM_RAM_BASE);
+        return 1;
+    }
+    
+    FILE* out = NULL;
+    if (write_path != NULL) {
+        out = fopen(write_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "cannot write %s\n", write_path);
+            return 1;
+        }
+        fprintf(out, "# scenario commands sectors fat_reads\n");
+    }
+    
+    int failures = 0;
+    
+    printf("%-16s %7s %8s %8s %8s %9s %9s %10s\n",
+           "scenario", "cmds", "sectors", "fat_lkp", "fat_rd", "copied", "zeroed", "storage_us");
+    
+    for (uint32_t i = 0; i < SCENARIO_COUNT; i++) {
+        const scenario_t* sc = &s_scenarios[i];
+        sim_volume_t vol;
+        uint8_t* elf = NULL;
+        
+        if (build_card(sc, &vol, &elf) != 0) {
+            printf("%-16s image build failed\n", sc->name);
+            failures++;
+            free(elf);
+            sim_volume_free(&vol);
+            continue;
+        }
+        
+        if (dump_dir != NULL) {
+            char file[256];
+            snprintf(file, sizeof(file), "%s/%s.img", dump_dir, sc->name);
+            sim_volume_save(&vol, file);
+        }
+        
+        sim_storage_t dev;
+        sim_storage_attach(&dev, vol.data, vol.total_sectors * 512);
+        sim_target_clear();
+        
+        if (sc->xip) {
+            sim_elf_program_flash(elf, SIM_XIP_BASE, SIM_XIP_SIZE);
+        }
+        
+        sim_boot_opts_t opts = {
+            .image_path = (sc->config == NULL) ? sc->path : NULL,
+            .verify = sc->verify,
+            .xip = sc->xip,
+            .multicore = sc->multicore,
+        };
+        sim_boot_result_t r;
+        mimi_err_t err = sim_boot(&dev, &opts, &r);
+        
+        /*
+         * Second boot from the same card, flash kept. RAM is cleared, as
+         * after a power cycle, or for a resume kept with only the
+         * writable segments scribbled on, as by a payload that ran.
+         * A delta is measured once the older build in full has filled
+         * the image cache, the card then updated with the delta.
+         */
+        if (sc->delta != NULL && err == MIMI_OK && !r.cache_saved) {
+            err = MIMI_ERR_STALE;
+        }
+        if ((sc->warm || sc->config_cache || sc->delta != NULL) && err == MIMI_OK) {
+            if (sc->resume || (sc->delta != NULL && !sc->delta_cache)) {
+                for (uint32_t s = 0; s < sc->elf.seg_count; s++) {
+                    if (sc->elf.segs[s].flags & PF_W) {
+                        memset((void*)(uintptr_t)sc->elf.segs[s].vaddr, 0x5A,
+                               sc->elf.segs[s].memsz);
+                    }
+                }
+                opts.reset_reason = MIMI_BOOT_WATCHDOG;
+            } else {
+                memset((void*)(uintptr_t)SIM_RAM_BASE, 0xA5, SIM_RAM_SIZE);
+            }
+            err = sim_boot(&dev, &opts, &r);
+            if (sc->delta != NULL ? !r.delta || r.delta_cached != sc->delta_cache :
+                sc->config_cache ? !r.config_cached : sc->resume ? !r.resumed : !r.warm) {
+                err = MIMI_ERR_STALE;
+            }
+        }
+        
+        /*
+         * The primary resets before confirming until its attempts run
+         * out and the fallback is booted. The measured boot follows a
+         * power cycle, with only the boot log left to skip the primary.
+         */
+        if (sc->crashing != NULL && err == MIMI_OK) {
+            opts.reset_reason = MIMI_BOOT_WATCHDOG;
+            for (uint32_t n = 0; n < MIMI_BOOTCOUNT_MAX && err == MIMI_OK && !r.fallback; n++) {
+                err = sim_boot(&dev, &opts, &r);
+            }
+            if (err == MIMI_OK && !r.given_up) {
+                err = MIMI_ERR_STALE;
+            }
+            
+            opts.reset_reason = 0;
+            memset((void*)(uintptr_t)SIM_RAM_BASE, 0xA5, SIM_RAM_SIZE);
+            if (err == MIMI_OK) {
+                err = sim_boot(&dev, &opts, &r);
+            }
+        }
+        
+        /* A resumed image is not read again, so it has no image CRC */
+        bool ok = (err == MIMI_OK) && sim_elf_check(&sc->elf, elf) &&
+                  (r.resumed || (r.load.has_crc && r.load.crc32 == sim_elf_crc(elf))) &&
+                  r.fallback == (sc->broken != NULL || sc->crashing != NULL) &&
+                  check_loads(sc) == (int)r.blobs_loaded;
+        
+        printf("%-16s %7u %8u %8u %8u %9u %9u %10u%s\n",
+               sc->name, r.storage.commands, r.storage.blocks_read,
+               r.fat_lookups, r.fat_reads, r.load.bytes_copied, r.load.bytes_zeroed,
+               r.total_us, ok ? "" : "  LOAD FAILED");
+        if (!ok) {
+            failures++;
+        }
+        
+        if (out != NULL) {
+            fprintf(out, "%s %u %u %u\n", sc->name, r.storage.commands,
+                    r.storage.blocks_read, r.fat_reads);
+        }
+        
+        counters_t base;
+        if (check_path != NULL && baseline_lookup(check_path, sc->name, &base)) {
+            if (r.storage.commands > base.commands ||
+                r.storage.blocks_read > base.sectors ||
+                r.fat_reads > base.fat_reads) {
+                printf("  regression: baseline %u cmds, %u sectors, %u fat reads\n",
+                       base.commands, base.sectors, base.fat_reads);
+                failures++;
+            }
+        }
+        
+        free(elf);
+        sim_volume_free(&vol);
+    }
+    
+    if (out != NULL) {
+        fclose(out);
+    }
+    
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * mimiboot_crc.c - Print the image CRC the loader will compute
+ * 
+ * Usage:
+ *     mimiboot_crc <payload.elf>
+ * 
+ * Prints the CRC-32 of the payload as loaded (see compute_crc in
+ * loader.h), for `image_crc = ...` in boot.cfg. LZ4-packed images
+ * are decoded first, so the value is the same before and after
+ * mimiboot_pack. The ELF is parsed by the loader itself, so segment
+ * order always matches the target.
+ */
+
+#include "core/loader.h"
+#include "core/crc32.h"
+#include "core/elf.h"
+#include "core/lz4.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*============================================================================
+ * In-Memory File
+ *============================================================================*/
+
+typedef struct {
+    const uint8_t*  data;
+    uint32_t        size;
+} mem_file_t;
+
+static int32_t mem_read(mimi_file_t file, uint32_t offset, void* buffer, uint32_t size) {
+    const mem_file_t* f = (const mem_file_t*)file;
+    
+    if (offset > f->size || size > f->size - offset) {
+        return -1;
+    }
+    memcpy(buffer, f->data + offset, size);
+    return (int32_t)size;
+}
+
+static int32_t mem_size(mimi_file_t file) {
+    return (int32_t)((const mem_file_t*)file)->size;
+}
+
+static const mimi_io_ops_t s_mem_io = {
+    .read = mem_read,
+    .size = mem_size,
+};
+
+static uint8_t* read_file(const char* path, uint32_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    
+    uint8_t* data = (len > 0) ? malloc((size_t)len) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    
+    fclose(f);
+    *size = (uint32_t)len;
+    return data;
+}
+
+/*============================================================================
+ * Main
+ *============================================================================*/
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s payload.elf\n", argv[0]);
+        return 2;
+    }
+    
+    mem_file_t file;
+    file.data = read_file(argv[1], &file.size);
+    if (file.data == NULL) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    
+    /* No regions: addresses are the target's business */
+    mimi_loader_config_t config = {
+        .io = &s_mem_io,
+    };
+    
+    static mimi_elf_layout_t layout;
+    mimi_err_t err = mimi_elf_parse(&config, &file, &layout);
+    
+    uint32_t crc = 0;
+    for (uint32_t i = 0; err == MIMI_OK && i < layout.segment_count; i++) {
+        const mimi_seg_desc_t* seg = &layout.segments[i];
+        
+        if (seg->flags & PF_MIMI_LZ4) {
+            uint8_t* raw = malloc(seg->memsz + 1);
+            uint32_t raw_size = 0;
+            
+            err = (raw == NULL) ? MIMI_ERR_NO_MEMORY
+                                : mimi_lz4_decode(&s_mem_io, &file, seg->offset, seg->filesz,
+                                                  raw, seg->memsz, false, &raw_size);
+            if (err == MIMI_OK) {
+                crc = mimi_crc32_update(crc, raw, raw_size);
+            }
+            free(raw);
+        } else if (seg->offset + seg->filesz <= file.size) {
+            crc = mimi_crc32_update(crc, file.data + seg->offset, seg->filesz);
+        } else {
+            err = MIMI_ERR_READ;
+        }
+    }
+    
+    if (err != MIMI_OK) {
+        fprintf(stderr, "%s: %s\n", argv[1], mimi_strerror(err));
+        free((void*)file.data);
+        return 1;
+    }
+    
+    printf("image_crc = 0x%08X\n", crc);
+    free((void*)file.data);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * mimiboot_delta.c - Delta between two builds of a payload
+ * 
+ * Usage:
+ *     mimiboot_delta [-f] <base.elf> <target.elf> <out.mdl>
+ * 
+ * Writes a delta (src/core/delta.h) that rebuilds target as a native
+ * image from base, loaded last, plus the sectors that changed. Name
+ * it in boot.cfg with "patch"; image still names the full base (or
+ * target) for when the delta cannot be applied.
+ * 
+ * By default the delta reuses only read-only sectors at unchanged
+ * addresses, so it applies against the base still in RAM after a
+ * reset as well as against the flash image cache. -f also reuses
+ * sectors that moved and writable data; it then needs the cache.
+ */
+
+#include "delta_pack.h"
+#include "core/delta.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t* read_file(const char* path, uint32_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    
+    uint8_t* data = (len > 0) ? malloc((size_t)len) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    
+    fclose(f);
+    *size = (uint32_t)len;
+    return data;
+}
+
+int main(int argc, char** argv) {
+    bool cache_only = (argc == 5 && strcmp(argv[1], "-f") == 0);
+    if (argc != 4 + cache_only) {
+        fprintf(stderr, "usage: %s [-f] base.elf target.elf out.mdl\n", argv[0]);
+        return 2;
+    }
+    const char* base_path = argv[1 + cache_only];
+    const char* target_path = argv[2 + cache_only];
+    const char* out_path = argv[3 + cache_only];
+    
+    uint32_t base_size, target_size;
+    uint8_t* base = read_file(base_path, &base_size);
+    uint8_t* target = read_file(target_path, &target_size);
+    if (base == NULL || target == NULL) {
+        fprintf(stderr, "cannot read %s\n", (base == NULL) ? base_path : target_path);
+        free(base);
+        free(target);
+        return 1;
+    }
+    
+    uint32_t out_size, literal_size;
+    uint8_t* out = delta_pack(base, base_size, target, target_size, cache_only,
+                              &out_size, &literal_size);
+    if (out == NULL) {
+        fprintf(stderr, "%s or %s: not a 32-bit ELF executable, or segments overlap\n",
+                base_path, target_path);
+        free(base);
+        free(target);
+        return 1;
+    }
+    
+    mimi_delta_header_t hdr;
+    memcpy(&hdr, out, sizeof(hdr));
+    printf("%s: %u runs, %u of %u bytes stored, base_crc = 0x%08X%s\n", out_path,
+           hdr.run_count, literal_size, hdr.image_size, hdr.base_crc,
+           (hdr.flags & MIMI_DELTA_IN_PLACE) ? "" : " (image cache only)");
+    
+    FILE* f = fopen(out_path, "wb");
+    int rc = 0;
+    if (f == NULL || fwrite(out, 1, out_size, f) != out_size) {
+        fprintf(stderr, "cannot write %s\n", out_path);
+        rc = 1;
+    }
+    if (f != NULL) {
+        fclose(f);
+    }
+    
+    free(base);
+    free(target);
+    free(out);
+    return rc;
+}
@@ -0,0 +1,94 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * mimiboot_image.c - Convert an ELF payload into a native image
+ * 
+ * Usage:
+ *     mimiboot_image [-z] <in.elf> <out.mim>
+ * 
+ * Writes the MimiBoot native image format (src/core/mimg.h): one
+ * header sector, then the segments in load order on sector
+ * boundaries. The loader takes it in place of the ELF and skips
+ * ELF header validation, segment sorting and pairwise overlap
+ * checks. -z stores the segments LZ4-compressed, as mimiboot_pack
+ * does for ELF.
+ */
+
+#include "mimg_pack.h"
+#include "core/elf.h"
+#include "core/mimg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t* read_file(const char* path, uint32_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    
+    uint8_t* data = (len > 0) ? malloc((size_t)len) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    
+    fclose(f);
+    *size = (uint32_t)len;
+    return data;
+}
+
+int main(int argc, char** argv) {
+    bool compress = (argc == 4 && strcmp(argv[1], "-z") == 0);
+    if (argc != 3 + compress) {
+        fprintf(stderr, "usage: %s [-z] in.elf out.mim\n", argv[0]);
+        return 2;
+    }
+    const char* in_path = argv[1 + compress];
+    const char* out_path = argv[2 + compress];
+    
+    uint32_t in_size;
+    uint8_t* in = read_file(in_path, &in_size);
+    if (in == NULL) {
+        fprintf(stderr, "cannot read %s\n", in_path);
+        return 1;
+    }
+    
+    uint32_t out_size;
+    uint8_t* out = mimg_pack_elf(in, in_size, compress, &out_size);
+    if (out == NULL) {
+        fprintf(stderr, "%s: not a 32-bit ELF executable, or segments overlap\n", in_path);
+        free(in);
+        return 1;
+    }
+    
+    /* Per-segment summary */
+    mimg_header_t hdr;
+    memcpy(&hdr, out, sizeof(hdr));
+    for (uint32_t i = 0; i < hdr.segment_count; i++) {
+        mimg_segment_t seg;
+        memcpy(&seg, out + sizeof(hdr) + i * sizeof(seg), sizeof(seg));
+        printf("  0x%08X  %8u bytes at 0x%06X  %s\n", seg.vaddr, seg.filesz, seg.offset,
+               (seg.flags & PF_MIMI_LZ4) ? "lz4" : "stored");
+    }
+    printf("%s: %u -> %u bytes, image_crc = 0x%08X\n", out_path, in_size, out_size,
+           hdr.image_crc);
+    
+    FILE* f = fopen(out_path, "wb");
+    int rc = 0;
+    if (f == NULL || fwrite(out, 1, out_size, f) != out_size) {
+        fprintf(stderr, "cannot write %s\n", out_path);
+        rc = 1;
+    }
+    if (f != NULL) {
+        fclose(f);
+    }
+    
+    free(in);
+    free(out);
+    return rc;
+}
@@ -0,0 +1,88 @@
+/**
+ * MimiBoot - Host Tools
+ * 
+ * mimiboot_pack.c - Compress an ELF payload for faster loading
+ * 
+ * Usage:
+ *     mimiboot_pack <in.elf> <out.elf>
+ * 
+ * Rewrites the PT_LOAD segments as LZ4 (PF_MIMI_LZ4); the loader
+ * decompresses them while reading, so fewer sectors cross the SD bus.
+ * Execute-in-place segments and data that does not shrink are kept
+ * uncompressed.
+ */
+
+#include "lz4_pack.h"
+#include "core/elf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t* read_file(const char* path, uint32_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    
+    uint8_t* data = (len > 0) ? malloc((size_t)len) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    
+    fclose(f);
+    *size = (uint32_t)len;
+    return data;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s in.elf out.elf\n", argv[0]);
+        return 2;
+    }
+    
+    uint32_t in_size;
+    uint8_t* in = read_file(argv[1], &in_size);
+    if (in == NULL) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    
+    uint32_t out_size;
+    uint8_t* out = lz4_pack_elf(in, in_size, &out_size);
+    if (out == NULL) {
+        fprintf(stderr, "%s: not a 32-bit ELF executable\n", argv[1]);
+        free(in);
+        return 1;
+    }
+    
+    /* Per-segment summary */
+    Elf32_Ehdr eh;
+    memcpy(&eh, out, sizeof(eh));
+    for (uint32_t i = 0; i < eh.e_phnum; i++) {
+        Elf32_Phdr ph;
+        memcpy(&ph, out + eh.e_phoff + i * sizeof(ph), sizeof(ph));
+        printf("  0x%08X  %8u bytes in file  %s\n", ph.p_vaddr, ph.p_filesz,
+               (ph.p_flags & PF_MIMI_LZ4) ? "lz4" : "stored");
+    }
+    printf("%s: %u -> %u bytes (%.1f%%)\n", argv[2], in_size, out_size,
+           100.0 * out_size / in_size);
+    
+    FILE* f = fopen(argv[2], "wb");
+    int rc = 0;
+    if (f == NULL || fwrite(out, 1, out_size, f) != out_size) {
+        fprintf(stderr, "cannot write %s\n", argv[2]);
+        rc = 1;
+    }
+    if (f != NULL) {
+        fclose(f);
+    }
+    
+    free(in);
+    free(out);
+    return rc;
+}
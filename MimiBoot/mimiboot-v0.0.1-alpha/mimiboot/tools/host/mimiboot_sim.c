@@ -0,0 +1,76 @@
+/**
+ * MimiBoot - Host Simulation
+ * 
+ * mimiboot_sim.c - Boot an SD card image on the host
+ * 
+ * Usage:
+ *     mimiboot_sim [options] <card.img>
+ * 
+ *     -i <path>       Image to load (default: from boot.cfg)
+ *     -c <path>       Configuration file (default: /boot.cfg)
+ *     -v              Verify after load
+ *     -l <cmd,blk,stop>  Latency model in microseconds
+ */
+
+#include "sim_boot.h"
+#include "sim_storage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-i image] [-c config] [-v] [-m] [-l cmd,blk,stop] card.img\n", prog);
+}
+
+int main(int argc, char** argv) {
+    sim_boot_opts_t opts = { 0 };
+    sim_latency_t latency = {
+        SIM_DEFAULT_CMD_US, SIM_DEFAULT_BLOCK_US, SIM_DEFAULT_STOP_US,
+    };
+    int opt;
+    
+    while ((opt = getopt(argc, argv, "i:c:vml:")) != -1) {
+        switch (opt) {
+            case 'i': opts.image_path = optarg; break;
+            case 'c': opts.config_path = optarg; break;
+            case 'v': opts.verify = true; break;
+            case 'm': opts.multicore = true; break;
+            case 'l':
+                if (sscanf(optarg, "%u,%u,%u", &latency.cmd_us,
+                           &latency.block_us, &latency.stop_us) != 3) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    
+    if (sim_target_map() != 0) {
+        fprintf(stderr, "cannot map target RAM at 0x%08X\n", SIM_RAM_BASE);
+        return 1;
+    }
+    sim_target_clear();
+    
+    sim_storage_t dev;
+    if (sim_storage_load(&dev, argv[optind]) != 0) {
+        fprintf(stderr, "cannot read %s\n", argv[optind]);
+        return 1;
+    }
+    dev.latency = latency;
+    
+    sim_boot_result_t result;
+    mimi_err_t err = sim_boot(&dev, &opts, &result);
+    sim_boot_print(&result);
+    
+    sim_storage_free(&dev);
+    return (err == MIMI_OK) ? 0 : 1;
+}
@@ -0,0 +1,446 @@
+/**
+ * MimiBoot - Host Simulation
+ * 
+ * sim_boot.c - Boot Flow Against a Simulated Card
+ */
+
+#define _GNU_SOURCE
+#include "sim_boot.h"
+#include "core/config.h"
+#include "core/crc32.h"
+#include "core/profile.h"
+#include "core/pipeline.h"
+#include "core/boot_flow.h"
+#include "core/bootstate.h"
+#include "hal/hal.h"
+#include "fs/blkcache.h"
+#include "fs/fat32.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/*============================================================================
+ * Target Memory
+ *============================================================================*/
+
+static bool s_mapped = false;
+
+int sim_target_map(void) {
+    if (s_mapped) {
+        return 0;
+    }
+    
+    static const struct {
+        uint32_t base;
+        uint32_t size;
+    } ranges[] = {
+        { SIM_RAM_BASE,   SIM_RAM_SIZE },
+        { SIM_FLASH_BASE, SIM_FLASH_SIZE },
+    };
+    
+    for (size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+        void* want = (void*)(uintptr_t)ranges[i].base;
+        void* p = mmap(want, ranges[i].size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if (p == MAP_FAILED || p != want) {
+            return -1;
+        }
+    }
+    
+    s_mapped = true;
+    return 0;
+}
+
+/* Retained words (watchdog scratch on the target) */
+static uint32_t s_retain[SIM_RETAIN_WORDS];
+
+void sim_target_clear(void) {
+    memset((void*)(uintptr_t)SIM_RAM_BASE, 0xA5, SIM_RAM_SIZE);
+    memset((void*)(uintptr_t)SIM_FLASH_BASE, 0xFF, SIM_FLASH_SIZE);
+    memset(s_retain, 0, sizeof(s_retain));
+}
+
+void sim_target_confirm(void) {
+    s_retain[MIMI_BOOTCOUNT_WORD] = MIMI_BOOT_CONFIRMED;
+}
+
+/*============================================================================
+ * Callbacks
+ *============================================================================*/
+
+static sim_storage_t*   s_dev;
+static fat32_fs_t       s_fs;
+static blkcache_t       s_blkcache;
+
+static int storage_read_sector(uint32_t sector, uint8_t* buffer) {
+    return sim_storage_read_blocks(s_dev, sector, buffer, 1);
+}
+
+static int storage_read_sectors(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    return sim_storage_read_blocks(s_dev, sector, buffer, count);
+}
+
+static int fs_read_sector(uint32_t sector, uint8_t* buffer) {
+    return blkcache_read(&s_blkcache, sector, buffer);
+}
+
+static int fs_read_sectors(uint32_t sector, uint8_t* buffer, uint32_t count) {
+    return blkcache_read_run(&s_blkcache, sector, buffer, count);
+}
+
+/*============================================================================
+ * Flash and Retained Words (boot flow services, as hal_nv_* and friends)
+ *============================================================================*/
+
+static uint8_t* nv_block(uint32_t block, uint32_t* size) {
+    switch (block) {
+        case HAL_NV_MANIFEST: *size = SIM_NV_SIZE;  return (uint8_t*)(uintptr_t)SIM_NV_BASE;
+        case HAL_NV_LOG:      *size = SIM_LOG_SIZE; return (uint8_t*)(uintptr_t)SIM_LOG_BASE;
+        case HAL_NV_CONFIG:   *size = SIM_CFG_SIZE; return (uint8_t*)(uintptr_t)SIM_CFG_BASE;
+        default:              *size = 0;            return NULL;
+    }
+}
+
+static const void* sim_nv_data(uint32_t block, uint32_t* size) {
+    return nv_block(block, size);
+}
+
+static int sim_nv_append(uint32_t block, uint32_t offset, const void* data, uint32_t size,
+                         bool erase) {
+    uint32_t block_size;
+    uint8_t* p = nv_block(block, &block_size);
+    
+    if (p == NULL || offset + size > block_size) {
+        return -1;
+    }
+    if (erase) {
+        memset(p, 0xFF, block_size);
+    }
+    memcpy(p + offset, data, size);
+    return 0;
+}
+
+static int sim_nv_write(uint32_t block, const void* data, uint32_t size) {
+    return sim_nv_append(block, 0, data, size, true);
+}
+
+static const void* sim_cache_data(uint32_t* size) {
+    *size = SIM_CACHE_SIZE;
+    return (const void*)(uintptr_t)SIM_CACHE_BASE;
+}
+
+static int sim_cache_write(uint32_t offset, const void* data, uint32_t size) {
+    uint8_t* cache = (uint8_t*)(uintptr_t)SIM_CACHE_BASE;
+    uint32_t erase = (size > 0) ? size : 1;
+    
+    if (offset % 4096 != 0 || offset + size > SIM_CACHE_SIZE) {
+        return -1;
+    }
+    
+    /* Every sector covered is erased first */
+    memset(cache + offset, 0xFF, (erase + 4095) & ~4095u);
+    memcpy(cache + offset, data, size);
+    return 0;
+}
+
+static uint32_t sim_retain_count(void) {
+    return SIM_RETAIN_WORDS;
+}
+
+static uint32_t sim_retain_get(uint32_t index) {
+    return s_retain[index];
+}
+
+static void sim_retain_set(uint32_t index, uint32_t value) {
+    s_retain[index] = value;
+}
+
+static uint32_t sim_retain_addr(uint32_t index) {
+    /* The simulated payload confirms through sim_target_confirm */
+    return 0;
+}
+
+static const mimi_flow_ops_t s_flow_ops = {
+    .nv_data = sim_nv_data,
+    .nv_write = sim_nv_write,
+    .nv_append = sim_nv_append,
+    .cache_data = sim_cache_data,
+    .cache_write = sim_cache_write,
+    .retain_count = sim_retain_count,
+    .retain_get = sim_retain_get,
+    .retain_set = sim_retain_set,
+    .retain_addr = sim_retain_addr,
+};
+
+/*============================================================================
+ * Second Core (host thread)
+ *============================================================================*/
+
+static pthread_t s_core1;
+static bool      s_core1_running = false;
+
+static void* core1_thread(void* arg) {
+    void (*entry)(void) = (void (*)(void))arg;
+    entry();
+    return NULL;
+}
+
+static bool core1_launch(void (*entry)(void)) {
+    if (pthread_create(&s_core1, NULL, core1_thread, (void*)entry) != 0) {
+        return false;
+    }
+    s_core1_running = true;
+    return true;
+}
+
+/**
+ * Stop the pipeline and join the worker (main.c resets the core).
+ */
+static void core1_stop(void) {
+    mimi_pipe_stop();
+    if (s_core1_running) {
+        pthread_join(s_core1, NULL);
+        s_core1_running = false;
+    }
+}
+
+/*============================================================================
+ * Boot Flow
+ *============================================================================*/
+
+static mimi_err_t fail(sim_boot_result_t* result, mimi_err_t err, const char* step) {
+    result->status = err;
+    result->failed_step = step;
+    return err;
+}
+
+static void finish(sim_boot_result_t* result) {
+    result->storage = s_dev->stats;
+    result->fat_lookups = s_fs.fat_lookups;
+    result->fat_reads = s_fs.fat_reads;
+    result->dir_reads = s_fs.dir_reads;
+    result->dir_hits = s_fs.dir_hits;
+    result->block_hits = s_blkcache.hits;
+    result->block_misses = s_blkcache.misses;
+    result->readahead_reads = s_blkcache.ahead_reads;
+    result->total_us = sim_clock_us() - 1;
+    
+    result->profile.storage_cmds = result->storage.commands;
+    result->profile.sectors_read = result->storage.blocks_read;
+    result->profile.fat_lookups = result->fat_lookups;
+    result->profile.fat_reads = result->fat_reads;
+    result->profile.bytes_copied = result->load.bytes_copied;
+    result->profile.bytes_zeroed = result->load.bytes_zeroed;
+    result->profile.block_hits = result->block_hits;
+    result->profile.block_misses = result->block_misses;
+    result->profile.readahead_reads = result->readahead_reads;
+}
+
+mimi_err_t sim_boot(sim_storage_t* dev, const sim_boot_opts_t* opts, sim_boot_result_t* result) {
+    static mimi_config_t config;
+    
+    memset(result, 0, sizeof(*result));
+    memset(&s_fs, 0, sizeof(s_fs));
+    s_dev = dev;
+    blkcache_init(&s_blkcache, storage_read_sector, storage_read_sectors);
+    sim_storage_reset_stats(dev);
+    mimi_profile_start(&result->profile, sim_clock_us);
+    
+    /* Power-on clears the retained words */
+    if (opts->reset_reason == 0) {
+        memset(s_retain, 0, sizeof(s_retain));
+    }
+    mimi_config_init(&config);
+    mimi_flow_init(&s_flow_ops, &s_fs, &config);
+    const mimi_flow_status_t* flow = mimi_flow_status();
+    
+    /* An image given on the command line skips resume and the manifest, like a menu pick */
+    bool one_off = opts->image_path != NULL;
+    
+    /* Fast resume */
+    if (!one_off && (opts->reset_reason & (MIMI_BOOT_WARM | MIMI_BOOT_WATCHDOG))) {
+        result->resumed = mimi_flow_resume(&result->load);
+        
+        if (result->resumed) {
+            snprintf(result->image_path, sizeof(result->image_path), "%s",
+                     MIMI_CONFIG_STR(&config, config.image_path));
+            result->boot_count = config.boot_count;
+            finish(result);
+            result->status = MIMI_OK;
+            return MIMI_OK;
+        }
+    }
+    mimi_flow_resume_disarm();
+    
+    /* Boot manifest */
+    if (!one_off) {
+        result->warm = mimi_flow_warm(fs_read_sector, fs_read_sectors);
+    }
+    
+    /* Mount */
+    if (!result->warm) {
+        mimi_profile_begin(MIMI_PHASE_MOUNT);
+        if (fat32_mount(&s_fs, fs_read_sector) != FAT32_OK) {
+            return fail(result, MIMI_ERR_IO, "mount");
+        }
+        fat32_set_multi_read(&s_fs, fs_read_sectors);
+        mimi_profile_end(MIMI_PHASE_MOUNT);
+    }
+    
+    /* Configuration */
+    if (!result->warm) {
+        mimi_profile_begin(MIMI_PHASE_CONFIG);
+        result->config_cached = mimi_flow_config_load((opts->config_path != NULL) ?
+                                                      opts->config_path : MIMI_DEFAULT_CONFIG) > 0;
+        mimi_profile_end(MIMI_PHASE_CONFIG);
+    }
+    
+    const char* path = one_off ? opts->image_path : mimi_config_get_image(&config);
+    if (path == NULL) {
+        return fail(result, MIMI_ERR_NOT_FOUND, "config");
+    }
+    /* Load */
+    mimi_mem_region_t regions[2] = {
+        {
+            .base = SIM_RAM_BASE,
+            .size = SIM_RAM_SIZE,
+            .flags = MIMI_MEM_READ | MIMI_MEM_WRITE | MIMI_MEM_EXEC | MIMI_MEM_RAM,
+        },
+        {
+            .base = SIM_XIP_BASE,
+            .size = SIM_XIP_SIZE,
+            .flags = MIMI_MEM_READ | MIMI_MEM_EXEC | MIMI_MEM_FLASH,
+        },
+    };
+    
+    bool use_xip = opts->xip || config.xip;
+    
+    mimi_loader_config_t loader_config = {
+        .regions = regions,
+        .region_count = use_xip ? 2 : 1,
+        .io = &mimi_flow_io,
+        .validate_addresses = true,
+        .zero_bss = config.zero_bss,
+        .verify_after_load = opts->verify || config.verify,
+        .allow_xip = use_xip,
+        .compute_crc = config.crc || config.has_image_crc || config.has_delta,
+        .check_crc = config.has_image_crc,
+        .expected_crc = config.image_crc,
+    };
+    
+    if (opts->multicore && config.multicore) {
+        mimi_pipe_start(core1_launch);
+    }
+    
+    mimi_err_t err = mimi_flow_load(&path, &loader_config, one_off, &result->load);
+    core1_stop();
+    
+    snprintf(result->image_path, sizeof(result->image_path), "%s", path);
+    result->fallback = flow->fallback;
+    result->delta = flow->delta;
+    result->delta_cached = flow->delta_cached;
+    
+    if (err != MIMI_OK) {
+        /* main.c drops the manifest and resets into a cold boot */
+        if (flow->warm) {
+            sim_nv_write(HAL_NV_MANIFEST, NULL, 0);
+        }
+        finish(result);
+        return fail(result, err, "load");
+    }
+    
+    err = mimi_flow_blobs_load(path, &loader_config);
+    mimi_flow_blobs(&result->blobs_loaded);
+    if (err != MIMI_OK) {
+        finish(result);
+        return fail(result, err, "load items");
+    }
+    
+    mimi_flow_finish(path, &result->load, one_off);
+    result->manifest_saved = flow->manifest_saved;
+    result->cache_saved = flow->cache_saved;
+    result->given_up = flow->given_up;
+    result->resume_armed = flow->resume_armed;
+    result->boot_count = config.boot_count;
+    finish(result);
+    
+    result->status = MIMI_OK;
+    return MIMI_OK;
+}
+
+/*============================================================================
+ * Reporting
+ *============================================================================*/
+
+static const char* const s_phase_names[MIMI_PHASE_COUNT] = {
+    "storage init", "sd init", "mount", "config", "file open",
+    "parse", "copy", "bss", "verify", "handoff", "core1 wait", "crc",
+    "manifest", "resume",
+};
+
+void sim_boot_print(const sim_boot_result_t* result) {
+    printf("image:        %s%s\n", result->image_path,
+           result->resumed ? " (resumed from RAM)" :
+           result->warm ? " (boot manifest)" :
+           result->fallback ? " (fallback)" : "");
+    printf("status:       %s%s%s\n", mimi_strerror(result->status),
+           result->failed_step ? " at " : "",
+           result->failed_step ? result->failed_step : "");
+    printf("segments:     %u (%u bytes copied, %u zeroed, %u in place)\n",
+           result->load.segment_count, result->load.bytes_copied,
+           result->load.bytes_zeroed, result->load.bytes_in_place);
+    if (result->load.bytes_unzeroed > 0) {
+        printf("unzeroed:     %u bytes of BSS left to the payload\n",
+               result->load.bytes_unzeroed);
+    }
+    if (result->load.bytes_compressed > 0) {
+        printf("compressed:   %u bytes read for LZ4 segments\n",
+               result->load.bytes_compressed);
+    }
+    if (result->load.has_crc) {
+        printf("crc32:        0x%08X\n", result->load.crc32);
+    }
+    if (result->delta) {
+        printf("delta:        rebuilt against the image in %s\n",
+               result->delta_cached ? "the image cache" : "RAM");
+    }
+    if (result->blobs_loaded > 0) {
+        printf("load items:   %u\n", result->blobs_loaded);
+    }
+    if (result->manifest_saved) {
+        printf("manifest:     saved\n");
+    }
+    if (result->cache_saved) {
+        printf("image cache:  saved\n");
+    }
+    if (result->resume_armed) {
+        printf("resume:       armed\n");
+    }
+    if (result->boot_count > 0) {
+        printf("boot count:   %u unconfirmed\n", result->boot_count);
+    }
+    if (result->config_cached) {
+        printf("config:       compiled copy\n");
+    }
+    if (result->given_up) {
+        printf("boot log:     primary given up\n");
+    }
+    printf("storage:      %u cmds (%u single, %u multi), %u sectors\n",
+           result->storage.commands, result->storage.single_reads,
+           result->storage.multi_reads, result->storage.blocks_read);
+    printf("fat:          %u lookups, %u sector reads\n",
+           result->fat_lookups, result->fat_reads);
+    printf("directories:  %u sectors read, %u cache hits\n",
+           result->dir_reads, result->dir_hits);
+    printf("block cache:  %u hits, %u misses, %u read-ahead\n",
+           result->block_hits, result->block_misses, result->readahead_reads);
+    printf("storage time: %u us\n", result->total_us);
+    
+    for (uint32_t i = 0; i < MIMI_PHASE_COUNT; i++) {
+        const mimi_phase_time_t* ph = &result->profile.phases[i];
+        if (ph->start_us != 0) {
+            printf("  %-12s %8u us\n", s_phase_names[i], ph->duration_us);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * MimiBoot - Host Simulation
+ * 
+ * sim_boot.h - Boot Flow Against a Simulated Card
+ * 
+ * Runs the same mount / config / open / load sequence as main.c using
+ * the real fat32, config and loader modules, and main.c's boot policy
+ * (core/boot_flow.c) against simulated flash and retained words. Load
+ * addresses are backed by host memory mapped at the target's physical
+ * addresses.
+ */
+
+#ifndef MIMIBOOT_SIM_BOOT_H
+#define MIMIBOOT_SIM_BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim_storage.h"
+#include "core/loader.h"
+#include "../../include/mimiboot/handoff.h"
+
+/* Target RAM (RP2040 striped SRAM) */
+#define SIM_RAM_BASE        0x20000000
+#define SIM_RAM_SIZE        (264 * 1024)
+
+/* Target XIP flash, the part of it left to payloads, the image cache and the non-volatile sectors */
+#define SIM_FLASH_BASE      0x10000000
+#define SIM_FLASH_SIZE      (2 * 1024 * 1024)
+#define SIM_NV_SIZE         0x1000
+#define SIM_NV_BASE         (SIM_FLASH_BASE + SIM_FLASH_SIZE - SIM_NV_SIZE)
+#define SIM_LOG_SIZE        0x1000
+#define SIM_LOG_BASE        (SIM_NV_BASE - SIM_LOG_SIZE)
+#define SIM_CFG_SIZE        0x1000
+#define SIM_CFG_BASE        (SIM_LOG_BASE - SIM_CFG_SIZE)
+#define SIM_CACHE_SIZE      (256 * 1024)
+#define SIM_CACHE_BASE      (SIM_CFG_BASE - SIM_CACHE_SIZE)
+#define SIM_XIP_BASE        (SIM_FLASH_BASE + 0x4000)
+#define SIM_XIP_SIZE        (SIM_CACHE_BASE - SIM_XIP_BASE)
+
+/* Retained words, as on RP2040 (watchdog scratch 0-3) */
+#define SIM_RETAIN_WORDS    4
+
+/**
+ * Boot options. NULL paths fall back to main.c's defaults; the boot
+ * manifest and fast resume are only used when image_path is NULL.
+ */
+typedef struct {
+    const char* config_path;    /* boot.cfg path, NULL for MIMI_DEFAULT_CONFIG */
+    const char* image_path;     /* Overrides the configured image if set (as a menu pick) */
+    bool        verify;         /* Force verify_after_load */
+    bool        xip;            /* Force allow_xip */
+    bool        multicore;      /* Run the core 1 pipeline on a host thread */
+    uint32_t    reset_reason;   /* MIMI_BOOT_* cause of this boot, 0 for power-on
+                                   (which clears the retained words) */
+} sim_boot_opts_t;
+
+/**
+ * Everything measured during one simulated boot.
+ */
+typedef struct {
+    mimi_err_t          status;
+    const char*         failed_step;    /* Step that failed, or NULL */
+    bool                warm;           /* Booted through the boot manifest */
+    bool                fallback;       /* Booted the fallback image */
+    bool                manifest_saved; /* Manifest (re)written afterwards */
+    bool                config_cached;  /* boot.cfg taken from its compiled copy */
+    bool                resumed;        /* Restarted the image in RAM */
+    bool                resume_armed;   /* Resume record set for the next reset */
+    bool                given_up;       /* Primary recorded in the boot log as failing */
+    bool                delta;          /* Rebuilt from the configured delta */
+    bool                delta_cached;   /* ...against the image cache, not RAM */
+    bool                cache_saved;    /* Image cache (re)written afterwards */
+    uint32_t            blobs_loaded;   /* boot.cfg load items loaded */
+    uint32_t            boot_count;     /* Unconfirmed boots of the image, this one included */
+    char                image_path[128];
+    mimi_load_result_t  load;
+    mimi_boot_profile_t profile;
+    sim_stats_t         storage;
+    uint32_t            fat_lookups;
+    uint32_t            fat_reads;
+    uint32_t            dir_reads;      /* Directory sectors read */
+    uint32_t            dir_hits;       /* Lookups answered by the directory cache */
+    uint32_t            block_hits;     /* Sector reads served by the block cache */
+    uint32_t            block_misses;   /* Sector reads that went to storage */
+    uint32_t            readahead_reads;/* Read-ahead transfers issued */
+    uint32_t            total_us;       /* Simulated storage time */
+} sim_boot_result_t;
+
+/**
+ * Map host memory at the target RAM and flash addresses (once per process).
+ * 
+ * @return  0 on success, negative if the range is unavailable
+ */
+int sim_target_map(void);
+
+/**
+ * Clear target RAM, erase flash (boot manifest included) and the
+ * retained words, as at power-on. RAM is filled with a non-zero
+ * pattern so skipped BSS shows up.
+ */
+void sim_target_clear(void);
+
+/**
+ * Confirm the last boot, as the payload does with MIMI_HANDOFF_CONFIRM.
+ */
+void sim_target_confirm(void);
+
+/**
+ * Run a boot against dev. Counters and clock are reset first.
+ * 
+ * @return  MIMI_OK or the first error
+ */
+mimi_err_t sim_boot(sim_storage_t* dev, const sim_boot_opts_t* opts, sim_boot_result_t* result);
+
+/**
+ * Print a result (profile breakdown and counters).
+ */
+void sim_boot_print(const sim_boot_result_t* result);
+
+#endif /* MIMIBOOT_SIM_BOOT_H */
@@ -0,0 +1,485 @@
+/**
+ * MimiBoot - Host Simulation
+ * 
+ * sim_image.c - Synthetic FAT32 and ELF Images
+ */
+
+#include "sim_image.h"
+#include "core/elf.h"
+#include "core/crc32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*============================================================================
+ * Internal Helpers
+ *============================================================================*/
+
+#define SIM_FAT_EOC     0x0FFFFFFF
+#define SIM_FATS        2
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint8_t* cluster_ptr(sim_volume_t* vol, uint32_t cluster) {
+    uint32_t sector = vol->data_start + (cluster - 2) * vol->sectors_per_cluster;
+    return vol->data + ((size_t)sector * 512);
+}
+
+static uint32_t cluster_bytes(const sim_volume_t* vol) {
+    return vol->sectors_per_cluster * 512;
+}
+
+/**
+ * Allocate one cluster, optionally linking it after prev.
+ */
+static uint32_t alloc_cluster(sim_volume_t* vol, uint32_t prev) {
+    while (vol->next_free < vol->cluster_count + 2 && vol->fat[vol->next_free] != 0) {
+        vol->next_free++;
+    }
+    if (vol->next_free >= vol->cluster_count + 2) {
+        return 0;
+    }
+    
+    uint32_t c = vol->next_free++;
+    vol->fat[c] = SIM_FAT_EOC;
+    if (prev != 0) {
+        vol->fat[prev] = c;
+    }
+    memset(cluster_ptr(vol, c), 0, cluster_bytes(vol));
+    return c;
+}
+
+/**
+ * Convert a path component to a space-padded 8.3 name.
+ */
+static int make_short_name(const char* name, size_t len, uint8_t out[11]) {
+    memset(out, ' ', 11);
+    
+    size_t dot = len;
+    for (size_t i = 0; i < len; i++) {
+        if (name[i] == '.') {
+            dot = i;
+        }
+    }
+    if (dot == 0 || dot > 8 || (len - dot) > 4) {
+        return -1;
+    }
+    
+    for (size_t i = 0; i < dot; i++) {
+        char c = name[i];
+        out[i] = (uint8_t)((c >= 'a' && c <= 'z') ? c - 32 : c);
+    }
+    for (size_t i = dot + 1; i < len; i++) {
+        char c = name[i];
+        out[8 + (i - dot - 1)] = (uint8_t)((c >= 'a' && c <= 'z') ? c - 32 : c);
+    }
+    return 0;
+}
+
+static sim_dir_t* find_dir(sim_volume_t* vol, const char* path, size_t len) {
+    for (uint32_t i = 0; i < vol->dir_count; i++) {
+        if (strlen(vol->dirs[i].path) == len && strncmp(vol->dirs[i].path, path, len) == 0) {
+            return &vol->dirs[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Append a 32-byte entry to a directory, growing it if full.
+ */
+static int dir_append(sim_volume_t* vol, sim_dir_t* dir, const uint8_t name[11],
+                      uint8_t attr, uint32_t cluster, uint32_t size) {
+    uint32_t per_cluster = cluster_bytes(vol) / 32;
+    
+    if (dir->entries == per_cluster) {
+        uint32_t c = alloc_cluster(vol, dir->last_cluster);
+        if (c == 0) {
+            return -1;
+        }
+        dir->last_cluster = c;
+        dir->entries = 0;
+    }
+    
+    uint8_t* e = cluster_ptr(vol, dir->last_cluster) + dir->entries * 32;
+    memcpy(e, name, 11);
+    e[11] = attr;
+    put_u16(e + 20, (uint16_t)(cluster >> 16));
+    put_u16(e + 26, (uint16_t)cluster);
+    put_u32(e + 28, size);
+    dir->entries++;
+    return 0;
+}
+
+/**
+ * Find or create the directory holding the last component of path.
+ * On return *leaf points at that component.
+ */
+static sim_dir_t* parent_dir(sim_volume_t* vol, const char* path, const char** leaf) {
+    const char* slash = strrchr(path, '/');
+    if (slash == NULL) {
+        *leaf = path;
+        return &vol->dirs[0];
+    }
+    
+    *leaf = slash + 1;
+    size_t len = (size_t)(slash - path);
+    
+    char parent[128];
+    if (len >= sizeof(parent)) {
+        return NULL;
+    }
+    memcpy(parent, path, len);
+    parent[len] = '\0';
+    
+    if (len > 0 && sim_volume_mkdir(vol, parent) != 0) {
+        return NULL;
+    }
+    return find_dir(vol, parent, len);
+}
+
+/*============================================================================
+ * Volume
+ *============================================================================*/
+
+int sim_volume_create(sim_volume_t* vol, uint32_t total_sectors, uint32_t sectors_per_cluster) {
+    memset(vol, 0, sizeof(*vol));
+    
+    vol->total_sectors = total_sectors;
+    vol->sectors_per_cluster = sectors_per_cluster;
+    vol->reserved_sectors = 32;
+    
+    /* Size the FAT: iterate until the cluster count is stable */
+    uint32_t fat_sectors = 1;
+    for (int i = 0; i < 8; i++) {
+        uint32_t data = total_sectors - vol->reserved_sectors - SIM_FATS * fat_sectors;
+        uint32_t clusters = data / sectors_per_cluster;
+        fat_sectors = ((clusters + 2) * 4 + 511) / 512;
+    }
+    
+    vol->sectors_per_fat = fat_sectors;
+    vol->data_start = vol->reserved_sectors + SIM_FATS * fat_sectors;
+    vol->cluster_count = (total_sectors - vol->data_start) / sectors_per_cluster;
+    vol->next_free = 2;
+    
+    vol->data = calloc(total_sectors, 512);
+    vol->fat = calloc(vol->cluster_count + 2, sizeof(uint32_t));
+    if (vol->data == NULL || vol->fat == NULL) {
+        sim_volume_free(vol);
+        return -1;
+    }
+    
+    vol->fat[0] = 0x0FFFFFF8;
+    vol->fat[1] = SIM_FAT_EOC;
+    
+    /* Boot sector */
+    uint8_t* bs = vol->data;
+    bs[0] = 0xEB;
+    bs[1] = 0x58;
+    bs[2] = 0x90;
+    memcpy(bs + 3, "MIMISIM ", 8);
+    put_u16(bs + 11, 512);
+    bs[13] = (uint8_t)sectors_per_cluster;
+    put_u16(bs + 14, (uint16_t)vol->reserved_sectors);
+    bs[16] = SIM_FATS;
+    bs[21] = 0xF8;
+    put_u32(bs + 32, total_sectors);
+    put_u32(bs + 36, fat_sectors);
+    put_u32(bs + 44, 2);
+    put_u16(bs + 48, 1);
+    memcpy(bs + 82, "FAT32   ", 8);
+    bs[510] = 0x55;
+    bs[511] = 0xAA;
+    
+    /* Root directory */
+    sim_dir_t* root = &vol->dirs[vol->dir_count++];
+    root->path[0] = '\0';
+    root->first_cluster = alloc_cluster(vol, 0);
+    root->last_cluster = root->first_cluster;
+    
+    return 0;
+}
+
+void sim_volume_free(sim_volume_t* vol) {
+    free(vol->data);
+    free(vol->fat);
+    vol->data = NULL;
+    vol->fat = NULL;
+}
+
+int sim_volume_mkdir(sim_volume_t* vol, const char* path) {
+    size_t len = strlen(path);
+    while (len > 0 && path[len - 1] == '/') {
+        len--;
+    }
+    if (len == 0 || find_dir(vol, path, len) != NULL) {
+        return 0;
+    }
+    if (vol->dir_count >= SIM_MAX_DIRS || len >= sizeof(vol->dirs[0].path)) {
+        return -1;
+    }
+    
+    char copy[128];
+    memcpy(copy, path, len);
+    copy[len] = '\0';
+    
+    const char* leaf;
+    sim_dir_t* parent = parent_dir(vol, copy, &leaf);
+    if (parent == NULL) {
+        return -1;
+    }
+    
+    uint8_t name[11];
+    if (make_short_name(leaf, strlen(leaf), name) != 0) {
+        return -1;
+    }
+    
+    uint32_t c = alloc_cluster(vol, 0);
+    if (c == 0 || dir_append(vol, parent, name, 0x10, c, 0) != 0) {
+        return -1;
+    }
+    
+    /* parent_dir may have added directories - take the slot now */
+    sim_dir_t* dir = &vol->dirs[vol->dir_count++];
+    memcpy(dir->path, copy, len + 1);
+    dir->first_cluster = c;
+    dir->last_cluster = c;
+    
+    /* "." and ".." */
+    uint8_t dot[11];
+    memset(dot, ' ', 11);
+    dot[0] = '.';
+    dir_append(vol, dir, dot, 0x10, c, 0);
+    dot[1] = '.';
+    uint32_t up = (parent == &vol->dirs[0]) ? 0 : parent->first_cluster;
+    dir_append(vol, dir, dot, 0x10, up, 0);
+    
+    return 0;
+}
+
+int sim_volume_add_file(sim_volume_t* vol, const char* path,
+                        const void* data, uint32_t size, const sim_frag_t* frag) {
+    const char* leaf;
+    sim_dir_t* parent = parent_dir(vol, path, &leaf);
+    if (parent == NULL) {
+        return -1;
+    }
+    
+    uint8_t name[11];
+    if (make_short_name(leaf, strlen(leaf), name) != 0) {
+        return -1;
+    }
+    
+    uint32_t csize = cluster_bytes(vol);
+    uint32_t needed = (size + csize - 1) / csize;
+    uint32_t first = 0;
+    uint32_t prev = 0;
+    uint32_t in_run = 0;
+    
+    for (uint32_t i = 0; i < needed; i++) {
+        if (frag != NULL && frag->run_clusters > 0 && in_run == frag->run_clusters) {
+            /* Leave a hole by pre-claiming and releasing the gap */
+            for (uint32_t g = 0; g < frag->gap_clusters; g++) {
+                uint32_t hole = alloc_cluster(vol, 0);
+                if (hole == 0) {
+                    return -1;
+                }
+                vol->fat[hole] = 0x0FFFFFF7;    /* Marked bad: never reused */
+            }
+            in_run = 0;
+        }
+        
+        uint32_t c = alloc_cluster(vol, prev);
+        if (c == 0) {
+            return -1;
+        }
+        if (first == 0) {
+            first = c;
+        }
+        
+        uint32_t off = i * csize;
+        uint32_t n = (size - off < csize) ? size - off : csize;
+        memcpy(cluster_ptr(vol, c), (const uint8_t*)data + off, n);
+        
+        prev = c;
+        in_run++;
+    }
+    
+    return dir_append(vol, parent, name, 0x20, first, size);
+}
+
+void sim_volume_finish(sim_volume_t* vol) {
+    for (uint32_t f = 0; f < SIM_FATS; f++) {
+        uint8_t* fat = vol->data + (size_t)(vol->reserved_sectors + f * vol->sectors_per_fat) * 512;
+        for (uint32_t c = 0; c < vol->cluster_count + 2; c++) {
+            put_u32(fat + c * 4, vol->fat[c]);
+        }
+    }
+}
+
+int sim_volume_save(const sim_volume_t* vol, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) {
+        return -1;
+    }
+    size_t n = fwrite(vol->data, 512, vol->total_sectors, f);
+    fclose(f);
+    return (n == vol->total_sectors) ? 0 : -1;
+}
+
+/*============================================================================
+ * ELF Builder
+ *============================================================================*/
+
+static uint8_t pattern_byte(uint32_t seg, uint32_t i) {
+    uint32_t x = (seg + 1) * 2654435761u ^ (i * 2246822519u);
+    x ^= x >> 15;
+    return (uint8_t)x;
+}
+
+/**
+ * Code-like contents: a small instruction vocabulary with frequent
+ * repeats of recent sequences, as compiled firmware has.
+ */
+static void fill_compressible(uint8_t* dst, uint32_t seg, uint32_t size) {
+    uint32_t x = (seg + 1) * 2654435761u;
+    uint32_t i = 0;
+    
+    while (i < size) {
+        x = x * 1103515245u + 12345u;
+        uint32_t run = 8 + ((x >> 8) & 15);
+        
+        if (i >= 64 && ((x >> 16) & 3) != 0) {
+            /* Repeat something seen recently */
+            uint32_t back = 16 + ((x >> 18) % (i < 2048 ? i - 15 : 2033));
+            for (uint32_t j = 0; j < run && i < size; j++, i++) {
+                dst[i] = dst[i - back];
+            }
+        } else {
+            for (uint32_t j = 0; j < run && i < size; j++, i++) {
+                x = x * 1103515245u + 12345u;
+                dst[i] = (uint8_t)(0x40 + ((x >> 20) & 0x1F));
+            }
+        }
+    }
+}
+
+uint8_t* sim_elf_build(const sim_elf_spec_t* spec, uint32_t* out_size) {
+    uint32_t align = (spec->align != 0) ? spec->align : 4;
+    uint32_t offset = sizeof(Elf32_Ehdr) + spec->seg_count * sizeof(Elf32_Phdr);
+    uint32_t offsets[SIM_MAX_SEGS];
+    
+    for (uint32_t i = 0; i < spec->seg_count; i++) {
+        offset = (offset + align - 1) & ~(align - 1);
+        offsets[i] = offset;
+        offset += spec->segs[i].filesz;
+    }
+    
+    uint8_t* img = calloc(1, offset);
+    if (img == NULL) {
+        return NULL;
+    }
+    
+    Elf32_Ehdr eh;
+    memset(&eh, 0, sizeof(eh));
+    eh.e_ident[EI_MAG0] = ELFMAG0;
+    eh.e_ident[EI_MAG1] = ELFMAG1;
+    eh.e_ident[EI_MAG2] = ELFMAG2;
+    eh.e_ident[EI_MAG3] = ELFMAG3;
+    eh.e_ident[EI_CLASS] = ELFCLASS32;
+    eh.e_ident[EI_DATA] = ELFDATA2LSB;
+    eh.e_ident[EI_VERSION] = EV_CURRENT;
+    eh.e_type = ET_EXEC;
+    eh.e_machine = EM_ARM;
+    eh.e_version = EV_CURRENT;
+    eh.e_entry = spec->entry;
+    eh.e_phoff = sizeof(Elf32_Ehdr);
+    eh.e_ehsize = sizeof(Elf32_Ehdr);
+    eh.e_phentsize = sizeof(Elf32_Phdr);
+    eh.e_phnum = (uint16_t)spec->seg_count;
+    memcpy(img, &eh, sizeof(eh));
+    
+    for (uint32_t i = 0; i < spec->seg_count; i++) {
+        const sim_seg_t* s = &spec->segs[i];
+        Elf32_Phdr ph;
+        memset(&ph, 0, sizeof(ph));
+        ph.p_type = PT_LOAD;
+        ph.p_offset = offsets[i];
+        ph.p_vaddr = s->vaddr;
+        ph.p_paddr = (s->paddr != 0) ? s->paddr : s->vaddr;
+        ph.p_filesz = s->filesz;
+        ph.p_memsz = s->memsz;
+        ph.p_flags = s->flags;
+        ph.p_align = align;
+        memcpy(img + sizeof(Elf32_Ehdr) + i * sizeof(Elf32_Phdr), &ph, sizeof(ph));
+        
+        if (spec->compressible) {
+            fill_compressible(img + offsets[i], i, s->filesz);
+        } else {
+            for (uint32_t b = 0; b < s->filesz; b++) {
+                img[offsets[i] + b] = pattern_byte(i, b);
+            }
+        }
+    }
+    
+    *out_size = offset;
+    return img;
+}
+
+void sim_elf_program_flash(const uint8_t* image, uint32_t flash_base, uint32_t flash_size) {
+    Elf32_Ehdr eh;
+    memcpy(&eh, image, sizeof(eh));
+    
+    for (uint32_t i = 0; i < eh.e_phnum; i++) {
+        Elf32_Phdr ph;
+        memcpy(&ph, image + eh.e_phoff + i * sizeof(Elf32_Phdr), sizeof(ph));
+        
+        uint32_t addr = ph.p_paddr;
+        if (addr >= flash_base && addr + ph.p_filesz <= flash_base + flash_size) {
+            memcpy((void*)(uintptr_t)addr, image + ph.p_offset, ph.p_filesz);
+        }
+    }
+}
+
+bool sim_elf_check(const sim_elf_spec_t* spec, const uint8_t* image) {
+    for (uint32_t i = 0; i < spec->seg_count; i++) {
+        Elf32_Phdr ph;
+        memcpy(&ph, image + sizeof(Elf32_Ehdr) + i * sizeof(Elf32_Phdr), sizeof(ph));
+        
+        const uint8_t* mem = (const uint8_t*)(uintptr_t)ph.p_vaddr;
+        if (memcmp(mem, image + ph.p_offset, ph.p_filesz) != 0) {
+            return false;
+        }
+        for (uint32_t b = ph.p_filesz; b < ph.p_memsz; b++) {
+            if (mem[b] != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+uint32_t sim_elf_crc(const uint8_t* image) {
+    Elf32_Ehdr eh;
+    uint32_t crc = 0;
+    
+    memcpy(&eh, image, sizeof(eh));
+    
+    /* sim_elf_build lays segments out in header order */
+    for (uint32_t i = 0; i < eh.e_phnum; i++) {
+        Elf32_Phdr ph;
+        memcpy(&ph, image + eh.e_phoff + i * sizeof(Elf32_Phdr), sizeof(ph));
+        crc = mimi_crc32_update(crc, image + ph.p_offset, ph.p_filesz);
+    }
+    return crc;
+}
@@ -0,0 +1,151 @@
+/**
+ * MimiBoot - Host Simulation
+ * 
+ * sim_image.h - Synthetic FAT32 and ELF Images
+ * 
+ * Builds superfloppy FAT32 volumes in memory with control over file
+ * fragmentation and directory depth, and minimal ARM ELF executables
+ * with arbitrary PT_LOAD layouts. Names are stored as 8.3 short
+ * entries only.
+ */
+
+#ifndef MIMIBOOT_SIM_IMAGE_H
+#define MIMIBOOT_SIM_IMAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================
+ * FAT32 Volume Builder
+ *============================================================================*/
+
+#define SIM_MAX_DIRS    64
+
+typedef struct {
+    char        path[128];      /* Absolute path, no trailing slash ("" = root) */
+    uint32_t    first_cluster;
+    uint32_t    last_cluster;
+    uint32_t    entries;        /* Entries used in the last cluster */
+} sim_dir_t;
+
+typedef struct {
+    uint8_t*    data;               /* Volume image */
+    uint32_t    total_sectors;
+    uint32_t    sectors_per_cluster;
+    uint32_t    reserved_sectors;
+    uint32_t    sectors_per_fat;
+    uint32_t    data_start;         /* First data sector */
+    uint32_t    cluster_count;
+    uint32_t    next_free;          /* Allocation cursor */
+    uint32_t*   fat;                /* Working FAT, copied out by finish */
+    
+    sim_dir_t   dirs[SIM_MAX_DIRS];
+    uint32_t    dir_count;
+} sim_volume_t;
+
+/**
+ * Fragmentation pattern for file data.
+ * Clusters are allocated in runs of run_clusters separated by
+ * gap_clusters left free. run_clusters == 0 means contiguous.
+ */
+typedef struct {
+    uint32_t    run_clusters;
+    uint32_t    gap_clusters;
+} sim_frag_t;
+
+/**
+ * Create an empty volume.
+ * 
+ * @return  0 on success, negative on error
+ */
+int sim_volume_create(sim_volume_t* vol, uint32_t total_sectors, uint32_t sectors_per_cluster);
+
+/**
+ * Free volume memory.
+ */
+void sim_volume_free(sim_volume_t* vol);
+
+/**
+ * Create directory and any missing parents ("/a/b/c").
+ * 
+ * @return  0 on success, negative on error
+ */
+int sim_volume_mkdir(sim_volume_t* vol, const char* path);
+
+/**
+ * Add a file, creating parent directories as needed.
+ * 
+ * @param frag  Fragmentation pattern, or NULL for contiguous
+ * @return      0 on success, negative on error
+ */
+int sim_volume_add_file(sim_volume_t* vol, const char* path,
+                        const void* data, uint32_t size, const sim_frag_t* frag);
+
+/**
+ * Write FAT copies into the image. Call after the last add.
+ */
+void sim_volume_finish(sim_volume_t* vol);
+
+/**
+ * Write the image to a file.
+ * 
+ * @return  0 on success, negative on error
+ */
+int sim_volume_save(const sim_volume_t* vol, const char* path);
+
+/*============================================================================
+ * ELF Builder
+ *============================================================================*/
+
+#define SIM_MAX_SEGS    16
+
+typedef struct {
+    uint32_t    vaddr;
+    uint32_t    filesz;
+    uint32_t    memsz;
+    uint32_t    flags;          /* PF_* */
+    uint32_t    paddr;          /* Load (LMA) address, 0 = vaddr */
+} sim_seg_t;
+
+typedef struct {
+    uint32_t    entry;
+    uint32_t    seg_count;
+    sim_seg_t   segs[SIM_MAX_SEGS];
+    uint32_t    align;          /* File alignment of segment data (0 = 4) */
+    bool        compressible;   /* Code-like contents instead of noise */
+} sim_elf_spec_t;
+
+/**
+ * Build an ELF32 ARM executable. Segment contents are a deterministic
+ * pseudo-random pattern so loads can be checked byte for byte; with
+ * compressible set the pattern repeats like real code and packs
+ * roughly 2-3x under LZ4.
+ * 
+ * @param spec      Layout description
+ * @param out_size  Output: image size
+ * @return          malloc'd image, or NULL
+ */
+uint8_t* sim_elf_build(const sim_elf_spec_t* spec, uint32_t* out_size);
+
+/**
+ * Program the initialized bytes of every segment whose vaddr or LMA
+ * lies in [flash_base, flash_base + flash_size) into that memory, as
+ * flashing the payload's UF2 would.
+ */
+void sim_elf_program_flash(const uint8_t* image, uint32_t flash_base, uint32_t flash_size);
+
+/**
+ * Check that every segment of an image built from spec is present at
+ * its load address with zeroed BSS.
+ * 
+ * @return  true if memory matches
+ */
+bool sim_elf_check(const sim_elf_spec_t* spec, const uint8_t* image);
+
+/**
+ * Expected loader image CRC of an (uncompressed) image built by
+ * sim_elf_build: CRC-32 of every segment's file data, in file order.
+ */
+uint32_t sim_elf_crc(const uint8_t* image);
+
+#endif /* MIMIBOOT_SIM_IMAGE_H */
@@ -0,0 +1,106 @@
+/**
+ * MimiBoot - Host Simulation
+ * 
+ * sim_storage.c - Simulated SD Card
+ */
+
+#include "sim_storage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*============================================================================
+ * Simulated Clock
+ *============================================================================*/
+
+/* Starts at 1 so phase start stamps are never 0 ("not run") */
+static uint32_t s_clock_us = 1;
+
+uint32_t sim_clock_us(void) {
+    return s_clock_us;
+}
+
+void sim_clock_reset(void) {
+    s_clock_us = 1;
+}
+
+/*============================================================================
+ * Device
+ *============================================================================*/
+
+static void set_default_latency(sim_storage_t* dev) {
+    dev->latency.cmd_us = SIM_DEFAULT_CMD_US;
+    dev->latency.block_us = SIM_DEFAULT_BLOCK_US;
+    dev->latency.stop_us = SIM_DEFAULT_STOP_US;
+}
+
+void sim_storage_attach(sim_storage_t* dev, uint8_t* data, uint32_t size) {
+    memset(dev, 0, sizeof(*dev));
+    dev->data = data;
+    dev->block_count = size / 512;
+    set_default_latency(dev);
+}
+
+int sim_storage_load(sim_storage_t* dev, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return -1;
+    }
+    
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    
+    if (size < 512) {
+        fclose(f);
+        return -2;
+    }
+    
+    uint8_t* data = malloc((size_t)size);
+    if (data == NULL || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        free(data);
+        fclose(f);
+        return -3;
+    }
+    fclose(f);
+    
+    sim_storage_attach(dev, data, (uint32_t)size);
+    dev->owned = true;
+    return 0;
+}
+
+void sim_storage_free(sim_storage_t* dev) {
+    if (dev->owned) {
+        free(dev->data);
+    }
+    dev->data = NULL;
+    dev->block_count = 0;
+}
+
+void sim_storage_reset_stats(sim_storage_t* dev) {
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    sim_clock_reset();
+}
+
+int sim_storage_read_blocks(sim_storage_t* dev, uint32_t block, uint8_t* buffer, uint32_t count) {
+    if (count == 0 || block >= dev->block_count || count > dev->block_count - block) {
+        return -1;
+    }
+    
+    memcpy(buffer, dev->data + ((size_t)block * 512), (size_t)count * 512);
+    
+    if (count == 1) {
+        dev->stats.commands += 1;
+        dev->stats.single_reads++;
+        s_clock_us += dev->latency.cmd_us;
+    } else {
+        dev->stats.commands += 2;
+        dev->stats.multi_reads++;
+        s_clock_us += dev->latency.cmd_us + dev->latency.stop_us;
+    }
+    
+    dev->stats.blocks_read += count;
+    s_clock_us += count * dev->latency.block_us;
+    
+    return 0;
+}
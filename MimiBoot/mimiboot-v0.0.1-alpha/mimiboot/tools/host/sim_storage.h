@@ -0,0 +1,105 @@
+/**
+ * MimiBoot - Host Simulation
+ * 
+ * sim_storage.h - Simulated SD Card
+ * 
+ * Block device backed by a memory image, with a simple SPI-mode SD
+ * latency model and the same command accounting as sd_spi.c:
+ * a single-block read is one command (CMD17), a multi-block read is
+ * two (CMD18 + CMD12).
+ */
+
+#ifndef MIMIBOOT_SIM_STORAGE_H
+#define MIMIBOOT_SIM_STORAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*============================================================================
+ * Latency Model
+ *============================================================================*/
+
+/**
+ * Per-operation costs in microseconds.
+ */
+typedef struct {
+    uint32_t    cmd_us;         /* Command frame, Ncr and start token wait */
+    uint32_t    block_us;       /* 512 data bytes plus CRC at bus speed */
+    uint32_t    stop_us;        /* CMD12 and busy wait after a multi-block read */
+} sim_latency_t;
+
+/*
+ * Defaults approximate a class 10 card at 31.25 MHz SPI (SYS_CLK/4):
+ * 514 bytes * 8 bits / 31.25 MHz ~= 132 us per block.
+ */
+#define SIM_DEFAULT_CMD_US      100
+#define SIM_DEFAULT_BLOCK_US    132
+#define SIM_DEFAULT_STOP_US     40
+
+/*============================================================================
+ * Device
+ *============================================================================*/
+
+/**
+ * Access counters.
+ */
+typedef struct {
+    uint32_t    commands;       /* Commands issued (CMD17/18/12) */
+    uint32_t    single_reads;   /* CMD17 transfers */
+    uint32_t    multi_reads;    /* CMD18 transfers */
+    uint32_t    blocks_read;    /* 512-byte blocks transferred */
+} sim_stats_t;
+
+typedef struct {
+    uint8_t*        data;           /* Image contents */
+    uint32_t        block_count;    /* Image size in blocks */
+    bool            owned;          /* data was allocated by sim_storage */
+    sim_latency_t   latency;
+    sim_stats_t     stats;
+} sim_storage_t;
+
+/**
+ * Attach an in-memory image (not copied, not freed).
+ */
+void sim_storage_attach(sim_storage_t* dev, uint8_t* data, uint32_t size);
+
+/**
+ * Load an image file into memory.
+ * 
+ * @return  0 on success, negative on error
+ */
+int sim_storage_load(sim_storage_t* dev, const char* path);
+
+/**
+ * Release an image loaded with sim_storage_load.
+ */
+void sim_storage_free(sim_storage_t* dev);
+
+/**
+ * Reset counters and the simulated clock.
+ */
+void sim_storage_reset_stats(sim_storage_t* dev);
+
+/**
+ * Read blocks, charging the latency model to the simulated clock.
+ * 
+ * @return  0 on success, negative on error
+ */
+int sim_storage_read_blocks(sim_storage_t* dev, uint32_t block, uint8_t* buffer, uint32_t count);
+
+/*============================================================================
+ * Simulated Clock
+ *============================================================================*/
+
+/**
+ * Microseconds of simulated storage time since the last reset.
+ * Signature matches hal_get_time_us so it can drive the boot profile.
+ */
+uint32_t sim_clock_us(void);
+
+/**
+ * Reset the simulated clock to zero.
+ */
+void sim_clock_reset(void);
+
+#endif /* MIMIBOOT_SIM_STORAGE_H */